@@ -25,11 +25,11 @@ static int local_nodes_out_of_range(
     const R *lo, const R *up, const R *x_max);
 static R random_number_less_than_one(
     void);
-static void default_fft_size(
-    const INT *N,
-    INT *n, R *x_max);
-static int default_m(
-    void);
+static void default_parameters(
+    int d, const INT *N, unsigned pnfft_flags,
+    INT *n, R *x_max, int *m);
+static R default_sigma(
+    unsigned pnfft_flags);
 
 
 void PNX(init_x_3d_adv)(
@@ -98,9 +98,8 @@ void PNX(local_size_adv)(
   INT n[3];
   R x_max[3];
 
-  m = default_m();
-  default_fft_size(N,
-      n, x_max);
+  default_parameters(d, N, pnfft_flags,
+      n, x_max, &m);
 
   PNX(local_size_guru)(
       d, N, n, x_max, m, comm_cart, pnfft_flags,
@@ -119,9 +118,8 @@ void PNX(local_size_adv_c2r)(
   INT n[3];
   R x_max[3];
 
-  m = default_m();
-  default_fft_size(N,
-      n, x_max);
+  default_parameters(d, N, pnfft_flags,
+      n, x_max, &m);
 
   PNX(local_size_guru_c2r)(
       d, N, n, x_max, m, comm_cart, pnfft_flags,
@@ -139,9 +137,8 @@ PNX(plan) PNX(init_adv)(
   INT n[3];
   R x_max[3];
 
-  m = default_m();
-  default_fft_size(N,
-      n, x_max);
+  default_parameters(d, N, pnfft_flags,
+      n, x_max, &m);
 
   return PNX(init_guru)(
       d, N, n, x_max, m,
@@ -159,9 +156,8 @@ PNX(plan) PNX(init_adv_c2r)(
   INT n[3];
   R x_max[3];
 
-  m = default_m();
-  default_fft_size(N,
-      n, x_max);
+  default_parameters(d, N, pnfft_flags,
+      n, x_max, &m);
 
   return PNX(init_guru_c2r)(
       d, N, n, x_max, m,
@@ -169,24 +165,49 @@ PNX(plan) PNX(init_adv_c2r)(
 }
 
 
-static void default_fft_size(
-    const INT *N,
-    INT *n, R *x_max
+/* Default oversampled FFT size and real space cutoff 'm'.
+ * Oversampling factors below 2 round n up to smooth sizes and increase 'm', such that
+ * the window keeps the accuracy of the default cutoff with oversampling factor 2. */
+static void default_parameters(
+    int d, const INT *N, unsigned pnfft_flags,
+    INT *n, R *x_max, int *m
     )
 {
-  for(int t=0; t<3; t++){
-    n[t] = 2*N[t];
+  const int m_default = 6;
+  const unsigned window = pnfft_flags & PNFFTI_WINDOW_MASK;
+  R sigma = default_sigma(pnfft_flags), sigma_min = 2.0;
+
+  if(sigma >= 2.0){
+    for(int t=0; t<d; t++){
+      n[t] = 2*N[t];
+      x_max[t] = 0.5;
+    }
+    *m = m_default;
+    return;
+  }
+
+  for(int t=0; t<d; t++){
+    n[t] = PNX(smooth_fft_size)((INT) pnfft_ceil(sigma * N[t]));
     x_max[t] = 0.5;
+    sigma_min = PNFFT_MIN(sigma_min, (R) n[t] / N[t]);
   }
+
+  *m = PNX(retune_m)(window, sigma_min, m_default, 2.0);
+
+  /* FFT grid must hold the window */
+  for(int t=0; t<d; t++)
+    if(n[t] < 2 * *m + 2)
+      n[t] = PNX(smooth_fft_size)(2 * *m + 2);
 }
 
 
-/* We choose the same default real space cutoff 'm' for all
- * window functions. Therefore, we do not need the pnfft_flags for 
- * local_size_adv */
-static int default_m(
-    void
+static R default_sigma(
+    unsigned pnfft_flags
     )
 {
-  return 6;
+  if(pnfft_flags & PNFFT_OVERSAMPLING_1_25)
+    return 1.25;
+  if(pnfft_flags & PNFFT_OVERSAMPLING_1_5)
+    return 1.5;
+  return 2.0;
 }
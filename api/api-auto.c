@@ -0,0 +1,399 @@
+/*
+ * Copyright (c) 2011-2013 Michael Pippig
+ *
+ * This file is part of PNFFT.
+ *
+ * PNFFT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PNFFT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PNFFT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <complex.h>
+#include "pnfft.h"
+#include "ipnfft.h"
+
+/* Automatic choice of window, oversampling, cut-off, window evaluation and interlacing.
+ * For every window and oversampling factor the smallest m is taken from a-priori error estimates.
+ * Candidates are ranked by a simple cost model. With PNFFT_AUTO_MEASURE the cheapest candidates
+ * (with PNFFT_AUTO_EXHAUSTIVE all of them) are planned and timed on the given process mesh and their
+ * error is measured against a more accurate reference plan. If none of them meets eps, the remaining
+ * candidates are measured until one does, otherwise the most accurate configuration is used.
+ * The chosen configuration is stored in the wisdom, i.e., it is reused by later calls and written
+ * by export_wisdom. */
+
+#define AUTO_MAX_M          16
+#define AUTO_NUM_SIGMA       3
+#define AUTO_NUM_WINDOWS     4
+#define AUTO_NUM_EVALS       3
+#define AUTO_NUM_MEASURE     6
+#define AUTO_MAX_CANDIDATES  (2*AUTO_NUM_SIGMA*AUTO_NUM_WINDOWS*AUTO_NUM_EVALS)
+
+/* only these flags influence the choice and are part of the wisdom key */
+#define AUTO_KEY_FLAGS ((PNFFT_AUTO_MEASURE | PNFFT_AUTO_EXHAUSTIVE | PNFFT_AUTO_NO_INTERLACING))
+
+static const R auto_sigma[AUTO_NUM_SIGMA] = {2.0, 1.5, 1.25};
+static const unsigned auto_windows[AUTO_NUM_WINDOWS] = {
+  PNFFT_WINDOW_KAISER_BESSEL, PNFFT_WINDOW_ES, PNFFT_WINDOW_GAUSSIAN, PNFFT_WINDOW_BSPLINE};
+static const unsigned auto_evals[AUTO_NUM_EVALS] = {
+  0, PNFFT_PRE_CUB_PSI, PNFFT_PRE_POLY_PSI};
+
+typedef struct{
+  int m;                      /**< Cut-off parameter of the window function        */
+  INT n[3];                   /**< FFT length                                      */
+  int sigma_index;            /**< Index of oversampling factor in auto_sigma      */
+  unsigned pnfft_flags;       /**< Window, evaluation and interlacing flags        */
+  R est_error;                /**< A-priori error estimate                         */
+  R cost;                     /**< Cost model, arbitrary units                     */
+  double time;                /**< Measured time of trafo and adj                  */
+  R error;                    /**< Measured error (negative if not measured)       */
+} auto_candidate;
+
+static R eval_cost(
+    unsigned window, unsigned eval, int m);
+static R cost_model(
+    const INT *N, const auto_candidate *c, int np_total);
+static int compare_cost(
+    const void *a, const void *b);
+static int get_candidates(
+    const INT *N, R eps, unsigned auto_flags, int np_total,
+    auto_candidate *cand);
+static double run_candidate(
+    const INT *N, int m, const INT *n, unsigned pnfft_flags,
+    unsigned pfft_flags, MPI_Comm comm_cart,
+    C **f, R *norm_f_hat);
+static void get_procmesh(
+    MPI_Comm comm_cart,
+    int *np);
+static const char* window_name(
+    unsigned pnfft_flags);
+
+
+/* rough number of flops for one evaluation of the one-dimensional window */
+static R eval_cost(
+    unsigned window, unsigned eval, int m
+    )
+{
+  if(eval & PNFFT_PRE_CUB_PSI)
+    return 8;
+  if(eval & PNFFT_PRE_POLY_PSI)
+    return 12;
+  if(window & PNFFT_WINDOW_BSPLINE)
+    return 4*m;
+  if(window & PNFFT_WINDOW_GAUSSIAN)
+    return 15;
+  return 30;
+}
+
+/* Flops of one trafo per process: tensor product convolution with M = N_total nodes plus the FFT,
+ * interlacing doubles both parts. */
+static R cost_model(
+    const INT *N, const auto_candidate *c, int np_total
+    )
+{
+  const unsigned window = c->pnfft_flags & PNFFTI_WINDOW_MASK;
+  const unsigned eval = c->pnfft_flags & (PNFFT_PRE_INTPOL_PSI | PNFFT_PRE_POLY_PSI);
+  const R cutoff = 2*c->m+1;
+  R M = (R) PNX(prod_INT)(3, N) / np_total;
+  R n_total = (R) PNX(prod_INT)(3, c->n);
+  R cost;
+
+  cost = M * (cutoff*cutoff*cutoff + 3*cutoff*eval_cost(window, eval, c->m));
+  cost += 5.0 * n_total * pnfft_log2(n_total) / np_total;
+
+  return (c->pnfft_flags & PNFFT_INTERLACED) ? 2*cost : cost;
+}
+
+static int compare_cost(
+    const void *a, const void *b
+    )
+{
+  R ca = ((const auto_candidate*) a)->cost;
+  R cb = ((const auto_candidate*) b)->cost;
+  return (ca > cb) - (ca < cb);
+}
+
+/* All combinations of oversampling, window and evaluation that meet 'eps' a-priori,
+ * sorted by the cost model. Interlaced candidates use one less m and are only added
+ * if they are measured. */
+static int get_candidates(
+    const INT *N, R eps, unsigned auto_flags, int np_total,
+    auto_candidate *cand
+    )
+{
+  const int measure = (auto_flags & (PNFFT_AUTO_MEASURE | PNFFT_AUTO_EXHAUSTIVE)) ? 1 : 0;
+  int num = 0;
+
+  for(int s=0; s<AUTO_NUM_SIGMA; s++){
+    for(int w=0; w<AUTO_NUM_WINDOWS; w++){
+      int m;
+      for(m=1; m<=AUTO_MAX_M; m++)
+        if( 3*PNX(window_error_estimate)(auto_windows[w], auto_sigma[s], m) <= eps )
+          break;
+      if(m > AUTO_MAX_M)
+        continue;
+
+      for(int e=0; e<AUTO_NUM_EVALS; e++){
+        for(int il=0; il<2; il++){
+          if( il && (!measure || (auto_flags & PNFFT_AUTO_NO_INTERLACING) || (m == 1)) )
+            continue;
+
+          auto_candidate *c = &cand[num++];
+          c->m = (il) ? m-1 : m;
+          c->sigma_index = s;
+          for(int t=0; t<3; t++){
+            /* smooth even FFT size, at least 2m+2 to hold the window */
+            c->n[t] = (INT) pnfft_ceil(auto_sigma[s] * N[t]);
+            c->n[t] = PNX(smooth_fft_size)(PNFFT_MAX(c->n[t], 2*c->m+2));
+          }
+          c->pnfft_flags = auto_windows[w] | auto_evals[e] | PNFFT_PRE_PHI_HAT;
+          if(il)
+            c->pnfft_flags |= PNFFT_INTERLACED;
+          c->est_error = 3*PNX(window_error_estimate)(auto_windows[w], auto_sigma[s], m);
+          c->cost = cost_model(N, c, np_total);
+          c->time = 0;
+          c->error = -1;
+        }
+      }
+    }
+  }
+
+  qsort(cand, (size_t) num, sizeof(auto_candidate), compare_cost);
+  return num;
+}
+
+/* Plan, execute and time one configuration with M = N_total quasi-random nodes.
+ * Returns the maximum time of one trafo and one adj over all processes.
+ * If 'f' is not NULL, the result of the trafo and the 1-norm of f_hat are returned. */
+static double run_candidate(
+    const INT *N, int m, const INT *n, unsigned pnfft_flags,
+    unsigned pfft_flags, MPI_Comm comm_cart,
+    C **f, R *norm_f_hat
+    )
+{
+  /* additive recurrence with irrational steps gives equal nodes for all candidates without using rand() */
+  const R alpha[3] = {0.7548776662466927, 0.5698402909980532, 0.4301597090019468};
+  INT local_N[3], local_N_start[3], local_M;
+  R lower_border[3], upper_border[3], x_max[3] = {0.5, 0.5, 0.5};
+  double time, time_max;
+  PNX(plan) ths;
+  PNX(nodes) nodes;
+
+  PNX(local_size_guru)(3, N, n, x_max, m, comm_cart, pnfft_flags,
+      local_N, local_N_start, lower_border, upper_border);
+  local_M = PNX(prod_INT)(3, local_N);
+
+  ths = PNX(init_guru)(3, N, n, x_max, m, pnfft_flags | PNFFT_MALLOC_F_HAT, pfft_flags, comm_cart);
+  nodes = PNX(init_nodes)(local_M, PNFFT_MALLOC_X | PNFFT_MALLOC_F);
+
+  PNX(init_f_hat_3d)(N, local_N, local_N_start, pnfft_flags, ths->f_hat);
+  for(INT j=0; j<local_M; j++)
+    for(int t=0; t<3; t++){
+      R u = (j+1) * alpha[t];
+      nodes->x[3*j+t] = lower_border[t] + (upper_border[t] - lower_border[t]) * (u - pnfft_floor(u));
+    }
+
+  if(f != NULL){
+    R local_norm = 0;
+    for(INT k=0; k<local_M; k++)
+      local_norm += pnfft_cabs(ths->f_hat[k]);
+    MPI_Allreduce(&local_norm, norm_f_hat, 1, PNFFT_MPI_REAL_TYPE, MPI_SUM, comm_cart);
+  }
+
+  /* first run initializes caches and gives the result */
+  PNX(trafo)(ths, nodes, PNFFT_COMPUTE_F);
+  if(f != NULL){
+    *f = (local_M) ? (C*) PNX(malloc_tagged)(sizeof(C) * (size_t) local_M, PNFFT_MEM_NODES, NULL) : NULL;
+    for(INT j=0; j<local_M; j++)
+      (*f)[j] = nodes->f[j];
+  }
+
+  MPI_Barrier(comm_cart);
+  time = -MPI_Wtime();
+  PNX(trafo)(ths, nodes, PNFFT_COMPUTE_F);
+  PNX(adj)(ths, nodes, PNFFT_COMPUTE_F);
+  time += MPI_Wtime();
+  MPI_Allreduce(&time, &time_max, 1, MPI_DOUBLE, MPI_MAX, comm_cart);
+
+  PNX(finalize)(ths, PNFFT_FREE_F_HAT);
+  PNX(free_nodes)(nodes, PNFFT_FREE_X | PNFFT_FREE_F);
+
+  return time_max;
+}
+
+static void get_procmesh(
+    MPI_Comm comm_cart,
+    int *np
+    )
+{
+  int ndims, status, periods[3], coords[3];
+
+  np[0] = np[1] = np[2] = 1;
+
+  MPI_Topo_test(comm_cart, &status);
+  if(status != MPI_CART){
+    MPI_Comm_size(comm_cart, &np[0]);
+    return;
+  }
+
+  MPI_Cartdim_get(comm_cart, &ndims);
+  if(ndims <= 3)
+    MPI_Cart_get(comm_cart, ndims, np, periods, coords);
+}
+
+static const char* window_name(
+    unsigned pnfft_flags
+    )
+{
+  if(pnfft_flags & PNFFT_WINDOW_GAUSSIAN)
+    return "Gaussian";
+  if(pnfft_flags & PNFFT_WINDOW_BSPLINE)
+    return "B-spline";
+  if(pnfft_flags & PNFFT_WINDOW_ES)
+    return "ES";
+  return "Kaiser-Bessel";
+}
+
+
+/* Return the fastest plan with an error (relative to the 1-norm of f_hat) below 'eps'.
+ * Collective on comm_cart. The plan allocates f_hat, finalize it with PNFFT_FREE_F_HAT. */
+PNX(plan) PNX(init_auto)(
+    const INT *N, R eps, MPI_Comm comm_cart,
+    unsigned auto_flags
+    )
+{
+  const unsigned key_flags = auto_flags & AUTO_KEY_FLAGS;
+  const R x_max[3] = {0.5, 0.5, 0.5};
+  int np[3], np_total, num, num_measure, best = -1, m;
+  unsigned pfft_flags, pnfft_flags;
+  INT n[3];
+  double time;
+  auto_candidate cand[AUTO_MAX_CANDIDATES];
+
+  get_procmesh(comm_cart, np);
+  np_total = np[0]*np[1]*np[2];
+
+  pfft_flags = PFFT_DESTROY_INPUT;
+  pfft_flags |= (auto_flags & (PNFFT_AUTO_MEASURE | PNFFT_AUTO_EXHAUSTIVE)) ? PFFT_MEASURE : PFFT_ESTIMATE;
+
+  /* reuse an earlier decision */
+  if( PNX(recall_auto_wisdom)(N, (double) eps, np, key_flags, &m, n, &pnfft_flags, &time) )
+    return PNX(init_guru)(3, N, n, x_max, m, pnfft_flags | PNFFT_MALLOC_F_HAT, pfft_flags, comm_cart);
+
+  num = get_candidates(N, eps, auto_flags, np_total, cand);
+
+  if(auto_flags & PNFFT_AUTO_EXHAUSTIVE)
+    num_measure = num;
+  else if(auto_flags & PNFFT_AUTO_MEASURE)
+    num_measure = PNFFT_MIN(num, AUTO_NUM_MEASURE);
+  else
+    num_measure = 0;
+
+  if(num_measure > 0){
+    C *f_ref[AUTO_NUM_SIGMA] = {NULL, NULL, NULL};
+    R norm_f_hat[AUTO_NUM_SIGMA];
+    INT n_ref[AUTO_NUM_SIGMA][3] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}};
+    INT local_N[3], local_N_start[3], local_M;
+    R lower_border[3], upper_border[3];
+
+    if(auto_flags & PNFFT_AUTO_VERBOSE)
+      PX(printf)(comm_cart, "PNFFT auto tuning for N = %td x %td x %td, eps = %.2e on %d x %d x %d processes:\n",
+          N[0], N[1], N[2], (double) eps, np[0], np[1], np[2]);
+
+    /* if none of the first candidates meets eps, go on with the next ones in the order of the cost model */
+    for(int k=0; k<num; k++){
+      auto_candidate *c = &cand[k];
+      int s = c->sigma_index;
+      C *f;
+
+      if( (k >= num_measure) && (best >= 0) )
+        break;
+
+      /* reference with the same FFT size, i.e., with the same node distribution */
+      if( (n_ref[s][0] != c->n[0]) || (n_ref[s][1] != c->n[1]) || (n_ref[s][2] != c->n[2]) ){
+        int m_ref;
+        for(m_ref=1; m_ref<AUTO_MAX_M; m_ref++)
+          if( 3*PNX(window_error_estimate)(PNFFT_WINDOW_KAISER_BESSEL, auto_sigma[s], m_ref) <= 1e-2*eps )
+            break;
+        /* the window of the reference must fit into the FFT grid of the candidate */
+        for(int t=0; t<3; t++)
+          m_ref = PNFFT_MIN(m_ref, (int) (c->n[t]/2 - 1));
+        PNX(save_free)(f_ref[s]);
+        run_candidate(N, m_ref, c->n, PNFFT_WINDOW_KAISER_BESSEL | PNFFT_PRE_PHI_HAT, PFFT_ESTIMATE | PFFT_DESTROY_INPUT,
+            comm_cart, &f_ref[s], &norm_f_hat[s]);
+        for(int t=0; t<3; t++)
+          n_ref[s][t] = c->n[t];
+      }
+
+      c->time = run_candidate(N, c->m, c->n, c->pnfft_flags, PFFT_ESTIMATE | PFFT_DESTROY_INPUT,
+          comm_cart, &f, &norm_f_hat[s]);
+
+      PNX(local_size_guru)(3, N, c->n, x_max, c->m, comm_cart, c->pnfft_flags,
+          local_N, local_N_start, lower_border, upper_border);
+      local_M = PNX(prod_INT)(3, local_N);
+
+      R local_err = 0;
+      for(INT j=0; j<local_M; j++)
+        local_err = PNFFT_MAX(local_err, pnfft_cabs(f[j] - f_ref[s][j]));
+      MPI_Allreduce(&local_err, &c->error, 1, PNFFT_MPI_REAL_TYPE, MPI_MAX, comm_cart);
+      if(norm_f_hat[s] > 0)
+        c->error /= norm_f_hat[s];
+      PNX(save_free)(f);
+
+      if(auto_flags & PNFFT_AUTO_VERBOSE)
+        PX(printf)(comm_cart, "  %-13s sigma = %.2f, m = %2d, %-7s%s: estimated error = %.2e, error = %.2e, time = %.2e s\n",
+            window_name(c->pnfft_flags), (double) auto_sigma[s], c->m,
+            (c->pnfft_flags & PNFFT_PRE_CUB_PSI) ? "intpol" : (c->pnfft_flags & PNFFT_PRE_POLY_PSI) ? "poly" : "direct",
+            (c->pnfft_flags & PNFFT_INTERLACED) ? ", interlaced" : "",
+            (double) c->est_error, (double) c->error, c->time);
+
+      if( (c->error <= eps) && ((best < 0) || (c->time < cand[best].time)) )
+        best = k;
+    }
+
+    for(int s=0; s<AUTO_NUM_SIGMA; s++)
+      PNX(save_free)(f_ref[s]);
+  }
+
+  /* without measurement take the cheapest candidate of the cost model,
+   * measured candidates that missed eps are never taken */
+  if( (best < 0) && (num_measure == 0) && (num > 0) ){
+    for(int k=0; k<num; k++)
+      if( ~cand[k].pnfft_flags & PNFFT_INTERLACED ){
+        best = k;
+        break;
+      }
+  }
+
+  if(best >= 0){
+    m = cand[best].m;
+    for(int t=0; t<3; t++)
+      n[t] = cand[best].n[t];
+    pnfft_flags = cand[best].pnfft_flags;
+    time = cand[best].time;
+  } else {
+    /* eps is out of reach, use the most accurate configuration */
+    m = AUTO_MAX_M;
+    for(int t=0; t<3; t++)
+      n[t] = PNFFT_MAX(2*N[t], 2*m+2);
+    pnfft_flags = PNFFT_WINDOW_KAISER_BESSEL | PNFFT_PRE_PHI_HAT;
+    time = 0;
+  }
+
+  if(auto_flags & PNFFT_AUTO_VERBOSE)
+    PX(printf)(comm_cart, "PNFFT auto tuning chose %s window with n = %td x %td x %td, m = %d, pnfft_flags = %u\n",
+        window_name(pnfft_flags), n[0], n[1], n[2], m, pnfft_flags);
+
+  PNX(remember_auto_wisdom)(N, (double) eps, np, key_flags, m, n, pnfft_flags, time);
+
+  return PNX(init_guru)(3, N, n, x_max, m, pnfft_flags | PNFFT_MALLOC_F_HAT, pfft_flags, comm_cart);
+}
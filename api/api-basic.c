@@ -30,6 +30,7 @@ void PNX(init) (void){
 
 
 void PNX(cleanup) (void){
+  PNX(forget_wisdom)();
   PX(cleanup)();
 }
 
@@ -101,67 +102,77 @@ static void trafo_F_and_B_ik_complex_input(
     PNX(plan) ths, PNX(nodes) nodes, int use_interlacing, int interlaced, unsigned compute_flags
     )
 {
-  /* duplicate g1 since we have to scale it several times for computing gradient/Hessian */
-  if( compute_flags & (PNFFT_COMPUTE_GRAD_F | PNFFT_COMPUTE_HESSIAN_F) ){
-    PNFFT_START_TIMING(ths->comm_cart, ths->timer_trafo[PNFFT_TIMER_MATRIX_D]);
-    if( ~compute_flags & PNFFT_OMIT_DECONV )
-      for(INT k=0; k<ths->local_N_total; k++)
-        ((C*)ths->g1_buffer)[k] = ((C*)ths->g1)[k];
-    PNFFT_FINISH_TIMING(ths->timer_trafo[PNFFT_TIMER_MATRIX_D]);
-  }
+  /* g1_buffer holds a copy of the deconvolved g1 (see trafo),
+   * since we have to scale it several times for computing gradient/Hessian */
 
   /* calculate potentials */
   if( compute_flags & PNFFT_COMPUTE_F){
-    PNFFT_START_TIMING(ths->comm_cart, ths->timer_trafo[PNFFT_TIMER_MATRIX_F]);
+    ths->stage_component = PNFFT_TIMER_IK_F;
+    PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_IK_F);
+    PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_F);
     if( ~compute_flags & PNFFT_OMIT_FFT )
       PNX(trafo_F)(ths);
-    PNFFT_FINISH_TIMING(ths->timer_trafo[PNFFT_TIMER_MATRIX_F]);
+    PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_F);
 
-    PNFFT_START_TIMING(ths->comm_cart, ths->timer_trafo[PNFFT_TIMER_MATRIX_B]);
+    PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_B);
     if( ~compute_flags & PNFFT_OMIT_CONV )
       PNX(trafo_B_ad)(ths, nodes, nodes->f, NULL, NULL, 0, 1, use_interlacing, interlaced, PNFFT_COMPUTE_F);
-    PNFFT_FINISH_TIMING(ths->timer_trafo[PNFFT_TIMER_MATRIX_B]);
+    PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_B);
+    PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_IK_F);
+    ths->stage_component = -1;
   }
 
-  /* calculate gradient component wise */
+  /* calculate gradient component wise, components of trivial axes d <= dim < 3 stay zero */
   if(compute_flags & PNFFT_COMPUTE_GRAD_F){
-    for(int dim =0; dim<3; dim++){
-      PNFFT_START_TIMING(ths->comm_cart, ths->timer_trafo[PNFFT_TIMER_MATRIX_D]);
+    for(int dim =0; dim<ths->d; dim++){
+      ths->stage_component = PNFFT_TIMER_IK_GRAD + dim;
+      PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_IK_GRAD + dim);
+      PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_D);
       if( ~compute_flags & PNFFT_OMIT_DECONV )
         PNX(trafo_scale_ik_diff_c2c)((C*)ths->g1_buffer, ths->local_N_start, ths->local_N, dim, ths->pnfft_flags,
             (C*)ths->g1);
-      PNFFT_FINISH_TIMING(ths->timer_trafo[PNFFT_TIMER_MATRIX_D]);
+      if( ~compute_flags & PNFFT_OMIT_DECONV )
+        PNX(count_D)(ths, ths->counter_trafo, 3, 2);
+      PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_D);
       
-      PNFFT_START_TIMING(ths->comm_cart, ths->timer_trafo[PNFFT_TIMER_MATRIX_F]);
+      PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_F);
       if( ~compute_flags & PNFFT_OMIT_FFT )
         PNX(trafo_F)(ths);
-      PNFFT_FINISH_TIMING(ths->timer_trafo[PNFFT_TIMER_MATRIX_F]);
+      PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_F);
 
-      PNFFT_START_TIMING(ths->comm_cart, ths->timer_trafo[PNFFT_TIMER_MATRIX_B]);
+      PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_B);
       if( ~compute_flags & PNFFT_OMIT_CONV )
         PNX(trafo_B_ad)(ths, nodes, nodes->grad_f, NULL, NULL, dim, 3, use_interlacing, interlaced, PNFFT_COMPUTE_F);
-      PNFFT_FINISH_TIMING(ths->timer_trafo[PNFFT_TIMER_MATRIX_B]);
+      PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_B);
+      PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_IK_GRAD + dim);
+      ths->stage_component = -1;
     }
   }
 
   /* calculate Hessian component wise */
   if(compute_flags & PNFFT_COMPUTE_HESSIAN_F){
     for(int dim =0; dim<6; dim++){
-      PNFFT_START_TIMING(ths->comm_cart, ths->timer_trafo[PNFFT_TIMER_MATRIX_D]);
+      ths->stage_component = PNFFT_TIMER_IK_HESSIAN + dim;
+      PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_IK_HESSIAN + dim);
+      PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_D);
       if( ~compute_flags & PNFFT_OMIT_DECONV )
         PNX(trafo_scale_ik_diff2_c2c)((C*)ths->g1_buffer, ths->local_N_start, ths->local_N, dim, ths->pnfft_flags,
             (C*)ths->g1);
-      PNFFT_FINISH_TIMING(ths->timer_trafo[PNFFT_TIMER_MATRIX_D]);
+      if( ~compute_flags & PNFFT_OMIT_DECONV )
+        PNX(count_D)(ths, ths->counter_trafo, 4, 2);
+      PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_D);
       
-      PNFFT_START_TIMING(ths->comm_cart, ths->timer_trafo[PNFFT_TIMER_MATRIX_F]);
+      PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_F);
       if( ~compute_flags & PNFFT_OMIT_FFT )
         PNX(trafo_F)(ths);
-      PNFFT_FINISH_TIMING(ths->timer_trafo[PNFFT_TIMER_MATRIX_F]);
+      PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_F);
 
-      PNFFT_START_TIMING(ths->comm_cart, ths->timer_trafo[PNFFT_TIMER_MATRIX_B]);
+      PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_B);
       if( ~compute_flags & PNFFT_OMIT_CONV )
         PNX(trafo_B_ad)(ths, nodes, nodes->hessian_f, NULL, NULL, dim, 6, use_interlacing, interlaced, PNFFT_COMPUTE_F);
-      PNFFT_FINISH_TIMING(ths->timer_trafo[PNFFT_TIMER_MATRIX_B]);
+      PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_B);
+      PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_IK_HESSIAN + dim);
+      ths->stage_component = -1;
     }
   }
 }
@@ -171,27 +182,35 @@ static void trafo(
     PNX(plan) ths, PNX(nodes) nodes, int use_interlacing, int interlaced, unsigned compute_flags
     )
 {
+  /* ik-differentiation scales the deconvolved coefficients several times, keep a copy in the same pass */
+  C *copy = ( (ths->pnfft_flags & PNFFT_DIFF_IK) && (compute_flags & (PNFFT_COMPUTE_GRAD_F | PNFFT_COMPUTE_HESSIAN_F)) )
+    ? (C*)ths->g1_buffer : NULL;
+
+  ths->stage_interlaced = interlaced;
+
   /* multiplication with matrix D */
-  PNFFT_START_TIMING(ths->comm_cart, ths->timer_trafo[PNFFT_TIMER_MATRIX_D]);
+  PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_D);
   if( ~compute_flags & PNFFT_OMIT_DECONV )
-    PNX(trafo_D)(ths, interlaced);
-  PNFFT_FINISH_TIMING(ths->timer_trafo[PNFFT_TIMER_MATRIX_D]);
+    PNX(trafo_D)(ths, interlaced, copy);
+  PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_D);
  
   if( ths->pnfft_flags & PNFFT_DIFF_IK ){
     /* multiplication with matrix F and B for ik-differentiation */
+    PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_IK);
     trafo_F_and_B_ik_complex_input(ths, nodes, use_interlacing, interlaced, compute_flags);
+    PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_IK);
   } else {
     /* multiplication with matrix F */
-    PNFFT_START_TIMING(ths->comm_cart, ths->timer_trafo[PNFFT_TIMER_MATRIX_F]);
+    PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_F);
     if( ~compute_flags & PNFFT_OMIT_FFT )
       PNX(trafo_F)(ths);
-    PNFFT_FINISH_TIMING(ths->timer_trafo[PNFFT_TIMER_MATRIX_F]);
+    PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_F);
 
     /* multiplication with matrix B */
-    PNFFT_START_TIMING(ths->comm_cart, ths->timer_trafo[PNFFT_TIMER_MATRIX_B]);
+    PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_B);
     if( ~compute_flags & PNFFT_OMIT_CONV )
       PNX(trafo_B_ad)(ths, nodes, nodes->f, nodes->grad_f, nodes->hessian_f, 0, 1, use_interlacing, interlaced, compute_flags);
-    PNFFT_FINISH_TIMING(ths->timer_trafo[PNFFT_TIMER_MATRIX_B]);
+    PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_B);
   }
 }
 
@@ -205,28 +224,32 @@ void PNX(trafo)(
   if(ths == NULL) return;
   if(nodes == NULL && (~compute_flags & PNFFT_OMIT_CONV) ) return;
 
-  PNFFT_START_TIMING(ths->comm_cart, ths->timer_trafo[PNFFT_TIMER_WHOLE]);
+  PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_WHOLE);
 
+  /* the outputs are accumulated by matrix B, time their zeroing as part of it */
   if( (~compute_flags & PNFFT_COMPUTE_ACCUMULATED) && (~compute_flags & PNFFT_OMIT_CONV) ){
     INT tuple = (ths->trafo_flag & PNFFTI_TRAFO_C2R) ? 1 : 2;
 
+    PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_B);
+    PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_ZERO);
     if(compute_flags & PNFFT_COMPUTE_F)
-      for(INT m=0; m<tuple*nodes->local_M; m++)
-        nodes->f[m] = 0;
+      PNX(zero_parallel)(nodes->f, tuple*nodes->local_M);
     if(compute_flags & PNFFT_COMPUTE_GRAD_F)
-      for(INT m=0; m<3*tuple*nodes->local_M; m++)
-        nodes->grad_f[m] = 0;
+      PNX(zero_parallel)(nodes->grad_f, 3*tuple*nodes->local_M);
     if(compute_flags & PNFFT_COMPUTE_HESSIAN_F)
-      for(INT m=0; m<6*tuple*nodes->local_M; m++)
-        nodes->hessian_f[m] = 0;
+      PNX(zero_parallel)(nodes->hessian_f, 6*tuple*nodes->local_M);
+    PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_ZERO);
+    PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_B);
   }
 
   if(compute_flags & PNFFT_COMPUTE_DIRECT){
 
+    PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_A);
     PNX(trafo_A)(ths, nodes, compute_flags);
+    PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_MATRIX_A);
     
     ths->timer_trafo[PNFFT_TIMER_ITER]++;
-    PNFFT_FINISH_TIMING(ths->timer_trafo[PNFFT_TIMER_WHOLE]);
+    PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_WHOLE);
     return;
   }
 
@@ -234,13 +257,14 @@ void PNX(trafo)(
     /* compute interlaced NFFT and average the results */
     trafo(ths, nodes, use_interlacing=1, interlaced=0, compute_flags);
     trafo(ths, nodes, use_interlacing=1, interlaced=1, compute_flags);
+    ths->stage_interlaced = 0;
   } else {
     /* compute non-interlaced NFFT */
     trafo(ths, nodes, use_interlacing=0, interlaced=0, compute_flags);
   }     
  
   ths->timer_trafo[PNFFT_TIMER_ITER]++;
-  PNFFT_FINISH_TIMING(ths->timer_trafo[PNFFT_TIMER_WHOLE]);
+  PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_WHOLE);
 }
 
 
@@ -251,93 +275,117 @@ static void adjoint_B_and_F_ik_complex_input(
     )
 {
   /* save g1 since we want to accumulate all results at the end */
-  PNFFT_START_TIMING(ths->comm_cart, ths->timer_adj[PNFFT_TIMER_MATRIX_B]);
+  PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_B);
+  PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_ZERO);
   if( ~compute_flags & PNFFT_OMIT_DECONV )
-    for(INT k=0; k<ths->local_N_total; k++)
-      ((C*)ths->g1_buffer)[k] = 0;
-//       ((C*)ths->g1_buffer)[k] = ((C*)ths->g1)[k];
-  PNFFT_FINISH_TIMING(ths->timer_adj[PNFFT_TIMER_MATRIX_B]);
+    PNX(zero_parallel)(ths->g1_buffer, 2*ths->local_N_total);
+  PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_ZERO);
+  PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_B);
 
   /* spread potentials */
   if( compute_flags & PNFFT_COMPUTE_F){
-    PNFFT_START_TIMING(ths->comm_cart, ths->timer_adj[PNFFT_TIMER_MATRIX_B]);
+    ths->stage_component = PNFFT_TIMER_IK_F;
+    PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_IK_F);
+    PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_B);
     if( ~compute_flags & PNFFT_OMIT_CONV )
       PNX(adjoint_B_ad)(ths, nodes, nodes->f, NULL, 0, 1, use_interlacing, interlaced, PNFFT_COMPUTE_F);
-    PNFFT_FINISH_TIMING(ths->timer_adj[PNFFT_TIMER_MATRIX_B]);
+    PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_B);
 
-    PNFFT_START_TIMING(ths->comm_cart, ths->timer_adj[PNFFT_TIMER_MATRIX_F]);
+    PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_F);
     if( ~compute_flags & PNFFT_OMIT_FFT )
       PNX(adjoint_F)(ths);
-    PNFFT_FINISH_TIMING(ths->timer_adj[PNFFT_TIMER_MATRIX_F]);
+    PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_F);
 
-    PNFFT_START_TIMING(ths->comm_cart, ths->timer_adj[PNFFT_TIMER_MATRIX_D]);
+    PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_D);
+#ifdef PNFFT_OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
     for(INT k=0; k<ths->local_N_total; k++)
       ((C*)ths->g1_buffer)[k] += ((C*)ths->g1)[k];
-    PNFFT_FINISH_TIMING(ths->timer_adj[PNFFT_TIMER_MATRIX_D]);
+    PNX(count_D)(ths, ths->counter_adj, 2, 3);
+    PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_D);
+    PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_IK_F);
+    ths->stage_component = -1;
   }
 
-  /* spread gradient component wise */
+  /* spread gradient component wise, components of trivial axes d <= dim < 3 are ignored */
   if(compute_flags & PNFFT_COMPUTE_GRAD_F){
-    for(int dim =0; dim<3; dim++){
-      PNFFT_START_TIMING(ths->comm_cart, ths->timer_adj[PNFFT_TIMER_MATRIX_B]);
+    for(int dim =0; dim<ths->d; dim++){
+      ths->stage_component = PNFFT_TIMER_IK_GRAD + dim;
+      PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_IK_GRAD + dim);
+      PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_B);
       if( ~compute_flags & PNFFT_OMIT_CONV ){
         PNX(adjoint_B_ad)(ths, nodes, nodes->grad_f, NULL, dim, 3, use_interlacing, interlaced, PNFFT_COMPUTE_F);
       }
-      PNFFT_FINISH_TIMING(ths->timer_adj[PNFFT_TIMER_MATRIX_B]);
+      PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_B);
       
-      PNFFT_START_TIMING(ths->comm_cart, ths->timer_adj[PNFFT_TIMER_MATRIX_F]);
+      PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_F);
       if( ~compute_flags & PNFFT_OMIT_FFT )
         PNX(adjoint_F)(ths);
-      PNFFT_FINISH_TIMING(ths->timer_adj[PNFFT_TIMER_MATRIX_F]);
+      PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_F);
 
-      PNFFT_START_TIMING(ths->comm_cart, ths->timer_adj[PNFFT_TIMER_MATRIX_D]);
+      PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_D);
       if( ~compute_flags & PNFFT_OMIT_DECONV )
         PNX(adjoint_scale_ik_diff_c2c)((C*)ths->g1, ths->local_N_start, ths->local_N, dim, ths->pnfft_flags,
             (C*)ths->g1_buffer);
-      PNFFT_FINISH_TIMING(ths->timer_adj[PNFFT_TIMER_MATRIX_D]);
+      if( ~compute_flags & PNFFT_OMIT_DECONV )
+        PNX(count_D)(ths, ths->counter_adj, 5, 3);
+      PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_D);
+      PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_IK_GRAD + dim);
+      ths->stage_component = -1;
     }
   }
 
-  PNFFT_START_TIMING(ths->comm_cart, ths->timer_adj[PNFFT_TIMER_MATRIX_D]);
-  for(INT k=0; k<ths->local_N_total; k++)
-    ((C*)ths->g1)[k] = ((C*)ths->g1_buffer)[k];
-  PNFFT_FINISH_TIMING(ths->timer_adj[PNFFT_TIMER_MATRIX_D]);
+  /* the accumulated spectra in g1_buffer are deconvolved directly by adjoint_D,
+   * copy them only if the deconvolution is omitted */
+  PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_D);
+  if( compute_flags & PNFFT_OMIT_DECONV ){
+#ifdef PNFFT_OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for(INT k=0; k<ths->local_N_total; k++)
+      ((C*)ths->g1)[k] = ((C*)ths->g1_buffer)[k];
+  }
+  PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_D);
 }
 
 static void adj(
     PNX(plan) ths, PNX(nodes) nodes, int use_interlacing, int interlaced, unsigned compute_flags
     )
 {
+  ths->stage_interlaced = interlaced;
+
   if( ths->pnfft_flags & PNFFT_DIFF_IK ){
     /* multiplication with matrix B^T and F^H for ik-differentiation */
+    PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_IK);
     adjoint_B_and_F_ik_complex_input(ths, nodes, use_interlacing, interlaced, compute_flags);
+    PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_IK);
   } else {
     /* multiplication with matrix B^T */
-    PNFFT_START_TIMING(ths->comm_cart, ths->timer_adj[PNFFT_TIMER_MATRIX_B]);
+    PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_B);
     if( ~compute_flags & PNFFT_OMIT_CONV )
       PNX(adjoint_B_ad)(ths, nodes, nodes->f, nodes->grad_f, 0, 1, use_interlacing, interlaced, compute_flags);
-    PNFFT_FINISH_TIMING(ths->timer_adj[PNFFT_TIMER_MATRIX_B]);
+    PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_B);
 
     /* multiplication with matrix F^H */
-    PNFFT_START_TIMING(ths->comm_cart, ths->timer_adj[PNFFT_TIMER_MATRIX_F]);
+    PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_F);
     if( ~compute_flags & PNFFT_OMIT_FFT )
       PNX(adjoint_F)(ths);
-    PNFFT_FINISH_TIMING(ths->timer_adj[PNFFT_TIMER_MATRIX_F]);
+    PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_F);
   }
 
   /* multiplication with matrix D */
-  PNFFT_START_TIMING(ths->comm_cart, ths->timer_adj[PNFFT_TIMER_MATRIX_D]);
+  PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_D);
   if( ~compute_flags & PNFFT_OMIT_DECONV )
-    PNX(adjoint_D)(ths, interlaced);
-  PNFFT_FINISH_TIMING(ths->timer_adj[PNFFT_TIMER_MATRIX_D]);
+    PNX(adjoint_D)(ths, interlaced, (ths->pnfft_flags & PNFFT_DIFF_IK) ? (C*)ths->g1_buffer : NULL);
+  PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_D);
 }
 
 void PNX(zero_f_hat)(
     PNX(plan) ths
     )
 {
-  for(INT m=0; m<ths->local_N_total; ++m)
-    ths->f_hat[m] = 0;
+  PNX(zero_parallel)((R*) ths->f_hat, 2*ths->local_N_total);
 }
 
 
@@ -350,17 +398,19 @@ void PNX(adj)(
   if(ths == NULL) return;
   if(nodes == NULL && (~compute_flags & PNFFT_OMIT_CONV) ) return;
 
-  PNFFT_START_TIMING(ths->comm_cart, ths->timer_adj[PNFFT_TIMER_WHOLE]);
+  PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_WHOLE);
 
   if( ~compute_flags & PNFFT_COMPUTE_ACCUMULATED )
     PNX(zero_f_hat)(ths);
 
   if(compute_flags & PNFFT_COMPUTE_DIRECT){
 
+    PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_A);
     PNX(adj_A)(ths, nodes, compute_flags);
+    PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_MATRIX_A);
 
     ths->timer_adj[PNFFT_TIMER_ITER]++;
-    PNFFT_FINISH_TIMING(ths->timer_adj[PNFFT_TIMER_WHOLE]);
+    PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_WHOLE);
     return;
   }
 
@@ -368,13 +418,14 @@ void PNX(adj)(
     /* compute interlaced NFFT and average the results */
     adj(ths, nodes, use_interlacing=1, interlaced=0, compute_flags);
     adj(ths, nodes, use_interlacing=1, interlaced=1, compute_flags);
+    ths->stage_interlaced = 0;
   } else {
     /* compute non-interlaced NFFT */
     adj(ths, nodes, use_interlacing=0, interlaced=0, compute_flags);
   }
 
   ths->timer_adj[PNFFT_TIMER_ITER]++;
-  PNFFT_FINISH_TIMING(ths->timer_adj[PNFFT_TIMER_WHOLE]);
+  PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_WHOLE);
 }
 
 static PNX(nodes) mknodes(
@@ -396,6 +447,8 @@ static PNX(nodes) mknodes(
   nodes->pre_dpsi_il  = NULL;
   nodes->pre_ddpsi_il = NULL;
 
+  PNX(reset_memory)(&nodes->mem);
+
   return nodes;
 }
 
@@ -425,14 +478,23 @@ void PNX(free_nodes)(
   if(nodes==NULL)
     return;
 
+  /* arrays that are not freed outlive the nodes */
   if(pnfft_finalize_flags & PNFFT_FREE_GRAD_F)
     PNX(save_free)(nodes->grad_f);
+  else
+    PNX(detach_tagged)(nodes->grad_f);
   if(pnfft_finalize_flags & PNFFT_FREE_HESSIAN_F)
     PNX(save_free)(nodes->hessian_f);
+  else
+    PNX(detach_tagged)(nodes->hessian_f);
   if(pnfft_finalize_flags & PNFFT_FREE_F)
     PNX(save_free)(nodes->f);
+  else
+    PNX(detach_tagged)(nodes->f);
   if(pnfft_finalize_flags & PNFFT_FREE_X)
     PNX(save_free)(nodes->x);
+  else
+    PNX(detach_tagged)(nodes->x);
 
   PNX(save_free)(nodes->pre_psi);
   PNX(save_free)(nodes->pre_dpsi);
@@ -619,6 +681,24 @@ int PNX(get_m)(
   return ths->m;
 }
 
+/* cutoff of every dimension, get_m returns the maximum */
+void PNX(get_m_aniso)(
+    const PNX(plan) ths,
+    int *m
+    )
+{
+  for(int t=0; t<ths->d; t++)
+    m[t] = ths->m_dim[t];
+}
+
+/* degree of the piecewise polynomial window, 0 without PNFFT_PRE_POLY_PSI */
+int PNX(get_poly_degree)(
+    const PNX(plan) ths
+    )
+{
+  return ths->poly_degree;
+}
+
 void PNX(get_x_max)(
     const PNX(plan) ths,
     R *x_max
@@ -660,6 +740,120 @@ unsigned PNX(get_pfft_flags)(
   return ths->pfft_opt_flags;
 }
 
+/* Local memory of the Fourier coefficients and FFT grids of 'ths'. Grids of plans with PNFFT_PLAN_POOL
+ * are counted as shared, since they are used by all compatible plans. */
+void PNX(get_plan_memory)(
+    const PNX(plan) ths,
+    size_t *shared_bytes, size_t *private_bytes
+    )
+{
+  size_t grid_bytes = sizeof(R) * (size_t) ths->alloc_local_out;
+
+  if(ths->g1 != ths->g2)
+    grid_bytes += sizeof(R) * (size_t) ths->alloc_local_in;
+  if(ths->g1_buffer != NULL)
+    grid_bytes += sizeof(R) * (size_t) (2 * ths->local_N_total);
+
+  *private_bytes = (ths->f_hat != NULL) ? sizeof(C) * (size_t) ths->local_N_total : 0;
+  if(ths->pnfft_flags & PNFFT_PLAN_POOL)
+    *shared_bytes = PNX(pooled_grid_bytes)(ths);
+  else {
+    *shared_bytes = 0;
+    *private_bytes += grid_bytes;
+  }
+}
+
+/* Tables may be shared between dimensions and derivatives, count every table once. */
+static void add_intpol_table_bytes(
+    const PNX(plan) ths,
+    size_t *bytes
+    )
+{
+  R **tables[3] = {ths->intpol_tables_psi, ths->intpol_tables_dpsi, ths->intpol_tables_ddpsi};
+  const R *seen[9];
+  int num_seen = 0;
+
+  for(int i=0; i<3; i++){
+    if(tables[i] == NULL)
+      continue;
+    for(int t=0; t<ths->d; t++){
+      int found = 0;
+      for(int k=0; k<num_seen; k++)
+        if(seen[k] == tables[i][t])
+          found = 1;
+      if(found)
+        continue;
+      seen[num_seen++] = tables[i][t];
+      PNX(add_tagged_bytes)(tables[i][t], bytes);
+    }
+  }
+}
+
+/* Current and high-water bytes per memory category of the arrays owned by 'ths' and 'nodes' (either may be NULL).
+ * Pooled grids and cached interpolation tables are added with their full size to every plan that uses them.
+ * The high-water marks of plan and nodes are summed, i.e., they bound the joint peak from above. */
+void PNX(get_memory_usage)(
+    const PNX(plan) ths, const PNX(nodes) nodes,
+    size_t *current, size_t *peak
+    )
+{
+  size_t shared[PNFFT_MEM_CATEGORIES] = {0};
+
+  for(int k=0; k<PNFFT_MEM_CATEGORIES; k++)
+    current[k] = peak[k] = 0;
+
+  if(ths != NULL){
+    if(ths->pnfft_flags & PNFFT_PLAN_POOL){
+      PNX(add_tagged_bytes)(ths->g2, shared);
+      if(ths->g1 != ths->g2)
+        PNX(add_tagged_bytes)(ths->g1, shared);
+      PNX(add_tagged_bytes)(ths->g1_buffer, shared);
+    }
+    add_intpol_table_bytes(ths, shared);
+
+    for(int k=0; k<PNFFT_MEM_CATEGORIES; k++){
+      current[k] += ths->mem.current[k] + shared[k];
+      peak[k] += ths->mem.peak[k] + shared[k];
+    }
+  }
+
+  if(nodes != NULL)
+    for(int k=0; k<PNFFT_MEM_CATEGORIES; k++){
+      current[k] += nodes->mem.current[k];
+      peak[k] += nodes->mem.peak[k];
+    }
+}
+
+/* Current bytes per memory category of the arrays of 'ths' and 'nodes' (either may be NULL) that were first touched
+ * by the OpenMP threads of the grid loops and that are backed by huge pages. Pooled grids are added like in get_memory_usage. */
+void PNX(get_memory_placement)(
+    const PNX(plan) ths, const PNX(nodes) nodes,
+    size_t *first_touch, size_t *huge_pages
+    )
+{
+  for(int k=0; k<PNFFT_MEM_CATEGORIES; k++)
+    first_touch[k] = huge_pages[k] = 0;
+
+  if(ths != NULL){
+    if(ths->pnfft_flags & PNFFT_PLAN_POOL){
+      PNX(add_tagged_placement)(ths->g2, first_touch, huge_pages);
+      if(ths->g1 != ths->g2)
+        PNX(add_tagged_placement)(ths->g1, first_touch, huge_pages);
+      PNX(add_tagged_placement)(ths->g1_buffer, first_touch, huge_pages);
+    }
+    for(int k=0; k<PNFFT_MEM_CATEGORIES; k++){
+      first_touch[k] += ths->mem.first_touch[k];
+      huge_pages[k] += ths->mem.huge_pages[k];
+    }
+  }
+
+  if(nodes != NULL)
+    for(int k=0; k<PNFFT_MEM_CATEGORIES; k++){
+      first_touch[k] += nodes->mem.first_touch[k];
+      huge_pages[k] += nodes->mem.huge_pages[k];
+    }
+}
+
 void PNX(init_f_hat_3d)(
     const INT *N, const INT *local_N, const INT *local_N_start,
     unsigned pnfft_flags,
@@ -828,6 +1022,8 @@ void PNX(check_init_parameters)(
   int window=4;         unsigned window_flag;
   int fast_gaussian=0;  unsigned fast_gaussian_flag;
   int intpol=-1;        unsigned intpol_flag;
+  int poly=0;           unsigned poly_flag;
+  int diff_intpol=0;    unsigned diff_intpol_flag;
   int interlaced=0;     unsigned interlaced_flag;
   int diff_ik=0;        unsigned diff_ik_flag;
   int tr_f_hat=0;       unsigned tr_f_hat_flag;
@@ -849,6 +1045,8 @@ void PNX(check_init_parameters)(
   pnfft_get_args(argc, argv, "-pnfft_window", 1, PFFT_INT, &window);
   pnfft_get_args(argc, argv, "-pnfft_fast_gaussian", 1, PFFT_INT, &fast_gaussian);
   pnfft_get_args(argc, argv, "-pnfft_intpol", 1, PFFT_INT, &intpol);
+  pnfft_get_args(argc, argv, "-pnfft_poly", 1, PFFT_INT, &poly);
+  pnfft_get_args(argc, argv, "-pnfft_diff_intpol", 1, PFFT_INT, &diff_intpol);
   pnfft_get_args(argc, argv, "-pnfft_interlaced", 1, PFFT_INT, &interlaced);
   pnfft_get_args(argc, argv, "-pnfft_diff_ik", 1, PFFT_INT, &diff_ik);
   pnfft_get_args(argc, argv, "-pnfft_tr_f_hat", 1, PFFT_INT, &tr_f_hat);
@@ -871,6 +1069,7 @@ void PNX(check_init_parameters)(
     case 3:  window_flag = PNFFT_WINDOW_BESSEL_I0; break;
     case 4:  window_flag = PNFFT_WINDOW_KAISER_BESSEL; break;
     case 5:  window_flag = PNFFT_WINDOW_GAUSSIAN_T; break;
+    case 6:  window_flag = PNFFT_WINDOW_ES; break;
     default: window_flag = PNFFT_WINDOW_KAISER_BESSEL;
   }
 
@@ -891,6 +1090,8 @@ void PNX(check_init_parameters)(
   diff_ik_flag       = (diff_ik)       ? PNFFT_DIFF_IK : PNFFT_DIFF_AD;
   tr_f_hat_flag      = (tr_f_hat)      ? PNFFT_TRANSPOSED_F_HAT : 0;
   fast_gaussian_flag = (fast_gaussian) ? PNFFT_FAST_GAUSSIAN : 0;
+  poly_flag          = (poly)          ? PNFFT_PRE_POLY_PSI : 0;
+  diff_intpol_flag   = (diff_intpol)   ? PNFFT_DIFF_INTPOL_PSI : 0;
 
   pfft_printf(MPI_COMM_WORLD, "******************************************************************************************************\n");
   pfft_printf(MPI_COMM_WORLD, "* Computation of parallel NFFT\n");
@@ -906,6 +1107,7 @@ void PNX(check_init_parameters)(
     case PNFFT_WINDOW_KAISER_BESSEL: pfft_printf(MPI_COMM_WORLD, "(PNFFT_WINDOW_BESSEL_I0) "); break;
     case PNFFT_WINDOW_BESSEL_I0:     pfft_printf(MPI_COMM_WORLD, "(PNFFT_WINDOW_KAISER_BESSEL) "); break;
     case PNFFT_WINDOW_GAUSSIAN_T: pfft_printf(MPI_COMM_WORLD, "(PNFFT_WINDOW_GAUSSIAN_T) "); break;
+    case PNFFT_WINDOW_ES:         pfft_printf(MPI_COMM_WORLD, "(PNFFT_WINDOW_ES) "); break;
     default: pfft_printf(MPI_COMM_WORLD, "(UNKNOWN WINDOW FUNCTION) "); break;
   }
   pfft_printf(MPI_COMM_WORLD, "(change with -pnfft_window *),\n");
@@ -922,6 +1124,14 @@ void PNX(check_init_parameters)(
     default:                  pfft_printf(MPI_COMM_WORLD, "(No interpolation enabled) ");
   }
   pfft_printf(MPI_COMM_WORLD, "(change with -pnfft_intpol *),\n");
+  if(poly_flag & PNFFT_PRE_POLY_PSI)
+    pfft_printf(MPI_COMM_WORLD, "*      polynomial window = enabled (disable with -pnfft_poly 0)\n");
+  else
+    pfft_printf(MPI_COMM_WORLD, "*      polynomial window = disabled (enable with -pnfft_poly 1)\n");
+  if(diff_intpol_flag & PNFFT_DIFF_INTPOL_PSI)
+    pfft_printf(MPI_COMM_WORLD, "*      derivatives of interpolant = enabled (disable with -pnfft_diff_intpol 0)\n");
+  else
+    pfft_printf(MPI_COMM_WORLD, "*      derivatives of interpolant = disabled (enable with -pnfft_diff_intpol 1)\n");
   if(interlaced_flag & PNFFT_INTERLACED)
     pfft_printf(MPI_COMM_WORLD, "*      interlacing = enabled (disable with -pnfft_interlaced 0)\n");
   else
@@ -949,5 +1159,5 @@ void PNX(check_init_parameters)(
   pfft_printf(MPI_COMM_WORLD, "* on   np[0] x np[1] x np[2] = %td x %td x %td processes (change with -pnfft_np * * *)\n", np[0], np[1], np[2]);
   pfft_printf(MPI_COMM_WORLD, "*******************************************************************************************************\n\n");
 
-  *pnfft_flags = window_flag | fast_gaussian_flag | intpol_flag | diff_ik_flag | tr_f_hat_flag | interlaced_flag;
+  *pnfft_flags = window_flag | fast_gaussian_flag | intpol_flag | poly_flag | diff_intpol_flag | diff_ik_flag | tr_f_hat_flag | interlaced_flag;
 }
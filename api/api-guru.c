@@ -23,19 +23,33 @@
 
 static unsigned extract_pfft_opt_flags(
     unsigned pfft_flags);
+static int check_dimension(
+    int d, MPI_Comm comm_cart);
+static void pad_parameters(
+    int d, const INT *N, const INT *n, const R *x_max, const int *m,
+    INT *N_pad, INT *n_pad, R *x_max_pad, int *m_pad);
 static void fft_output_size(
-    const INT *n, const R *x_max, int m,
+    const INT *n, const R *x_max, const int *m,
     INT *no);
+static void isotropic_cutoff(
+    int m,
+    int *m_dim);
 static PNX(plan) PNX(init_guru_internal)(
-    int d, const INT *N, const INT *n, const R *x_max, int m,
+    int d, const INT *N, const INT *n, const R *x_max, const int *m,
     unsigned trafo_flag, unsigned pnfft_flags, unsigned pfft_flags,
     MPI_Comm comm_cart);
 static void local_size_guru_internal(
-    int d, const INT *N, const INT *n, const R *x_max, int m,
+    int d, const INT *N, const INT *n, const R *x_max, const int *m,
     MPI_Comm comm_cart,
     unsigned trafo_flag, unsigned pnfft_flags,
     INT *local_N, INT *local_N_start,
     R *lower_border, R *upper_border);
+static void estimate_memory_usage_internal(
+    int d, const INT *N, const INT *n, const R *x_max, const int *m,
+    INT local_M, MPI_Comm comm_cart,
+    unsigned trafo_flag, unsigned pnfft_flags,
+    unsigned malloc_flags, unsigned precompute_flags,
+    size_t *bytes);
 
 
 
@@ -46,7 +60,10 @@ void PNX(local_size_guru)(
     R *lower_border, R *upper_border
     )
 {
-  local_size_guru_internal(d, N, n, x_max, m, comm_cart, PNFFTI_TRAFO_C2C, pnfft_flags, local_N, local_N_start, lower_border, upper_border);
+  int m_dim[3];
+
+  isotropic_cutoff(m, m_dim);
+  local_size_guru_internal(d, N, n, x_max, m_dim, comm_cart, PNFFTI_TRAFO_C2C, pnfft_flags, local_N, local_N_start, lower_border, upper_border);
 }
 
 
@@ -56,6 +73,32 @@ void PNX(local_size_guru_c2r)(
     INT *local_N, INT *local_N_start,
     R *lower_border, R *upper_border
     )
+{
+  int m_dim[3];
+
+  isotropic_cutoff(m, m_dim);
+  local_size_guru_internal(d, N, n, x_max, m_dim, comm_cart, PNFFTI_TRAFO_C2R, pnfft_flags, local_N, local_N_start, lower_border, upper_border);
+}
+
+
+/* anisotropic variants with one cutoff m[t] per dimension */
+void PNX(local_size_guru_aniso)(
+    int d, const INT *N, const INT *n, const R *x_max, const int *m,
+    MPI_Comm comm_cart, unsigned pnfft_flags,
+    INT *local_N, INT *local_N_start,
+    R *lower_border, R *upper_border
+    )
+{
+  local_size_guru_internal(d, N, n, x_max, m, comm_cart, PNFFTI_TRAFO_C2C, pnfft_flags, local_N, local_N_start, lower_border, upper_border);
+}
+
+
+void PNX(local_size_guru_aniso_c2r)(
+    int d, const INT *N, const INT *n, const R *x_max, const int *m,
+    MPI_Comm comm_cart, unsigned pnfft_flags,
+    INT *local_N, INT *local_N_start,
+    R *lower_border, R *upper_border
+    )
 {
   local_size_guru_internal(d, N, n, x_max, m, comm_cart, PNFFTI_TRAFO_C2R, pnfft_flags, local_N, local_N_start, lower_border, upper_border);
 }
@@ -67,7 +110,10 @@ PNX(plan) PNX(init_guru)(
     MPI_Comm comm_cart
     )
 {
-  return PNX(init_guru_internal)(d, N, n, x_max, m, PNFFTI_TRAFO_C2C, pnfft_flags, pfft_flags, comm_cart);
+  int m_dim[3];
+
+  isotropic_cutoff(m, m_dim);
+  return PNX(init_guru_internal)(d, N, n, x_max, m_dim, PNFFTI_TRAFO_C2C, pnfft_flags, pfft_flags, comm_cart);
 }
 
 
@@ -76,53 +122,150 @@ PNX(plan) PNX(init_guru_c2r)(
     unsigned pnfft_flags, unsigned pfft_flags,
     MPI_Comm comm_cart
     )
+{
+  int m_dim[3];
+
+  isotropic_cutoff(m, m_dim);
+  return PNX(init_guru_internal)(d, N, n, x_max, m_dim, PNFFTI_TRAFO_C2R, pnfft_flags, pfft_flags, comm_cart);
+}
+
+
+PNX(plan) PNX(init_guru_aniso)(
+    int d, const INT *N, const INT *n, const R *x_max, const int *m,
+    unsigned pnfft_flags, unsigned pfft_flags,
+    MPI_Comm comm_cart
+    )
+{
+  return PNX(init_guru_internal)(d, N, n, x_max, m, PNFFTI_TRAFO_C2C, pnfft_flags, pfft_flags, comm_cart);
+}
+
+
+PNX(plan) PNX(init_guru_aniso_c2r)(
+    int d, const INT *N, const INT *n, const R *x_max, const int *m,
+    unsigned pnfft_flags, unsigned pfft_flags,
+    MPI_Comm comm_cart
+    )
 {
   return PNX(init_guru_internal)(d, N, n, x_max, m, PNFFTI_TRAFO_C2R, pnfft_flags, pfft_flags, comm_cart);
 }
 
 
-static void local_size_guru_internal(
+/* Estimate the bytes per memory category of a plan initialized by init_guru with the same parameters,
+ * nodes initialized by init_nodes(local_M, malloc_flags) and precompute_psi with precompute_flags.
+ * Can be called before planning, since no memory is allocated. */
+void PNX(estimate_memory_usage)(
     int d, const INT *N, const INT *n, const R *x_max, int m,
+    INT local_M, MPI_Comm comm_cart, unsigned pnfft_flags,
+    unsigned malloc_flags, unsigned precompute_flags,
+    size_t *bytes
+    )
+{
+  int m_dim[3];
+
+  isotropic_cutoff(m, m_dim);
+  estimate_memory_usage_internal(d, N, n, x_max, m_dim, local_M, comm_cart, PNFFTI_TRAFO_C2C, pnfft_flags,
+      malloc_flags, precompute_flags, bytes);
+}
+
+
+void PNX(estimate_memory_usage_c2r)(
+    int d, const INT *N, const INT *n, const R *x_max, int m,
+    INT local_M, MPI_Comm comm_cart, unsigned pnfft_flags,
+    unsigned malloc_flags, unsigned precompute_flags,
+    size_t *bytes
+    )
+{
+  int m_dim[3];
+
+  isotropic_cutoff(m, m_dim);
+  estimate_memory_usage_internal(d, N, n, x_max, m_dim, local_M, comm_cart, PNFFTI_TRAFO_C2R, pnfft_flags,
+      malloc_flags, precompute_flags, bytes);
+}
+
+
+static void estimate_memory_usage_internal(
+    int d, const INT *N, const INT *n, const R *x_max, const int *m,
+    INT local_M, MPI_Comm comm_cart,
+    unsigned trafo_flag, unsigned pnfft_flags,
+    unsigned malloc_flags, unsigned precompute_flags,
+    size_t *bytes
+    )
+{
+  INT N_pad[3], n_pad[3], no[3];
+  R x_max_pad[3];
+  int m_pad[3];
+
+  for(int k=0; k<PNFFT_MEM_CATEGORIES; k++)
+    bytes[k] = 0;
+
+  if(check_dimension(d, comm_cart))
+    return;
+
+  pad_parameters(d, N, n, x_max, m,
+      N_pad, n_pad, x_max_pad, m_pad);
+  fft_output_size(n_pad, x_max_pad, m_pad,
+      no);
+
+  PNX(estimate_memory_internal)(d, N_pad, n_pad, no, m_pad, local_M, comm_cart, trafo_flag, pnfft_flags,
+      malloc_flags, precompute_flags, bytes);
+}
+
+
+static void local_size_guru_internal(
+    int d, const INT *N, const INT *n, const R *x_max, const int *m,
     MPI_Comm comm_cart,
     unsigned trafo_flag, unsigned pnfft_flags,
     INT *local_N, INT *local_N_start,
     R *lower_border, R *upper_border
     )
 {
-  INT no[3], local_no[3], local_no_start[3];
+  INT N_pad[3], n_pad[3], no[3], local_no[3], local_no_start[3];
+  INT local_N_pad[3], local_N_start_pad[3];
+  R x_max_pad[3], lo[3], up[3];
+  int m_pad[3];
 
-  if(d != 3){
-    PX(fprintf)(comm_cart, stderr, "!!! Error in PNFFT: d != 3 not yet implemented !!!\n");
+  if(check_dimension(d, comm_cart))
     return;
-  }
 
-  fft_output_size(n, x_max, m,
+  pad_parameters(d, N, n, x_max, m,
+      N_pad, n_pad, x_max_pad, m_pad);
+  fft_output_size(n_pad, x_max_pad, m_pad,
       no);
 
-  PNX(local_size_internal)(N, n, no, comm_cart, trafo_flag, pnfft_flags,
-      local_N, local_N_start, local_no, local_no_start);
+  PNX(local_size_internal)(d, N_pad, n_pad, no, comm_cart, trafo_flag, pnfft_flags,
+      local_N_pad, local_N_start_pad, local_no, local_no_start);
+
+  PNX(node_borders)(n_pad, local_no, local_no_start, x_max_pad,
+      lo, up);
 
-  PNX(node_borders)(n, local_no, local_no_start, x_max,
-      lower_border, upper_border);
+  /* the user arrays hold d entries */
+  for(int t=0; t<d; t++){
+    local_N[t] = local_N_pad[t];
+    local_N_start[t] = local_N_start_pad[t];
+    lower_border[t] = lo[t];
+    upper_border[t] = up[t];
+  }
 }
 
 
 static PNX(plan) PNX(init_guru_internal)(
-    int d, const INT *N, const INT *n, const R *x_max, int m,
+    int d, const INT *N, const INT *n, const R *x_max, const int *m,
     unsigned trafo_flag, unsigned pnfft_flags, unsigned pfft_flags,
     MPI_Comm comm_cart
     )
 {
-  INT no[3];
+  INT N_pad[3], n_pad[3], no[3];
+  R x_max_pad[3];
+  int m_pad[3];
   PNX(plan) ths;
   unsigned pfft_opt_flags = extract_pfft_opt_flags(pfft_flags);
   
-  if(d != 3){
-    PX(fprintf)(comm_cart, stderr, "!!! Error in PNFFT: d != 3 not yet implemented !!!\n");
+  if(check_dimension(d, comm_cart))
     return NULL;
-  }
   
-  fft_output_size(n, x_max, m,
+  pad_parameters(d, N, n, x_max, m,
+      N_pad, n_pad, x_max_pad, m_pad);
+  fft_output_size(n_pad, x_max_pad, m_pad,
     no);
 
 #if PNFFT_DEBUG_USE_KAISER_BESSEL | PNFFT_DEBUG_USE_GAUSSIAN | PNFFT_DEBUG_USE_BSPLINE | PNFFT_DEBUG_USE_SINC_POWER
@@ -154,7 +297,7 @@ static PNX(plan) PNX(init_guru_internal)(
   if(pnfft_flags & PNFFT_PRE_GRAD_PSI)
     pnfft_flags |= PNFFT_PRE_PSI;
 
-  ths = PNX(init_internal)(d, N, n, no, m, trafo_flag, pnfft_flags, pfft_opt_flags, comm_cart);
+  ths = PNX(init_internal)(d, N_pad, n_pad, no, m_pad, trafo_flag, pnfft_flags, pfft_opt_flags, comm_cart);
 
   /* Quick fix to save x_max in PNFFT plan */
   for(int t=0; t<d; t++)
@@ -165,6 +308,54 @@ static PNX(plan) PNX(init_guru_internal)(
 
 
 
+/* Plans with d = 1 and d = 2 are computed natively, i.e., PFFT and the ghost cells only work on
+ * the first d axes and the window has a single stencil point on the remaining trivial axes.
+ * The process grid can not have more dimensions than the transform. */
+static int check_dimension(
+    int d, MPI_Comm comm_cart
+    )
+{
+  int rnk_pm;
+
+  if(d < 1 || d > 3){
+    PX(fprintf)(comm_cart, stderr, "!!! Error in PNFFT: d must be 1, 2 or 3 !!!\n");
+    return 1;
+  }
+
+  MPI_Cartdim_get(comm_cart, &rnk_pm);
+  if(rnk_pm > d){
+    PX(fprintf)(comm_cart, stderr, "!!! Error in PNFFT: process grid of dimension %d does not fit to d = %d !!!\n", rnk_pm, d);
+    return 1;
+  }
+
+  return 0;
+}
+
+/* extend the user parameters by trivial axes of size 1 and cutoff 0 */
+static void pad_parameters(
+    int d, const INT *N, const INT *n, const R *x_max, const int *m,
+    INT *N_pad, INT *n_pad, R *x_max_pad, int *m_pad
+    )
+{
+  for(int t=0; t<3; t++){
+    N_pad[t] = (t < d) ? N[t] : 1;
+    n_pad[t] = (t < d) ? n[t] : 1;
+    x_max_pad[t] = (t < d) ? x_max[t] : 0.5;
+    m_pad[t] = (t < d) ? m[t] : 0;
+  }
+}
+
+/* the same cutoff in all dimensions */
+static void isotropic_cutoff(
+    int m,
+    int *m_dim
+    )
+{
+  for(int t=0; t<3; t++)
+    m_dim[t] = m;
+}
+
+
 static unsigned extract_pfft_opt_flags(
     unsigned pfft_flags
     )
@@ -193,7 +384,7 @@ static unsigned extract_pfft_opt_flags(
 
 
 static void fft_output_size(
-    const INT *n, const R *x_max, int m,
+    const INT *n, const R *x_max, const int *m,
     INT *no
     )
 {
@@ -213,7 +404,7 @@ static void fft_output_size(
   
   for(int t=0; t<3; t++){
     c = pnfft_lrint(pnfft_floor(n[t]*x_max[t]));
-    no[t] = PNFFT_MIN(n[t], 2*(c+m+2));
+    no[t] = PNFFT_MIN(n[t], 2*(c+m[t]+2));
   }
 }
 
@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2011-2013 Michael Pippig
+ *
+ * This file is part of PNFFT.
+ *
+ * PNFFT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PNFFT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PNFFT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Deterministic node sets for benchmarks and checks. Node number g of a global set of M_total nodes
+ * is a function of (seed, g) only, computed by a counter-based hash. Every process walks through all
+ * global nodes and keeps the ones inside of its local box, i.e., the union of the local sets does not
+ * depend on the number of processes, the process mesh or the number of threads. */
+
+#include <stdint.h>
+#include "pnfft.h"
+#include "ipnfft.h"
+
+/* global nodes are generated in a fixed number of chunks, such that the order of the local nodes
+ * does not depend on the number of threads */
+#define PNFFT_NODES_CHUNKS 64
+
+#define PNFFT_NODES_NUM_CLUSTERS 8
+
+static uint64_t mix(
+    uint64_t z);
+static R uniform(
+    uint64_t seed, INT g, int k);
+static void global_node(
+    int distribution, uint64_t seed, INT g, INT M_total, const R *x_max,
+    R *x);
+static INT lattice_size(
+    INT M_total);
+static R wrap(
+    R x, R x_max);
+static int is_local(
+    const R *x, const R *lo, const R *up);
+static INT count_chunk(
+    int distribution, uint64_t seed, INT M_total, const R *lo, const R *up, const R *x_max,
+    INT g_start, INT g_end);
+static INT fill_chunk(
+    int distribution, uint64_t seed, INT M_total, const R *lo, const R *up, const R *x_max,
+    INT g_start, INT g_end,
+    R **x, INT **index);
+
+
+/* Returns the number of nodes of the global set that fall into the local box [lo,up).
+ * Every process generates all M_total global nodes once. */
+INT PNX(local_size_x_3d_dist)(
+    int distribution, unsigned seed, INT M_total,
+    const R *lo, const R *up, const R *x_max
+    )
+{
+  INT loc_M = 0;
+
+#ifdef PNFFT_OPENMP
+  #pragma omp parallel for schedule(static) reduction(+:loc_M)
+#endif
+  for(int c=0; c<PNFFT_NODES_CHUNKS; c++)
+    loc_M += count_chunk(distribution, seed, M_total, lo, up, x_max,
+        M_total * c / PNFFT_NODES_CHUNKS, M_total * (c+1) / PNFFT_NODES_CHUNKS);
+
+  return loc_M;
+}
+
+/* Writes at most loc_M local nodes in the order of their global index to x.
+ * If index is not NULL, it gets the global index of every node.
+ * Every process generates all M_total global nodes once. The local nodes of every chunk are buffered
+ * until the number of local nodes of the preceding chunks is known. */
+void PNX(init_x_3d_dist)(
+    int distribution, unsigned seed, INT M_total,
+    const R *lo, const R *up, const R *x_max, INT loc_M,
+    R *x, INT *index
+    )
+{
+  INT num[PNFFT_NODES_CHUNKS], offset[PNFFT_NODES_CHUNKS+1];
+  R *x_chunk[PNFFT_NODES_CHUNKS];
+  INT *index_chunk[PNFFT_NODES_CHUNKS];
+
+#ifdef PNFFT_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for(int c=0; c<PNFFT_NODES_CHUNKS; c++)
+    num[c] = fill_chunk(distribution, seed, M_total, lo, up, x_max,
+        M_total * c / PNFFT_NODES_CHUNKS, M_total * (c+1) / PNFFT_NODES_CHUNKS,
+        &x_chunk[c], &index_chunk[c]);
+
+  /* local nodes of preceding chunks */
+  offset[0] = 0;
+  for(int c=0; c<PNFFT_NODES_CHUNKS; c++)
+    offset[c+1] = offset[c] + num[c];
+
+#ifdef PNFFT_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for(int c=0; c<PNFFT_NODES_CHUNKS; c++){
+    for(INT k=0; k<num[c] && offset[c]+k < loc_M; k++){
+      for(int t=0; t<3; t++)
+        x[3*(offset[c]+k)+t] = x_chunk[c][3*k+t];
+      if(index != NULL)
+        index[offset[c]+k] = index_chunk[c][k];
+    }
+    free(x_chunk[c]);
+    free(index_chunk[c]);
+  }
+}
+
+/* Charges of valence one or two. The nodes 2k and 2k+1 carry opposite charges of equal size,
+ * such that every global set of even size is neutral. */
+void PNX(init_f_charges)(
+    unsigned seed, INT loc_M, const INT *index,
+    C *f
+    )
+{
+#ifdef PNFFT_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for(INT j=0; j<loc_M; j++){
+    const INT g = index[j];
+    const R valence = (mix(mix(seed) ^ (uint64_t) (g/2)) & 1) ? 2 : 1;
+    f[j] = (g % 2) ? -valence : valence;
+  }
+}
+
+/* Dipoles of uniformly distributed direction with moments in [0.5,1.5). */
+void PNX(init_grad_f_dipoles)(
+    unsigned seed, INT loc_M, const INT *index,
+    C *grad_f
+    )
+{
+  const uint64_t s = mix(mix(seed) + 1);
+
+#ifdef PNFFT_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for(INT j=0; j<loc_M; j++){
+    const R z = 2 * uniform(s, index[j], 0) - 1;
+    const R phi = 2 * PNFFT_PI * uniform(s, index[j], 1);
+    const R r = pnfft_sqrt(1 - z*z);
+    const R moment = K(0.5) + uniform(s, index[j], 2);
+
+    grad_f[3*j+0] = moment * r * pnfft_cos(phi);
+    grad_f[3*j+1] = moment * r * pnfft_sin(phi);
+    grad_f[3*j+2] = moment * z;
+  }
+}
+
+
+static INT count_chunk(
+    int distribution, uint64_t seed, INT M_total, const R *lo, const R *up, const R *x_max,
+    INT g_start, INT g_end
+    )
+{
+  INT num = 0;
+
+  for(INT g=g_start; g<g_end; g++){
+    R xg[3];
+    global_node(distribution, seed, g, M_total, x_max,
+        xg);
+    num += is_local(xg, lo, up);
+  }
+
+  return num;
+}
+
+/* Local nodes of the global nodes g_start <= g < g_end and their global indices in arrays that grow as needed.
+ * Returns the number of local nodes. */
+static INT fill_chunk(
+    int distribution, uint64_t seed, INT M_total, const R *lo, const R *up, const R *x_max,
+    INT g_start, INT g_end,
+    R **x, INT **index
+    )
+{
+  INT num = 0, size = 0;
+
+  *x = NULL;
+  *index = NULL;
+  for(INT g=g_start; g<g_end; g++){
+    R xg[3];
+    global_node(distribution, seed, g, M_total, x_max,
+        xg);
+    if(!is_local(xg, lo, up))
+      continue;
+    if(num == size){
+      size = PNFFT_MAX(2*size, 64);
+      *x = (R*) realloc(*x, sizeof(R) * (size_t) (3*size));
+      *index = (INT*) realloc(*index, sizeof(INT) * (size_t) size);
+    }
+    for(int t=0; t<3; t++)
+      (*x)[3*num+t] = xg[t];
+    (*index)[num] = g;
+    num++;
+  }
+
+  return num;
+}
+
+/* Node g of the global set within [-x_max,x_max) */
+static void global_node(
+    int distribution, uint64_t seed, INT g, INT M_total, const R *x_max,
+    R *x
+    )
+{
+  const uint64_t s = mix(seed);
+  const R u = uniform(s, g, 3);
+
+  switch(distribution){
+    case PNFFT_NODES_CLUSTERED: {
+      /* Gaussian blobs of width 5% of the box around random centers */
+      const int c = (int) (u * PNFFT_NODES_NUM_CLUSTERS);
+      const R rad = pnfft_sqrt(-2 * pnfft_log(1 - uniform(s, g, 4)));
+      const R phi = 2 * PNFFT_PI * uniform(s, g, 5);
+      const R gauss[3] = {rad * pnfft_cos(phi), rad * pnfft_sin(phi),
+        pnfft_sqrt(-2 * pnfft_log(1 - uniform(s, g, 6))) * pnfft_cos(2 * PNFFT_PI * uniform(s, g, 7))};
+      for(int t=0; t<3; t++){
+        const R center = x_max[t] * (2 * uniform(mix(s + 1), c, t) - 1);
+        x[t] = wrap(center + K(0.1) * x_max[t] * gauss[t], x_max[t]);
+      }
+      break;
+    }
+    case PNFFT_NODES_SLAB:
+      /* dense slab |x_0| < x_max/4 with 90% of the nodes between dilute layers */
+      for(int t=0; t<3; t++)
+        x[t] = x_max[t] * (2 * uniform(s, g, t) - 1);
+      if(u < K(0.9))
+        x[0] *= K(0.25);
+      break;
+    case PNFFT_NODES_LATTICE: {
+      /* simple cubic lattice, every site shifted by up to 10% of the spacing */
+      const INT L = lattice_size(M_total);
+      const INT site[3] = {g / (L*L), (g / L) % L, g % L};
+      for(int t=0; t<3; t++)
+        x[t] = wrap(x_max[t] * (2 * (site[t] + K(0.5) + K(0.2) * (uniform(s, g, t) - K(0.5))) / L - 1), x_max[t]);
+      break;
+    }
+    case PNFFT_NODES_IMBALANCED:
+      /* 90% of the nodes in the corner [-x_max, -x_max/2)^3 of 1/64 of the volume */
+      for(int t=0; t<3; t++)
+        x[t] = x_max[t] * (2 * uniform(s, g, t) - 1);
+      if(u < K(0.9))
+        for(int t=0; t<3; t++)
+          x[t] = K(0.25) * (x[t] - 3 * x_max[t]);
+      break;
+    default:
+      for(int t=0; t<3; t++)
+        x[t] = x_max[t] * (2 * uniform(s, g, t) - 1);
+  }
+}
+
+/* smallest L with L^3 >= M_total */
+static INT lattice_size(
+    INT M_total
+    )
+{
+  INT L = (INT) pnfft_pow((R) M_total, K(1.0)/3);
+
+  while(L*L*L < M_total)
+    L++;
+  while(L > 1 && (L-1)*(L-1)*(L-1) >= M_total)
+    L--;
+  return PNFFT_MAX(L, 1);
+}
+
+/* periodic continuation into [-x_max,x_max) */
+static R wrap(
+    R x, R x_max
+    )
+{
+  x -= 2 * x_max * pnfft_floor((x + x_max) / (2 * x_max));
+  return (x < x_max) ? x : -x_max;
+}
+
+static int is_local(
+    const R *x, const R *lo, const R *up
+    )
+{
+  for(int t=0; t<3; t++)
+    if( (x[t] < lo[t]) || (up[t] <= x[t]) )
+      return 0;
+  return 1;
+}
+
+/* finalizer of splitmix64 */
+static uint64_t mix(
+    uint64_t z
+    )
+{
+  z += 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/* component k of the random numbers of node g in [0,1) */
+static R uniform(
+    uint64_t seed, INT g, int k
+    )
+{
+  return (R) (mix(seed ^ mix(8 * (uint64_t) g + (uint64_t) k)) >> 11) / K(9007199254740992.0);
+}
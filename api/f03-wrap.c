@@ -11,12 +11,21 @@ PNFFT_EXTERN void PNX(local_size_adv_f03)(int d, const INT * N, MPI_Fint f_comm_
 PNFFT_EXTERN void PNX(local_size_adv_c2r_f03)(int d, const INT * N, MPI_Fint f_comm_cart, unsigned pnfft_flags, INT * local_N, INT * local_N_start, R * lower_border, R * upper_border);
 PNFFT_EXTERN void PNX(local_size_guru_f03)(int d, const INT * N, const INT * Nos, const R * x_max, int m, MPI_Fint f_comm_cart, unsigned pnfft_flags, INT * local_N, INT * local_N_start, R * lower_border, R * upper_border);
 PNFFT_EXTERN void PNX(local_size_guru_c2r_f03)(int d, const INT * N, const INT * Nos, const R * x_max, int m, MPI_Fint f_comm_cart, unsigned pnfft_flags, INT * local_N, INT * local_N_start, R * lower_border, R * upper_border);
+PNFFT_EXTERN void PNX(local_size_guru_aniso_f03)(int d, const INT * N, const INT * Nos, const R * x_max, const int * m, MPI_Fint f_comm_cart, unsigned pnfft_flags, INT * local_N, INT * local_N_start, R * lower_border, R * upper_border);
+PNFFT_EXTERN void PNX(local_size_guru_aniso_c2r_f03)(int d, const INT * N, const INT * Nos, const R * x_max, const int * m, MPI_Fint f_comm_cart, unsigned pnfft_flags, INT * local_N, INT * local_N_start, R * lower_border, R * upper_border);
+PNFFT_EXTERN void PNX(estimate_memory_usage_f03)(int d, const INT * N, const INT * Nos, const R * x_max, int m, INT local_M, MPI_Fint f_comm_cart, unsigned pnfft_flags, unsigned malloc_flags, unsigned precompute_flags, size_t * bytes);
+PNFFT_EXTERN void PNX(estimate_memory_usage_c2r_f03)(int d, const INT * N, const INT * Nos, const R * x_max, int m, INT local_M, MPI_Fint f_comm_cart, unsigned pnfft_flags, unsigned malloc_flags, unsigned precompute_flags, size_t * bytes);
 PNFFT_EXTERN PNX(plan) PNX(init_3d_f03)(const INT * N, MPI_Fint f_comm_cart);
 PNFFT_EXTERN PNX(plan) PNX(init_3d_c2r_f03)(const INT * N, MPI_Fint f_comm_cart);
 PNFFT_EXTERN PNX(plan) PNX(init_adv_f03)(int d, const INT * N, unsigned pnfft_flags, unsigned fftw_flags, MPI_Fint f_comm_cart);
 PNFFT_EXTERN PNX(plan) PNX(init_adv_c2r_f03)(int d, const INT * N, unsigned pnfft_flags, unsigned fftw_flags, MPI_Fint f_comm_cart);
 PNFFT_EXTERN PNX(plan) PNX(init_guru_f03)(int d, const INT * N, const INT * Nos, const R * x_max, int m, unsigned pnfft_flags, unsigned fftw_flags, MPI_Fint f_comm_cart);
 PNFFT_EXTERN PNX(plan) PNX(init_guru_c2r_f03)(int d, const INT * N, const INT * Nos, const R * x_max, int m, unsigned pnfft_flags, unsigned fftw_flags, MPI_Fint f_comm_cart);
+PNFFT_EXTERN PNX(plan) PNX(init_guru_aniso_f03)(int d, const INT * N, const INT * Nos, const R * x_max, const int * m, unsigned pnfft_flags, unsigned fftw_flags, MPI_Fint f_comm_cart);
+PNFFT_EXTERN PNX(plan) PNX(init_guru_aniso_c2r_f03)(int d, const INT * N, const INT * Nos, const R * x_max, const int * m, unsigned pnfft_flags, unsigned fftw_flags, MPI_Fint f_comm_cart);
+PNFFT_EXTERN PNX(plan) PNX(init_auto_f03)(const INT * N, R eps, MPI_Fint f_comm_cart, unsigned auto_flags);
+PNFFT_EXTERN int PNX(export_wisdom_f03)(const char * filename, MPI_Fint f_comm);
+PNFFT_EXTERN int PNX(import_wisdom_f03)(const char * filename, MPI_Fint f_comm);
 PNFFT_EXTERN void PNX(vpr_complex_f03)(C * data, INT N, const char * name, MPI_Fint f_comm);
 PNFFT_EXTERN void PNX(vpr_real_f03)(R * data, INT N, const char * name, MPI_Fint f_comm);
 PNFFT_EXTERN void PNX(apr_complex_3d_f03)(C * data, INT * local_N, INT * local_N_start, unsigned pnfft_flags, const char * name, MPI_Fint f_comm);
@@ -25,7 +34,10 @@ PNFFT_EXTERN double * PNX(timer_reduce_max_f03)(MPI_Fint f_comm, double * timer)
 PNFFT_EXTERN void PNX(print_average_timer_f03)(const PNX(plan) ths, MPI_Fint f_comm);
 PNFFT_EXTERN void PNX(print_average_timer_adv_f03)(const PNX(plan) ths, MPI_Fint f_comm);
 PNFFT_EXTERN void PNX(write_average_timer_f03)(const PNX(plan) ths, const char * name, MPI_Fint f_comm);
+PNFFT_EXTERN void PNX(timer_reduce_stats_f03)(MPI_Fint f_comm, const double * timer, double * min, double * median, double * max);
 PNFFT_EXTERN void PNX(write_average_timer_adv_f03)(const PNX(plan) ths, const char * name, MPI_Fint f_comm);
+PNFFT_EXTERN void PNX(write_timer_tree_json_f03)(const PNX(plan) ths, const char * name, MPI_Fint f_comm);
+PNFFT_EXTERN void PNX(write_timer_tree_csv_f03)(const PNX(plan) ths, const char * name, MPI_Fint f_comm);
 
 int PNX(create_procmesh_2d_f03)(MPI_Fint f_comm, int np0, int np1, MPI_Fint * f_comm_cart_2d)
 {
@@ -95,6 +107,38 @@ void PNX(local_size_guru_c2r_f03)(int d, const INT * N, const INT * Nos, const R
   PNX(local_size_guru_c2r)(d, N, Nos, x_max, m, comm_cart, pnfft_flags, local_N, local_N_start, lower_border, upper_border);
 }
 
+void PNX(local_size_guru_aniso_f03)(int d, const INT * N, const INT * Nos, const R * x_max, const int * m, MPI_Fint f_comm_cart, unsigned pnfft_flags, INT * local_N, INT * local_N_start, R * lower_border, R * upper_border)
+{
+  MPI_Comm comm_cart;
+
+  comm_cart = MPI_Comm_f2c(f_comm_cart);
+  PNX(local_size_guru_aniso)(d, N, Nos, x_max, m, comm_cart, pnfft_flags, local_N, local_N_start, lower_border, upper_border);
+}
+
+void PNX(local_size_guru_aniso_c2r_f03)(int d, const INT * N, const INT * Nos, const R * x_max, const int * m, MPI_Fint f_comm_cart, unsigned pnfft_flags, INT * local_N, INT * local_N_start, R * lower_border, R * upper_border)
+{
+  MPI_Comm comm_cart;
+
+  comm_cart = MPI_Comm_f2c(f_comm_cart);
+  PNX(local_size_guru_aniso_c2r)(d, N, Nos, x_max, m, comm_cart, pnfft_flags, local_N, local_N_start, lower_border, upper_border);
+}
+
+void PNX(estimate_memory_usage_f03)(int d, const INT * N, const INT * Nos, const R * x_max, int m, INT local_M, MPI_Fint f_comm_cart, unsigned pnfft_flags, unsigned malloc_flags, unsigned precompute_flags, size_t * bytes)
+{
+  MPI_Comm comm_cart;
+
+  comm_cart = MPI_Comm_f2c(f_comm_cart);
+  PNX(estimate_memory_usage)(d, N, Nos, x_max, m, local_M, comm_cart, pnfft_flags, malloc_flags, precompute_flags, bytes);
+}
+
+void PNX(estimate_memory_usage_c2r_f03)(int d, const INT * N, const INT * Nos, const R * x_max, int m, INT local_M, MPI_Fint f_comm_cart, unsigned pnfft_flags, unsigned malloc_flags, unsigned precompute_flags, size_t * bytes)
+{
+  MPI_Comm comm_cart;
+
+  comm_cart = MPI_Comm_f2c(f_comm_cart);
+  PNX(estimate_memory_usage_c2r)(d, N, Nos, x_max, m, local_M, comm_cart, pnfft_flags, malloc_flags, precompute_flags, bytes);
+}
+
 PNX(plan) PNX(init_3d_f03)(const INT * N, MPI_Fint f_comm_cart)
 {
   MPI_Comm comm_cart;
@@ -149,6 +193,51 @@ PNX(plan) PNX(init_guru_c2r_f03)(int d, const INT * N, const INT * Nos, const R
   return ret;
 }
 
+PNX(plan) PNX(init_guru_aniso_f03)(int d, const INT * N, const INT * Nos, const R * x_max, const int * m, unsigned pnfft_flags, unsigned fftw_flags, MPI_Fint f_comm_cart)
+{
+  MPI_Comm comm_cart;
+
+  comm_cart = MPI_Comm_f2c(f_comm_cart);
+  PNX(plan) ret = PNX(init_guru_aniso)(d, N, Nos, x_max, m, pnfft_flags, fftw_flags, comm_cart);
+  return ret;
+}
+
+PNX(plan) PNX(init_guru_aniso_c2r_f03)(int d, const INT * N, const INT * Nos, const R * x_max, const int * m, unsigned pnfft_flags, unsigned fftw_flags, MPI_Fint f_comm_cart)
+{
+  MPI_Comm comm_cart;
+
+  comm_cart = MPI_Comm_f2c(f_comm_cart);
+  PNX(plan) ret = PNX(init_guru_aniso_c2r)(d, N, Nos, x_max, m, pnfft_flags, fftw_flags, comm_cart);
+  return ret;
+}
+
+PNX(plan) PNX(init_auto_f03)(const INT * N, R eps, MPI_Fint f_comm_cart, unsigned auto_flags)
+{
+  MPI_Comm comm_cart;
+
+  comm_cart = MPI_Comm_f2c(f_comm_cart);
+  PNX(plan) ret = PNX(init_auto)(N, eps, comm_cart, auto_flags);
+  return ret;
+}
+
+int PNX(export_wisdom_f03)(const char * filename, MPI_Fint f_comm)
+{
+  MPI_Comm comm;
+
+  comm = MPI_Comm_f2c(f_comm);
+  int ret = PNX(export_wisdom)(filename, comm);
+  return ret;
+}
+
+int PNX(import_wisdom_f03)(const char * filename, MPI_Fint f_comm)
+{
+  MPI_Comm comm;
+
+  comm = MPI_Comm_f2c(f_comm);
+  int ret = PNX(import_wisdom)(filename, comm);
+  return ret;
+}
+
 void PNX(vpr_complex_f03)(C * data, INT N, const char * name, MPI_Fint f_comm)
 {
   MPI_Comm comm;
@@ -190,6 +279,14 @@ double * PNX(timer_reduce_max_f03)(MPI_Fint f_comm, double * timer)
   return ret;
 }
 
+void PNX(timer_reduce_stats_f03)(MPI_Fint f_comm, const double * timer, double * min, double * median, double * max)
+{
+  MPI_Comm comm;
+
+  comm = MPI_Comm_f2c(f_comm);
+  PNX(timer_reduce_stats)(comm, timer, min, median, max);
+}
+
 void PNX(print_average_timer_f03)(const PNX(plan) ths, MPI_Fint f_comm)
 {
   MPI_Comm comm;
@@ -221,3 +318,19 @@ void PNX(write_average_timer_adv_f03)(const PNX(plan) ths, const char * name, MP
   comm = MPI_Comm_f2c(f_comm);
   PNX(write_average_timer_adv)(ths, name, comm);
 }
+
+void PNX(write_timer_tree_json_f03)(const PNX(plan) ths, const char * name, MPI_Fint f_comm)
+{
+  MPI_Comm comm;
+
+  comm = MPI_Comm_f2c(f_comm);
+  PNX(write_timer_tree_json)(ths, name, comm);
+}
+
+void PNX(write_timer_tree_csv_f03)(const PNX(plan) ths, const char * name, MPI_Fint f_comm)
+{
+  MPI_Comm comm;
+
+  comm = MPI_Comm_f2c(f_comm);
+  PNX(write_timer_tree_csv)(ths, name, comm);
+}
@@ -52,6 +52,9 @@
                                                                                         \
   typedef struct PNX(plan_s) *PNX(plan);                                                \
   typedef struct PNX(nodes_s) *PNX(nodes);                                              \
+  typedef void (*PNX(stage_hook))(                                                      \
+      PNX(plan) ths, int stage, int component, int interlaced, int adjoint,             \
+      double bytes, double mpi_bytes, void *data);                                      \
                                                                                         \
   PNFFT_EXTERN int PNX(create_procmesh_2d)(                                             \
       MPI_Comm comm, int np0, int np1, MPI_Comm *comm_cart_2d);                         \
@@ -87,6 +90,16 @@
       int d, const INT *N, const INT *n, const R *x_max, int m,                         \
       MPI_Comm comm_cart, unsigned pnfft_flags,                                         \
       INT *local_N, INT *local_N_start,                                                 \
+      R *lower_border, R *upper_border);                                                \
+  PNFFT_EXTERN void PNX(local_size_guru_aniso)(                                         \
+      int d, const INT *N, const INT *n, const R *x_max, const int *m,                  \
+      MPI_Comm comm_cart, unsigned pnfft_flags,                                         \
+      INT *local_N, INT *local_N_start,                                                 \
+      R *lower_border, R *upper_border);                                                \
+  PNFFT_EXTERN void PNX(local_size_guru_aniso_c2r)(                                     \
+      int d, const INT *N, const INT *n, const R *x_max, const int *m,                  \
+      MPI_Comm comm_cart, unsigned pnfft_flags,                                         \
+      INT *local_N, INT *local_N_start,                                                 \
       R *lower_border, R *upper_border);                                                \
                                                                                         \
   PNFFT_EXTERN PNX(plan) PNX(init_3d)(                                                  \
@@ -111,6 +124,19 @@
         const INT *N, const INT *n, const R *x_max, int m,                              \
         unsigned pnfft_flags, unsigned fftw_flags,                                      \
         MPI_Comm comm_cart);                                                            \
+  PNFFT_EXTERN PNX(plan) PNX(init_guru_aniso)(                                          \
+        int d,                                                                          \
+        const INT *N, const INT *n, const R *x_max, const int *m,                       \
+        unsigned pnfft_flags, unsigned fftw_flags,                                      \
+        MPI_Comm comm_cart);                                                            \
+  PNFFT_EXTERN PNX(plan) PNX(init_guru_aniso_c2r)(                                      \
+        int d,                                                                          \
+        const INT *N, const INT *n, const R *x_max, const int *m,                       \
+        unsigned pnfft_flags, unsigned fftw_flags,                                      \
+        MPI_Comm comm_cart);                                                            \
+  PNFFT_EXTERN PNX(plan) PNX(init_auto)(                                                \
+      const INT *N, R eps, MPI_Comm comm_cart,                                          \
+      unsigned auto_flags);                                                             \
                                                                                         \
   PNFFT_EXTERN PNX(nodes) PNX(init_nodes)(                                              \
       INT local_M, unsigned malloc_flags);                                              \
@@ -166,6 +192,10 @@
       const PNX(plan) ths);                                                             \
   PNFFT_EXTERN int PNX(get_m)(                                                          \
       const PNX(plan) ths);                                                             \
+  PNFFT_EXTERN void PNX(get_m_aniso)(                                                   \
+      const PNX(plan) ths, int *m);                                                     \
+  PNFFT_EXTERN int PNX(get_poly_degree)(                                                \
+      const PNX(plan) ths);                                                             \
   PNFFT_EXTERN void PNX(get_x_max)(                                                     \
       const PNX(plan) ths, R *x_max);                                                   \
   PNFFT_EXTERN  void PNX(get_N)(                                                        \
@@ -179,6 +209,27 @@
   PNFFT_EXTERN void PNX(get_b)(                                                         \
       const PNX(plan) ths,                                                              \
       R *b0, R *b1, R *b2);                                                             \
+  PNFFT_EXTERN void PNX(get_plan_memory)(                                               \
+      const PNX(plan) ths,                                                              \
+      size_t *shared_bytes, size_t *private_bytes);                                     \
+  PNFFT_EXTERN void PNX(get_memory_usage)(                                              \
+      const PNX(plan) ths, const PNX(nodes) nodes,                                      \
+      size_t *current, size_t *peak);                                                   \
+  PNFFT_EXTERN void PNX(get_memory_usage_total)(                                        \
+      size_t *current, size_t *peak);                                                   \
+  PNFFT_EXTERN void PNX(get_memory_placement)(                                          \
+      const PNX(plan) ths, const PNX(nodes) nodes,                                      \
+      size_t *first_touch, size_t *huge_pages);                                         \
+  PNFFT_EXTERN void PNX(estimate_memory_usage)(                                         \
+      int d, const INT *N, const INT *n, const R *x_max, int m,                         \
+      INT local_M, MPI_Comm comm_cart, unsigned pnfft_flags,                            \
+      unsigned malloc_flags, unsigned precompute_flags,                                 \
+      size_t *bytes);                                                                   \
+  PNFFT_EXTERN void PNX(estimate_memory_usage_c2r)(                                     \
+      int d, const INT *N, const INT *n, const R *x_max, int m,                         \
+      INT local_M, MPI_Comm comm_cart, unsigned pnfft_flags,                            \
+      unsigned malloc_flags, unsigned precompute_flags,                                 \
+      size_t *bytes);                                                                   \
                                                                                         \
   PNFFT_EXTERN void PNX(finalize)(                                                      \
       PNX(plan) ths, unsigned pnfft_finalize_flags);                                    \
@@ -193,6 +244,13 @@
   PNFFT_EXTERN void PNX(cleanup)(                                                       \
       void);                                                                            \
                                                                                         \
+  PNFFT_EXTERN int PNX(export_wisdom)(                                                  \
+      const char *filename, MPI_Comm comm);                                             \
+  PNFFT_EXTERN int PNX(import_wisdom)(                                                  \
+      const char *filename, MPI_Comm comm);                                             \
+  PNFFT_EXTERN void PNX(forget_wisdom)(                                                 \
+      void);                                                                            \
+                                                                                        \
   PNFFT_EXTERN void *PNX(malloc)(size_t n);					        \
   PNFFT_EXTERN R *PNX(alloc_real)(size_t n);					        \
   PNFFT_EXTERN C *PNX(alloc_complex)(size_t n);				                \
@@ -211,6 +269,19 @@
   PNFFT_EXTERN void PNX(init_x_3d_adv)(                                                 \
       const R *lo, const R *up, const R *x_max, INT loc_M,                              \
       R *x);                                                                            \
+  PNFFT_EXTERN INT PNX(local_size_x_3d_dist)(                                           \
+      int distribution, unsigned seed, INT M_total,                                     \
+      const R *lo, const R *up, const R *x_max);                                        \
+  PNFFT_EXTERN void PNX(init_x_3d_dist)(                                                \
+      int distribution, unsigned seed, INT M_total,                                     \
+      const R *lo, const R *up, const R *x_max, INT loc_M,                              \
+      R *x, INT *index);                                                                \
+  PNFFT_EXTERN void PNX(init_f_charges)(                                                \
+      unsigned seed, INT loc_M, const INT *index,                                       \
+      C *f);                                                                            \
+  PNFFT_EXTERN void PNX(init_grad_f_dipoles)(                                           \
+      unsigned seed, INT loc_M, const INT *index,                                       \
+      C *grad_f);                                                                       \
                                                                                         \
   PNFFT_EXTERN void PNX(zero_f_hat)(                                                    \
       PNX(plan) ths);                                                                   \
@@ -241,6 +312,10 @@
       PNX(plan) ths);                                                                   \
   PNFFT_EXTERN double *PNX(get_timer_adj)(                                              \
       PNX(plan) ths);                                                                   \
+  PNFFT_EXTERN double *PNX(get_counter_trafo)(                                          \
+      PNX(plan) ths, int kind);                                                         \
+  PNFFT_EXTERN double *PNX(get_counter_adj)(                                            \
+      PNX(plan) ths, int kind);                                                         \
   PNFFT_EXTERN void PNX(timer_average)(                                                 \
       double *timer);                                                                   \
   PNFFT_EXTERN double *PNX(timer_copy)(                                                 \
@@ -251,9 +326,18 @@
       const double *sum1, const double *sum2);                                          \
   PNFFT_EXTERN void PNX(timer_free)(                                                    \
       double *ths);                                                                     \
+  PNFFT_EXTERN int PNX(timer_parent)(                                                   \
+      int idx);                                                                         \
+  PNFFT_EXTERN const char *PNX(timer_name)(                                             \
+      int idx);                                                                         \
+  PNFFT_EXTERN void PNX(timer_reduce_stats)(                                            \
+      MPI_Comm comm, const double *timer,                                               \
+      double *min, double *median, double *max);                                        \
                                                                                         \
   PNFFT_EXTERN void PNX(reset_timer)(                                                   \
       PNX(plan) ths);                                                                   \
+  PNFFT_EXTERN void PNX(set_stage_hooks)(                                               \
+      PNX(plan) ths, PNX(stage_hook) begin, PNX(stage_hook) end, void *data);           \
   PNFFT_EXTERN void PNX(print_average_timer)(                                           \
       const PNX(plan) ths, MPI_Comm comm);                                              \
   PNFFT_EXTERN void PNX(print_average_timer_adv)(                                       \
@@ -261,6 +345,10 @@
   PNFFT_EXTERN void PNX(write_average_timer)(                                           \
       const PNX(plan) ths, const char *name, MPI_Comm comm);                            \
   PNFFT_EXTERN void PNX(write_average_timer_adv)(                                       \
+      const PNX(plan) ths, const char *name, MPI_Comm comm);                            \
+  PNFFT_EXTERN void PNX(write_timer_tree_json)(                                         \
+      const PNX(plan) ths, const char *name, MPI_Comm comm);                            \
+  PNFFT_EXTERN void PNX(write_timer_tree_csv)(                                          \
       const PNX(plan) ths, const char *name, MPI_Comm comm);                            \
                                                                                         \
   PNFFT_EXTERN void PNX(get_args)(                                                      \
@@ -330,9 +418,33 @@ PNFFT_DEFINE_API(PNFFT_MANGLE_LONG_DOUBLE, PFFT_MANGLE_LONG_DOUBLE, FFTW_MANGLE_
 #define PNFFT_WINDOW_BESSEL_I0      (1U<< 16)
 #define PNFFT_USE_FK_GAUSSIAN_T     (1U<< 17)
 #define PNFFT_WINDOW_GAUSSIAN_T     ((PNFFT_USE_FK_GAUSSIAN_T | PNFFT_WINDOW_GAUSSIAN))
+#define PNFFT_WINDOW_ES             (1U<< 20)
 
 #define PNFFT_SORT_NODES            (1U<< 18)
 
+#define PNFFT_PRE_POLY_PSI          (1U<< 19)
+
+#define PNFFT_DIFF_INTPOL_PSI       (1U<< 21)
+
+#define PNFFT_PLAN_POOL             (1U<< 22)
+
+/* oversampling factor of the FFT size chosen by the adv and basic interface, default is 2 */
+#define PNFFT_OVERSAMPLING_1_5      (1U<< 23)
+#define PNFFT_OVERSAMPLING_1_25     (1U<< 24)
+
+/* back grids and f_hat by transparent or by explicit (hugetlbfs) huge pages */
+#define PNFFT_HUGE_PAGES            (1U<< 25)
+#define PNFFT_HUGE_PAGES_EXPLICIT   (1U<< 26)
+
+
+/**************************************/
+/* Flags for automatic parameter tuning */
+/**************************************/
+#define PNFFT_AUTO_ESTIMATE         (0U)
+#define PNFFT_AUTO_MEASURE          (1U<< 0)
+#define PNFFT_AUTO_EXHAUSTIVE       (1U<< 1)
+#define PNFFT_AUTO_NO_INTERLACING   (1U<< 2)
+#define PNFFT_AUTO_VERBOSE          (1U<< 3)
 
 /*************************************/
 /* Flags for PNFFT plan finalization */
@@ -352,6 +464,9 @@ PNFFT_DEFINE_API(PNFFT_MANGLE_LONG_DOUBLE, PFFT_MANGLE_LONG_DOUBLE, FFTW_MANGLE_
 /* enable some optimizations for real inputs */
 #define PNFFT_REAL_F           (1U<< 4)
 
+/* back the node arrays by transparent huge pages */
+#define PNFFT_MALLOC_HUGE_PAGES (1U<< 5)
+
 /***********************************/
 /* Flags for window precomputation */
 /***********************************/
@@ -414,8 +529,51 @@ PNFFT_DEFINE_API(PNFFT_MANGLE_LONG_DOUBLE, PFFT_MANGLE_LONG_DOUBLE, FFTW_MANGLE_
 #define PNFFT_TIMER_MATRIX_D        (7)
 #define PNFFT_TIMER_SHIFT_INPUT     (8)
 #define PNFFT_TIMER_SHIFT_OUTPUT    (9)
-
-#define PNFFT_TIMER_LENGTH          (10)
+#define PNFFT_TIMER_INDEX           (10)
+#define PNFFT_TIMER_WINDOW          (11)
+#define PNFFT_TIMER_GRID            (12)
+#define PNFFT_TIMER_ZERO            (13)
+#define PNFFT_TIMER_IK              (14)
+#define PNFFT_TIMER_IK_F            (15)
+#define PNFFT_TIMER_IK_GRAD         (16) /* + dim, 0 <= dim < 3 */
+#define PNFFT_TIMER_IK_HESSIAN      (19) /* + dim, 0 <= dim < 6 */
+#define PNFFT_TIMER_MATRIX_A        (25)
+
+#define PNFFT_TIMER_LENGTH          (26)
+
+/***********************************************************/
+/* kinds of PNFFT counters, indexed like the PNFFT timers  */
+/***********************************************************/
+#define PNFFT_COUNTER_FLOPS         (0)
+#define PNFFT_COUNTER_BYTES         (1)
+#define PNFFT_COUNTER_MPI_BYTES     (2)
+#define PNFFT_COUNTER_MPI_MSGS      (3)
+
+#define PNFFT_COUNTER_KINDS         (4)
+
+/***********************************************************/
+/* categories of PNFFT memory accounting                   */
+/***********************************************************/
+#define PNFFT_MEM_FFT_GRIDS         (0)
+#define PNFFT_MEM_GHOST_CELLS       (1)
+#define PNFFT_MEM_WINDOW_TABLES     (2)
+#define PNFFT_MEM_PRE_PSI           (3)
+#define PNFFT_MEM_SORT              (4)
+#define PNFFT_MEM_F_HAT             (5)
+#define PNFFT_MEM_NODES             (6)
+#define PNFFT_MEM_OTHER             (7)
+#define PNFFT_MEM_WORKSPACE         (8)
+
+#define PNFFT_MEM_CATEGORIES        (9)
+
+/***********************************************************/
+/* distributions of the node generators                    */
+/***********************************************************/
+#define PNFFT_NODES_UNIFORM         (0)
+#define PNFFT_NODES_CLUSTERED       (1)
+#define PNFFT_NODES_SLAB            (2)
+#define PNFFT_NODES_LATTICE         (3)
+#define PNFFT_NODES_IMBALANCED      (4)
 
 
 
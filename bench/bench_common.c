@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <string.h>
+#include "bench_common.h"
+
+/* same numbering as -pnfft_window of the checks */
+unsigned window_flag(
+    int window
+    )
+{
+  switch(window){
+    case 0:  return PNFFT_WINDOW_GAUSSIAN;
+    case 1:  return PNFFT_WINDOW_BSPLINE;
+    case 2:  return PNFFT_WINDOW_SINC_POWER;
+    case 3:  return PNFFT_WINDOW_BESSEL_I0;
+    case 5:  return PNFFT_WINDOW_GAUSSIAN_T;
+    case 6:  return PNFFT_WINDOW_ES;
+    default: return PNFFT_WINDOW_KAISER_BESSEL;
+  }
+}
+
+/* 0 direct evaluation, 1-4 interpolation of order 0-3 */
+unsigned intpol_flag(
+    int intpol
+    )
+{
+  switch(intpol){
+    case 1:  return PNFFT_PRE_CONST_PSI;
+    case 2:  return PNFFT_PRE_LIN_PSI;
+    case 3:  return PNFFT_PRE_QUAD_PSI;
+    case 4:  return PNFFT_PRE_CUB_PSI;
+    default: return 0;
+  }
+}
+
+int compare_double(
+    const void *a, const void *b
+    )
+{
+  double x = *(const double*) a, y = *(const double*) b;
+  return (x > y) - (x < y);
+}
+
+/* reads '-name_num k' followed by '-name v_1 ... v_k' with 'per_entry' values per list entry */
+void get_list_int(
+    int argc, char **argv, const char *name, int per_entry,
+    int *num, int *list
+    )
+{
+  char num_name[64];
+
+  snprintf(num_name, sizeof(num_name), "%s_num", name);
+  pnfft_get_args(argc, argv, num_name, 1, PFFT_INT, num);
+  *num = (*num < 1) ? 1 : (*num > BENCH_MAX_LIST) ? BENCH_MAX_LIST : *num;
+  pnfft_get_args(argc, argv, name, per_entry * *num, PFFT_INT, list);
+}
+
+const char *get_string(
+    int argc, char **argv, const char *name, const char *fallback
+    )
+{
+  for(int k=1; k<argc-1; k++)
+    if(strcmp(argv[k], name) == 0)
+      return argv[k+1];
+  return fallback;
+}
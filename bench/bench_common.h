@@ -0,0 +1,22 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <pnfft.h>
+
+/* Helpers that are shared by the benchmarks. */
+
+#define BENCH_MAX_LIST 16
+
+unsigned window_flag(
+    int window);
+unsigned intpol_flag(
+    int intpol);
+int compare_double(
+    const void *a, const void *b);
+void get_list_int(
+    int argc, char **argv, const char *name, int per_entry,
+    int *num, int *list);
+const char *get_string(
+    int argc, char **argv, const char *name, const char *fallback);
+
+#endif /* !BENCH_COMMON_H */
@@ -0,0 +1,522 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <complex.h>
+#include <pnfft.h>
+#include "ipnfft.h"
+#include "matrix_D.h"
+#include "bench_common.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h>
+#  define BENCH_HAVE_TSC 1
+#endif
+
+/* Single-process microbenchmarks of the kernels of matrix B and D: spreading and assignment for every cutoff,
+ * grid layout and precomputation, evaluation of the window for every window with and without interpolation,
+ * radix sort of the node indices and the deconvolution loops. The plans live on a 1 x 1 x 1 process mesh of
+ * MPI_COMM_SELF, i.e., no communication is measured and only rank 0 runs the benchmarks.
+ *
+ * Every kernel reports the median over -bench_reps runs as seconds, cycles per particle (or element) and an
+ * estimated bandwidth of the bytes that the kernel has to read and write. Cycles are TSC ticks on x86,
+ * otherwise the seconds times -bench_ghz. */
+
+enum { LAYOUT_C2C, LAYOUT_R2R, LAYOUT_R2R_STRIDE2, LAYOUTS };
+enum { MODE_NONE, MODE_PRE_PSI, MODE_PRE_FULL, MODES };
+enum { OP_SPREAD_F, OP_SPREAD_GRAD_F, OP_ASSIGN_F, OP_ASSIGN_GRAD_F, OP_ASSIGN_F_AND_GRAD_F, OP_ASSIGN_HESSIAN_F, OPS };
+
+static const char *layout_name[LAYOUTS] = {"c2c", "r2r", "r2r_stride2"};
+static const char *mode_name[MODES] = {"none", "pre_psi", "pre_full_psi"};
+static const char *op_name[OPS] = {
+  "spread_f", "spread_grad_f", "assign_f", "assign_grad_f", "assign_f_and_grad_f", "assign_hessian_f"};
+static const char *intpol_name[5] = {"direct", "const", "lin", "quad", "cub"};
+
+typedef struct{
+  ptrdiff_t N;                /**< NFFT size in every dimension                    */
+  ptrdiff_t M;                /**< Number of nodes                                 */
+  ptrdiff_t M_full;           /**< Number of nodes with PNFFT_PRE_FULL             */
+  int num_m, m[BENCH_MAX_LIST];
+  int num_window, window[BENCH_MAX_LIST];
+  int num_intpol, intpol[BENCH_MAX_LIST];
+  int reps, nodes, seed;
+  double ghz;
+  FILE *csv;
+} params_s;
+
+static void init_params(
+    int argc, char **argv,
+    params_s *p);
+static PNX(plan) init_plan(
+    const params_s *p, int m, unsigned pnfft_flags, MPI_Comm comm);
+static PNX(nodes) init_nodes(
+    const params_s *p, ptrdiff_t M);
+static void bench_assign(
+    const params_s *p, int m);
+static void bench_window(
+    const params_s *p, int m, int window, int intpol);
+static void bench_sort(
+    const params_s *p);
+static void bench_deconvolution(
+    const params_s *p, int m);
+static double ticks(void);
+static void report(
+    const params_s *p, const char *kernel, const char *variant, int m, int window, int intpol,
+    double elements, double bytes, double *sec, double *tck);
+
+
+int main(int argc, char **argv){
+  int myrank;
+  params_s p;
+
+  MPI_Init(&argc, &argv);
+  pnfft_init();
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+
+  if(myrank == 0){
+    init_params(argc, argv, &p);
+
+    printf("%-22s %-28s %3s %6s %6s %10s %12s %12s %10s\n",
+        "kernel", "variant", "m", "window", "intpol", "elements", "seconds", "cycles/elem", "GB/s");
+    if(p.csv != NULL)
+      fprintf(p.csv, "kernel,variant,m,window,intpol,elements,seconds,cycles_per_element,gb_per_sec\n");
+
+    for(int i=0; i<p.num_m; i++)
+      bench_assign(&p, p.m[i]);
+    for(int i=0; i<p.num_m; i++)
+      for(int w=0; w<p.num_window; w++)
+        for(int k=0; k<p.num_intpol; k++)
+          bench_window(&p, p.m[i], p.window[w], p.intpol[k]);
+    bench_sort(&p);
+    bench_deconvolution(&p, p.m[0]);
+
+    if(p.csv != NULL)
+      fclose(p.csv);
+  }
+
+  pnfft_cleanup();
+  MPI_Finalize();
+  return 0;
+}
+
+
+static void init_params(
+    int argc, char **argv,
+    params_s *p
+    )
+{
+  const char *csv = "bench_kernels.csv";
+
+  p->N = 32;
+  p->M = 100000;
+  p->M_full = 2000;
+  p->num_m = 3;      p->m[0] = 2; p->m[1] = 4; p->m[2] = 6;
+  p->num_window = 7;
+  for(int w=0; w<7; w++)
+    p->window[w] = w;
+  p->num_intpol = 2; p->intpol[0] = 0; p->intpol[1] = 4;
+  p->reps = 5;
+  p->nodes = PNFFT_NODES_UNIFORM;
+  p->seed = 1;
+  p->ghz = 0.0;
+
+  pnfft_get_args(argc, argv, "-bench_N", 1, PFFT_PTRDIFF_T, &p->N);
+  pnfft_get_args(argc, argv, "-bench_M", 1, PFFT_PTRDIFF_T, &p->M);
+  pnfft_get_args(argc, argv, "-bench_M_full", 1, PFFT_PTRDIFF_T, &p->M_full);
+  pnfft_get_args(argc, argv, "-bench_m_num", 1, PFFT_INT, &p->num_m);
+  pnfft_get_args(argc, argv, "-bench_window_num", 1, PFFT_INT, &p->num_window);
+  pnfft_get_args(argc, argv, "-bench_intpol_num", 1, PFFT_INT, &p->num_intpol);
+  p->num_m      = PNFFT_MAX(1, PNFFT_MIN(p->num_m, BENCH_MAX_LIST));
+  p->num_window = PNFFT_MAX(1, PNFFT_MIN(p->num_window, BENCH_MAX_LIST));
+  p->num_intpol = PNFFT_MAX(1, PNFFT_MIN(p->num_intpol, BENCH_MAX_LIST));
+  pnfft_get_args(argc, argv, "-bench_m", p->num_m, PFFT_INT, p->m);
+  pnfft_get_args(argc, argv, "-bench_window", p->num_window, PFFT_INT, p->window);
+  pnfft_get_args(argc, argv, "-bench_intpol", p->num_intpol, PFFT_INT, p->intpol);
+  for(int k=0; k<p->num_intpol; k++)
+    p->intpol[k] = PNFFT_MAX(0, PNFFT_MIN(p->intpol[k], 4));
+  pnfft_get_args(argc, argv, "-bench_reps", 1, PFFT_INT, &p->reps);
+  pnfft_get_args(argc, argv, "-bench_ghz", 1, PFFT_DOUBLE, &p->ghz);
+  pnfft_get_args(argc, argv, "-bench_nodes", 1, PFFT_INT, &p->nodes);
+  pnfft_get_args(argc, argv, "-bench_seed", 1, PFFT_INT, &p->seed);
+  p->reps = PNFFT_MAX(1, p->reps);
+
+  csv = get_string(argc, argv, "-bench_csv", csv);
+  if( (p->csv = fopen(csv, "w")) == NULL )
+    fprintf(stderr, "Error: can not open %s\n", csv);
+}
+
+static PNX(plan) init_plan(
+    const params_s *p, int m, unsigned pnfft_flags, MPI_Comm comm
+    )
+{
+  INT N[3], n[3];
+  R x_max[3];
+
+  for(int t=0; t<3; t++){
+    N[t] = p->N;
+    n[t] = 2*p->N;
+    x_max[t] = 0.5;
+  }
+
+  return PNX(init_guru)(3, N, n, x_max, m, pnfft_flags, PFFT_ESTIMATE, comm);
+}
+
+/* all M nodes of the distribution -bench_nodes in [-0.5,0.5)^3 */
+static PNX(nodes) init_nodes(
+    const params_s *p, ptrdiff_t M
+    )
+{
+  const R lo[3] = {-0.5, -0.5, -0.5}, up[3] = {0.5, 0.5, 0.5};
+  PNX(nodes) nodes = PNX(init_nodes)(M, PNFFT_MALLOC_X | PNFFT_MALLOC_F | PNFFT_MALLOC_GRAD_F | PNFFT_MALLOC_HESSIAN_F);
+
+  PNX(init_x_3d_dist)(p->nodes, (unsigned) p->seed, M, lo, up, up, M,
+      PNX(get_x)(nodes), NULL);
+
+  return nodes;
+}
+
+/* Spreading and assignment of the nodes to a grid with ghost cells, every node touches a box of cutoff^3 grid
+ * points. The nodes are not sorted, such that also the cache misses on the grid are measured. */
+static void bench_assign(
+    const params_s *p, int m
+    )
+{
+  int np[3] = {1, 1, 1};
+  MPI_Comm comm;
+  PNX(plan) ths;
+
+  if( PNX(create_procmesh)(3, MPI_COMM_SELF, np, &comm) )
+    return;
+  ths = init_plan(p, m, PNFFT_WINDOW_KAISER_BESSEL, comm);
+
+  const int cutoff = ths->cutoff;
+  const int *cutoff_dim = ths->cutoff_dim;
+  INT grid_size[3], grid_total = 1;
+  for(int t=0; t<3; t++){
+    grid_size[t] = ths->n[t] + cutoff_dim[t];
+    grid_total *= grid_size[t];
+  }
+
+  C *grid = PNX(malloc_C)((size_t) grid_total);
+  R *pre_b = PNX(malloc_R)((size_t) 3 * 3*cutoff*PNFFT_WINDOW_BATCH);
+  double *sec = (double*) malloc(sizeof(double) * (size_t) p->reps);
+  double *tck = (double*) malloc(sizeof(double) * (size_t) p->reps);
+
+  for(INT k=0; k<grid_total; k++)
+    grid[k] = 1.0;
+  for(int k=0; k<3*3*cutoff*PNFFT_WINDOW_BATCH; k++)
+    pre_b[k] = 0.5;
+
+  for(int mode=0; mode<MODES; mode++){
+    const INT M = (mode == MODE_PRE_FULL) ? PNFFT_MIN(p->M, p->M_full) : p->M;
+    PNX(nodes) nodes = init_nodes(p, M);
+    INT *m0 = PNX(malloc_INT)((size_t) M);
+    const R *x = PNX(get_x)(nodes);
+    C *f = PNX(get_f)(nodes), *grad_f = PNX(get_grad_f)(nodes), *hessian_f = PNX(get_hessian_f)(nodes);
+    unsigned precompute_flags = 0;
+
+    /* lowest grid index of every box */
+    for(INT j=0; j<M; j++){
+      INT u[3];
+      for(int t=0; t<3; t++)
+        u[t] = (INT) pnfft_floor(ths->n[t] * (x[3*j+t] + 0.5));
+      m0[j] = PNFFT_PLAIN_INDEX_3D(u, grid_size);
+    }
+    for(INT j=0; j<M; j++)
+      f[j] = 1.0;
+    for(INT j=0; j<3*M; j++)
+      grad_f[j] = 1.0;
+    for(INT j=0; j<6*M; j++)
+      hessian_f[j] = 0.0;
+
+    if(mode == MODE_PRE_PSI)
+      precompute_flags = PNFFT_PRE_PSI | PNFFT_PRE_GRAD_PSI | PNFFT_PRE_HESSIAN_PSI;
+    if(mode == MODE_PRE_FULL)
+      precompute_flags = PNFFT_PRE_PSI | PNFFT_PRE_GRAD_PSI | PNFFT_PRE_FULL;
+    if(precompute_flags)
+      PNX(precompute_psi)(ths, nodes, precompute_flags);
+
+    for(int layout=0; layout<LAYOUTS; layout++){
+      const INT s = (layout == LAYOUT_R2R_STRIDE2) ? 2 : 1;
+      const double elem = (layout == LAYOUT_C2C) ? sizeof(C) : sizeof(R);
+
+      for(int op=0; op<OPS; op++){
+        /* the full tensor of the second derivatives is never precomputed */
+        const int nwin[OPS] = {1, 2, 1, 2, 2, 3};
+        const int ngrid[OPS] = {2, 2, 1, 1, 1, 1};
+        double bytes;
+        char variant[64];
+
+        if(mode == MODE_PRE_FULL && op == OP_ASSIGN_HESSIAN_F)
+          continue;
+
+        bytes = (double) PNFFT_PROD3(cutoff_dim) * elem * ngrid[op];
+        if(mode == MODE_PRE_PSI)
+          bytes += (double) PNFFT_SUM3(cutoff_dim) * sizeof(R) * nwin[op];
+        if(mode == MODE_PRE_FULL)
+          bytes += (double) PNFFT_PROD3(cutoff_dim) * sizeof(R) * ((op == OP_SPREAD_F || op == OP_ASSIGN_F) ? 1 : 3);
+
+        for(int r=0; r<p->reps; r++){
+          double t0 = MPI_Wtime(), c0 = ticks();
+
+          for(INT j=0; j<M; j++){
+            const int q = (int) (j % PNFFT_WINDOW_BATCH);
+            R *pre_psi   = pre_b + 3*cutoff*q;
+            R *pre_dpsi  = pre_b + 3*cutoff*(PNFFT_WINDOW_BATCH + q);
+            R *pre_ddpsi = pre_b + 3*cutoff*(2*PNFFT_WINDOW_BATCH + q);
+
+            switch(op){
+              case OP_SPREAD_F:
+                if(layout == LAYOUT_C2C)
+                  PNX(spread_f_c2c)(ths, nodes, j, f[j], pre_psi, m0[j], grid_size, cutoff_dim, 0, 0,
+                      grid);
+                else
+                  PNX(spread_f_r2r)(ths, nodes, j, ((R*)f)[s*j], pre_psi, s*m0[j], grid_size, cutoff_dim, s, 0, 0,
+                      (R*)grid);
+                break;
+              case OP_SPREAD_GRAD_F:
+                if(layout == LAYOUT_C2C)
+                  PNX(spread_grad_f_c2c)(ths, nodes, j, grad_f + 3*j, pre_psi, pre_dpsi, m0[j], grid_size, cutoff_dim, 0, 0,
+                      grid);
+                else
+                  PNX(spread_grad_f_r2r)(ths, nodes, j, (R*)grad_f + s*3*j, pre_psi, pre_dpsi, s*m0[j], grid_size, cutoff_dim, s, s, 0, 0,
+                      (R*)grid);
+                break;
+              case OP_ASSIGN_F:
+                if(layout == LAYOUT_C2C)
+                  PNX(assign_f_c2c)(ths, nodes, j, grid, pre_psi, m0[j], grid_size, cutoff_dim, 0, 0,
+                      f + j);
+                else
+                  PNX(assign_f_r2r)(ths, nodes, j, (R*)grid, pre_psi, s*m0[j], grid_size, cutoff_dim, s, 0, 0,
+                      (R*)f + s*j);
+                break;
+              case OP_ASSIGN_GRAD_F:
+                if(layout == LAYOUT_C2C)
+                  PNX(assign_grad_f_c2c)(ths, nodes, j, grid, pre_psi, pre_dpsi, m0[j], grid_size, cutoff_dim, 0, 0,
+                      grad_f + 3*j);
+                else
+                  PNX(assign_grad_f_r2r)(ths, nodes, j, (R*)grid, pre_psi, pre_dpsi, s*m0[j], grid_size, cutoff_dim, s, s, 0, 0,
+                      (R*)grad_f + s*3*j);
+                break;
+              case OP_ASSIGN_F_AND_GRAD_F:
+                if(layout == LAYOUT_C2C)
+                  PNX(assign_f_and_grad_f_c2c)(ths, nodes, j, grid, pre_psi, pre_dpsi, m0[j], grid_size, cutoff_dim, 0, 0,
+                      f + j, grad_f + 3*j);
+                else
+                  PNX(assign_f_and_grad_f_r2r)(ths, nodes, j, (R*)grid, pre_psi, pre_dpsi, s*m0[j], grid_size, cutoff_dim, s, s, 0, 0,
+                      (R*)f + s*j, (R*)grad_f + s*3*j);
+                break;
+              default:
+                if(layout == LAYOUT_C2C)
+                  PNX(assign_hessian_f_c2c)(ths, nodes, j, grid, pre_psi, pre_dpsi, pre_ddpsi, m0[j], grid_size, cutoff_dim, 0, 0,
+                      hessian_f + 6*j);
+                else
+                  PNX(assign_hessian_f_r2r)(ths, nodes, j, (R*)grid, pre_psi, pre_dpsi, pre_ddpsi, s*m0[j], grid_size, cutoff_dim, s, s, 0, 0,
+                      (R*)hessian_f + s*6*j);
+            }
+          }
+
+          tck[r] = ticks() - c0;
+          sec[r] = MPI_Wtime() - t0;
+        }
+
+        snprintf(variant, sizeof(variant), "%s/%s", layout_name[layout], mode_name[mode]);
+        report(p, op_name[op], variant, m, 4, 0, (double) M, bytes * M, sec, tck);
+      }
+    }
+
+    PNX(free)(m0);
+    PNX(free_nodes)(nodes, PNFFT_FREE_X | PNFFT_FREE_F | PNFFT_FREE_GRAD_F | PNFFT_FREE_HESSIAN_F);
+  }
+
+  free(sec); free(tck);
+  PNX(free)(pre_b);
+  PNX(free)(grid);
+  PNX(finalize)(ths, 0);
+  MPI_Comm_free(&comm);
+}
+
+/* Window values on the axes of all nodes, once by the tensor evaluation of pnfft_precompute_psi and once by the
+ * batched evaluation of the particle loops where it is supported. */
+static void bench_window(
+    const params_s *p, int m, int window, int intpol
+    )
+{
+  int np[3] = {1, 1, 1};
+  const unsigned pnfft_flags = window_flag(window) | intpol_flag(intpol);
+  MPI_Comm comm;
+  PNX(plan) ths;
+  PNX(nodes) nodes;
+
+  if( PNX(create_procmesh)(3, MPI_COMM_SELF, np, &comm) )
+    return;
+  ths = init_plan(p, m, pnfft_flags, comm);
+  nodes = init_nodes(p, p->M);
+
+  const INT M = p->M;
+  const double bytes = (double) M * sizeof(R) * (3 + PNFFT_SUM3(ths->cutoff_dim));
+  double *sec = (double*) malloc(sizeof(double) * (size_t) p->reps);
+  double *tck = (double*) malloc(sizeof(double) * (size_t) p->reps);
+
+  for(int r=0; r<p->reps; r++){
+    double t0 = MPI_Wtime(), c0 = ticks();
+    PNX(precompute_psi)(ths, nodes, PNFFT_PRE_PSI);
+    tck[r] = ticks() - c0;
+    sec[r] = MPI_Wtime() - t0;
+  }
+  report(p, "pre_psi_tensor", "precompute_psi", m, window, intpol, (double) M, bytes, sec, tck);
+
+  if(PNX(window_batch_supported)(ths->pnfft_flags)){
+    const R *x = PNX(get_x)(nodes);
+    R *buf = PNX(malloc_R)((size_t) 3*ths->cutoff*PNFFT_WINDOW_BATCH);
+    R *pre_psi = PNX(malloc_R)((size_t) 3*ths->cutoff*PNFFT_WINDOW_BATCH);
+    R floor_nx[3*PNFFT_WINDOW_BATCH];
+
+    for(int r=0; r<p->reps; r++){
+      double t0 = MPI_Wtime(), c0 = ticks();
+      for(INT j=0; j<M; j+=PNFFT_WINDOW_BATCH){
+        const int num = (int) PNFFT_MIN(PNFFT_WINDOW_BATCH, M-j);
+        for(int q=0; q<num; q++)
+          for(int t=0; t<3; t++)
+            floor_nx[3*q+t] = pnfft_floor(ths->n[t] * x[3*(j+q)+t]);
+        PNX(pre_psi_tensor_batch)(ths, num, x + 3*j, floor_nx, buf,
+            pre_psi);
+      }
+      tck[r] = ticks() - c0;
+      sec[r] = MPI_Wtime() - t0;
+    }
+    /* the batch stays in cache, only the nodes are streamed */
+    report(p, "pre_psi_tensor_batch", "loop_B", m, window, intpol, (double) M, (double) M * sizeof(R) * 3, sec, tck);
+
+    PNX(free)(buf);
+    PNX(free)(pre_psi);
+  }
+
+  free(sec); free(tck);
+  PNX(free_nodes)(nodes, PNFFT_FREE_X | PNFFT_FREE_F | PNFFT_FREE_GRAD_F | PNFFT_FREE_HESSIAN_F);
+  PNX(finalize)(ths, 0);
+  MPI_Comm_free(&comm);
+}
+
+/* Radix sort of (grid index, node index) pairs as used by PNFFT_SORT_NODES, with keys of an oversampled grid of
+ * size (2N)^3. The keys are restored from a copy before every run. */
+static void bench_sort(
+    const params_s *p
+    )
+{
+  const INT M = p->M, n = 2*p->N;
+  const INT rhigh = (INT) pnfft_ceil(pnfft_log2((R) n*n*n)) - 1;
+  const INT passes = (rhigh + 9) / 9;
+  INT *keys = PNX(malloc_INT)((size_t) 2*M);
+  INT *keys0 = PNX(malloc_INT)((size_t) 2*M);
+  INT *keys1 = PNX(malloc_INT)((size_t) 2*M);
+  double *sec = (double*) malloc(sizeof(double) * (size_t) p->reps);
+  double *tck = (double*) malloc(sizeof(double) * (size_t) p->reps);
+  unsigned seed = 42;
+
+  for(INT j=0; j<M; j++){
+    seed = 1664525u * seed + 1013904223u;
+    keys[2*j] = (INT) (seed % (unsigned) (n*n*n));
+    keys[2*j+1] = j;
+  }
+
+  for(int msdf=0; msdf<2; msdf++){
+    for(int r=0; r<p->reps; r++){
+      double t0, c0;
+
+      memcpy(keys0, keys, sizeof(INT) * (size_t) 2*M);
+      t0 = MPI_Wtime(); c0 = ticks();
+      if(msdf)
+        PNX(sort_node_indices_radix_msdf)(M, keys0, keys1, rhigh);
+      else
+        PNX(sort_node_indices_radix_lsdf)(M, keys0, keys1, rhigh);
+      tck[r] = ticks() - c0;
+      sec[r] = MPI_Wtime() - t0;
+    }
+    /* every pass over 9 bits reads and writes all pairs */
+    report(p, (msdf) ? "sort_radix_msdf" : "sort_radix_lsdf", "index_pairs", 0, 0, 0,
+        (double) M, (double) passes * 2 * 2*M * sizeof(INT), sec, tck);
+  }
+
+  free(sec); free(tck);
+  PNX(free)(keys);
+  PNX(free)(keys0);
+  PNX(free)(keys1);
+}
+
+/* Deconvolution of matrix D with tables computed on the fly and with precomputed window Fourier coefficients. */
+static void bench_deconvolution(
+    const params_s *p, int m
+    )
+{
+  int np[3] = {1, 1, 1};
+  MPI_Comm comm;
+  double *sec = (double*) malloc(sizeof(double) * (size_t) p->reps);
+  double *tck = (double*) malloc(sizeof(double) * (size_t) p->reps);
+
+  if( PNX(create_procmesh)(3, MPI_COMM_SELF, np, &comm) ){
+    free(sec); free(tck);
+    return;
+  }
+
+  for(int pre=0; pre<2; pre++){
+    const unsigned pnfft_flags = PNFFT_WINDOW_KAISER_BESSEL | PNFFT_MALLOC_F_HAT | ((pre) ? PNFFT_PRE_PHI_HAT : 0);
+    PNX(plan) ths = init_plan(p, m, pnfft_flags, comm);
+    const double elements = (double) ths->local_N_total;
+
+    for(INT k=0; k<ths->local_N_total; k++)
+      ths->f_hat[k] = 1.0;
+
+    for(int adjoint=0; adjoint<2; adjoint++){
+      for(int r=0; r<p->reps; r++){
+        double t0 = MPI_Wtime(), c0 = ticks();
+        if(adjoint)
+          PNX(adjoint_D)(ths, 0, NULL);
+        else
+          PNX(trafo_D)(ths, 0, NULL);
+        tck[r] = ticks() - c0;
+        sec[r] = MPI_Wtime() - t0;
+      }
+      /* trafo reads f_hat and writes g1, adjoint reads g1 and updates f_hat */
+      report(p, (adjoint) ? "adjoint_D" : "trafo_D", (pre) ? "pre_phi_hat" : "phi_hat_on_the_fly", m, 4, 0,
+          elements, elements * sizeof(C) * ((adjoint) ? 3 : 2), sec, tck);
+    }
+
+    PNX(finalize)(ths, PNFFT_FREE_F_HAT);
+  }
+
+  free(sec); free(tck);
+  MPI_Comm_free(&comm);
+}
+
+static double ticks(void)
+{
+#ifdef BENCH_HAVE_TSC
+  return (double) __rdtsc();
+#else
+  return 0.0;
+#endif
+}
+
+/* prints and writes the medians of seconds and cycles, sorts 'sec' and 'tck' */
+static void report(
+    const params_s *p, const char *kernel, const char *variant, int m, int window, int intpol,
+    double elements, double bytes, double *sec, double *tck
+    )
+{
+  const int r = p->reps;
+  double s, c;
+
+  qsort(sec, (size_t) r, sizeof(double), compare_double);
+  qsort(tck, (size_t) r, sizeof(double), compare_double);
+  s = (r % 2) ? sec[r/2] : 0.5 * (sec[r/2-1] + sec[r/2]);
+  c = (r % 2) ? tck[r/2] : 0.5 * (tck[r/2-1] + tck[r/2]);
+#ifndef BENCH_HAVE_TSC
+  c = s * p->ghz * 1e9;
+#endif
+
+  printf("%-22s %-28s %3d %6d %6s %10.0f %12.4e %12.1f %10.2f\n",
+      kernel, variant, m, window, intpol_name[intpol], elements, s, c / elements, (s > 0) ? bytes / s * 1e-9 : 0.0);
+  if(p->csv != NULL)
+    fprintf(p->csv, "%s,%s,%d,%d,%s,%.0f,%e,%e,%e\n",
+        kernel, variant, m, window, intpol_name[intpol], elements, s, c / elements, (s > 0) ? bytes / s * 1e-9 : 0.0);
+}
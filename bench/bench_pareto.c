@@ -0,0 +1,523 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <complex.h>
+#include <pnfft.h>
+#include "bench_common.h"
+
+/* Accuracy versus run time of trafo and adj for every combination of window, interpolation order, interlacing
+ * and cutoff m. The error is the relative l2 error against a reference, either the NDFT (-bench_ref_m 0) or
+ * PNFFT with the Kaiser-Bessel window and cutoff -bench_ref_m. The time is the median over -bench_reps calls
+ * of the maximum over all processes. All points are written as CSV with a flag for the Pareto front, i.e., the
+ * points that no other point beats in both error and time. The front alone is written as JSON.
+ *
+ * With -bench_baseline the front of an earlier CSV output is checked: every baseline front point must still be
+ * reached by a point with at most the same error and at most (1 + -bench_threshold) times its time.
+ * Otherwise the front has moved and the program returns 1.
+ *
+ * The nodes come from the deterministic generators (-bench_nodes, -bench_seed), such that the reference and all
+ * configurations work on the same node set. */
+
+#define BENCH_LINE_LEN 1024
+
+typedef struct{
+  int window, intpol, interlaced, m;
+  int adjoint;
+  double error;               /**< Relative l2 error                               */
+  double error_max;           /**< Maximum error relative to the maximum reference */
+  double time;                /**< Median of the maximum time over all processes   */
+  int on_front;
+} point_s;
+
+typedef struct{
+  ptrdiff_t N;
+  double M_factor;
+  int num_window, window[BENCH_MAX_LIST];
+  int num_intpol, intpol[BENCH_MAX_LIST];
+  int num_il, il[BENCH_MAX_LIST];
+  int num_m, m[BENCH_MAX_LIST];
+  int np[3];
+  int ref_m, reps, nodes, seed;
+  double threshold;
+  const char *csv, *json, *baseline;
+} params_s;
+
+typedef struct{
+  ptrdiff_t N[3], n[3], local_N[3], local_N_start[3];
+  ptrdiff_t M_total, local_M;
+  double x_max[3], lower_border[3], upper_border[3];
+  ptrdiff_t *index;
+  pnfft_complex *f_ref, *f_hat_ref, *f_in, *f_hat_in;
+  MPI_Comm comm;
+} problem_s;
+
+static void init_params(
+    int argc, char **argv,
+    params_s *p);
+static int init_problem(
+    const params_s *p,
+    problem_s *pr);
+static void free_problem(
+    problem_s *pr);
+static pnfft_plan init_plan(
+    const params_s *p, problem_s *pr, int m, unsigned pnfft_flags,
+    pnfft_nodes *nodes);
+static void run(
+    const params_s *p, problem_s *pr, int window, int intpol, int interlaced, int m,
+    point_s *pts);
+static void relative_error(
+    const pnfft_complex *data, const pnfft_complex *ref, ptrdiff_t len, MPI_Comm comm,
+    double *error, double *error_max);
+static void mark_front(
+    point_s *pts, int num);
+static void write_csv(
+    const char *name, const point_s *pts, int num);
+static void write_json(
+    const char *name, const point_s *pts, int num);
+static int compare_baseline(
+    const char *name, double threshold, const point_s *pts, int num);
+static int compare_error(
+    const void *a, const void *b);
+
+
+int main(int argc, char **argv){
+  int num = 0, moved = 0, num_configs;
+  params_s p;
+  problem_s pr;
+  point_s *pts;
+
+  MPI_Init(&argc, &argv);
+  pnfft_init();
+
+  init_params(argc, argv, &p);
+  if( init_problem(&p, &pr) ){
+    MPI_Finalize();
+    return 1;
+  }
+
+  num_configs = p.num_window * p.num_intpol * p.num_il * p.num_m;
+  pts = (point_s*) malloc(sizeof(point_s) * (size_t) (2*num_configs));
+
+  for(int w=0; w<p.num_window; w++)
+    for(int k=0; k<p.num_intpol; k++)
+      for(int i=0; i<p.num_il; i++)
+        for(int j=0; j<p.num_m; j++){
+          run(&p, &pr, p.window[w], p.intpol[k], p.il[i], p.m[j],
+              pts + num);
+          num += 2;
+        }
+
+  mark_front(pts, num);
+  write_csv(p.csv, pts, num);
+  write_json(p.json, pts, num);
+  if(p.baseline != NULL)
+    moved = compare_baseline(p.baseline, p.threshold, pts, num);
+  MPI_Bcast(&moved, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+  free(pts);
+  free_problem(&pr);
+  pnfft_cleanup();
+  MPI_Finalize();
+  return (moved) ? 1 : 0;
+}
+
+
+static void init_params(
+    int argc, char **argv,
+    params_s *p
+    )
+{
+  int size;
+
+  p->N = 16;
+  p->M_factor = 1.0;
+  p->num_window = 7;
+  for(int w=0; w<7; w++)
+    p->window[w] = w;
+  p->num_intpol = 2; p->intpol[0] = 0; p->intpol[1] = 4;
+  p->num_il = 2;     p->il[0] = 0;     p->il[1] = 1;
+  p->num_m = 7;
+  for(int k=0; k<7; k++)
+    p->m[k] = k+2;
+  p->ref_m = 0;
+  p->reps = 5;
+  p->nodes = PNFFT_NODES_UNIFORM;
+  p->seed = 1;
+  p->threshold = 0.1;
+
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  p->np[0] = p->np[1] = p->np[2] = 0;
+  MPI_Dims_create(size, 3, p->np);
+
+  pnfft_get_args(argc, argv, "-bench_N", 1, PFFT_PTRDIFF_T, &p->N);
+  pnfft_get_args(argc, argv, "-bench_M_factor", 1, PFFT_DOUBLE, &p->M_factor);
+  get_list_int(argc, argv, "-bench_window", 1, &p->num_window, p->window);
+  get_list_int(argc, argv, "-bench_intpol", 1, &p->num_intpol, p->intpol);
+  get_list_int(argc, argv, "-bench_interlaced", 1, &p->num_il, p->il);
+  get_list_int(argc, argv, "-bench_m", 1, &p->num_m, p->m);
+  pnfft_get_args(argc, argv, "-bench_np", 3, PFFT_INT, p->np);
+  pnfft_get_args(argc, argv, "-bench_ref_m", 1, PFFT_INT, &p->ref_m);
+  pnfft_get_args(argc, argv, "-bench_reps", 1, PFFT_INT, &p->reps);
+  pnfft_get_args(argc, argv, "-bench_nodes", 1, PFFT_INT, &p->nodes);
+  pnfft_get_args(argc, argv, "-bench_seed", 1, PFFT_INT, &p->seed);
+  pnfft_get_args(argc, argv, "-bench_threshold", 1, PFFT_DOUBLE, &p->threshold);
+  p->reps = (p->reps < 1) ? 1 : p->reps;
+  for(int k=0; k<p->num_intpol; k++)
+    p->intpol[k] = (p->intpol[k] < 0) ? 0 : (p->intpol[k] > 4) ? 4 : p->intpol[k];
+
+  p->csv      = get_string(argc, argv, "-bench_csv", "bench_pareto.csv");
+  p->json     = get_string(argc, argv, "-bench_json", "bench_pareto.json");
+  p->baseline = get_string(argc, argv, "-bench_baseline", NULL);
+}
+
+/* nodes, inputs and reference results of trafo and adj, returns 1 if the process mesh does not fit */
+static int init_problem(
+    const params_s *p,
+    problem_s *pr
+    )
+{
+  const int ref_m = (p->ref_m > 0) ? p->ref_m : 6;
+  const unsigned ref_compute = (p->ref_m > 0) ? 0 : PNFFT_COMPUTE_DIRECT;
+  pnfft_plan pnfft;
+  pnfft_nodes nodes;
+  ptrdiff_t local_N_total;
+
+  if( pnfft_create_procmesh(3, MPI_COMM_WORLD, p->np, &pr->comm) ){
+    pfft_fprintf(MPI_COMM_WORLD, stderr, "Error: Procmesh of size %d x %d x %d does not fit to number of allocated processes.\n", p->np[0], p->np[1], p->np[2]);
+    return 1;
+  }
+
+  for(int t=0; t<3; t++){
+    pr->N[t] = p->N;
+    pr->n[t] = 2*p->N;
+    pr->x_max[t] = 0.5;
+  }
+  pr->M_total = (ptrdiff_t) (p->M_factor * pr->N[0]*pr->N[1]*pr->N[2]);
+  pr->index = NULL;
+
+  pnfft = init_plan(p, pr, ref_m, PNFFT_WINDOW_KAISER_BESSEL, &nodes);
+  local_N_total = pr->local_N[0] * pr->local_N[1] * pr->local_N[2];
+
+  pr->f_in      = pnfft_alloc_complex(pr->local_M + 1);
+  pr->f_ref     = pnfft_alloc_complex(pr->local_M + 1);
+  pr->f_hat_in  = pnfft_alloc_complex(local_N_total);
+  pr->f_hat_ref = pnfft_alloc_complex(local_N_total);
+
+  pnfft_init_f_hat_3d(pr->N, pr->local_N, pr->local_N_start, 0,
+      pr->f_hat_in);
+  pnfft_init_f_charges((unsigned) p->seed, pr->local_M, pr->index,
+      pr->f_in);
+
+  memcpy(pnfft_get_f_hat(pnfft), pr->f_hat_in, sizeof(pnfft_complex) * (size_t) local_N_total);
+  pnfft_trafo(pnfft, nodes, PNFFT_COMPUTE_F | ref_compute);
+  memcpy(pr->f_ref, pnfft_get_f(nodes), sizeof(pnfft_complex) * (size_t) pr->local_M);
+
+  memcpy(pnfft_get_f(nodes), pr->f_in, sizeof(pnfft_complex) * (size_t) pr->local_M);
+  pnfft_adj(pnfft, nodes, PNFFT_COMPUTE_F | ref_compute);
+  memcpy(pr->f_hat_ref, pnfft_get_f_hat(pnfft), sizeof(pnfft_complex) * (size_t) local_N_total);
+
+  pfft_printf(pr->comm, "* Reference: %s, %td nodes of distribution %d\n",
+      (p->ref_m > 0) ? "PNFFT with Kaiser-Bessel window" : "NDFT", pr->M_total, p->nodes);
+
+  pnfft_finalize(pnfft, PNFFT_FREE_F_HAT);
+  pnfft_free_nodes(nodes, PNFFT_FREE_X | PNFFT_FREE_F);
+  return 0;
+}
+
+static void free_problem(
+    problem_s *pr
+    )
+{
+  free(pr->index);
+  pnfft_free(pr->f_in);
+  pnfft_free(pr->f_ref);
+  pnfft_free(pr->f_hat_in);
+  pnfft_free(pr->f_hat_ref);
+  MPI_Comm_free(&pr->comm);
+}
+
+/* Plans with the generated nodes. The first call fixes the local boxes and the global node indices,
+ * later calls return NULL if their boxes differ. */
+static pnfft_plan init_plan(
+    const params_s *p, problem_s *pr, int m, unsigned pnfft_flags,
+    pnfft_nodes *nodes
+    )
+{
+  ptrdiff_t local_N[3], local_N_start[3];
+  double lo[3], up[3];
+  int differ = 0, global_differ;
+
+  pnfft_local_size_guru(3, pr->N, pr->n, pr->x_max, m, pr->comm, pnfft_flags,
+      local_N, local_N_start, lo, up);
+
+  if(pr->index == NULL){
+    for(int t=0; t<3; t++){
+      pr->local_N[t] = local_N[t];
+      pr->local_N_start[t] = local_N_start[t];
+      pr->lower_border[t] = lo[t];
+      pr->upper_border[t] = up[t];
+    }
+    pr->local_M = pnfft_local_size_x_3d_dist(p->nodes, (unsigned) p->seed, pr->M_total,
+        lo, up, pr->x_max);
+    pr->index = (ptrdiff_t*) malloc(sizeof(ptrdiff_t) * (size_t) (pr->local_M + 1));
+  }
+
+  for(int t=0; t<3; t++)
+    if(local_N[t] != pr->local_N[t] || local_N_start[t] != pr->local_N_start[t]
+        || lo[t] != pr->lower_border[t] || up[t] != pr->upper_border[t])
+      differ = 1;
+  MPI_Allreduce(&differ, &global_differ, 1, MPI_INT, MPI_MAX, pr->comm);
+  if(global_differ)
+    return NULL;
+
+  *nodes = pnfft_init_nodes(pr->local_M, PNFFT_MALLOC_X | PNFFT_MALLOC_F);
+  pnfft_init_x_3d_dist(p->nodes, (unsigned) p->seed, pr->M_total,
+      lo, up, pr->x_max, pr->local_M,
+      pnfft_get_x(*nodes), pr->index);
+
+  return pnfft_init_guru(3, pr->N, pr->n, pr->x_max, m, pnfft_flags | PNFFT_MALLOC_F_HAT, PFFT_ESTIMATE, pr->comm);
+}
+
+/* fills pts[0] with trafo and pts[1] with adj */
+static void run(
+    const params_s *p, problem_s *pr, int window, int intpol, int interlaced, int m,
+    point_s *pts
+    )
+{
+  const unsigned pnfft_flags = window_flag(window) | intpol_flag(intpol) | ((interlaced) ? PNFFT_INTERLACED : 0);
+  const ptrdiff_t local_N_total = pr->local_N[0] * pr->local_N[1] * pr->local_N[2];
+  double *times = (double*) malloc(sizeof(double) * (size_t) p->reps);
+  pnfft_nodes nodes;
+  pnfft_plan pnfft;
+
+  for(int adjoint=0; adjoint<2; adjoint++){
+    pts[adjoint].window = window;
+    pts[adjoint].intpol = intpol;
+    pts[adjoint].interlaced = interlaced;
+    pts[adjoint].m = m;
+    pts[adjoint].adjoint = adjoint;
+    pts[adjoint].error = pts[adjoint].error_max = pts[adjoint].time = -1;
+  }
+
+  pnfft = init_plan(p, pr, m, pnfft_flags, &nodes);
+  if(pnfft == NULL){
+    pfft_printf(pr->comm, "* Skip window %d, m=%d: the local boxes differ from the reference\n", window, m);
+    free(times);
+    return;
+  }
+
+  for(int adjoint=0; adjoint<2; adjoint++){
+    /* one unmeasured call for the precomputations */
+    for(int r=-1; r<p->reps; r++){
+      double t, t_max;
+
+      if(adjoint)
+        memcpy(pnfft_get_f(nodes), pr->f_in, sizeof(pnfft_complex) * (size_t) pr->local_M);
+      else
+        memcpy(pnfft_get_f_hat(pnfft), pr->f_hat_in, sizeof(pnfft_complex) * (size_t) local_N_total);
+
+      MPI_Barrier(pr->comm);
+      t = -MPI_Wtime();
+      if(adjoint)
+        pnfft_adj(pnfft, nodes, PNFFT_COMPUTE_F);
+      else
+        pnfft_trafo(pnfft, nodes, PNFFT_COMPUTE_F);
+      t += MPI_Wtime();
+
+      MPI_Allreduce(&t, &t_max, 1, MPI_DOUBLE, MPI_MAX, pr->comm);
+      if(r >= 0)
+        times[r] = t_max;
+    }
+
+    qsort(times, (size_t) p->reps, sizeof(double), compare_double);
+    pts[adjoint].time = (p->reps % 2) ? times[p->reps/2] : 0.5 * (times[p->reps/2-1] + times[p->reps/2]);
+
+    if(adjoint)
+      relative_error(pnfft_get_f_hat(pnfft), pr->f_hat_ref, local_N_total, pr->comm,
+          &pts[adjoint].error, &pts[adjoint].error_max);
+    else
+      relative_error(pnfft_get_f(nodes), pr->f_ref, pr->local_M, pr->comm,
+          &pts[adjoint].error, &pts[adjoint].error_max);
+
+    pfft_printf(pr->comm, "* %-5s window=%d intpol=%d interlaced=%d m=%2d: error %.2e, time %.3e s\n",
+        (adjoint) ? "adj" : "trafo", window, intpol, interlaced, m, pts[adjoint].error, pts[adjoint].time);
+  }
+
+  free(times);
+  pnfft_finalize(pnfft, PNFFT_FREE_F_HAT);
+  pnfft_free_nodes(nodes, PNFFT_FREE_X | PNFFT_FREE_F);
+}
+
+static void relative_error(
+    const pnfft_complex *data, const pnfft_complex *ref, ptrdiff_t len, MPI_Comm comm,
+    double *error, double *error_max
+    )
+{
+  double loc[2] = {0, 0}, glob[2], loc_max[2] = {0, 0}, glob_max[2];
+
+  for(ptrdiff_t k=0; k<len; k++){
+    const double d = cabs(data[k] - ref[k]), a = cabs(ref[k]);
+    loc[0] += d*d;
+    loc[1] += a*a;
+    if(d > loc_max[0]) loc_max[0] = d;
+    if(a > loc_max[1]) loc_max[1] = a;
+  }
+  MPI_Allreduce(loc, glob, 2, MPI_DOUBLE, MPI_SUM, comm);
+  MPI_Allreduce(loc_max, glob_max, 2, MPI_DOUBLE, MPI_MAX, comm);
+
+  *error     = (glob[1] > 0) ? sqrt(glob[0] / glob[1]) : sqrt(glob[0]);
+  *error_max = (glob_max[1] > 0) ? glob_max[0] / glob_max[1] : glob_max[0];
+}
+
+/* a point is on the front of its direction, if no other point is at least as good in both error and time
+ * and better in one of them */
+static void mark_front(
+    point_s *pts, int num
+    )
+{
+  for(int i=0; i<num; i++){
+    pts[i].on_front = (pts[i].time >= 0);
+    for(int j=0; j<num && pts[i].on_front; j++){
+      if(j == i || pts[j].time < 0 || pts[j].adjoint != pts[i].adjoint)
+        continue;
+      if(pts[j].error <= pts[i].error && pts[j].time <= pts[i].time
+          && (pts[j].error < pts[i].error || pts[j].time < pts[i].time))
+        pts[i].on_front = 0;
+    }
+  }
+}
+
+static void write_csv(
+    const char *name, const point_s *pts, int num
+    )
+{
+  int myrank;
+  FILE *f;
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  if(myrank != 0 || name == NULL)
+    return;
+
+  if( (f = fopen(name, "w")) == NULL ){
+    fprintf(stderr, "Error: can not open %s\n", name);
+    return;
+  }
+
+  fprintf(f, "direction,window,intpol,interlaced,m,error,error_max,time,on_front\n");
+  for(int k=0; k<num; k++)
+    if(pts[k].time >= 0)
+      fprintf(f, "%s,%d,%d,%d,%d,%e,%e,%e,%d\n",
+          (pts[k].adjoint) ? "adj" : "trafo", pts[k].window, pts[k].intpol, pts[k].interlaced, pts[k].m,
+          pts[k].error, pts[k].error_max, pts[k].time, pts[k].on_front);
+
+  fclose(f);
+}
+
+/* front of both directions, sorted by decreasing error */
+static void write_json(
+    const char *name, const point_s *pts, int num
+    )
+{
+  int myrank, num_front = 0;
+  point_s *front;
+  FILE *f;
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  if(myrank != 0 || name == NULL)
+    return;
+
+  if( (f = fopen(name, "w")) == NULL ){
+    fprintf(stderr, "Error: can not open %s\n", name);
+    return;
+  }
+
+  front = (point_s*) malloc(sizeof(point_s) * (size_t) (num + 1));
+  for(int k=0; k<num; k++)
+    if(pts[k].on_front)
+      front[num_front++] = pts[k];
+  qsort(front, (size_t) num_front, sizeof(point_s), compare_error);
+
+  fprintf(f, "{");
+  for(int adjoint=0; adjoint<2; adjoint++){
+    int first = 1;
+    fprintf(f, "%s\n  \"%s\": [", (adjoint) ? "," : "", (adjoint) ? "adj" : "trafo");
+    for(int k=0; k<num_front; k++){
+      if(front[k].adjoint != adjoint)
+        continue;
+      fprintf(f, "%s\n    {\"window\": %d, \"intpol\": %d, \"interlaced\": %d, \"m\": %d, \"error\": %e, \"error_max\": %e, \"time\": %e}",
+          (first) ? "" : ",", front[k].window, front[k].intpol, front[k].interlaced, front[k].m,
+          front[k].error, front[k].error_max, front[k].time);
+      first = 0;
+    }
+    fprintf(f, "\n  ]");
+  }
+  fprintf(f, "\n}\n");
+
+  free(front);
+  fclose(f);
+}
+
+/* Returns the number of front points of the baseline CSV that no current point reaches with at most the same error
+ * and at most (1+threshold) times the time. Only rank 0 compares. */
+static int compare_baseline(
+    const char *name, double threshold, const point_s *pts, int num
+    )
+{
+  int myrank, moved = 0, compared = 0;
+  char line[BENCH_LINE_LEN];
+  FILE *f;
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  if(myrank != 0)
+    return 0;
+
+  if( (f = fopen(name, "r")) == NULL ){
+    fprintf(stderr, "Error: can not open baseline %s\n", name);
+    return 0;
+  }
+
+  /* skip header */
+  if(fgets(line, BENCH_LINE_LEN, f) == NULL){
+    fclose(f);
+    return 0;
+  }
+
+  while(fgets(line, BENCH_LINE_LEN, f) != NULL){
+    char dir[16];
+    int window, intpol, interlaced, m, on_front, reached = 0;
+    double error, error_max, time;
+
+    if(sscanf(line, "%15[^,],%d,%d,%d,%d,%le,%le,%le,%d",
+          dir, &window, &intpol, &interlaced, &m, &error, &error_max, &time, &on_front) != 9)
+      continue;
+    if(!on_front)
+      continue;
+
+    compared++;
+    for(int k=0; k<num && !reached; k++)
+      if(pts[k].time >= 0 && pts[k].adjoint == (strcmp(dir, "adj") == 0)
+          && pts[k].error <= error && pts[k].time <= (1.0 + threshold) * time)
+        reached = 1;
+
+    if(!reached){
+      printf("* FRONT MOVED %s: error %.2e in %.3e s (window=%d intpol=%d interlaced=%d m=%d) is not reached any more\n",
+          dir, error, time, window, intpol, interlaced, m);
+      moved++;
+    }
+  }
+
+  printf("* Compared %d front points with %s: %d not reached within %.1f%%\n",
+      compared, name, moved, 100.0 * threshold);
+
+  fclose(f);
+  return moved;
+}
+
+static int compare_error(
+    const void *a, const void *b
+    )
+{
+  double x = ((const point_s*) a)->error, y = ((const point_s*) b)->error;
+  return (x < y) - (x > y);
+}
@@ -0,0 +1,508 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <complex.h>
+#include <pnfft.h>
+#include "bench_common.h"
+
+/* Parameter sweep over the NFFT size, the number of nodes, the cutoff, the window, the precomputation,
+ * interlacing, ad vs. ik differentiation, c2c vs. c2r and the process mesh. Every configuration is warmed up
+ * and repeated, the stage timers are reduced to their maximum over all processes per run. Medians and variances
+ * over the runs are written as CSV and JSON. With -bench_baseline the medians of the whole transforms are compared
+ * to the CSV output of an earlier run (e.g. of another library build) and slowdowns beyond -bench_threshold are
+ * reported as regressions.
+ *
+ * Lists are given by their length and their values, e.g., -bench_N_num 3 -bench_N 16 32 64 or
+ * -bench_np_num 2 -bench_np 2 2 2 4 2 1 for two process meshes.
+ * The nodes are taken from the deterministic generators (-bench_nodes, numbered as PNFFT_NODES_*, and -bench_seed),
+ * such that all builds and process meshes see the same node set. */
+
+#define BENCH_KEY_LEN    256
+#define BENCH_LINE_LEN   16384
+#define BENCH_KEY_FIELDS 13
+
+typedef struct{
+  ptrdiff_t N;                /**< NFFT size in every dimension                    */
+  double M_factor;            /**< Number of nodes per Fourier coefficient         */
+  int m;                      /**< Real space cutoff                               */
+  int window;                 /**< Window as in -pnfft_window of the checks        */
+  int precompute;             /**< 0 none, 1 cubic tables, 2 tensor, 3 full        */
+  int interlaced;
+  int diff_ik;
+  int c2r;
+  int np[3];                  /**< Process mesh                                    */
+  int nodes;                  /**< Distribution of the nodes, PNFFT_NODES_*        */
+} config_s;
+
+typedef struct{
+  config_s cfg;
+  int adjoint;
+  ptrdiff_t M_total;
+  double nodes_per_sec;       /**< Total number of nodes over median of whole      */
+  double median[PNFFT_TIMER_LENGTH];
+  double variance[PNFFT_TIMER_LENGTH];
+} result_s;
+
+typedef struct{
+  int num_N, N[BENCH_MAX_LIST];
+  int num_M, num_m, m[BENCH_MAX_LIST];
+  double M_factor[BENCH_MAX_LIST];
+  int num_window, window[BENCH_MAX_LIST];
+  int num_pre, pre[BENCH_MAX_LIST];
+  int num_il, il[BENCH_MAX_LIST];
+  int num_ik, ik[BENCH_MAX_LIST];
+  int num_c2r, c2r[BENCH_MAX_LIST];
+  int num_np, np[3*BENCH_MAX_LIST];
+  int num_nodes, nodes[BENCH_MAX_LIST];
+  int reps, warmup, grad, seed;
+  double threshold;
+  const char *csv, *json, *baseline;
+} params_s;
+
+static void init_params(
+    int argc, char **argv,
+    params_s *p);
+static int run_config(
+    const config_s *cfg, const params_s *p,
+    result_s *res);
+static void measure(
+    pnfft_plan pnfft, pnfft_nodes nodes, int adjoint, unsigned compute_flags,
+    const params_s *p, MPI_Comm comm,
+    double *samples);
+static void stats(
+    double *samples, int reps,
+    double *median, double *variance);
+static void make_key(
+    const result_s *res,
+    char *key);
+static void write_csv(
+    const char *name, const result_s *res, int num);
+static void write_json(
+    const char *name, const result_s *res, int num);
+static int compare_baseline(
+    const char *name, double threshold, const result_s *res, int num);
+
+
+int main(int argc, char **argv){
+  int num_configs = 0, num_results = 0, regressions = 0;
+  int sizes[10], idx[10] = {0};
+  params_s p;
+  result_s *results;
+
+  MPI_Init(&argc, &argv);
+  pnfft_init();
+
+  init_params(argc, argv, &p);
+
+  sizes[0] = p.num_N;      sizes[1] = p.num_M;  sizes[2] = p.num_m;
+  sizes[3] = p.num_window; sizes[4] = p.num_pre; sizes[5] = p.num_il;
+  sizes[6] = p.num_ik;     sizes[7] = p.num_c2r; sizes[8] = p.num_nodes;
+  sizes[9] = p.num_np;
+
+  num_configs = 1;
+  for(int k=0; k<10; k++)
+    num_configs *= sizes[k];
+  results = (result_s*) malloc(sizeof(result_s) * (size_t) (2*num_configs));
+
+  pfft_printf(MPI_COMM_WORLD, "* Sweep over %d configurations with %d warm-up and %d measured runs per transform\n",
+      num_configs, p.warmup, p.reps);
+
+  /* odometer over all lists, the process mesh changes fastest */
+  for(int c=0; c<num_configs; c++){
+    config_s cfg;
+
+    cfg.N          = p.N[idx[0]];
+    cfg.M_factor   = p.M_factor[idx[1]];
+    cfg.m          = p.m[idx[2]];
+    cfg.window     = p.window[idx[3]];
+    cfg.precompute = p.pre[idx[4]];
+    cfg.interlaced = p.il[idx[5]];
+    cfg.diff_ik    = p.ik[idx[6]];
+    cfg.c2r        = p.c2r[idx[7]];
+    cfg.nodes      = p.nodes[idx[8]];
+    for(int t=0; t<3; t++)
+      cfg.np[t] = p.np[3*idx[9]+t];
+
+    num_results += run_config(&cfg, &p, results + num_results);
+
+    for(int k=9; k>=0; k--){
+      if(++idx[k] < sizes[k])
+        break;
+      idx[k] = 0;
+    }
+  }
+
+  write_csv(p.csv, results, num_results);
+  write_json(p.json, results, num_results);
+  if(p.baseline != NULL)
+    regressions = compare_baseline(p.baseline, p.threshold, results, num_results);
+  MPI_Bcast(&regressions, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+  free(results);
+  pnfft_cleanup();
+  MPI_Finalize();
+  return (regressions) ? 1 : 0;
+}
+
+
+static void init_params(
+    int argc, char **argv,
+    params_s *p
+    )
+{
+  int size;
+
+  p->num_N = 1;      p->N[0] = 32;
+  p->num_M = 1;      p->M_factor[0] = 1.0;
+  p->num_m = 1;      p->m[0] = 6;
+  p->num_window = 1; p->window[0] = 4;
+  p->num_pre = 1;    p->pre[0] = 0;
+  p->num_il = 1;     p->il[0] = 0;
+  p->num_ik = 1;     p->ik[0] = 0;
+  p->num_c2r = 1;    p->c2r[0] = 0;
+  p->num_nodes = 1;  p->nodes[0] = PNFFT_NODES_UNIFORM;
+  p->seed = 1;
+  p->reps = 10;
+  p->warmup = 2;
+  p->grad = 0;
+  p->threshold = 0.1;
+
+  /* default mesh uses all processes */
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  p->num_np = 1;
+  p->np[0] = p->np[1] = p->np[2] = 0;
+  MPI_Dims_create(size, 3, p->np);
+
+  get_list_int(argc, argv, "-bench_N", 1, &p->num_N, p->N);
+  get_list_int(argc, argv, "-bench_m", 1, &p->num_m, p->m);
+  get_list_int(argc, argv, "-bench_window", 1, &p->num_window, p->window);
+  get_list_int(argc, argv, "-bench_precompute", 1, &p->num_pre, p->pre);
+  get_list_int(argc, argv, "-bench_interlaced", 1, &p->num_il, p->il);
+  get_list_int(argc, argv, "-bench_diff_ik", 1, &p->num_ik, p->ik);
+  get_list_int(argc, argv, "-bench_c2r", 1, &p->num_c2r, p->c2r);
+  get_list_int(argc, argv, "-bench_np", 3, &p->num_np, p->np);
+  get_list_int(argc, argv, "-bench_nodes", 1, &p->num_nodes, p->nodes);
+
+  pnfft_get_args(argc, argv, "-bench_M_factor_num", 1, PFFT_INT, &p->num_M);
+  p->num_M = (p->num_M < 1) ? 1 : (p->num_M > BENCH_MAX_LIST) ? BENCH_MAX_LIST : p->num_M;
+  pnfft_get_args(argc, argv, "-bench_M_factor", p->num_M, PFFT_DOUBLE, p->M_factor);
+
+  pnfft_get_args(argc, argv, "-bench_reps", 1, PFFT_INT, &p->reps);
+  pnfft_get_args(argc, argv, "-bench_warmup", 1, PFFT_INT, &p->warmup);
+  pnfft_get_args(argc, argv, "-bench_grad", 1, PFFT_INT, &p->grad);
+  pnfft_get_args(argc, argv, "-bench_seed", 1, PFFT_INT, &p->seed);
+  pnfft_get_args(argc, argv, "-bench_threshold", 1, PFFT_DOUBLE, &p->threshold);
+  p->reps = (p->reps < 1) ? 1 : p->reps;
+
+  p->csv      = get_string(argc, argv, "-bench_csv", "bench_sweep.csv");
+  p->json     = get_string(argc, argv, "-bench_json", "bench_sweep.json");
+  p->baseline = get_string(argc, argv, "-bench_baseline", NULL);
+}
+
+/* returns the number of results, i.e., 2 for trafo and adj or 0 if the process mesh does not fit */
+static int run_config(
+    const config_s *cfg, const params_s *p,
+    result_s *res
+    )
+{
+  unsigned pnfft_flags, precompute_flags = 0, compute_flags;
+  unsigned malloc_flags = PNFFT_MALLOC_X | PNFFT_MALLOC_F;
+  ptrdiff_t N[3], n[3], local_N[3], local_N_start[3], local_M, M_total;
+  double x_max[3], lower_border[3], upper_border[3];
+  double *samples;
+  pnfft_plan pnfft;
+  pnfft_nodes nodes;
+  MPI_Comm comm_cart_3d;
+
+  if( pnfft_create_procmesh(3, MPI_COMM_WORLD, cfg->np, &comm_cart_3d) ){
+    pfft_printf(MPI_COMM_WORLD, "* Skip process mesh %d x %d x %d, it does not fit to the number of processes\n",
+        cfg->np[0], cfg->np[1], cfg->np[2]);
+    return 0;
+  }
+
+  for(int t=0; t<3; t++){
+    N[t] = cfg->N;
+    n[t] = 2*cfg->N;
+    x_max[t] = 0.5;
+  }
+
+  pnfft_flags = window_flag(cfg->window) | PNFFT_MALLOC_F_HAT;
+  if(cfg->interlaced) pnfft_flags |= PNFFT_INTERLACED;
+  if(cfg->diff_ik)    pnfft_flags |= PNFFT_DIFF_IK;
+  if(cfg->precompute == 1)
+    pnfft_flags |= PNFFT_PRE_CUB_PSI;
+
+  compute_flags = PNFFT_COMPUTE_F;
+  if(p->grad){
+    compute_flags |= PNFFT_COMPUTE_GRAD_F;
+    malloc_flags |= PNFFT_MALLOC_GRAD_F;
+  }
+
+  if(cfg->precompute >= 2){
+    precompute_flags = PNFFT_PRE_PSI;
+    if(p->grad)
+      precompute_flags |= PNFFT_PRE_GRAD_PSI;
+    if(cfg->precompute == 3)
+      precompute_flags |= PNFFT_PRE_FULL;
+  }
+
+  if(cfg->c2r){
+    pnfft_local_size_guru_c2r(3, N, n, x_max, cfg->m, comm_cart_3d, pnfft_flags,
+        local_N, local_N_start, lower_border, upper_border);
+    pnfft = pnfft_init_guru_c2r(3, N, n, x_max, cfg->m, pnfft_flags, PFFT_ESTIMATE, comm_cart_3d);
+  } else {
+    pnfft_local_size_guru(3, N, n, x_max, cfg->m, comm_cart_3d, pnfft_flags,
+        local_N, local_N_start, lower_border, upper_border);
+    pnfft = pnfft_init_guru(3, N, n, x_max, cfg->m, pnfft_flags, PFFT_ESTIMATE, comm_cart_3d);
+  }
+
+  /* the generators decide about the number of local nodes */
+  M_total = (ptrdiff_t) (cfg->M_factor * N[0]*N[1]*N[2]);
+  local_M = pnfft_local_size_x_3d_dist(cfg->nodes, (unsigned) p->seed, M_total,
+      lower_border, upper_border, x_max);
+  nodes = pnfft_init_nodes(local_M, malloc_flags);
+  pnfft_init_x_3d_dist(cfg->nodes, (unsigned) p->seed, M_total,
+      lower_border, upper_border, x_max, local_M,
+      pnfft_get_x(nodes), NULL);
+  pnfft_init_f_hat_3d(N, local_N, local_N_start, pnfft_flags & PNFFT_TRANSPOSED_F_HAT,
+      pnfft_get_f_hat(pnfft));
+  if(precompute_flags)
+    pnfft_precompute_psi(pnfft, nodes, precompute_flags);
+
+  samples = (double*) malloc(sizeof(double) * (size_t) (p->reps * PNFFT_TIMER_LENGTH));
+  for(int adjoint=0; adjoint<2; adjoint++){
+    result_s *r = res + adjoint;
+
+    measure(pnfft, nodes, adjoint, (adjoint) ? PNFFT_COMPUTE_F : compute_flags, p, comm_cart_3d,
+        samples);
+    r->cfg = *cfg;
+    r->adjoint = adjoint;
+    r->M_total = M_total;
+    stats(samples, p->reps,
+        r->median, r->variance);
+    r->nodes_per_sec = (r->median[PNFFT_TIMER_WHOLE] > 0) ? (double) M_total / r->median[PNFFT_TIMER_WHOLE] : 0.0;
+
+    pfft_printf(MPI_COMM_WORLD, "* N=%td M=%.2f m=%d window=%d pre=%d il=%d ik=%d c2r=%d nodes=%d np=%dx%dx%d %-5s: %.3e s, %.3e nodes/s\n",
+        cfg->N, cfg->M_factor, cfg->m, cfg->window, cfg->precompute, cfg->interlaced, cfg->diff_ik, cfg->c2r, cfg->nodes,
+        cfg->np[0], cfg->np[1], cfg->np[2], (adjoint) ? "adj" : "trafo", r->median[PNFFT_TIMER_WHOLE], r->nodes_per_sec);
+  }
+  free(samples);
+
+  pnfft_finalize(pnfft, PNFFT_FREE_F_HAT);
+  pnfft_free_nodes(nodes, PNFFT_FREE_X | PNFFT_FREE_F | ((p->grad) ? PNFFT_FREE_GRAD_F : 0));
+  MPI_Comm_free(&comm_cart_3d);
+  return 2;
+}
+
+/* samples[r*PNFFT_TIMER_LENGTH + t] holds the maximum over all processes of stage t in run r (valid on rank 0) */
+static void measure(
+    pnfft_plan pnfft, pnfft_nodes nodes, int adjoint, unsigned compute_flags,
+    const params_s *p, MPI_Comm comm,
+    double *samples
+    )
+{
+  for(int r=-p->warmup; r<p->reps; r++){
+    double *timer, *timer_max;
+
+    pnfft_reset_timer(pnfft);
+    MPI_Barrier(comm);
+    if(adjoint)
+      pnfft_adj(pnfft, nodes, compute_flags);
+    else
+      pnfft_trafo(pnfft, nodes, compute_flags);
+
+    if(r < 0)
+      continue;
+
+    timer = (adjoint) ? pnfft_get_timer_adj(pnfft) : pnfft_get_timer_trafo(pnfft);
+    timer_max = pnfft_timer_reduce_max(comm, timer);
+    for(int t=0; t<PNFFT_TIMER_LENGTH; t++)
+      samples[r*PNFFT_TIMER_LENGTH + t] = timer_max[t];
+    pnfft_timer_free(timer);
+    pnfft_timer_free(timer_max);
+  }
+}
+
+static void stats(
+    double *samples, int reps,
+    double *median, double *variance
+    )
+{
+  double *sorted = (double*) malloc(sizeof(double) * (size_t) reps);
+
+  for(int t=0; t<PNFFT_TIMER_LENGTH; t++){
+    double mean = 0, var = 0;
+
+    for(int r=0; r<reps; r++){
+      sorted[r] = samples[r*PNFFT_TIMER_LENGTH + t];
+      mean += sorted[r] / reps;
+    }
+    for(int r=0; r<reps; r++)
+      var += (sorted[r] - mean) * (sorted[r] - mean);
+
+    qsort(sorted, (size_t) reps, sizeof(double), compare_double);
+    median[t] = (reps % 2) ? sorted[reps/2] : 0.5 * (sorted[reps/2-1] + sorted[reps/2]);
+    variance[t] = (reps > 1) ? var / (reps-1) : 0.0;
+  }
+
+  free(sorted);
+}
+
+/* the first BENCH_KEY_FIELDS columns of the CSV output identify a configuration */
+static void make_key(
+    const result_s *res,
+    char *key
+    )
+{
+  const config_s *c = &res->cfg;
+
+  snprintf(key, BENCH_KEY_LEN, "%td,%g,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%s",
+      c->N, c->M_factor, c->m, c->window, c->precompute, c->interlaced, c->diff_ik, c->c2r, c->nodes,
+      c->np[0], c->np[1], c->np[2], (res->adjoint) ? "adj" : "trafo");
+}
+
+static void write_csv(
+    const char *name, const result_s *res, int num
+    )
+{
+  int myrank;
+  char key[BENCH_KEY_LEN];
+  FILE *f;
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  if(myrank != 0 || name == NULL)
+    return;
+
+  if( (f = fopen(name, "w")) == NULL ){
+    fprintf(stderr, "Error: can not open %s\n", name);
+    return;
+  }
+
+  fprintf(f, "N,M_factor,m,window,precompute,interlaced,diff_ik,c2r,nodes,np0,np1,np2,direction,M_total,nodes_per_sec");
+  for(int t=1; t<PNFFT_TIMER_LENGTH; t++)
+    fprintf(f, ",median_%s,var_%s", pnfft_timer_name(t), pnfft_timer_name(t));
+  fprintf(f, "\n");
+
+  for(int k=0; k<num; k++){
+    make_key(&res[k], key);
+    fprintf(f, "%s,%td,%e", key, res[k].M_total, res[k].nodes_per_sec);
+    for(int t=1; t<PNFFT_TIMER_LENGTH; t++)
+      fprintf(f, ",%e,%e", res[k].median[t], res[k].variance[t]);
+    fprintf(f, "\n");
+  }
+
+  fclose(f);
+}
+
+static void write_json(
+    const char *name, const result_s *res, int num
+    )
+{
+  int myrank;
+  FILE *f;
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  if(myrank != 0 || name == NULL)
+    return;
+
+  if( (f = fopen(name, "w")) == NULL ){
+    fprintf(stderr, "Error: can not open %s\n", name);
+    return;
+  }
+
+  fprintf(f, "[\n");
+  for(int k=0; k<num; k++){
+    const config_s *c = &res[k].cfg;
+
+    fprintf(f, "  {\"N\": %td, \"M_factor\": %g, \"m\": %d, \"window\": %d, \"precompute\": %d, ",
+        c->N, c->M_factor, c->m, c->window, c->precompute);
+    fprintf(f, "\"interlaced\": %d, \"diff_ik\": %d, \"c2r\": %d, \"nodes\": %d, \"np\": [%d, %d, %d], ",
+        c->interlaced, c->diff_ik, c->c2r, c->nodes, c->np[0], c->np[1], c->np[2]);
+    fprintf(f, "\"direction\": \"%s\", \"M_total\": %td, \"nodes_per_sec\": %e,\n    \"stages\": {",
+        (res[k].adjoint) ? "adj" : "trafo", res[k].M_total, res[k].nodes_per_sec);
+    for(int t=1; t<PNFFT_TIMER_LENGTH; t++)
+      fprintf(f, "%s\"%s\": {\"median\": %e, \"variance\": %e}", (t > 1) ? ", " : "",
+          pnfft_timer_name(t), res[k].median[t], res[k].variance[t]);
+    fprintf(f, "}}%s\n", (k < num-1) ? "," : "");
+  }
+  fprintf(f, "]\n");
+
+  fclose(f);
+}
+
+/* Returns the number of configurations whose median of the whole transform exceeds the baseline by more than
+ * 'threshold' (relative). Configurations missing in the baseline are skipped. Only rank 0 compares. */
+static int compare_baseline(
+    const char *name, double threshold, const result_s *res, int num
+    )
+{
+  int myrank, col = -1, regressions = 0, compared = 0;
+  char key[BENCH_KEY_LEN];
+  char *line;
+  FILE *f;
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  if(myrank != 0)
+    return 0;
+
+  if( (f = fopen(name, "r")) == NULL ){
+    fprintf(stderr, "Error: can not open baseline %s\n", name);
+    return 0;
+  }
+
+  line = (char*) malloc(BENCH_LINE_LEN);
+
+  /* column of the median of the whole transform */
+  if(fgets(line, BENCH_LINE_LEN, f) != NULL){
+    int c = 0;
+    for(char *tok = strtok(line, ",\n"); tok != NULL; tok = strtok(NULL, ",\n"), c++)
+      if(strcmp(tok, "median_whole") == 0)
+        col = c;
+  }
+
+  while(col >= 0 && fgets(line, BENCH_LINE_LEN, f) != NULL){
+    char *pos = line;
+    double base;
+    int c;
+
+    /* split off the key */
+    for(c=0; c<BENCH_KEY_FIELDS && pos != NULL; c++){
+      pos = strchr(pos, ',');
+      if(pos != NULL && c < BENCH_KEY_FIELDS-1)
+        pos++;
+    }
+    if(pos == NULL)
+      continue;
+    *pos = '\0';
+
+    /* the key ends with the direction, the value follows after the remaining columns */
+    c = BENCH_KEY_FIELDS;
+    for(pos++; c < col && pos != NULL; c++){
+      pos = strchr(pos, ',');
+      if(pos != NULL)
+        pos++;
+    }
+    if(pos == NULL)
+      continue;
+    base = atof(pos);
+
+    for(int k=0; k<num; k++){
+      double cur = res[k].median[PNFFT_TIMER_WHOLE];
+      make_key(&res[k], key);
+      if(strcmp(key, line) != 0)
+        continue;
+      compared++;
+      if(base > 0 && cur > (1.0 + threshold) * base){
+        printf("* REGRESSION %s: %.3e s, baseline %.3e s (+%.1f%%)\n", key, cur, base, 100.0 * (cur/base - 1.0));
+        regressions++;
+      }
+    }
+  }
+
+  printf("* Compared %d configurations with %s: %d regressions beyond %.1f%%\n",
+      compared, name, regressions, 100.0 * threshold);
+
+  free(line);
+  fclose(f);
+  return regressions;
+}
@@ -24,104 +24,104 @@
 
 static void spread_f_c2c_pre_psi(
     C f, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *grid);
 static void spread_f_c2c_pre_full_psi(
     C f, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *grid);
 static void spread_f_r2r_pre_psi(
     R f, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT ostride,
     R *grid);
 static void spread_f_r2r_pre_full_psi(
     R f, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT ostride,
     R *grid);
 
 static void spread_grad_f_c2c_pre_psi(
     const C *grad_f, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *grid);
 static void spread_grad_f_c2c_pre_full_psi(
     const C *grad_f, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *grid);
 static void spread_grad_f_r2r_pre_psi(
     const R *grad_f, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT istride, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT istride, INT ostride,
     R *grid);
 static void spread_grad_f_r2r_pre_full_psi(
     const R *grad_f, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT istride, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT istride, INT ostride,
     R *grid);
 
 static void assign_f_c2c_pre_psi(
     const C *grid, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *fv);
 static void assign_f_c2c_pre_full_psi(
     const C *grid, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *fv);
 static void assign_f_r2r_pre_psi(
     const R *grid, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT istride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT istride,
     R *fv);
 static void assign_f_r2r_pre_full_psi(
     const R *grid, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, int istride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, int istride,
     R *fv);
 
 static void assign_grad_f_c2c_pre_psi(
     const C *grid, R *pre_psi, R *pre_dpsi, 
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *grad_f);
 static void assign_grad_f_c2c_pre_full_psi(
     const C *grid, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *grad_f);
 static void assign_grad_f_r2r_pre_psi(
     const R *grid, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT istride, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT istride, INT ostride,
     R *grad_f);
 static void assign_grad_f_r2r_pre_full_psi(
     const R *grid, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT istride, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT istride, INT ostride,
     R *grad_f);
 
 static void assign_hessian_f_c2c_pre_psi(
     const C *grid, R *pre_psi, R *pre_dpsi, R *pre_ddpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *hessian_f);
 static void assign_hessian_f_c2c_pre_full_psi(
     const C *grid, R *pre_psi, R *pre_dpsi, R *pre_ddpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *hessian_f);
 static void assign_hessian_f_r2r_pre_psi(
     const R *grid, R *pre_psi, R *pre_dpsi, R *pre_ddpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT istride, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT istride, INT ostride,
     R *hessian_f);
 static void assign_hessian_f_r2r_pre_full_psi(
     const R *grid, R *pre_psi, R *pre_dpsi, R *pre_ddpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT istride, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT istride, INT ostride,
     R *hessian_f);
 
 static void assign_f_and_grad_f_c2c_pre_psi(
     const C *grid, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *fv, C *grad_f);
 static void assign_f_and_grad_f_c2c_pre_full_psi(
     const C *grid, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *fv, C *grad_f);
 static void assign_f_and_grad_f_r2r_pre_psi(
     const R *grid, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT istride, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT istride, INT ostride,
     R *fv, R *grad_f);
 static void assign_f_and_grad_f_r2r_pre_full_psi(
     const R *grid, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT istride, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT istride, INT ostride,
     R *fv, R *grad_f);
 
 
@@ -131,7 +131,7 @@ static void assign_f_and_grad_f_r2r_pre_full_psi(
 void PNX(spread_f_c2c)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     C f, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff,
+    INT m0, const INT *grid_size, const int *cutoff,
     int use_interlacing, int interlaced,
     C *grid
     )
@@ -144,18 +144,18 @@ void PNX(spread_f_c2c)(
         grid);
   else if (nodes->precompute_flags & PNFFT_PRE_FULL)
     spread_f_c2c_pre_full_psi(
-        f, plan_pre_psi + ind*PNFFT_POW3(cutoff), m0, grid_size, cutoff, use_interlacing, 
+        f, plan_pre_psi + ind*PNFFT_PROD3(cutoff), m0, grid_size, cutoff, use_interlacing, 
         grid);
   else
     spread_f_c2c_pre_psi(
-        f, plan_pre_psi + ind*3*cutoff, m0, grid_size, cutoff, use_interlacing, 
+        f, plan_pre_psi + ind*PNFFT_SUM3(cutoff), m0, grid_size, cutoff, use_interlacing, 
         grid);
 }
 
 void PNX(spread_f_r2r)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     R f, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, INT ostride,
     int use_interlacing, int interlaced,
     R *grid
     )
@@ -168,18 +168,18 @@ void PNX(spread_f_r2r)(
         grid);
   else if (nodes->precompute_flags & PNFFT_PRE_FULL)
     spread_f_r2r_pre_full_psi(
-        f, plan_pre_psi + ind*PNFFT_POW3(cutoff), m0, grid_size, cutoff, ostride, use_interlacing,
+        f, plan_pre_psi + ind*PNFFT_PROD3(cutoff), m0, grid_size, cutoff, ostride, use_interlacing,
         grid);
   else
     spread_f_r2r_pre_psi(
-        f, plan_pre_psi + ind*3*cutoff, m0, grid_size, cutoff, ostride, use_interlacing,
+        f, plan_pre_psi + ind*PNFFT_SUM3(cutoff), m0, grid_size, cutoff, ostride, use_interlacing,
         grid);
 }
 
 void PNX(spread_grad_f_c2c)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     const C *grad_f, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff,
+    INT m0, const INT *grid_size, const int *cutoff,
     int use_interlacing, int interlaced,
     C *grid
     )
@@ -193,12 +193,12 @@ void PNX(spread_grad_f_c2c)(
         grid);
   else if (nodes->precompute_flags & PNFFT_PRE_FULL)
     spread_grad_f_c2c_pre_full_psi(
-        grad_f, plan_pre_dpsi + ind*PNFFT_POW3(cutoff),
+        grad_f, plan_pre_dpsi + ind*PNFFT_PROD3(cutoff),
         m0, grid_size, cutoff, use_interlacing, 
         grid);
   else
     spread_grad_f_c2c_pre_psi(
-        grad_f, plan_pre_psi + ind*3*cutoff, plan_pre_dpsi + ind*3*cutoff, 
+        grad_f, plan_pre_psi + ind*PNFFT_SUM3(cutoff), plan_pre_dpsi + ind*PNFFT_SUM3(cutoff), 
         m0, grid_size, cutoff, use_interlacing, 
         grid);
 }
@@ -206,7 +206,7 @@ void PNX(spread_grad_f_c2c)(
 void PNX(spread_grad_f_r2r)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     const R *grad_f, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff,
+    INT m0, const INT *grid_size, const int *cutoff,
     INT istride, INT ostride,
     int use_interlacing, int interlaced,
     R *grid
@@ -222,12 +222,12 @@ void PNX(spread_grad_f_r2r)(
         grid);
   else if (nodes->precompute_flags & PNFFT_PRE_FULL)
     spread_grad_f_r2r_pre_full_psi(
-        grad_f, plan_pre_dpsi + ind*PNFFT_POW3(cutoff),
+        grad_f, plan_pre_dpsi + ind*PNFFT_PROD3(cutoff),
         m0, grid_size, cutoff, use_interlacing, istride, ostride, 
         grid);
   else
     spread_grad_f_r2r_pre_psi(
-        grad_f, plan_pre_psi + ind*3*cutoff, plan_pre_dpsi + ind*3*cutoff, 
+        grad_f, plan_pre_psi + ind*PNFFT_SUM3(cutoff), plan_pre_dpsi + ind*PNFFT_SUM3(cutoff), 
         m0, grid_size, cutoff, use_interlacing, istride, ostride,
         grid);
 }
@@ -235,7 +235,7 @@ void PNX(spread_grad_f_r2r)(
 void PNX(assign_f_c2c)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     const C *grid, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff,
+    INT m0, const INT *grid_size, const int *cutoff,
     int use_interlacing, int interlaced,
     C *f
     )
@@ -248,18 +248,18 @@ void PNX(assign_f_c2c)(
         f);
   else if (nodes->precompute_flags & PNFFT_PRE_FULL)
     assign_f_c2c_pre_full_psi(
-        grid, plan_pre_psi + ind*PNFFT_POW3(cutoff), m0, grid_size, cutoff, use_interlacing,
+        grid, plan_pre_psi + ind*PNFFT_PROD3(cutoff), m0, grid_size, cutoff, use_interlacing,
         f);
   else
     assign_f_c2c_pre_psi(
-        grid, plan_pre_psi + ind*3*cutoff, m0, grid_size, cutoff, use_interlacing,
+        grid, plan_pre_psi + ind*PNFFT_SUM3(cutoff), m0, grid_size, cutoff, use_interlacing,
         f);
 }
 
 void PNX(assign_f_r2r)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     const R *grid, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff, INT istride,
+    INT m0, const INT *grid_size, const int *cutoff, INT istride,
     int use_interlacing, int interlaced,
     R *f
     )
@@ -272,18 +272,18 @@ void PNX(assign_f_r2r)(
         f);
   else if (nodes->precompute_flags & PNFFT_PRE_FULL)
     assign_f_r2r_pre_full_psi(
-        grid, plan_pre_psi + ind*PNFFT_POW3(cutoff), m0, grid_size, cutoff, use_interlacing, istride,
+        grid, plan_pre_psi + ind*PNFFT_PROD3(cutoff), m0, grid_size, cutoff, use_interlacing, istride,
         f);
   else
     assign_f_r2r_pre_psi(
-        grid, plan_pre_psi + ind*3*cutoff, m0, grid_size, cutoff, use_interlacing, istride,
+        grid, plan_pre_psi + ind*PNFFT_SUM3(cutoff), m0, grid_size, cutoff, use_interlacing, istride,
         f);
 }
 
 void PNX(assign_grad_f_c2c)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     const C *grid, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff,
+    INT m0, const INT *grid_size, const int *cutoff,
     int use_interlacing, int interlaced,
     C *grad_f
     )
@@ -298,12 +298,12 @@ void PNX(assign_grad_f_c2c)(
         grad_f);
   else if (nodes->precompute_flags & PNFFT_PRE_FULL)
     assign_grad_f_c2c_pre_full_psi(
-        grid, plan_pre_dpsi + 3*ind*PNFFT_POW3(cutoff),
+        grid, plan_pre_dpsi + 3*ind*PNFFT_PROD3(cutoff),
         m0, grid_size, cutoff, use_interlacing,
         grad_f);
   else
     assign_grad_f_c2c_pre_psi(
-        grid, plan_pre_psi + ind*3*cutoff, plan_pre_dpsi + ind*3*cutoff,
+        grid, plan_pre_psi + ind*PNFFT_SUM3(cutoff), plan_pre_dpsi + ind*PNFFT_SUM3(cutoff),
         m0, grid_size, cutoff, use_interlacing,
         grad_f);
 }
@@ -311,7 +311,7 @@ void PNX(assign_grad_f_c2c)(
 void PNX(assign_grad_f_r2r)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     const R *grid, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff,
+    INT m0, const INT *grid_size, const int *cutoff,
     INT istride, INT ostride,
     int use_interlacing, int interlaced,
     R *grad_f
@@ -327,12 +327,12 @@ void PNX(assign_grad_f_r2r)(
         grad_f);
   else if (nodes->precompute_flags & PNFFT_PRE_FULL)
     assign_grad_f_r2r_pre_full_psi(
-        grid, plan_pre_dpsi + 3*ind*PNFFT_POW3(cutoff),
+        grid, plan_pre_dpsi + 3*ind*PNFFT_PROD3(cutoff),
         m0, grid_size, cutoff, use_interlacing, istride, ostride,
         grad_f);
   else
     assign_grad_f_r2r_pre_psi(
-        grid, plan_pre_psi + ind*3*cutoff, plan_pre_dpsi + ind*3*cutoff,
+        grid, plan_pre_psi + ind*PNFFT_SUM3(cutoff), plan_pre_dpsi + ind*PNFFT_SUM3(cutoff),
         m0, grid_size, cutoff, use_interlacing, istride, ostride,
         grad_f);
 }
@@ -340,7 +340,7 @@ void PNX(assign_grad_f_r2r)(
 void PNX(assign_hessian_f_c2c)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     const C *grid, R *pre_psi, R *pre_dpsi, R *pre_ddpsi,
-    INT m0, const INT *grid_size, int cutoff,
+    INT m0, const INT *grid_size, const int *cutoff,
     int use_interlacing, int interlaced,
     C *hessian_f
     )
@@ -357,17 +357,17 @@ void PNX(assign_hessian_f_c2c)(
   else if (nodes->precompute_flags & PNFFT_PRE_FULL)
     assign_hessian_f_c2c_pre_full_psi(
         grid,
-        plan_pre_psi + ind*PNFFT_POW3(cutoff),
-        plan_pre_dpsi + 3*ind*PNFFT_POW3(cutoff),
-        plan_pre_ddpsi + 3*ind*PNFFT_POW3(cutoff),
+        plan_pre_psi + ind*PNFFT_PROD3(cutoff),
+        plan_pre_dpsi + 3*ind*PNFFT_PROD3(cutoff),
+        plan_pre_ddpsi + 6*ind*PNFFT_PROD3(cutoff),
         m0, grid_size, cutoff, use_interlacing,
         hessian_f);
   else
     assign_hessian_f_c2c_pre_psi(
         grid, 
-        plan_pre_psi + ind*3*cutoff,
-        plan_pre_dpsi + ind*3*cutoff,
-        plan_pre_ddpsi + ind*3*cutoff,
+        plan_pre_psi + ind*PNFFT_SUM3(cutoff),
+        plan_pre_dpsi + ind*PNFFT_SUM3(cutoff),
+        plan_pre_ddpsi + ind*PNFFT_SUM3(cutoff),
         m0, grid_size, cutoff, use_interlacing,
         hessian_f);
 }
@@ -375,7 +375,7 @@ void PNX(assign_hessian_f_c2c)(
 void PNX(assign_hessian_f_r2r)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     const R *grid, R *pre_psi, R *pre_dpsi, R *pre_ddpsi,
-    INT m0, const INT *grid_size, int cutoff,
+    INT m0, const INT *grid_size, const int *cutoff,
     INT istride, INT ostride,
     int use_interlacing, int interlaced,
     R *hessian_f
@@ -393,17 +393,17 @@ void PNX(assign_hessian_f_r2r)(
   else if (nodes->precompute_flags & PNFFT_PRE_FULL)
     assign_hessian_f_r2r_pre_full_psi(
         grid,
-        plan_pre_psi + ind*PNFFT_POW3(cutoff),
-        plan_pre_dpsi + 3*ind*PNFFT_POW3(cutoff),
-        plan_pre_ddpsi + 3*ind*PNFFT_POW3(cutoff),
+        plan_pre_psi + ind*PNFFT_PROD3(cutoff),
+        plan_pre_dpsi + 3*ind*PNFFT_PROD3(cutoff),
+        plan_pre_ddpsi + 6*ind*PNFFT_PROD3(cutoff),
         m0, grid_size, cutoff, use_interlacing, istride, ostride,
         hessian_f);
   else
     assign_hessian_f_r2r_pre_psi(
         grid, 
-        plan_pre_psi + ind*3*cutoff, 
-        plan_pre_dpsi + ind*3*cutoff,
-        plan_pre_ddpsi + ind*3*cutoff,
+        plan_pre_psi + ind*PNFFT_SUM3(cutoff), 
+        plan_pre_dpsi + ind*PNFFT_SUM3(cutoff),
+        plan_pre_ddpsi + ind*PNFFT_SUM3(cutoff),
         m0, grid_size, cutoff, use_interlacing, istride, ostride,
         hessian_f);
 }
@@ -414,7 +414,7 @@ void PNX(assign_hessian_f_r2r)(
 void PNX(assign_f_and_grad_f_c2c)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     const C *grid, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff,
+    INT m0, const INT *grid_size, const int *cutoff,
     int use_interlacing, int interlaced,
     C *f, C *grad_f
     )
@@ -429,12 +429,12 @@ void PNX(assign_f_and_grad_f_c2c)(
         f, grad_f);
   else if (nodes->precompute_flags & PNFFT_PRE_FULL)
     assign_f_and_grad_f_c2c_pre_full_psi(
-        grid, plan_pre_psi + ind*PNFFT_POW3(cutoff), plan_pre_dpsi + 3*ind*PNFFT_POW3(cutoff),
+        grid, plan_pre_psi + ind*PNFFT_PROD3(cutoff), plan_pre_dpsi + 3*ind*PNFFT_PROD3(cutoff),
         m0, grid_size, cutoff, use_interlacing,
         f, grad_f);
   else
     assign_f_and_grad_f_c2c_pre_psi(
-        grid, plan_pre_psi + ind*3*cutoff, plan_pre_dpsi + ind*3*cutoff,
+        grid, plan_pre_psi + ind*PNFFT_SUM3(cutoff), plan_pre_dpsi + ind*PNFFT_SUM3(cutoff),
         m0, grid_size, cutoff, use_interlacing,
         f, grad_f);
 }
@@ -442,7 +442,7 @@ void PNX(assign_f_and_grad_f_c2c)(
 void PNX(assign_f_and_grad_f_r2r)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     const R *grid, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff,
+    INT m0, const INT *grid_size, const int *cutoff,
     INT istride, INT ostride,
     int use_interlacing, int interlaced,
     R *f, R *grad_f
@@ -458,12 +458,12 @@ void PNX(assign_f_and_grad_f_r2r)(
         f, grad_f);
   else if (nodes->precompute_flags & PNFFT_PRE_FULL)
     assign_f_and_grad_f_r2r_pre_full_psi(
-        grid, plan_pre_psi + ind*PNFFT_POW3(cutoff), plan_pre_dpsi + 3*ind*PNFFT_POW3(cutoff),
+        grid, plan_pre_psi + ind*PNFFT_PROD3(cutoff), plan_pre_dpsi + 3*ind*PNFFT_PROD3(cutoff),
         m0, grid_size, cutoff, use_interlacing, istride, ostride,
         f, grad_f);
   else
     assign_f_and_grad_f_r2r_pre_psi(
-        grid, plan_pre_psi + ind*3*cutoff, plan_pre_dpsi + ind*3*cutoff,
+        grid, plan_pre_psi + ind*PNFFT_SUM3(cutoff), plan_pre_dpsi + ind*PNFFT_SUM3(cutoff),
         m0, grid_size, cutoff, use_interlacing, istride, ostride,
         f, grad_f);
 }
@@ -477,21 +477,21 @@ void PNX(assign_f_and_grad_f_r2r)(
 
 static void spread_f_c2c_pre_psi(
     C f, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *grid
     )
 { 
   INT m1, m2, l0, l1, l2;
-  R *pre_psi_x = &pre_psi[0*cutoff];
-  R *pre_psi_y = &pre_psi[1*cutoff];
-  R *pre_psi_z = &pre_psi[2*cutoff];
+  R *pre_psi_x = &pre_psi[0];
+  R *pre_psi_y = &pre_psi[cutoff[0]];
+  R *pre_psi_z = &pre_psi[cutoff[0]+cutoff[1]];
 
   if(use_interlacing) f *= 0.5;
 
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]){
       R psi_xy = pre_psi_x[l0] * pre_psi_y[l1];
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2++ ){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2++ ){
         grid[m2] += psi_xy * pre_psi_z[l2] * f;
       }
     }
@@ -500,7 +500,7 @@ static void spread_f_c2c_pre_psi(
 
 static void spread_f_c2c_pre_full_psi(
     C f, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *grid
     )
 { 
@@ -508,29 +508,29 @@ static void spread_f_c2c_pre_full_psi(
 
   if(use_interlacing) f *= 0.5;
   
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2])
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2])
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2++, m++ )
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2])
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2])
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2++, m++ )
         grid[m2] += pre_psi[m] * f;
 }
 
 static void spread_f_r2r_pre_psi(
     R f, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT ostride,
     R *grid
     )
 { 
   INT m1, m2, l0, l1, l2;
-  R *pre_psi_x = &pre_psi[0*cutoff];
-  R *pre_psi_y = &pre_psi[1*cutoff];
-  R *pre_psi_z = &pre_psi[2*cutoff];
+  R *pre_psi_x = &pre_psi[0];
+  R *pre_psi_y = &pre_psi[cutoff[0]];
+  R *pre_psi_z = &pre_psi[cutoff[0]+cutoff[1]];
 
   if(use_interlacing) f *= 0.5;
   
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]*ostride){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]*ostride){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]*ostride){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]*ostride){
       R psi_xy = pre_psi_x[l0] * pre_psi_y[l1];
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2+=ostride ){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2+=ostride ){
         grid[m2] += psi_xy * pre_psi_z[l2] * f;
       }
     }
@@ -539,7 +539,7 @@ static void spread_f_r2r_pre_psi(
 
 static void spread_f_r2r_pre_full_psi(
     R f, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT ostride,
     R *grid
     )
 { 
@@ -547,9 +547,9 @@ static void spread_f_r2r_pre_full_psi(
 
   if(use_interlacing) f *= 0.5;
   
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]*ostride)
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]*ostride)
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2+=ostride, m++ )
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]*ostride)
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]*ostride)
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2+=ostride, m++ )
         grid[m2] += pre_psi[m] * f;
 }
 
@@ -557,26 +557,26 @@ static void spread_f_r2r_pre_full_psi(
 
 static void spread_grad_f_c2c_pre_psi(
     const C *grad_f, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *grid
     )
 { 
   INT m1, m2, l0, l1, l2;
-  R *pre_psi_x = &pre_psi[0*cutoff], *pre_dpsi_x = &pre_dpsi[0*cutoff];
-  R *pre_psi_y = &pre_psi[1*cutoff], *pre_dpsi_y = &pre_dpsi[1*cutoff];
-  R *pre_psi_z = &pre_psi[2*cutoff], *pre_dpsi_z = &pre_dpsi[2*cutoff];
+  R *pre_psi_x = &pre_psi[0], *pre_dpsi_x = &pre_dpsi[0];
+  R *pre_psi_y = &pre_psi[cutoff[0]], *pre_dpsi_y = &pre_dpsi[cutoff[0]];
+  R *pre_psi_z = &pre_psi[cutoff[0]+cutoff[1]], *pre_dpsi_z = &pre_dpsi[cutoff[0]+cutoff[1]];
   C g0 = grad_f[0], g1 = grad_f[1], g2 = grad_f[2];
 
   if(use_interlacing){
     g0 *= 0.5; g1 *= 0.5; g2 *= 0.5;
   }
   
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]){
       R psi_xy  = pre_psi_x[l0]  * pre_psi_y[l1];
       R psi_dxy = pre_dpsi_x[l0] * pre_psi_y[l1]; 
       R psi_xdy = pre_psi_x[l0]  * pre_dpsi_y[l1];
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2++ ){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2++ ){
         grid[m2] += psi_dxy * pre_psi_z[l2]  * g0;
         grid[m2] += psi_xdy * pre_psi_z[l2]  * g1;
         grid[m2] += psi_xy  * pre_dpsi_z[l2] * g2;
@@ -587,7 +587,7 @@ static void spread_grad_f_c2c_pre_psi(
 
 static void spread_grad_f_c2c_pre_full_psi(
     const C *grad_f, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *grid
     )
 { 
@@ -598,9 +598,9 @@ static void spread_grad_f_c2c_pre_full_psi(
     g0 *= 0.5; g1 *= 0.5; g2 *= 0.5;
   }
   
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]){
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2++, dm+=3 ){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2++, dm+=3 ){
         grid[m2] += pre_dpsi[dm+0] * g0;
         grid[m2] += pre_dpsi[dm+1] * g1;
         grid[m2] += pre_dpsi[dm+2] * g2;
@@ -611,26 +611,26 @@ static void spread_grad_f_c2c_pre_full_psi(
 
 static void spread_grad_f_r2r_pre_psi(
     const R *grad_f, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT istride, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT istride, INT ostride,
     R *grid
     )
 { 
   INT m1, m2, l0, l1, l2;
-  R *pre_psi_x = &pre_psi[0*cutoff], *pre_dpsi_x = &pre_dpsi[0*cutoff];
-  R *pre_psi_y = &pre_psi[1*cutoff], *pre_dpsi_y = &pre_dpsi[1*cutoff];
-  R *pre_psi_z = &pre_psi[2*cutoff], *pre_dpsi_z = &pre_dpsi[2*cutoff];
+  R *pre_psi_x = &pre_psi[0], *pre_dpsi_x = &pre_dpsi[0];
+  R *pre_psi_y = &pre_psi[cutoff[0]], *pre_dpsi_y = &pre_dpsi[cutoff[0]];
+  R *pre_psi_z = &pre_psi[cutoff[0]+cutoff[1]], *pre_dpsi_z = &pre_dpsi[cutoff[0]+cutoff[1]];
   R g0 = grad_f[0*istride], g1 = grad_f[1*istride], g2 = grad_f[2*istride];
 
   if(use_interlacing){
     g0 *= 0.5; g1 *= 0.5; g2 *= 0.5;
   }
   
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]*ostride){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]*ostride){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]*ostride){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]*ostride){
       R psi_xy  = pre_psi_x[l0]  * pre_psi_y[l1];
       R psi_dxy = pre_dpsi_x[l0] * pre_psi_y[l1]; 
       R psi_xdy = pre_psi_x[l0]  * pre_dpsi_y[l1];
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2+=ostride ){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2+=ostride ){
         grid[m2] += psi_dxy * pre_psi_z[l2]  * g0;
         grid[m2] += psi_xdy * pre_psi_z[l2]  * g1;
         grid[m2] += psi_xy  * pre_dpsi_z[l2] * g2;
@@ -641,7 +641,7 @@ static void spread_grad_f_r2r_pre_psi(
 
 static void spread_grad_f_r2r_pre_full_psi(
     const R *grad_f, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT istride, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT istride, INT ostride,
     R *grid
     )
 { 
@@ -652,9 +652,9 @@ static void spread_grad_f_r2r_pre_full_psi(
     g0 *= 0.5; g1 *= 0.5; g2 *= 0.5;
   }
   
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]*ostride){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]*ostride){
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2+=ostride, m++ ){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]*ostride){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]*ostride){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2+=ostride, m++ ){
         grid[m2] += pre_dpsi[m] * g0;
         grid[m2] += pre_dpsi[m] * g1;
         grid[m2] += pre_dpsi[m] * g2;
@@ -666,20 +666,20 @@ static void spread_grad_f_r2r_pre_full_psi(
 
 static void assign_f_c2c_pre_psi(
     const C *grid, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *fv
     )
 { 
   INT m1, m2, l0, l1, l2;
-  R *pre_psi_x = &pre_psi[0*cutoff];
-  R *pre_psi_y = &pre_psi[1*cutoff];
-  R *pre_psi_z = &pre_psi[2*cutoff];
+  R *pre_psi_x = &pre_psi[0];
+  R *pre_psi_y = &pre_psi[cutoff[0]];
+  R *pre_psi_z = &pre_psi[cutoff[0]+cutoff[1]];
   C f=0;
   
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]){
       R psi_xy = pre_psi_x[l0] * pre_psi_y[l1];
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2++ ){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2++ ){
         f += psi_xy * pre_psi_z[l2] * grid[m2];
       }
     }
@@ -692,16 +692,16 @@ static void assign_f_c2c_pre_psi(
 
 static void assign_f_c2c_pre_full_psi(
     const C *grid, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *fv
     )
 { 
   INT m1, m2, l0, l1, l2, m=0;
   C f=0;
 
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]){
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2++, m++ ){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2++, m++ ){
         f += pre_psi[m] * grid[m2];
       }
     }
@@ -714,20 +714,20 @@ static void assign_f_c2c_pre_full_psi(
 
 static void assign_f_r2r_pre_psi(
     const R *grid, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT istride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT istride,
     R *fv
     )
 { 
   INT m1, m2, l0, l1, l2;
-  R *pre_psi_x = &pre_psi[0*cutoff];
-  R *pre_psi_y = &pre_psi[1*cutoff];
-  R *pre_psi_z = &pre_psi[2*cutoff];
+  R *pre_psi_x = &pre_psi[0];
+  R *pre_psi_y = &pre_psi[cutoff[0]];
+  R *pre_psi_z = &pre_psi[cutoff[0]+cutoff[1]];
   R f=0;
 
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]*istride){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]*istride){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]*istride){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]*istride){
       R psi_xy = pre_psi_x[l0] * pre_psi_y[l1];
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2+=istride ){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2+=istride ){
         f += psi_xy * pre_psi_z[l2] * grid[m2];
       }
     }
@@ -740,16 +740,16 @@ static void assign_f_r2r_pre_psi(
 
 static void assign_f_r2r_pre_full_psi(
     const R *grid, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, int istride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, int istride,
     R *fv
     )
 { 
   INT m1, m2, l0, l1, l2, m=0;
   R f=0;
   
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]*istride){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]*istride){
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2+=istride, m++ ){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]*istride){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]*istride){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2+=istride, m++ ){
         f += pre_psi[m] * grid[m2];
       }
     }
@@ -762,22 +762,22 @@ static void assign_f_r2r_pre_full_psi(
 
 static void assign_grad_f_c2c_pre_psi(
     const C *grid, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *grad_f
     )
 { 
   INT m1, m2, l0, l1, l2;
-  R *pre_psi_x = &pre_psi[0*cutoff], *pre_dpsi_x = &pre_dpsi[0*cutoff];
-  R *pre_psi_y = &pre_psi[1*cutoff], *pre_dpsi_y = &pre_dpsi[1*cutoff];
-  R *pre_psi_z = &pre_psi[2*cutoff], *pre_dpsi_z = &pre_dpsi[2*cutoff];
+  R *pre_psi_x = &pre_psi[0], *pre_dpsi_x = &pre_dpsi[0];
+  R *pre_psi_y = &pre_psi[cutoff[0]], *pre_dpsi_y = &pre_dpsi[cutoff[0]];
+  R *pre_psi_z = &pre_psi[cutoff[0]+cutoff[1]], *pre_dpsi_z = &pre_dpsi[cutoff[0]+cutoff[1]];
   C g0=0, g1=0, g2=0;
 
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]){
       R psi_xy  = pre_psi_x[l0]  * pre_psi_y[l1];
       R psi_dxy = pre_dpsi_x[l0] * pre_psi_y[l1]; 
       R psi_xdy = pre_psi_x[l0]  * pre_dpsi_y[l1];
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2++ ){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2++ ){
         g0 += psi_dxy * pre_psi_z[l2]  * grid[m2];
         g1 += psi_xdy * pre_psi_z[l2]  * grid[m2];
         g2 += psi_xy  * pre_dpsi_z[l2] * grid[m2];
@@ -794,16 +794,16 @@ static void assign_grad_f_c2c_pre_psi(
 
 static void assign_grad_f_c2c_pre_full_psi(
     const C *grid, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *grad_f
     )
 { 
   INT m1, m2, l0, l1, l2, dm=0;
   C g0=0, g1=0, g2=0;
 
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]){
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2++, dm+=3 ){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2++, dm+=3 ){
         g0 += pre_dpsi[dm+0] * grid[m2];
         g1 += pre_dpsi[dm+1] * grid[m2];
         g2 += pre_dpsi[dm+2] * grid[m2];
@@ -820,22 +820,22 @@ static void assign_grad_f_c2c_pre_full_psi(
 
 static void assign_grad_f_r2r_pre_psi(
     const R *grid, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT istride, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT istride, INT ostride,
     R *grad_f
     )
 { 
   INT m1, m2, l0, l1, l2;
-  R *pre_psi_x = &pre_psi[0*cutoff], *pre_dpsi_x = &pre_dpsi[0*cutoff];
-  R *pre_psi_y = &pre_psi[1*cutoff], *pre_dpsi_y = &pre_dpsi[1*cutoff];
-  R *pre_psi_z = &pre_psi[2*cutoff], *pre_dpsi_z = &pre_dpsi[2*cutoff];
+  R *pre_psi_x = &pre_psi[0], *pre_dpsi_x = &pre_dpsi[0];
+  R *pre_psi_y = &pre_psi[cutoff[0]], *pre_dpsi_y = &pre_dpsi[cutoff[0]];
+  R *pre_psi_z = &pre_psi[cutoff[0]+cutoff[1]], *pre_dpsi_z = &pre_dpsi[cutoff[0]+cutoff[1]];
   R g0=0, g1=0, g2=0;
 
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]*istride){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]*istride){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]*istride){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]*istride){
       R psi_xy  = pre_psi_x[l0]  * pre_psi_y[l1];
       R psi_dxy = pre_dpsi_x[l0] * pre_psi_y[l1]; 
       R psi_xdy = pre_psi_x[l0]  * pre_dpsi_y[l1];
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2+=istride ){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2+=istride ){
         g0 += psi_dxy * pre_psi_z[l2]  * grid[m2];
         g1 += psi_xdy * pre_psi_z[l2]  * grid[m2];
         g2 += psi_xy  * pre_dpsi_z[l2] * grid[m2];
@@ -852,16 +852,16 @@ static void assign_grad_f_r2r_pre_psi(
 
 static void assign_grad_f_r2r_pre_full_psi(
     const R *grid, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT istride, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT istride, INT ostride,
     R *grad_f
     )
 { 
   INT m1, m2, l0, l1, l2, dm=0;
   R g0=0, g1=0, g2=0;
 
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]*istride){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]*istride){
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2+=istride, dm+=3 ){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]*istride){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]*istride){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2+=istride, dm+=3 ){
         g0 += pre_dpsi[dm+0] * grid[m2];
         g1 += pre_dpsi[dm+1] * grid[m2];
         g2 += pre_dpsi[dm+2] * grid[m2];
@@ -880,28 +880,28 @@ static void assign_grad_f_r2r_pre_full_psi(
 
 static void assign_hessian_f_c2c_pre_psi(
     const C *grid, R *pre_psi, R *pre_dpsi, R *pre_ddpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *hessian_f
     )
 { 
   INT m1, m2, l0, l1, l2;
-  R *pre_psi_x = &pre_psi[0*cutoff], *pre_dpsi_x = &pre_dpsi[0*cutoff];
-  R *pre_psi_y = &pre_psi[1*cutoff], *pre_dpsi_y = &pre_dpsi[1*cutoff];
-  R *pre_psi_z = &pre_psi[2*cutoff], *pre_dpsi_z = &pre_dpsi[2*cutoff];
-  R *pre_ddpsi_x =  &pre_ddpsi[0*cutoff];
-  R *pre_ddpsi_y =  &pre_ddpsi[1*cutoff];
-  R *pre_ddpsi_z =  &pre_ddpsi[2*cutoff];
+  R *pre_psi_x = &pre_psi[0], *pre_dpsi_x = &pre_dpsi[0];
+  R *pre_psi_y = &pre_psi[cutoff[0]], *pre_dpsi_y = &pre_dpsi[cutoff[0]];
+  R *pre_psi_z = &pre_psi[cutoff[0]+cutoff[1]], *pre_dpsi_z = &pre_dpsi[cutoff[0]+cutoff[1]];
+  R *pre_ddpsi_x =  &pre_ddpsi[0];
+  R *pre_ddpsi_y =  &pre_ddpsi[cutoff[0]];
+  R *pre_ddpsi_z =  &pre_ddpsi[cutoff[0]+cutoff[1]];
   C g0=0, g1=0, g2=0, g3=0, g4=0, g5=0;
 
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]){
       R psi_xy   = pre_psi_x[l0]   * pre_psi_y[l1];
       R psi_dxy  = pre_dpsi_x[l0]  * pre_psi_y[l1]; 
       R psi_xdy  = pre_psi_x[l0]   * pre_dpsi_y[l1];
       R psi_dxdy = pre_dpsi_x[l0]  * pre_dpsi_y[l1];
       R psi_ddxy = pre_ddpsi_x[l0] * pre_psi_y[l1];
       R psi_xddy = pre_psi_x[l0]   * pre_ddpsi_y[l1];
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2++ ){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2++ ){
         g0 += psi_ddxy * pre_psi_z[l2]   * grid[m2];
         g1 += psi_dxdy * pre_psi_z[l2]   * grid[m2];
         g2 += psi_dxy  * pre_dpsi_z[l2]  * grid[m2];
@@ -923,16 +923,16 @@ static void assign_hessian_f_c2c_pre_psi(
 
 static void assign_hessian_f_c2c_pre_full_psi(
     const C *grid, R *pre_psi, R *pre_dpsi, R *pre_ddpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *hessian_f
     )
 { 
   INT m1, m2, l0, l1, l2, ddm=0;
   C g0=0, g1=0, g2=0, g3=0, g4=0, g5=0;
 
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]){
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2++, ddm+=6 ){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2++, ddm+=6 ){
         g0 += pre_ddpsi[ddm+0] * grid[m2];
         g1 += pre_ddpsi[ddm+1] * grid[m2];
         g2 += pre_ddpsi[ddm+2] * grid[m2];
@@ -954,28 +954,28 @@ static void assign_hessian_f_c2c_pre_full_psi(
 
 static void assign_hessian_f_r2r_pre_psi(
     const R *grid, R *pre_psi, R *pre_dpsi, R *pre_ddpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT istride, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT istride, INT ostride,
     R *hessian_f
     )
 { 
   INT m1, m2, l0, l1, l2;
-  R *pre_psi_x = &pre_psi[0*cutoff], *pre_dpsi_x = &pre_dpsi[0*cutoff];
-  R *pre_psi_y = &pre_psi[1*cutoff], *pre_dpsi_y = &pre_dpsi[1*cutoff];
-  R *pre_psi_z = &pre_psi[2*cutoff], *pre_dpsi_z = &pre_dpsi[2*cutoff];
-  R *pre_ddpsi_x =  &pre_ddpsi[0*cutoff];
-  R *pre_ddpsi_y =  &pre_ddpsi[1*cutoff];
-  R *pre_ddpsi_z =  &pre_ddpsi[2*cutoff];
+  R *pre_psi_x = &pre_psi[0], *pre_dpsi_x = &pre_dpsi[0];
+  R *pre_psi_y = &pre_psi[cutoff[0]], *pre_dpsi_y = &pre_dpsi[cutoff[0]];
+  R *pre_psi_z = &pre_psi[cutoff[0]+cutoff[1]], *pre_dpsi_z = &pre_dpsi[cutoff[0]+cutoff[1]];
+  R *pre_ddpsi_x =  &pre_ddpsi[0];
+  R *pre_ddpsi_y =  &pre_ddpsi[cutoff[0]];
+  R *pre_ddpsi_z =  &pre_ddpsi[cutoff[0]+cutoff[1]];
   R g0=0, g1=0, g2=0, g3=0, g4=0, g5=0;
 
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]*istride){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]*istride){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]*istride){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]*istride){
       R psi_xy   = pre_psi_x[l0]   * pre_psi_y[l1];
       R psi_dxy  = pre_dpsi_x[l0]  * pre_psi_y[l1]; 
       R psi_xdy  = pre_psi_x[l0]   * pre_dpsi_y[l1];
       R psi_dxdy = pre_dpsi_x[l0]  * pre_dpsi_y[l1];
       R psi_ddxy = pre_ddpsi_x[l0] * pre_psi_y[l1];
       R psi_xddy = pre_psi_x[l0]   * pre_ddpsi_y[l1];
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2+=istride ){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2+=istride ){
         g0 += psi_ddxy * pre_psi_z[l2]   * grid[m2];
         g1 += psi_dxdy * pre_psi_z[l2]   * grid[m2];
         g2 += psi_dxy  * pre_dpsi_z[l2]  * grid[m2];
@@ -997,16 +997,16 @@ static void assign_hessian_f_r2r_pre_psi(
 
 static void assign_hessian_f_r2r_pre_full_psi(
     const R *grid, R *pre_psi, R *pre_dpsi, R *pre_ddpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT istride, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT istride, INT ostride,
     R *hessian_f
     )
 { 
   INT m1, m2, l0, l1, l2, ddm=0;
   R g0=0, g1=0, g2=0, g3=0, g4=0, g5=0;
 
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]*istride){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]*istride){
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2+=istride, ddm+=6 ){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]*istride){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]*istride){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2+=istride, ddm+=6 ){
         g0 += pre_ddpsi[ddm+0] * grid[m2];
         g1 += pre_ddpsi[ddm+1] * grid[m2];
         g2 += pre_ddpsi[ddm+2] * grid[m2];
@@ -1032,22 +1032,22 @@ static void assign_hessian_f_r2r_pre_full_psi(
 
 static void assign_f_and_grad_f_c2c_pre_psi(
     const C *grid, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *fv, C *grad_f
     )
 { 
   INT m1, m2, l0, l1, l2;
-  R *pre_psi_x = &pre_psi[0*cutoff], *pre_dpsi_x = &pre_dpsi[0*cutoff];
-  R *pre_psi_y = &pre_psi[1*cutoff], *pre_dpsi_y = &pre_dpsi[1*cutoff];
-  R *pre_psi_z = &pre_psi[2*cutoff], *pre_dpsi_z = &pre_dpsi[2*cutoff];
+  R *pre_psi_x = &pre_psi[0], *pre_dpsi_x = &pre_dpsi[0];
+  R *pre_psi_y = &pre_psi[cutoff[0]], *pre_dpsi_y = &pre_dpsi[cutoff[0]];
+  R *pre_psi_z = &pre_psi[cutoff[0]+cutoff[1]], *pre_dpsi_z = &pre_dpsi[cutoff[0]+cutoff[1]];
   C f=0, g0=0, g1=0, g2=0;
 
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]){
       R psi_xy  = pre_psi_x[l0] * pre_psi_y[l1];
       R psi_dxy = pre_dpsi_x[l0] * pre_psi_y[l1]; 
       R psi_xdy = pre_psi_x[l0] * pre_dpsi_y[l1];
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2++ ){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2++ ){
         f  += psi_xy  * pre_psi_z[l2]  * grid[m2];
         g0 += psi_dxy * pre_psi_z[l2]  * grid[m2];
         g1 += psi_xdy * pre_psi_z[l2]  * grid[m2];
@@ -1067,16 +1067,16 @@ static void assign_f_and_grad_f_c2c_pre_psi(
 
 static void assign_f_and_grad_f_c2c_pre_full_psi(
     const C *grid, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing,
     C *fv, C *grad_f
     )
 { 
   INT m1, m2, l0, l1, l2, m=0, dm=0;
   C f=0, g0=0, g1=0, g2=0;
 
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]){
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2++, m++, dm+=3 ){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2++, m++, dm+=3 ){
         f  += pre_psi[m]  * grid[m2];
         g0 += pre_dpsi[dm+0] * grid[m2];
         g1 += pre_dpsi[dm+1] * grid[m2];
@@ -1096,22 +1096,22 @@ static void assign_f_and_grad_f_c2c_pre_full_psi(
 
 static void assign_f_and_grad_f_r2r_pre_psi(
     const R *grid, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT istride, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT istride, INT ostride,
     R *fv, R *grad_f
     )
 { 
   INT m1, m2, l0, l1, l2;
-  R *pre_psi_x = &pre_psi[0*cutoff], *pre_dpsi_x = &pre_dpsi[0*cutoff];
-  R *pre_psi_y = &pre_psi[1*cutoff], *pre_dpsi_y = &pre_dpsi[1*cutoff];
-  R *pre_psi_z = &pre_psi[2*cutoff], *pre_dpsi_z = &pre_dpsi[2*cutoff];
+  R *pre_psi_x = &pre_psi[0], *pre_dpsi_x = &pre_dpsi[0];
+  R *pre_psi_y = &pre_psi[cutoff[0]], *pre_dpsi_y = &pre_dpsi[cutoff[0]];
+  R *pre_psi_z = &pre_psi[cutoff[0]+cutoff[1]], *pre_dpsi_z = &pre_dpsi[cutoff[0]+cutoff[1]];
   R f=0, g0=0, g1=0, g2=0;
 
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]*istride){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]*istride){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]*istride){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]*istride){
       R psi_xy  = pre_psi_x[l0] * pre_psi_y[l1];
       R psi_dxy = pre_dpsi_x[l0] * pre_psi_y[l1]; 
       R psi_xdy = pre_psi_x[l0] * pre_dpsi_y[l1];
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2+=istride ){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2+=istride ){
         f  += psi_xy  * pre_psi_z[l2]  * grid[m2];
         g0 += psi_dxy * pre_psi_z[l2]  * grid[m2];
         g1 += psi_xdy * pre_psi_z[l2]  * grid[m2];
@@ -1131,16 +1131,16 @@ static void assign_f_and_grad_f_r2r_pre_psi(
 
 static void assign_f_and_grad_f_r2r_pre_full_psi(
     const R *grid, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff, int use_interlacing, INT istride, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, int use_interlacing, INT istride, INT ostride,
     R *fv, R *grad_f
     )
 {
   INT m1, m2, l0, l1, l2, m=0, dm=0;
   R f=0, g0=0, g1=0, g2=0;
 
-  for(l0=0; l0<cutoff; l0++, m0 += grid_size[1]*grid_size[2]*istride){
-    for(l1=0, m1=m0; l1<cutoff; l1++, m1 += grid_size[2]*istride){
-      for(l2=0, m2 = m1; l2<cutoff; l2++, m2+=istride, m++, dm+=3 ){
+  for(l0=0; l0<cutoff[0]; l0++, m0 += grid_size[1]*grid_size[2]*istride){
+    for(l1=0, m1=m0; l1<cutoff[1]; l1++, m1 += grid_size[2]*istride){
+      for(l2=0, m2 = m1; l2<cutoff[2]; l2++, m2+=istride, m++, dm+=3 ){
         f  += pre_psi[m]  * grid[m2];
         g0 += pre_dpsi[dm+0] * grid[m2];
         g1 += pre_dpsi[dm+1] * grid[m2];
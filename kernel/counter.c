@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2011-2013 Michael Pippig
+ *
+ * This file is part of PNFFT.
+ *
+ * PNFFT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PNFFT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PNFFT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Work and traffic counters beside the timers. The counters are derived analytically
+ * from the plan parameters, i.e., they cost a few operations per stage and call.
+ * Every count is added to its stage and to all parents in the timer tree. */
+
+#include "pnfft.h"
+#include "ipnfft.h"
+
+/* flops per grid point and output component of the tensor product loops in assign.c */
+#define PNFFT_FLOPS_GRID_C2C 5
+#define PNFFT_FLOPS_GRID_R2R 3
+
+static double* get_counter(
+    const double *counter, const double *timer, int kind);
+static int grid_element_size(
+    const PNX(plan) ths);
+
+
+double* PNX(get_counter_trafo)(
+    PNX(plan) ths, int kind
+    )
+{
+  return get_counter(ths->counter_trafo, ths->timer_trafo, kind);
+}
+
+double* PNX(get_counter_adj)(
+    PNX(plan) ths, int kind
+    )
+{
+  return get_counter(ths->counter_adj, ths->timer_adj, kind);
+}
+
+/* Returns a copy in the layout of the timers, which is freed by PNX(timer_free).
+ * The number of calls is copied from the timer, such that PNX(timer_average) gives counts per call. */
+static double* get_counter(
+    const double *counter, const double *timer, int kind
+    )
+{
+  double *copy = PNX(mktimer)();
+
+  if(kind < 0 || kind >= PNFFT_COUNTER_KINDS)
+    return copy;
+
+  for(int t=0; t<PNFFT_TIMER_LENGTH; t++)
+    copy[t] = counter[kind*PNFFT_TIMER_LENGTH + t];
+  copy[PNFFT_TIMER_ITER] = timer[PNFFT_TIMER_ITER];
+  return copy;
+}
+
+double* PNX(mkcounter)(
+    void
+    )
+{
+  double *counter = (double*) malloc(sizeof(double) * PNFFT_COUNTER_KINDS * PNFFT_TIMER_LENGTH);
+  PNX(reset_counter)(counter);
+  return counter;
+}
+
+void PNX(rmcounter)(
+    double *counter
+    )
+{
+  if(counter != NULL)
+    free(counter);
+}
+
+void PNX(reset_counter)(
+    double *counter
+    )
+{
+  for(int t=0; t<PNFFT_COUNTER_KINDS * PNFFT_TIMER_LENGTH; t++)
+    counter[t] = 0;
+}
+
+void PNX(counter_add)(
+    double *counter, int idx, int kind, double value
+    )
+{
+  for(; idx >= 0; idx = PNX(timer_parent)(idx))
+    counter[kind*PNFFT_TIMER_LENGTH + idx] += value;
+}
+
+/* One pass over the local grid per output or input array. Assigning reads every grid point of the stencil once,
+ * spreading reads and writes it. */
+void PNX(count_loop_B)(
+    const PNX(plan) ths, double *counter, INT local_M, unsigned compute_flags, int adjoint
+    )
+{
+  const double points = (double) local_M * PNFFT_PROD3(ths->cutoff_dim);
+  const int fpp = (ths->trafo_flag & PNFFTI_TRAFO_C2R) || (ths->pnfft_flags & PNFFT_REAL_F)
+    ? PNFFT_FLOPS_GRID_R2R : PNFFT_FLOPS_GRID_C2C;
+  int comps = 0, passes = 0;
+
+  if(compute_flags & PNFFT_COMPUTE_F)
+    comps += 1;
+  if(compute_flags & PNFFT_COMPUTE_GRAD_F)
+    comps += 3;
+  if(compute_flags & PNFFT_COMPUTE_HESSIAN_F)
+    comps += (adjoint) ? 0 : 6;
+
+  if(adjoint){
+    /* spread_f and spread_grad_f run separately */
+    passes += (compute_flags & PNFFT_COMPUTE_F) ? 2 : 0;
+    passes += (compute_flags & PNFFT_COMPUTE_GRAD_F) ? 2 : 0;
+  } else {
+    /* f and grad_f are assigned in one pass, the Hessian in a second one */
+    passes += (compute_flags & (PNFFT_COMPUTE_F | PNFFT_COMPUTE_GRAD_F)) ? 1 : 0;
+    passes += (compute_flags & PNFFT_COMPUTE_HESSIAN_F) ? 1 : 0;
+  }
+
+  PNX(counter_add)(counter, PNFFT_TIMER_GRID, PNFFT_COUNTER_FLOPS, points * comps * fpp);
+  PNX(counter_add)(counter, PNFFT_TIMER_GRID, PNFFT_COUNTER_BYTES, points * passes * grid_element_size(ths));
+}
+
+/* PFFT sends the ghost cells dimension by dimension. The slab of dimension t includes the ghost cells
+ * of the dimensions before. Dimensions without process decomposition only copy locally. */
+void PNX(count_gcells)(
+    const PNX(plan) ths, double *counter, const INT *local_no, const INT *local_ngc
+    )
+{
+  const int size = grid_element_size(ths);
+
+  for(int t=0; t<ths->d; t++){
+    double slab = (double) (local_ngc[t] - local_no[t]);
+    for(int s=0; s<3; s++)
+      if(s != t)
+        slab *= (s < t) ? local_ngc[s] : local_no[s];
+
+    if(slab == 0)
+      continue;
+
+    PNX(counter_add)(counter, PNFFT_TIMER_GCELLS, PNFFT_COUNTER_BYTES, 2.0 * slab * size);
+    if(ths->np[t] > 1){
+      PNX(counter_add)(counter, PNFFT_TIMER_GCELLS, PNFFT_COUNTER_MPI_BYTES, slab * size);
+      PNX(counter_add)(counter, PNFFT_TIMER_GCELLS, PNFFT_COUNTER_MPI_MSGS, 2);
+    }
+  }
+}
+
+/* Estimate 5 n log2(n) for complex FFTs and half of it for real ones. Every one-dimensional pass
+ * reads and writes the local data, every global transpose sends all but the own block. */
+void PNX(count_F)(
+    const PNX(plan) ths, double *counter
+    )
+{
+  const int c2r = (ths->trafo_flag & PNFFTI_TRAFO_C2R) ? 1 : 0;
+  const int size = grid_element_size(ths);
+  const double np_total = (double) ths->np[0] * ths->np[1] * ths->np[2];
+  const double local_total = (double) ths->n_total / np_total;
+
+  PNX(counter_add)(counter, PNFFT_TIMER_MATRIX_F, PNFFT_COUNTER_FLOPS,
+      ((c2r) ? 2.5 : 5.0) * local_total * log2((double) ths->n_total));
+  PNX(counter_add)(counter, PNFFT_TIMER_MATRIX_F, PNFFT_COUNTER_BYTES, 2.0 * ths->d * local_total * size);
+
+  for(int t=0; t<3; t++){
+    if(ths->np[t] < 2)
+      continue;
+    PNX(counter_add)(counter, PNFFT_TIMER_MATRIX_F, PNFFT_COUNTER_MPI_BYTES,
+        local_total * size * (ths->np[t] - 1) / ths->np[t]);
+    PNX(counter_add)(counter, PNFFT_TIMER_MATRIX_F, PNFFT_COUNTER_MPI_MSGS, ths->np[t] - 1);
+  }
+}
+
+/* elementwise operations on the local Fourier coefficients, i.e., deconvolution and ik-scaling */
+void PNX(count_D)(
+    const PNX(plan) ths, double *counter, int flops_per_coeff, int arrays
+    )
+{
+  PNX(counter_add)(counter, PNFFT_TIMER_MATRIX_D, PNFFT_COUNTER_FLOPS, (double) flops_per_coeff * ths->local_N_total);
+  PNX(counter_add)(counter, PNFFT_TIMER_MATRIX_D, PNFFT_COUNTER_BYTES, (double) arrays * ths->local_N_total * sizeof(C));
+}
+
+static int grid_element_size(
+    const PNX(plan) ths
+    )
+{
+  return (ths->trafo_flag & PNFFTI_TRAFO_C2R) ? sizeof(R) : sizeof(C);
+}
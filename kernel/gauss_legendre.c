@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2011-2013 Michael Pippig
+ *
+ * This file is part of PNFFT.
+ *
+ * PNFFT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PNFFT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PNFFT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "pnfft.h"
+#include "ipnfft.h"
+#include "gauss_legendre.h"
+
+/* Compute nodes and weights of the q-point Gauss-Legendre quadrature on [-1,1].
+ * The roots of the Legendre polynomial P_q are found by Newton's method
+ * starting from the asymptotic approximation cos(pi*(i+0.75)/(q+0.5)). */
+void PNX(gauss_legendre)(
+    int q, R *nodes, R *weights
+    )
+{
+  for(int i=0; i<(q+1)/2; i++){
+    R x = pnfft_cos( PNFFT_PI * (i + K(0.75)) / (q + K(0.5)) );
+    R dp = K(1.0);
+
+    for(int iter=0; iter<100; iter++){
+      /* evaluate P_q(x) and its derivative by the three term recurrence */
+      R p0 = K(1.0), p1 = x;
+      for(int k=2; k<=q; k++){
+        R p2 = ((2*k-1)*x*p1 - (k-1)*p0) / k;
+        p0 = p1;
+        p1 = p2;
+      }
+      dp = q * (x*p1 - p0) / (x*x - K(1.0));
+
+      R dx = p1/dp;
+      x -= dx;
+      if(pnfft_fabs(dx) <= PNFFT_EPSILON)
+        break;
+    }
+
+    nodes[i]       = x;
+    nodes[q-1-i]   = -x;
+    weights[i]     = K(2.0) / ((K(1.0) - x*x) * dp*dp);
+    weights[q-1-i] = weights[i];
+  }
+}
@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2011-2013 Michael Pippig
+ *
+ * This file is part of PNFFT.
+ *
+ * PNFFT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PNFFT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PNFFT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "ipnfft.h"
+
+#ifndef __GAUSS_LEGENDRE_H__
+#define __GAUSS_LEGENDRE_H__
+
+void PNX(gauss_legendre)(
+    int q, R *nodes, R *weights);
+
+#endif
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2011-2013 Michael Pippig
+ *
+ * This file is part of PNFFT.
+ *
+ * PNFFT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PNFFT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PNFFT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "pnfft.h"
+#include "ipnfft.h"
+
+/* Process wide cache of window interpolation tables.
+ * A table only depends on the window type, the window parameters (m, n, b),
+ * the interpolation order and the number of interpolation nodes.
+ * Dimensions and plans with equal parameters share one reference counted table. */
+
+typedef struct intpol_entry_s{
+  unsigned window;            /**< Window flags                                    */
+  int m;                      /**< Cut-off parameter of the window function        */
+  INT n;                      /**< FFT length                                      */
+  R b;                        /**< Shape parameter of the window function          */
+  int order;                  /**< Order of window interpolation                   */
+  INT num_nodes;              /**< Number of interpolation nodes per interval      */
+  int derivative;             /**< 0: psi, 1: dpsi, 2: ddpsi                       */
+
+  R *table;                   /**< Sampled values of window function (derivative)  */
+  int refs;                   /**< Number of plans/dimensions using this table     */
+  struct intpol_entry_s *next;
+} intpol_entry;
+
+static intpol_entry *intpol_cache = NULL;
+
+static void sample_window(
+    const PNX(plan) ths, int dim, int derivative, INT j_start, INT j_end,
+    R *samples);
+static void init_intpol_table_psi(
+    const PNX(plan) ths, int dim, int derivative,
+    R *table);
+
+
+/* Sample psi (derivative) at u = m + j/num_nodes - c for j_start <= j < j_end and all stencil offsets c.
+ * Windows with branch free kernels are evaluated by the vectorized batch routines. */
+static void sample_window(
+    const PNX(plan) ths, int dim, int derivative, INT j_start, INT j_end,
+    R *samples
+    )
+{
+  const int cutoff = ths->cutoff_dim[dim], m = ths->m_dim[dim];
+  const INT n = ths->n[dim], num_nodes = ths->intpol_num_nodes;
+  unsigned window_flags = ths->pnfft_flags & ~(PNFFT_PRE_INTPOL_PSI | PNFFT_PRE_POLY_PSI | PNFFT_FAST_GAUSSIAN);
+
+  if( (derivative == 0) && PNX(window_batch_supported)(window_flags) ){
+#ifdef PNFFT_OPENMP
+    /* chunks are multiples of the batch size, such that all but the last batch are full */
+    INT chunk = PNFFT_WINDOW_BATCH * 64;
+    #pragma omp parallel for schedule(static)
+    for(INT j0=j_start; j0<j_end; j0+=chunk)
+      PNX(sample_window_batch)(ths, dim, j0, PNFFT_MIN(j0+chunk, j_end), num_nodes,
+          samples + cutoff*(j0-j_start));
+#else
+    PNX(sample_window_batch)(ths, dim, j_start, j_end, num_nodes,
+        samples);
+#endif
+    return;
+  }
+
+  /* B-spline windows use the scratch array of the plan and must not be threaded */
+#ifdef PNFFT_OPENMP
+  #pragma omp parallel for schedule(static) if(!(ths->pnfft_flags & PNFFT_WINDOW_BSPLINE))
+#endif
+  for(INT j=j_start; j<j_end; j++){
+    R *out = samples + cutoff*(j-j_start);
+    for(int c=0; c<cutoff; c++){
+      R x = (m + (R)j/num_nodes - c)/n;
+      switch(derivative){
+        case 0: out[c] = PNX(psi)(ths, dim, x); break;
+        case 1: out[c] = PNX(dpsi)(ths, dim, x); break;
+        case 2: out[c] = PNX(ddpsi)(ths, dim, x); break;
+      }
+    }
+  }
+}
+
+/* Compute the table collectively on ths->comm_cart. Every process samples a contiguous block
+ * of the window values, the blocks are exchanged with one allgather and expanded to the table
+ * layout of the interpolation routines. */
+static void init_intpol_table_psi(
+    const PNX(plan) ths, int dim, int derivative,
+    R *table
+    )
+{
+  /* interpolation of "f" at grid point "r" of order
+   * 0: uses f[r]
+   * 1: uses f[r], f[r+1]
+   * 2: uses f[r-1], f[r], f[r+1]
+   * 3: uses f[r-1], f[r], f[r+1], f[r+2]
+   * This equivalent to f[-order/2], ... , f[(order+1)/2]
+   * with integer division. */
+  const int cutoff = ths->cutoff_dim[dim], order = ths->intpol_order;
+  const INT num_nodes = ths->intpol_num_nodes;
+  const INT j_first = -order/2, num_j = num_nodes + order;
+  int np, rnk, *counts, *displs;
+
+  MPI_Comm_size(ths->comm_cart, &np);
+  MPI_Comm_rank(ths->comm_cart, &rnk);
+
+  counts = (int*) malloc(sizeof(int) * (size_t) np);
+  displs = (int*) malloc(sizeof(int) * (size_t) np);
+  for(int p=0; p<np; p++){
+    INT lo = num_j * p / np, hi = num_j * (p+1) / np;
+    counts[p] = (int) (cutoff * (hi-lo));
+    displs[p] = (int) (cutoff * lo);
+  }
+
+  /* samples[cutoff*(j-j_first) + c] = psi^(derivative)( (m + j/num_nodes - c)/n ) */
+  R *samples = (R*) PNX(malloc_tagged)(sizeof(R) * (size_t) (cutoff * num_j), PNFFT_MEM_WINDOW_TABLES, NULL);
+  sample_window(ths, dim, derivative,
+      j_first + displs[rnk]/cutoff, j_first + (displs[rnk] + counts[rnk])/cutoff,
+      samples + displs[rnk]);
+  MPI_Allgatherv(MPI_IN_PLACE, 0, PNFFT_MPI_REAL_TYPE,
+      samples, counts, displs, PNFFT_MPI_REAL_TYPE, ths->comm_cart);
+
+#ifdef PNFFT_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for(INT k=0; k<num_nodes; k++){
+    R *out = table + k*cutoff*(order+1);
+    for(int c=0; c<cutoff; c++)
+      for(int i=0; i<=order; i++)
+        out[c*(order+1) + i] = samples[cutoff*(k+i) + c];
+  }
+
+  PNX(free)(samples);
+  free(counts);
+  free(displs);
+}
+
+
+/* Return the interpolation table of the window function (derivative) in dimension 'dim'.
+ * The table is computed only if no plan holds an equivalent one.
+ * Collective on ths->comm_cart, since a missing table is computed by all processes together. */
+R* PNX(acquire_intpol_table)(
+    const PNX(plan) ths, int dim, int derivative
+    )
+{
+  unsigned window = ths->pnfft_flags & PNFFTI_WINDOW_MASK;
+  intpol_entry *e, *found = NULL;
+  int have_table, all_have_table;
+
+  for(e = intpol_cache; e != NULL; e = e->next){
+    if( (e->window == window) && (e->m == ths->m_dim[dim]) && (e->n == ths->n[dim])
+        && (e->b == ths->b[dim]) && (e->order == ths->intpol_order)
+        && (e->num_nodes == ths->intpol_num_nodes) && (e->derivative == derivative) )
+    {
+      found = e;
+      break;
+    }
+  }
+
+  /* caches may differ between processes, e.g., after plans on sub-communicators */
+  have_table = (found != NULL);
+  MPI_Allreduce(&have_table, &all_have_table, 1, MPI_INT, MPI_MIN, ths->comm_cart);
+
+  if(all_have_table){
+    found->refs++;
+    return found->table;
+  }
+
+  /* cached tables are shared between plans and accounted to the process only */
+  R *table = (R*) PNX(malloc_tagged)(sizeof(R) * (size_t) (ths->intpol_num_nodes * ths->cutoff_dim[dim] * (ths->intpol_order+1)),
+      PNFFT_MEM_WINDOW_TABLES, NULL);
+  init_intpol_table_psi(ths, dim, derivative,
+      table);
+
+  /* processes that already hold the table only took part in the computation */
+  if(found != NULL){
+    PNX(free)(table);
+    found->refs++;
+    return found->table;
+  }
+
+  e = (intpol_entry*) malloc(sizeof(intpol_entry));
+  e->window     = window;
+  e->m          = ths->m_dim[dim];
+  e->n          = ths->n[dim];
+  e->b          = ths->b[dim];
+  e->order      = ths->intpol_order;
+  e->num_nodes  = ths->intpol_num_nodes;
+  e->derivative = derivative;
+  e->refs       = 1;
+  e->table      = table;
+
+  e->next = intpol_cache;
+  intpol_cache = e;
+
+  return e->table;
+}
+
+/* Drop one reference to 'table'. The memory is freed after the last reference is gone. */
+void PNX(release_intpol_table)(
+    R *table
+    )
+{
+  intpol_entry **p;
+
+  if(table == NULL)
+    return;
+
+  for(p = &intpol_cache; *p != NULL; p = &(*p)->next){
+    intpol_entry *e = *p;
+    if(e->table != table)
+      continue;
+
+    if(--e->refs == 0){
+      *p = e->next;
+      PNX(free)(e->table);
+      free(e);
+    }
+    return;
+  }
+}
+
+/* Release the tables of all 'num_tables' dimensions. The array of table pointers is kept. */
+void PNX(release_intpol_tables)(
+    R **tables, int num_tables
+    )
+{
+  if(tables == NULL)
+    return;
+
+  for(int t=0; t<num_tables; t++){
+    PNX(release_intpol_table)(tables[t]);
+    tables[t] = NULL;
+  }
+}
@@ -35,6 +35,9 @@
 
 #define PNFFT_SORT_RADIX 1
 
+/* number of particles whose window functions are evaluated at once, see window_batch.c */
+#define PNFFT_WINDOW_BATCH 8
+
 /* Begin: This part is based on ifftw3.h */
 #include <stdlib.h>             /* size_t */
 #include <stdarg.h>             /* va_list */
@@ -62,6 +65,8 @@ typedef ptrdiff_t INT;
 #define PNFFT_SIGN(a) (((a)>=0)?1:-1)
 #define PNFFT_SQR(a) ((a)*(a))
 #define PNFFT_POW3(a) ((a)*(a)*(a))
+#define PNFFT_SUM3(a) ((a)[0]+(a)[1]+(a)[2])
+#define PNFFT_PROD3(a) ((a)[0]*(a)[1]*(a)[2])
 
 #define PNFFT_PLAIN_INDEX_3D(k, n)      ( k[2] + n[2]*(k[1] + n[1]*k[0]) )
 #define PNFFT_FFTSHIFT(k, N)            ( ((N)/2-1 < (k)) ? (k)-(N) : (k) )
@@ -109,6 +114,7 @@ typedef ptrdiff_t INT;
 #define pnfft_cexp(_x_)  PNFFT_MATH(cexp)(_x_) 
 #define pnfft_creal(_x_) PNFFT_MATH(creal)(_x_) 
 #define pnfft_cimag(_x_) PNFFT_MATH(cimag)(_x_) 
+#define pnfft_cabs(_x_)  PNFFT_MATH(cabs)(_x_) 
 #define pnfft_floor(_x_) PNFFT_MATH(floor)(_x_) 
 #define pnfft_ceil(_x_)  PNFFT_MATH(ceil)(_x_) 
 #define pnfft_lrint(_x_) PNFFT_MATH(lrint)(_x_) 
@@ -136,6 +142,9 @@ typedef ptrdiff_t INT;
 #define PNFFTI_TRAFO_C2C            (1U<< 0)
 #define PNFFTI_TRAFO_C2R            (1U<< 1)
 
+/* all flags that change the shape of the window function psi */
+#define PNFFTI_WINDOW_MASK          ((PNFFT_WINDOW_GAUSSIAN| PNFFT_WINDOW_BSPLINE| PNFFT_WINDOW_SINC_POWER| PNFFT_WINDOW_BESSEL_I0| PNFFT_WINDOW_ES))
+
 #define A(ex) /* nothing */
 
 #define PNFFT_PRINT_TIMER_BASIC    (1U<<0)
@@ -152,11 +161,58 @@ typedef ptrdiff_t INT;
 #define PNFFT_FINISH_TIMING(timer) \
    timer += MPI_Wtime();
 
+/* Sub-stages of the loop over the nodes are timed in one of every PNFFT_SUBSTAGE_SAMPLE batches
+ * of nodes only and scaled to all batches afterwards, which keeps the clock reads cheap enough
+ * for production runs. */
+#define PNFFT_SUBSTAGE_SAMPLE 64
+#define PNFFT_SUBSTAGE_SAMPLED(batch_index) \
+   ((batch_index) % PNFFT_SUBSTAGE_SAMPLE == 0)
+#define PNFFT_SUBSTAGE_SCALE(num_batches) \
+   (((num_batches) > 0) ? (double) (num_batches) / (((num_batches) + PNFFT_SUBSTAGE_SAMPLE - 1) / PNFFT_SUBSTAGE_SAMPLE) : 0.0)
+#define PNFFT_START_SUBSTAGE(timer, sampled) \
+   if(sampled) timer -= MPI_Wtime();
+#define PNFFT_FINISH_SUBSTAGE(timer, sampled) \
+   if(sampled) timer += MPI_Wtime();
+
+/* Timed stages of a plan. The stage hooks are called outside of the time measurement,
+ * an unregistered hook costs one comparison per stage. */
+#define PNFFT_STAGE_HOOK(ths, hook, timer, stage) \
+   if((ths)->hook != NULL) \
+     PNX(call_stage_hook)((ths), (ths)->hook, (ths)->timer == (ths)->timer_adj, (stage));
+#define PNFFT_START_STAGE(ths, timer, stage) \
+   PNFFT_STAGE_HOOK(ths, stage_begin, timer, stage) \
+   PNFFT_START_TIMING((ths)->comm_cart, (ths)->timer[stage])
+#define PNFFT_FINISH_STAGE(ths, timer, stage) \
+   PNFFT_FINISH_TIMING((ths)->timer[stage]) \
+   PNFFT_STAGE_HOOK(ths, stage_end, timer, stage)
+
 #ifndef PNFFT_H
 typedef struct PNX(plan_s) *PNX(plan);
 typedef struct PNX(nodes_s) *PNX(nodes);
 #endif /* !PNFFT_H */
 
+/* placement of tagged memory blocks */
+#define PNFFTI_PLACE_FIRST_TOUCH  (1U<< 0)
+#define PNFFTI_PLACE_HUGE         (1U<< 1)
+#define PNFFTI_PLACE_HUGETLB      (1U<< 2)
+
+/* bytes per category of the memory owned by a plan or by nodes */
+typedef struct{
+  size_t current[PNFFT_MEM_CATEGORIES];
+  size_t peak[PNFFT_MEM_CATEGORIES];
+  size_t first_touch[PNFFT_MEM_CATEGORIES];
+  size_t huge_pages[PNFFT_MEM_CATEGORIES];
+} memory_s;
+
+/* stack of temporary buffers owned by a plan, see workspace.c */
+typedef struct{
+  char *base;                 /**< Preallocated block of 'capacity' bytes          */
+  size_t capacity;            /**< Size of the preallocated block                  */
+  size_t used;                /**< Bytes handed out, including heap blocks         */
+  size_t high_water;          /**< Largest value of 'used' so far                  */
+  void *spill;                /**< Heap blocks of requests beyond 'capacity'       */
+} workspace_s;
+
 typedef struct PNX(nodes_s){
   INT local_M;                /**< Number of local nodes                           */
   R *f;                       /**< Vector of samples                               */
@@ -174,6 +230,8 @@ typedef struct PNX(nodes_s){
   R *pre_ddpsi_il;            /**< Precomputed window function 2nd derivatives, interlaced */
 
   unsigned precompute_flags;
+
+  memory_s mem;               /**< Current and high-water bytes of the node arrays */
 } nodes_s;
 
 
@@ -203,7 +261,7 @@ typedef struct PNX(plan_s){
   INT *n;                     /**< FFT length, equal to sigma*N                    */
   INT *no;                    /**< FFT output length                               */
   INT n_total;                /**< Total size of FFTW                              */
-  int m;                      /**< Cut-off parameter of the window function        */
+  int m;                      /**< Maximum cut-off parameter over all dimensions   */
   R *x_max;                   /**< Upper border for nodes in time/spatial domain   */
   INT *local_N;               /**< Local multi bandwidth                           */
   INT *local_N_start;         /**< Offset of local multi bandwidth                 */
@@ -236,8 +294,12 @@ typedef struct PNX(plan_s){
   R *g1;                      /**< Input of PFFT                                   */
   R *g2;                      /**< Output of PFFT                                  */
   R *g1_buffer;               /**< Buffer for computing Fourier-space derivatives  */
+  INT alloc_local_in;         /**< Number of reals needed for g1                   */
+  INT alloc_local_out;        /**< Number of reals needed for g2                   */
                                                                                      
-  int cutoff;                 /**< cutoff range                                    */
+  int cutoff;                 /**< cutoff range 2*m+1 of the maximum cut-off       */
+  int m_dim[3];               /**< Cut-off parameter per dimension, 0 for d <= t < 3 */
+  int cutoff_dim[3];          /**< Cutoff range per dimension, 1 for d <= t < 3    */
                                                                                      
   /* parameters for window interpolation table */                                    
   int intpol_order;           /**< order of window interpolation                   */
@@ -246,6 +308,17 @@ typedef struct PNX(plan_s){
   R **intpol_tables_dpsi;     /**< sampled values of window function derivatives   */
   R **intpol_tables_ddpsi;    /**< sampled values of window function 2nd derivatives */
                                                                                      
+  /* parameters for piecewise polynomial window approximation */
+  int poly_degree;            /**< degree of polynomials per stencil offset        */
+  R **poly_coeffs_psi;        /**< monomial coefficients of window functions       */
+  R **poly_coeffs_dpsi;       /**< monomial coefficients of window function derivatives */
+  R **poly_coeffs_ddpsi;      /**< monomial coefficients of window function 2nd derivatives */
+                                                                                     
+  /* quadrature of window Fourier coefficients without closed form */
+  int phi_hat_quad_num;       /**< number of quadrature nodes                      */
+  R *phi_hat_quad_nodes;      /**< quadrature nodes in [0,m] for every dimension   */
+  R *phi_hat_quad_weights;    /**< quadrature weights times psi for every dimension */
+                                                                                     
   MPI_Comm comm_cart;         /**< 2d or 3d Cartesian communicator                 */
   int np[3];                  /**< Size of Cartesian communicator                  */
   int rnk_pm;                 /**< rank of Cartesian communicator                  */
@@ -253,6 +326,17 @@ typedef struct PNX(plan_s){
                                                                                      
   double* timer_trafo;        /**< Saves time measurements during PNFFT            */
   double* timer_adj;          /**< Saves time measurements during adjoint PNFFT    */
+  double* counter_trafo;      /**< Flops and bytes per timer during PNFFT          */
+  double* counter_adj;        /**< Flops and bytes per timer during adjoint PNFFT  */
+
+  PNX(stage_hook) stage_begin; /**< Called at the beginning of every timed stage  */
+  PNX(stage_hook) stage_end;  /**< Called at the end of every timed stage          */
+  void *stage_data;           /**< User data passed to the stage hooks             */
+  int stage_component;        /**< Timer of the current ik component, or -1        */
+  int stage_interlaced;       /**< Current pass of interlacing                     */
+
+  memory_s mem;               /**< Current and high-water bytes owned by the plan  */
+  workspace_s ws;             /**< Temporary buffers of trafo and adj              */
 } plan_s;
 
 #if PNFFT_ENABLE_DEBUG
@@ -297,7 +381,7 @@ void PNX(sort_node_indices_radix_lsdf)(
 void PNX(sort_node_indices_radix_msdf)(
     INT n, INT *keys0, INT *keys1, INT rhigh);
 void PNX(sort_nodes_indices_qsort_3d)(
-    const INT *n, int m, INT local_M, const R *x,
+    int d, const INT *n, const int *m, INT local_M, const R *x,
     INT *sort);
 
 
@@ -305,12 +389,121 @@ void PNX(sort_nodes_indices_qsort_3d)(
 void PNX(die)(
     const char *s, MPI_Comm comm);
 void PNX(save_free)(void *p);
+void *PNX(malloc_tagged)(
+    size_t n, int category, memory_s *owner);
+void *PNX(malloc_placed)(
+    size_t n, int category, memory_s *owner, unsigned huge_flags);
+void PNX(first_touch)(
+    R *data, INT n);
+void PNX(split_tagged)(
+    const void *p, size_t n, int category);
+void PNX(detach_tagged)(
+    const void *p);
+void PNX(add_tagged_bytes)(
+    const void *p,
+    size_t *bytes);
+void PNX(add_tagged_placement)(
+    const void *p,
+    size_t *first_touch, size_t *huge_pages);
+void PNX(reset_memory)(
+    memory_s *mem);
+void PNX(zero_parallel)(R *data, INT n);
+
+/* workspace.c */
+void PNX(init_workspace)(
+    PNX(plan) ths);
+void PNX(free_workspace)(
+    PNX(plan) ths);
+size_t PNX(workspace_mark)(
+    const PNX(plan) ths);
+void *PNX(workspace_get)(
+    PNX(plan) ths, size_t n);
+void PNX(workspace_release)(
+    PNX(plan) ths, size_t mark);
+size_t PNX(workspace_size)(
+    size_t n);
 
 /* timer.c */
 double* PNX(mktimer)(
     void);
 void PNX(rmtimer)(
     double* timer);
+void PNX(call_stage_hook)(
+    PNX(plan) ths, PNX(stage_hook) hook, int adjoint, int stage);
+
+/* counter.c */
+double* PNX(mkcounter)(
+    void);
+void PNX(rmcounter)(
+    double *counter);
+void PNX(reset_counter)(
+    double *counter);
+void PNX(counter_add)(
+    double *counter, int idx, int kind, double value);
+void PNX(count_loop_B)(
+    const PNX(plan) ths, double *counter, INT local_M, unsigned compute_flags, int adjoint);
+void PNX(count_gcells)(
+    const PNX(plan) ths, double *counter, const INT *local_no, const INT *local_ngc);
+void PNX(count_F)(
+    const PNX(plan) ths, double *counter);
+void PNX(count_D)(
+    const PNX(plan) ths, double *counter, int flops_per_coeff, int arrays);
+
+/* intpol_cache.c */
+R* PNX(acquire_intpol_table)(
+    const PNX(plan) ths, int dim, int derivative);
+void PNX(release_intpol_table)(
+    R *table);
+void PNX(release_intpol_tables)(
+    R **tables, int num_tables);
+
+/* plan_pool.c */
+void PNX(acquire_pooled_grids)(
+    PNX(plan) ths, INT alloc_local_in, INT alloc_local_out,
+    unsigned forw_flags, unsigned back_flags,
+    const INT *gcells_below, const INT *gcells_above);
+void PNX(release_pooled_grids)(
+    PNX(plan) ths);
+size_t PNX(pooled_grid_bytes)(
+    const PNX(plan) ths);
+
+/* wisdom.c */
+int PNX(recall_wisdom)(
+    const PNX(plan) ths,
+    INT *intpol_num_nodes, int *poly_degree);
+void PNX(remember_wisdom)(
+    const PNX(plan) ths);
+int PNX(recall_auto_wisdom)(
+    const INT *N, double eps, const int *np, unsigned auto_flags,
+    int *m, INT *n, unsigned *pnfft_flags, double *time);
+void PNX(remember_auto_wisdom)(
+    const INT *N, double eps, const int *np, unsigned auto_flags,
+    int m, const INT *n, unsigned pnfft_flags, double time);
+
+/* oversampling.c */
+R PNX(window_error_estimate)(
+    unsigned window, R sigma, int m);
+int PNX(retune_m)(
+    unsigned window, R sigma, int m_ref, R sigma_ref);
+INT PNX(smooth_fft_size)(
+    INT n_min);
+
+/* poly_window.c */
+void PNX(init_poly_window)(
+    PNX(plan) ths);
+void PNX(free_poly_window)(
+    PNX(plan) ths);
+
+/* window_batch.c */
+int PNX(window_batch_supported)(
+    unsigned pnfft_flags);
+void PNX(pre_psi_tensor_batch)(
+    const PNX(plan) ths, int num, const R *x, const R *floor_nx,
+    R *buf,
+    R *pre_psi);
+void PNX(sample_window_batch)(
+    const PNX(plan) ths, int dim, INT j_start, INT j_end, INT num_nodes,
+    R *samples);
 
 /* ndft-parallel.c */
 void PNX(init_precompute_window)(
@@ -318,20 +511,27 @@ void PNX(init_precompute_window)(
 void PNX(rmplan)(
     PNX(plan) ths, unsigned pnfft_finalize_flags);
 INT PNX(local_size_internal)(
-    const INT *N, const INT *n, const INT *no,
+    int d, const INT *N, const INT *n, const INT *no,
     MPI_Comm comm_cart_2d,
     unsigned trafo_flag, unsigned pnfft_flags,
     INT *local_N, INT *local_N_start,
     INT *local_no, INT *local_no_start);
+void PNX(pad_trivial_axes)(
+    int d, INT *local_n, INT *local_n_start);
 void PNX(local_block_internal)(
-    const INT *N, const INT *no,
+    int d, const INT *N, const INT *no,
     MPI_Comm comm_cart, int pid,
     unsigned pnfft_flags, unsigned trafo_flag,
     INT *local_N, INT *local_N_start);
 PNX(plan) PNX(init_internal)(
-    int d, const INT *N, const INT *n, const INT *no, int m,
+    int d, const INT *N, const INT *n, const INT *no, const int *m,
     unsigned trafo_flag, unsigned pnfft_flags, unsigned pfft_opt_flags,
     MPI_Comm comm_cart_2d);
+void PNX(estimate_memory_internal)(
+    int d, const INT *N, const INT *n, const INT *no, const int *m, INT local_M,
+    MPI_Comm comm_cart, unsigned trafo_flag, unsigned pnfft_flags,
+    unsigned malloc_flags, unsigned precompute_flags,
+    size_t *bytes);
 void PNX(trafo_A)(
     PNX(plan) ths, PNX(nodes) nodes, unsigned compute_flags);
 void PNX(adj_A)(
@@ -374,75 +574,75 @@ void PNX(trafo_scale_ik_diff2_c2c)(
 /* assign.c */
 void PNX(spread_f_c2c)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
-    C f, R *pre_psi, INT m0, const INT *grid_size, int cutoff,
+    C f, R *pre_psi, INT m0, const INT *grid_size, const int *cutoff,
     int use_interlacing, int interlaced,
     C *grid);
 void PNX(spread_f_r2r)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     R f, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff, INT ostride,
+    INT m0, const INT *grid_size, const int *cutoff, INT ostride,
     int use_interlacing, int interlaced,
     R *grid);
 void PNX(spread_grad_f_c2c)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     const C *grad_f, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff,
+    INT m0, const INT *grid_size, const int *cutoff,
     int use_interlacing, int interlaced,
     C *grid);
 void PNX(spread_grad_f_r2r)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     const R *grad_f, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff,
+    INT m0, const INT *grid_size, const int *cutoff,
     INT istride, INT ostride,
     int use_interlacing, int interlaced,
     R *grid);
 void PNX(assign_f_c2c)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     const C *grid, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff,
+    INT m0, const INT *grid_size, const int *cutoff,
     int use_interlacing, int interlaced,
     C *f);
 void PNX(assign_f_r2r)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     const R *grid, R *pre_psi,
-    INT m0, const INT *grid_size, int cutoff, INT istride,
+    INT m0, const INT *grid_size, const int *cutoff, INT istride,
     int use_interlacing, int interlaced,
     R *f);
 void PNX(assign_grad_f_c2c)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     const C *grid, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff,
+    INT m0, const INT *grid_size, const int *cutoff,
     int use_interlacing, int interlaced,
     C *grad_f);
 void PNX(assign_grad_f_r2r)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
-    const R *grid, R *pre_psi, R *pre_dpsi, INT m0, const INT *grid_size, int cutoff,
+    const R *grid, R *pre_psi, R *pre_dpsi, INT m0, const INT *grid_size, const int *cutoff,
     INT istride, INT ostride,
     int use_interlacing, int interlaced,
     R *grad_f);
 void PNX(assign_hessian_f_c2c)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     const C *grid, R *pre_psi, R *pre_dpsi, R *pre_ddpsi,
-    INT m0, const INT *grid_size, int cutoff,
+    INT m0, const INT *grid_size, const int *cutoff,
     int use_interlacing, int interlaced,
     C *hessian_f);
 void PNX(assign_hessian_f_r2r)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     const R *grid, R *pre_psi, R *pre_dpsi, R *pre_ddpsi,
-    INT m0, const INT *grid_size, int cutoff,
+    INT m0, const INT *grid_size, const int *cutoff,
     INT istride, INT ostride,
     int use_interlacing, int interlaced,
     R *hessian_f);
 void PNX(assign_f_and_grad_f_c2c)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     const C *grid, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff,
+    INT m0, const INT *grid_size, const int *cutoff,
     int use_interlacing, int interlaced,
     C *f, C *grad_f);
 void PNX(assign_f_and_grad_f_r2r)(
     PNX(plan) ths, PNX(nodes) nodes, INT ind,
     const R *grid, R *pre_psi, R *pre_dpsi,
-    INT m0, const INT *grid_size, int cutoff,
+    INT m0, const INT *grid_size, const int *cutoff,
     INT istride, INT ostride,
     int use_interlacing, int interlaced,
     R *f, R *grad_f);
@@ -499,6 +699,28 @@ static inline R pnfft_intpol_kub(
   return(-f0*c1*c2*c3+3.0*c0*f1*c2*c3-3.0*c0*c1*f2*c3+c0*c1*c2*f3)/6.0;
 }
 
+/** first derivative of cubic spline interpolation with respect to dist */
+static inline R pnfft_intpol_kub_d(
+    int k, R dist, const R *table
+    )
+{
+  R d2 = dist*dist;
+  R f0,f1,f2,f3;
+  f0=table[k]; f1=table[k+1]; f2=table[k+2]; f3=table[k+3];
+  return (-f0*(3.0*d2-6.0*dist+2.0) + 3.0*f1*(3.0*d2-4.0*dist-1.0)
+      - 3.0*f2*(3.0*d2-2.0*dist-2.0) + f3*(3.0*d2-1.0))/6.0;
+}
+
+/** second derivative of cubic spline interpolation with respect to dist */
+static inline R pnfft_intpol_kub_dd(
+    int k, R dist, const R *table
+    )
+{
+  R f0,f1,f2,f3;
+  f0=table[k]; f1=table[k+1]; f2=table[k+2]; f3=table[k+3];
+  return f0*(1.0-dist) + f1*(3.0*dist-2.0) + f2*(1.0-3.0*dist) + f3*dist;
+}
+
 /* liberfc */
 #include <../cerf/cerf.h>
 
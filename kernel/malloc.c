@@ -21,26 +21,468 @@
 #include "pnfft.h"
 #include "ipnfft.h"
 
+#if HAVE_SYS_MMAN_H
+#  include <sys/mman.h>
+#endif
+
+/* size of the huge pages requested for the large grids */
+#define PNFFT_HUGE_PAGE_SIZE ((size_t) 2 << 20)
+
+/* Every allocation of PNFFT is tagged with a memory category and optionally with the plan or nodes
+ * that own it. The tags live in a process wide open addressing hash table, which is keyed by the
+ * address of the block. Blocks that are not found in the table (e.g. arrays set by the user with
+ * PNX(set_f_hat) and friends) are freed without accounting. */
+
+typedef struct{
+  void *p;                    /**< Address of the block, NULL for empty slots      */
+  size_t size;                /**< Size of the block in bytes                      */
+  size_t split;               /**< Trailing bytes that belong to 'split_category'  */
+  int category;               /**< Memory category of the leading bytes            */
+  int split_category;         /**< Memory category of the trailing bytes           */
+  memory_s *owner;            /**< Plan or nodes the block is accounted to, or NULL */
+  unsigned placement;         /**< PNFFTI_PLACE_* flags of the block               */
+} block_s;
+
+static block_s *blocks = NULL;
+static size_t blocks_capacity = 0;
+static size_t blocks_count = 0;
+static memory_s process_memory;
+
+static size_t home_slot(
+    const void *p);
+static block_s* find_block(
+    const void *p);
+static void insert_block(
+    const block_s *b);
+static void remove_block(
+    block_s *b);
+static void account(
+    memory_s *owner, int category, size_t bytes, unsigned placement, int sign);
+static void account_block(
+    const block_s *b, memory_s *owner, int sign);
+static void *track(
+    void *p, size_t n, int category, memory_s *owner, unsigned placement);
+static void *alloc_huge(
+    size_t n, unsigned huge_flags,
+    unsigned *placement);
+static size_t huge_size(
+    size_t n);
+
 
 void *PNX(malloc)(size_t n){
-  return PX(malloc)(n);  
+  return PNX(malloc_tagged)(n, PNFFT_MEM_OTHER, NULL);
 }
 
 R *PNX(alloc_real)(size_t n){
-  return PX(alloc_real)(n);
+  return (R*) PNX(malloc_tagged)(sizeof(R) * n, PNFFT_MEM_OTHER, NULL);
 }
 
 C *PNX(alloc_complex)(size_t n){
-  return PX(alloc_complex)(n);
+  return (C*) PNX(malloc_tagged)(sizeof(C) * n, PNFFT_MEM_OTHER, NULL);
 }
   
 void PNX(free)(void *p){
-  PX(free)(p);
+  block_s *b;
+  unsigned placement = 0;
+  size_t size = 0;
+
+  if(p == NULL)
+    return;
+
+#ifdef PNFFT_OPENMP
+  #pragma omp critical (pnfft_memory)
+#endif
+  {
+    b = find_block(p);
+    if(b != NULL){
+      placement = b->placement;
+      size = b->size;
+      account_block(b, b->owner, -1);
+      remove_block(b);
+    }
+  }
+
+#if HAVE_SYS_MMAN_H && defined(MAP_HUGETLB)
+  if(placement & PNFFTI_PLACE_HUGETLB){
+    munmap(p, huge_size(size));
+    return;
+  }
+#endif
+  if(placement & PNFFTI_PLACE_HUGE)
+    free(p);
+  else
+    PX(free)(p);
+  (void) size;
 }
 
 void PNX(save_free)(void *p){
   if(p != NULL)
-    PX(free)(p);
+    PNX(free)(p);
+}
+
+/* Allocate 'n' bytes with the alignment of PFFT and account them to 'category' of the process
+ * and of 'owner' (may be NULL for memory that is shared between plans). */
+void *PNX(malloc_tagged)(
+    size_t n, int category, memory_s *owner
+    )
+{
+  return track(PX(malloc)(n), n, category, owner, 0);
+}
+
+/* Same as PNX(malloc_tagged), but blocks of at least one huge page are backed by huge pages if requested
+ * by 'huge_flags' (PNFFT_HUGE_PAGES or PNFFT_HUGE_PAGES_EXPLICIT). Explicit huge pages are taken from
+ * the hugetlbfs pool of the kernel; if the pool is empty, transparent huge pages are advised instead. */
+void *PNX(malloc_placed)(
+    size_t n, int category, memory_s *owner, unsigned huge_flags
+    )
+{
+  unsigned placement = 0;
+  void *p = alloc_huge(n, huge_flags, &placement);
+
+  if(p == NULL)
+    return PNX(malloc_tagged)(n, category, owner);
+
+  return track(p, n, category, owner, placement);
+}
+
+/* Zero 'n' reals of a fresh block with the static schedule of the grid loops, such that every page is
+ * placed on the NUMA domain of the thread that works on it. The block is reported as first touched. */
+void PNX(first_touch)(
+    R *data, INT n
+    )
+{
+  if(data == NULL)
+    return;
+
+  PNX(zero_parallel)(data, n);
+
+#ifdef PNFFT_OPENMP
+  #pragma omp critical (pnfft_memory)
+  {
+    block_s *b = find_block(data);
+    if(b != NULL && (~b->placement & PNFFTI_PLACE_FIRST_TOUCH)){
+      account_block(b, b->owner, -1);
+      b->placement |= PNFFTI_PLACE_FIRST_TOUCH;
+      account_block(b, b->owner, +1);
+    }
+  }
+#endif
+}
+
+/* Account the trailing 'n' bytes of the block 'p' to 'category', e.g. the ghost cells behind the FFT output. */
+void PNX(split_tagged)(
+    const void *p, size_t n, int category
+    )
+{
+  if(p == NULL)
+    return;
+
+#ifdef PNFFT_OPENMP
+  #pragma omp critical (pnfft_memory)
+#endif
+  {
+    block_s *b = find_block(p);
+    if(b != NULL){
+      account_block(b, b->owner, -1);
+      b->split = (n < b->size) ? n : b->size;
+      b->split_category = category;
+      account_block(b, b->owner, +1);
+    }
+  }
+}
+
+/* The owner of 'p' goes away while the block survives, e.g. f_hat after PNX(finalize) without PNFFT_FREE_F_HAT.
+ * The block stays accounted to the process only. */
+void PNX(detach_tagged)(
+    const void *p
+    )
+{
+  if(p == NULL)
+    return;
+
+#ifdef PNFFT_OPENMP
+  #pragma omp critical (pnfft_memory)
+#endif
+  {
+    block_s *b = find_block(p);
+    if(b != NULL){
+      account_block(b, b->owner, -1);
+      account_block(b, NULL, +1);
+      b->owner = NULL;
+    }
+  }
+}
+
+/* Add the size of the block 'p' to 'bytes' per category, used for memory that is shared between plans. */
+void PNX(add_tagged_bytes)(
+    const void *p,
+    size_t *bytes
+    )
+{
+  if(p == NULL)
+    return;
+
+#ifdef PNFFT_OPENMP
+  #pragma omp critical (pnfft_memory)
+#endif
+  {
+    block_s *b = find_block(p);
+    if(b != NULL){
+      bytes[b->category] += b->size - b->split;
+      bytes[b->split_category] += b->split;
+    }
+  }
+}
+
+/* Add the size of the block 'p' to 'first_touch' and 'huge_pages' per category, if it is placed that way. */
+void PNX(add_tagged_placement)(
+    const void *p,
+    size_t *first_touch, size_t *huge_pages
+    )
+{
+  if(p == NULL)
+    return;
+
+#ifdef PNFFT_OPENMP
+  #pragma omp critical (pnfft_memory)
+#endif
+  {
+    block_s *b = find_block(p);
+    if(b != NULL){
+      size_t *bytes[2] = {first_touch, huge_pages};
+      const int placed[2] = {
+        (b->placement & PNFFTI_PLACE_FIRST_TOUCH) != 0,
+        (b->placement & (PNFFTI_PLACE_HUGE | PNFFTI_PLACE_HUGETLB)) != 0};
+
+      for(int i=0; i<2; i++){
+        if(!placed[i])
+          continue;
+        bytes[i][b->category] += b->size - b->split;
+        bytes[i][b->split_category] += b->split;
+      }
+    }
+  }
+}
+
+void PNX(reset_memory)(
+    memory_s *mem
+    )
+{
+  for(int k=0; k<PNFFT_MEM_CATEGORIES; k++)
+    mem->current[k] = mem->peak[k] = mem->first_touch[k] = mem->huge_pages[k] = 0;
+}
+
+/* Current and high-water bytes per category of all memory allocated by PNFFT on the calling process. */
+void PNX(get_memory_usage_total)(
+    size_t *current, size_t *peak
+    )
+{
+#ifdef PNFFT_OPENMP
+  #pragma omp critical (pnfft_memory)
+#endif
+  {
+    for(int k=0; k<PNFFT_MEM_CATEGORIES; k++){
+      current[k] = process_memory.current[k];
+      peak[k] = process_memory.peak[k];
+    }
+  }
+}
+
+static void account_block(
+    const block_s *b, memory_s *owner, int sign
+    )
+{
+  account(owner, b->category, b->size - b->split, b->placement, sign);
+  account(owner, b->split_category, b->split, b->placement, sign);
+}
+
+/* owner == NULL only changes the process wide numbers, high-water marks never decrease */
+static void account(
+    memory_s *owner, int category, size_t bytes, unsigned placement, int sign
+    )
+{
+  memory_s *mem[2] = {&process_memory, owner};
+
+  for(int k=0; k<2; k++){
+    if(mem[k] == NULL)
+      continue;
+    if(sign > 0){
+      mem[k]->current[category] += bytes;
+      if(mem[k]->current[category] > mem[k]->peak[category])
+        mem[k]->peak[category] = mem[k]->current[category];
+      if(placement & PNFFTI_PLACE_FIRST_TOUCH)
+        mem[k]->first_touch[category] += bytes;
+      if(placement & (PNFFTI_PLACE_HUGE | PNFFTI_PLACE_HUGETLB))
+        mem[k]->huge_pages[category] += bytes;
+    } else {
+      mem[k]->current[category] -= bytes;
+      if(placement & PNFFTI_PLACE_FIRST_TOUCH)
+        mem[k]->first_touch[category] -= bytes;
+      if(placement & (PNFFTI_PLACE_HUGE | PNFFTI_PLACE_HUGETLB))
+        mem[k]->huge_pages[category] -= bytes;
+    }
+  }
+}
+
+static void *track(
+    void *p, size_t n, int category, memory_s *owner, unsigned placement
+    )
+{
+  block_s b;
+
+  if(p == NULL)
+    return NULL;
+
+  b.p = p;
+  b.size = n;
+  b.split = 0;
+  b.category = b.split_category = category;
+  b.owner = owner;
+  b.placement = placement;
+
+#ifdef PNFFT_OPENMP
+  #pragma omp critical (pnfft_memory)
+#endif
+  {
+    insert_block(&b);
+    account_block(&b, owner, +1);
+  }
+
+  return p;
+}
+
+/* Returns NULL if no huge pages are requested, the block is smaller than one huge page or the system does not support them. */
+static void *alloc_huge(
+    size_t n, unsigned huge_flags,
+    unsigned *placement
+    )
+{
+  void *p = NULL;
+
+  if( !(huge_flags & (PNFFT_HUGE_PAGES | PNFFT_HUGE_PAGES_EXPLICIT)) || n < PNFFT_HUGE_PAGE_SIZE )
+    return NULL;
+
+#if HAVE_SYS_MMAN_H && defined(MAP_HUGETLB)
+  if(huge_flags & PNFFT_HUGE_PAGES_EXPLICIT){
+    p = mmap(NULL, huge_size(n), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if(p != MAP_FAILED){
+      *placement = PNFFTI_PLACE_HUGETLB;
+      return p;
+    }
+    p = NULL;
+  }
+#endif
+
+#if HAVE_POSIX_MEMALIGN && HAVE_MADVISE && defined(MADV_HUGEPAGE)
+  if(posix_memalign(&p, PNFFT_HUGE_PAGE_SIZE, huge_size(n)) != 0)
+    return NULL;
+  madvise(p, huge_size(n), MADV_HUGEPAGE);
+  *placement = PNFFTI_PLACE_HUGE;
+#endif
+
+  return p;
+}
+
+static size_t huge_size(
+    size_t n
+    )
+{
+  return (n + PNFFT_HUGE_PAGE_SIZE - 1) / PNFFT_HUGE_PAGE_SIZE * PNFFT_HUGE_PAGE_SIZE;
+}
+
+static size_t home_slot(
+    const void *p
+    )
+{
+  /* allocations are aligned, drop the low bits before Fibonacci hashing */
+  return (size_t) ((((unsigned long long) (size_t) p >> 4) * 11400714819323198485ULL) >> 32) & (blocks_capacity - 1);
+}
+
+static block_s* find_block(
+    const void *p
+    )
+{
+  if(blocks_count == 0)
+    return NULL;
+
+  for(size_t k = home_slot(p); blocks[k].p != NULL; k = (k+1) & (blocks_capacity-1))
+    if(blocks[k].p == p)
+      return &blocks[k];
+
+  return NULL;
+}
+
+static void insert_block(
+    const block_s *b
+    )
+{
+  size_t k;
+
+  /* keep the load factor below 1/2 */
+  if(2*(blocks_count+1) > blocks_capacity){
+    block_s *old = blocks;
+    size_t old_capacity = blocks_capacity;
+
+    blocks_capacity = (blocks_capacity) ? 2*blocks_capacity : 64;
+    blocks = (block_s*) malloc(sizeof(block_s) * blocks_capacity);
+    for(k=0; k<blocks_capacity; k++)
+      blocks[k].p = NULL;
+
+    for(size_t j=0; j<old_capacity; j++){
+      if(old[j].p == NULL)
+        continue;
+      for(k = home_slot(old[j].p); blocks[k].p != NULL; k = (k+1) & (blocks_capacity-1));
+      blocks[k] = old[j];
+    }
+    if(old != NULL)
+      free(old);
+  }
+
+  for(k = home_slot(b->p); blocks[k].p != NULL; k = (k+1) & (blocks_capacity-1));
+  blocks[k] = *b;
+  blocks_count++;
+}
+
+/* linear probing with backward shift deletion, i.e., no tombstones are needed */
+static void remove_block(
+    block_s *b
+    )
+{
+  const size_t mask = blocks_capacity-1;
+  size_t i = (size_t) (b - blocks), j = i;
+
+  for(;;){
+    size_t h;
+    j = (j+1) & mask;
+    if(blocks[j].p == NULL)
+      break;
+    h = home_slot(blocks[j].p);
+    /* move the entry at j into the hole at i, if i lies cyclically between its home h and j */
+    if( (i <= j) ? ((h <= i) || (h > j)) : ((h <= i) && (h > j)) ){
+      blocks[i] = blocks[j];
+      i = j;
+    }
+  }
+  blocks[i].p = NULL;
+
+  if(--blocks_count == 0){
+    free(blocks);
+    blocks = NULL;
+    blocks_capacity = 0;
+  }
+}
+
+/* Set 'n' reals to zero with a static schedule. Called directly after allocation
+ * it places the pages close to the threads that work on them in the grid loops. */
+void PNX(zero_parallel)(R *data, INT n){
+  if(data == NULL)
+    return;
+
+#ifdef PNFFT_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for(INT k=0; k<n; k++)
+    data[k] = 0;
 }
 
 
@@ -25,6 +25,7 @@
 #include "bessel_i0.h"
 #include "bspline.h"
 #include "sinc.h"
+#include "gauss_legendre.h"
 
 /* The factor 1/n from matrix D cancels with the factor n of the inverse Fourier coefficients. */
 #define PNFFT_INV_PHI_HAT_GAUSS(k,n,b) \
@@ -140,6 +141,27 @@ static inline R phi_hat_sinc_power(
 }
 
 
+/* Window Fourier coefficients computed by quadrature of
+ *   phi_hat(k) = int_{-m}^{m} psi(u/n) cos(2*pi*k*u/n) du,
+ * where 'weights' already contain the factor psi(u/n) of the integrand. */
+static inline R phi_hat_quad(
+    INT k, INT n, int num, const R *nodes, const R *weights
+    )
+{
+  R sum = 0.0, w = K(2.0) * PNFFT_PI * (R)k / (R)n;
+  for(int j=0; j<num; j++)
+    sum += weights[j] * pnfft_cos(w*nodes[j]);
+  return sum;
+}
+
+static inline R inv_phi_hat_quad(
+    INT k, INT n, int num, const R *nodes, const R *weights
+    )
+{
+  R phi_hat = phi_hat_quad(k, n, num, nodes, weights);
+  return (phi_hat > 0) ? K(1.0) / phi_hat : 0.0;
+}
+
 
 /* For oversampling factor sigma==1 avoid division by zero. */
 /* The factor 1/n from matrix D is computed in matrix B (There it cancels with the factor N of the window). */
@@ -150,35 +172,20 @@ static inline R phi_hat_sinc_power(
   ( (PNFFT_ABS(k) >= (n) - (N)/2) ? 0.0 : PNX(bspline)(2 * (m), (R)(k) * (b) / ((R) n) + (R)(m), (spline_coeffs)) )
 
 
-static void convolution_due_to_interlacing(
-    const INT *n,
-    const INT *local_N, const INT *local_N_start,
-    unsigned pnfft_flags, int sign,
-    C *inout);
-static void convolution_with_general_window_overwrite(
-    const C *in,
-    const INT *n,
-    const INT *local_N, const INT *local_N_start,
-    unsigned pnfft_flags,
-    const PNX(plan) window_param,
-    C *out);
-static void convolution_with_general_window_accumulate(
-    const C *in,
-    const INT *n,
-    const INT *local_N, const INT *local_N_start,
-    unsigned pnfft_flags,
-    const PNX(plan) window_param,
-    C *out);
-static void convolution_with_pre_inv_phi_hat_overwrite(
+static void init_deconvolution_tables(
+    const PNX(plan) ths, int interlaced, int sign,
+    const C *pre_inv_phi_hat,
+    C *tables);
+static void deconvolution_overwrite(
     const C *in,
     const INT *local_N,
-    const C *pre_inv_phi_hat,
+    const C *tables,
     unsigned pnfft_flags,
-    C *out);
-static void convolution_with_pre_inv_phi_hat_accumulate(
+    C *out, C *copy);
+static void deconvolution_accumulate(
     const C *in,
     const INT *local_N,
-    const C *pre_inv_phi_hat,
+    const C *tables,
     unsigned pnfft_flags,
     C *out);
 static void precompute_inv_phi_hat_general_window(
@@ -192,86 +199,137 @@ R PNX(inv_phi_hat)(
     const PNX(plan) ths, int dim, INT k
     )
 {
+  /* window of the trivial axes d <= dim < 3 is a single stencil point with weight 1 */
+  if(dim >= ths->d)
+    return K(1.0);
+
   if((ths->pnfft_flags & PNFFT_WINDOW_GAUSSIAN) && (ths->pnfft_flags & PNFFT_USE_FK_GAUSSIAN_T))
-    return inv_phi_hat_gauss_t(k, ths->n[dim], ths->b[dim], ths->m);
+    return inv_phi_hat_gauss_t(k, ths->n[dim], ths->b[dim], ths->m_dim[dim]);
   else if(ths->pnfft_flags & PNFFT_WINDOW_GAUSSIAN)
     return PNFFT_INV_PHI_HAT_GAUSS(k, ths->n[dim], ths->b[dim]);
   else if(ths->pnfft_flags & PNFFT_WINDOW_BSPLINE)
-    return PNFFT_INV_PHI_HAT_BSPLINE(k, ths->n[dim], ths->m);
+    return PNFFT_INV_PHI_HAT_BSPLINE(k, ths->n[dim], ths->m_dim[dim]);
   else if(ths->pnfft_flags & PNFFT_WINDOW_SINC_POWER)
-    return inv_phi_hat_sinc_power(k, ths->n[dim], ths->b[dim], ths->m, ths->spline_coeffs);
+    return inv_phi_hat_sinc_power(k, ths->n[dim], ths->b[dim], ths->m_dim[dim], ths->spline_coeffs);
   else if(ths->pnfft_flags & PNFFT_WINDOW_BESSEL_I0)
-    return inv_phi_hat_bessel_i0(k, ths->n[dim], ths->b[dim], ths->m);
+    return inv_phi_hat_bessel_i0(k, ths->n[dim], ths->b[dim], ths->m_dim[dim]);
+  else if(ths->pnfft_flags & PNFFT_WINDOW_ES)
+    return inv_phi_hat_quad(k, ths->n[dim], ths->phi_hat_quad_num, ths->phi_hat_quad_nodes + dim*ths->phi_hat_quad_num,
+        ths->phi_hat_quad_weights + dim*ths->phi_hat_quad_num);
   else
-    return inv_phi_hat_kaiser(k, ths->n[dim], ths->b[dim], ths->m);
+    return inv_phi_hat_kaiser(k, ths->n[dim], ths->b[dim], ths->m_dim[dim]);
 }
 
 R PNX(phi_hat)(
     const PNX(plan) ths, int dim, INT k
     )
 {
+  /* window of the trivial axes d <= dim < 3 is a single stencil point with weight 1 */
+  if(dim >= ths->d)
+    return K(1.0);
+
   if((ths->pnfft_flags & PNFFT_WINDOW_GAUSSIAN) && (ths->pnfft_flags & PNFFT_USE_FK_GAUSSIAN_T))
-    return phi_hat_gauss_t(k, ths->n[dim], ths->b[dim], ths->m);
+    return phi_hat_gauss_t(k, ths->n[dim], ths->b[dim], ths->m_dim[dim]);
   else if(ths->pnfft_flags & PNFFT_WINDOW_GAUSSIAN)
     return PNFFT_PHI_HAT_GAUSS(k, ths->n[dim], ths->b[dim]);
   else if(ths->pnfft_flags & PNFFT_WINDOW_BSPLINE)
-    return PNFFT_PHI_HAT_BSPLINE(k, ths->n[dim], ths->m);
+    return PNFFT_PHI_HAT_BSPLINE(k, ths->n[dim], ths->m_dim[dim]);
   else if(ths->pnfft_flags & PNFFT_WINDOW_SINC_POWER)
-    return phi_hat_sinc_power(k, ths->n[dim], ths->b[dim], ths->m, ths->spline_coeffs);
+    return phi_hat_sinc_power(k, ths->n[dim], ths->b[dim], ths->m_dim[dim], ths->spline_coeffs);
   else if(ths->pnfft_flags & PNFFT_WINDOW_BESSEL_I0)
-    return phi_hat_bessel_i0(k, ths->n[dim], ths->b[dim], ths->m);
+    return phi_hat_bessel_i0(k, ths->n[dim], ths->b[dim], ths->m_dim[dim]);
+  else if(ths->pnfft_flags & PNFFT_WINDOW_ES)
+    return phi_hat_quad(k, ths->n[dim], ths->phi_hat_quad_num, ths->phi_hat_quad_nodes + dim*ths->phi_hat_quad_num,
+        ths->phi_hat_quad_weights + dim*ths->phi_hat_quad_num);
   else
-    return phi_hat_kaiser(k, ths->n[dim], ths->b[dim], ths->m);
+    return phi_hat_kaiser(k, ths->n[dim], ths->b[dim], ths->m_dim[dim]);
+}
+
+/* Init quadrature for windows without closed form of the Fourier coefficients.
+ * Since psi is even with support [-m,m], we integrate over [0,m] and double the weights.
+ * The substitution u = m*cos(theta) removes the square root singularity at the border of the support,
+ * such that Gauss-Legendre quadrature in theta converges fast.
+ * Nodes and weights are stored per dimension, since the cutoff m may differ. */
+void PNX(init_phi_hat_quad)(
+    PNX(plan) ths
+    )
+{
+  const int q = 3*ths->m + 10;
+
+  PNX(save_free)(ths->phi_hat_quad_nodes);
+  PNX(save_free)(ths->phi_hat_quad_weights);
+
+  ths->phi_hat_quad_num = q;
+  ths->phi_hat_quad_nodes   = (R*) PNX(malloc_tagged)(sizeof(R) * (size_t) (ths->d * q), PNFFT_MEM_WINDOW_TABLES, &ths->mem);
+  ths->phi_hat_quad_weights = (R*) PNX(malloc_tagged)(sizeof(R) * (size_t) (ths->d * q), PNFFT_MEM_WINDOW_TABLES, &ths->mem);
+
+  R *u = ths->phi_hat_quad_nodes, *w = ths->phi_hat_quad_weights;
+  PNX(gauss_legendre)(q, u, w);
+
+  /* map to theta in [0,pi/2], apply substitution and include window values into the weights,
+   * the reference nodes in the block of dimension 0 are overwritten last */
+  for(int t=ths->d-1; t>=0; t--)
+    for(int j=0; j<q; j++){
+      R theta = K(0.25) * PNFFT_PI * (u[j] + K(1.0));
+      R m = (R) ths->m_dim[t];
+      R w_j = w[j] * K(0.5) * PNFFT_PI * m * pnfft_sin(theta);
+      u[t*q+j] = m * pnfft_cos(theta);
+      w[t*q+j] = w_j * PNX(psi)(ths, t, u[t*q+j] / ths->n[t]);
+    }
 }
 
+/* Deconvolution and the phase shift of interlacing are separable, i.e.,
+ *   D(k) = prod_t inv_phi_hat_t(k_t) * exp(-sign*pi*I*k_t/n_t).
+ * Both factors are folded into one 1D table per axis, such that the local Fourier block
+ * is streamed only once. If 'copy' is not NULL, the result is stored there as well,
+ * which saves the extra pass over g1 for ik-differentiation. */
 void PNX(trafo_D)(
-    PNX(plan) ths, int interlaced
+    PNX(plan) ths, int interlaced, C *copy
     )
 {
+  const size_t mark = PNX(workspace_mark)(ths);
+  C *tables = (C*) PNX(workspace_get)(ths, sizeof(C) * (size_t) (ths->local_N[0] + ths->local_N[1] + ths->local_N[2]));
+
 #if PNFFT_ENABLE_DEBUG
   PNX(debug_sum_print)((R*)ths->f_hat, ths->local_N[0]*ths->local_N[1]*ths->local_N[2], 1,
       "PNFFT: Sum of Fourier coefficients before deconvolution");
 #endif
 
-  /* use precomputed window Fourier coefficients if possible */
-  if(ths->pnfft_flags & PNFFT_PRE_PHI_HAT){
-    convolution_with_pre_inv_phi_hat_overwrite(
-        ths->f_hat, ths->local_N, ths->pre_inv_phi_hat_trafo, ths->pnfft_flags,
-        (C*)ths->g1);
-  } else {
-    convolution_with_general_window_overwrite(
-        ths->f_hat, ths->n, ths->local_N, ths->local_N_start, ths->pnfft_flags, ths,
-        (C*)ths->g1);
-  }
+  /* use precomputed window Fourier coefficients if possible,
+   * interlaced NFFT needs extra modulation to revert the shift in x */
+  init_deconvolution_tables(ths, interlaced, FFTW_FORWARD,
+      (ths->pnfft_flags & PNFFT_PRE_PHI_HAT) ? ths->pre_inv_phi_hat_trafo : NULL,
+      tables);
+
+  deconvolution_overwrite(
+      ths->f_hat, ths->local_N, tables, ths->pnfft_flags,
+      (C*)ths->g1, copy);
+  /* two complex multiplications per coefficient */
+  PNX(count_D)(ths, ths->counter_trafo, 12, (copy != NULL) ? 3 : 2);
 
-  /* interlaced NFFT needs extra modulation to revert the shift in x */
-  if(interlaced)
-    convolution_due_to_interlacing(
-        ths->n, ths->local_N, ths->local_N_start, ths->pnfft_flags, FFTW_FORWARD,
-        (C*)ths->g1);
+  PNX(workspace_release)(ths, mark);
 }
 
 
+/* Same as trafo_D with reversed phase shift. The input is read from 'in',
+ * which is g1 unless the ik-differentiated spectra have been accumulated elsewhere. */
 void PNX(adjoint_D)(
-    PNX(plan) ths, int interlaced
+    PNX(plan) ths, int interlaced, const C *in
     )
 {
-  /* interlaced NFFT needs extra modulation to revert the shift in x */
-  if(interlaced)
-    convolution_due_to_interlacing(
-        ths->n, ths->local_N, ths->local_N_start, ths->pnfft_flags, FFTW_BACKWARD,
-        (C*)ths->g1);
-
-  /* use precomputed window Fourier coefficients if possible */
-  if(ths->pnfft_flags & PNFFT_PRE_PHI_HAT){
-    convolution_with_pre_inv_phi_hat_accumulate(
-        (C*)ths->g1, ths->local_N, ths->pre_inv_phi_hat_adj, ths->pnfft_flags,
-        ths->f_hat);
-  } else {
-    convolution_with_general_window_accumulate(
-        (C*)ths->g1, ths->n, ths->local_N, ths->local_N_start, ths->pnfft_flags, ths,
-        ths->f_hat);
-  }
+  const size_t mark = PNX(workspace_mark)(ths);
+  C *tables = (C*) PNX(workspace_get)(ths, sizeof(C) * (size_t) (ths->local_N[0] + ths->local_N[1] + ths->local_N[2]));
+
+  init_deconvolution_tables(ths, interlaced, FFTW_BACKWARD,
+      (ths->pnfft_flags & PNFFT_PRE_PHI_HAT) ? ths->pre_inv_phi_hat_adj : NULL,
+      tables);
+
+  deconvolution_accumulate(
+      (in != NULL) ? in : (C*)ths->g1, ths->local_N, tables, ths->pnfft_flags,
+      ths->f_hat);
+  PNX(count_D)(ths, ths->counter_adj, 14, 3);
+
+  PNX(workspace_release)(ths, mark);
 
 #if PNFFT_ENABLE_DEBUG
   PNX(debug_sum_print)((R*)ths->f_hat, ths->local_N[0]*ths->local_N[1]*ths->local_N[2], 1,
@@ -279,174 +337,84 @@ void PNX(adjoint_D)(
 #endif
 }
 
-static void convolution_due_to_interlacing(
-    const INT *n,
-    const INT *local_N, const INT *local_N_start,
-    unsigned pnfft_flags, int sign,
-    C *inout
+/* tables[l] with l = k0, local_N[0] + k1, local_N[0] + local_N[1] + k2 */
+static void init_deconvolution_tables(
+    const PNX(plan) ths, int interlaced, int sign,
+    const C *pre_inv_phi_hat,
+    C *tables
     )
 {
-  INT k0, k1, k2, k=0;
-  R h0, h1, h2;
-
-  if(pnfft_flags & PNFFT_TRANSPOSED_F_HAT){
-    /* f_hat is transposed N1 x N2 x N0 */
-    for(k1=local_N_start[1]; k1<local_N_start[1] + local_N[1]; k1++){
-      h1 = (R) k1/n[1];
-      for(k2=local_N_start[2]; k2<local_N_start[2] + local_N[2]; k2++){
-        h2 = h1 + (R) k2/n[2];
-        for(k0=local_N_start[0]; k0<local_N_start[0] + local_N[0]; k0++, k++){
-          h0 = h2 + (R) k0/n[0];
-          inout[k] *= pnfft_cexp(-sign * PNFFT_PI * I * h0);
-        }
-      }
-    }
-  } else {
-    /* f_hat is non-transposed N0 x N1 x N2 */
-    for(k0=local_N_start[0]; k0<local_N_start[0] + local_N[0]; k0++){
-      h0 = (R) k0/n[0];
-      for(k1=local_N_start[1]; k1<local_N_start[1] + local_N[1]; k1++){
-        h1 = h0 + (R) k1/n[1];
-        for(k2=local_N_start[2]; k2<local_N_start[2] + local_N[2]; k2++, k++){
-          h2 = h1 + (R) k2/n[2];
-          inout[k] *= pnfft_cexp(-sign * PNFFT_PI * I * h2);
-        }
-      }
-    }
-  }
-}
+  INT l=0;
 
-static void convolution_with_general_window_overwrite(
-    const C *in,
-    const INT *n,
-    const INT *local_N, const INT *local_N_start,
-    unsigned pnfft_flags,
-    const PNX(plan) window_param,
-    C *out
-    )
-{
-  INT k0, k1, k2, k=0;
-  C inv_phi_x, inv_phi_xy, inv_phi_xyz;
-
-  if(pnfft_flags & PNFFT_TRANSPOSED_F_HAT){
-    /* g_hat is transposed N1 x N2 x N0 */
-    for(k1=local_N_start[1]; k1<local_N_start[1] + local_N[1]; k1++){
-      inv_phi_x = PNX(inv_phi_hat)(window_param, 1, k1);
-      for(k2=local_N_start[2]; k2<local_N_start[2] + local_N[2]; k2++){
-        inv_phi_xy = inv_phi_x * PNX(inv_phi_hat)(window_param, 2, k2);
-        for(k0=local_N_start[0]; k0<local_N_start[0] + local_N[0]; k0++, k++){
-          inv_phi_xyz = inv_phi_xy * PNX(inv_phi_hat)(window_param, 0, k0);
-          out[k] = in[k] * inv_phi_xyz;
-        }
-      }
-    }
-  } else {
-    /* g_hat is non-transposed N0 x N1 x N2 */
-    for(k0=local_N_start[0]; k0<local_N_start[0] + local_N[0]; k0++){
-      inv_phi_x = PNX(inv_phi_hat)(window_param, 0, k0);
-      for(k1=local_N_start[1]; k1<local_N_start[1] + local_N[1]; k1++){
-        inv_phi_xy = inv_phi_x * PNX(inv_phi_hat)(window_param, 1, k1);
-        for(k2=local_N_start[2]; k2<local_N_start[2] + local_N[2]; k2++, k++){
-          inv_phi_xyz = inv_phi_xy * PNX(inv_phi_hat)(window_param, 2, k2);
-          out[k] = in[k] * inv_phi_xyz;
-        }
-      }
+  for(int t=0; t<3; t++){
+    for(INT k=ths->local_N_start[t]; k<ths->local_N_start[t] + ths->local_N[t]; k++, l++){
+      tables[l] = (pre_inv_phi_hat != NULL) ? pre_inv_phi_hat[l] : PNX(inv_phi_hat)(ths, t, k);
+      if(interlaced)
+        tables[l] *= pnfft_cexp(-sign * PNFFT_PI * I * (R) k / ths->n[t]);
     }
   }
 }
 
-static void convolution_with_general_window_accumulate(
+static void deconvolution_overwrite(
     const C *in,
-    const INT *n,
-    const INT *local_N, const INT *local_N_start,
+    const INT *local_N,
+    const C *tables,
     unsigned pnfft_flags,
-    const PNX(plan) window_param,
-    C *out
+    C *out, C *copy
     )
 {
-  INT k0, k1, k2, k=0;
-  C inv_phi_x, inv_phi_xy, inv_phi_xyz;
-
-  if(pnfft_flags & PNFFT_TRANSPOSED_F_HAT){
-    /* g_hat is transposed N1 x N2 x N0 */
-    for(k1=local_N_start[1]; k1<local_N_start[1] + local_N[1]; k1++){
-      inv_phi_x = PNX(inv_phi_hat)(window_param, 1, k1);
-      for(k2=local_N_start[2]; k2<local_N_start[2] + local_N[2]; k2++){
-        inv_phi_xy = inv_phi_x * PNX(inv_phi_hat)(window_param, 2, k2);
-        for(k0=local_N_start[0]; k0<local_N_start[0] + local_N[0]; k0++, k++){
-          inv_phi_xyz = inv_phi_xy * PNX(inv_phi_hat)(window_param, 0, k0);
-          out[k] += in[k] * inv_phi_xyz;
-        }
-      }
-    }
-  } else {
-    /* g_hat is non-transposed N0 x N1 x N2 */
-    for(k0=local_N_start[0]; k0<local_N_start[0] + local_N[0]; k0++){
-      inv_phi_x = PNX(inv_phi_hat)(window_param, 0, k0);
-      for(k1=local_N_start[1]; k1<local_N_start[1] + local_N[1]; k1++){
-        inv_phi_xy = inv_phi_x * PNX(inv_phi_hat)(window_param, 1, k1);
-        for(k2=local_N_start[2]; k2<local_N_start[2] + local_N[2]; k2++, k++){
-          inv_phi_xyz = inv_phi_xy * PNX(inv_phi_hat)(window_param, 2, k2);
-          out[k] += in[k] * inv_phi_xyz;
-        }
+  const C *tab[3] = {tables, tables + local_N[0], tables + local_N[0] + local_N[1]};
+
+  /* g_hat is transposed N1 x N2 x N0 or non-transposed N0 x N1 x N2 */
+  const int a0 = (pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? 1 : 0;
+  const int a1 = (pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? 2 : 1;
+  const int a2 = (pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? 0 : 2;
+
+#ifdef PNFFT_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for(INT i0=0; i0<local_N[a0]; i0++){
+    for(INT i1=0; i1<local_N[a1]; i1++){
+      const INT k = (i0*local_N[a1] + i1) * local_N[a2];
+      const C w = tab[a0][i0] * tab[a1][i1];
+      const C *tab2 = tab[a2];
+      if(copy == NULL){
+        for(INT i2=0; i2<local_N[a2]; i2++)
+          out[k+i2] = in[k+i2] * w * tab2[i2];
+      } else {
+        for(INT i2=0; i2<local_N[a2]; i2++)
+          copy[k+i2] = out[k+i2] = in[k+i2] * w * tab2[i2];
       }
     }
   }
 }
 
-static void convolution_with_pre_inv_phi_hat_overwrite(
+static void deconvolution_accumulate(
     const C *in,
     const INT *local_N,
-    const C *pre_inv_phi_hat,
+    const C *tables,
     unsigned pnfft_flags,
     C *out
     )
 {
-  INT k0, k1, k2, k=0;
-  const C *inv_phi_hat0 = pre_inv_phi_hat;
-  const C *inv_phi_hat1 = inv_phi_hat0 + local_N[0];
-  const C *inv_phi_hat2 = inv_phi_hat1 + local_N[1];
-
-  if(pnfft_flags & PNFFT_TRANSPOSED_F_HAT){
-    /* g_hat is transposed N1 x N2 x N0 */
-    for(k1=0; k1<local_N[1]; k1++)
-      for(k2=0; k2<local_N[2]; k2++)
-        for(k0=0; k0<local_N[0]; k0++, k++)
-          out[k] = in[k] * inv_phi_hat0[k0] * inv_phi_hat1[k1] * inv_phi_hat2[k2];
-  } else {
-    /* g_hat is non-transposed N0 x N1 x N2 */
-    for(k0=0; k0<local_N[0]; k0++)
-      for(k1=0; k1<local_N[1]; k1++)
-        for(k2=0; k2<local_N[2]; k2++, k++)
-          out[k] = in[k] * inv_phi_hat0[k0] * inv_phi_hat1[k1] * inv_phi_hat2[k2];
-  }
-}
+  const C *tab[3] = {tables, tables + local_N[0], tables + local_N[0] + local_N[1]};
 
-static void convolution_with_pre_inv_phi_hat_accumulate(
-    const C *in,
-    const INT *local_N,
-    const C *pre_inv_phi_hat,
-    unsigned pnfft_flags,
-    C *out
-    )
-{
-  INT k0, k1, k2, k=0;
-  const C *inv_phi_hat0 = pre_inv_phi_hat;
-  const C *inv_phi_hat1 = inv_phi_hat0 + local_N[0];
-  const C *inv_phi_hat2 = inv_phi_hat1 + local_N[1];
-
-  if(pnfft_flags & PNFFT_TRANSPOSED_F_HAT){
-    /* g_hat is transposed N1 x N2 x N0 */
-    for(k1=0; k1<local_N[1]; k1++)
-      for(k2=0; k2<local_N[2]; k2++)
-        for(k0=0; k0<local_N[0]; k0++, k++)
-          out[k] += in[k] * inv_phi_hat0[k0] * inv_phi_hat1[k1] * inv_phi_hat2[k2];
-  } else {
-    /* g_hat is non-transposed N0 x N1 x N2 */
-    for(k0=0; k0<local_N[0]; k0++)
-      for(k1=0; k1<local_N[1]; k1++)
-        for(k2=0; k2<local_N[2]; k2++, k++)
-          out[k] += in[k] * inv_phi_hat0[k0] * inv_phi_hat1[k1] * inv_phi_hat2[k2];
+  /* g_hat is transposed N1 x N2 x N0 or non-transposed N0 x N1 x N2 */
+  const int a0 = (pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? 1 : 0;
+  const int a1 = (pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? 2 : 1;
+  const int a2 = (pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? 0 : 2;
+
+#ifdef PNFFT_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for(INT i0=0; i0<local_N[a0]; i0++){
+    for(INT i1=0; i1<local_N[a1]; i1++){
+      const INT k = (i0*local_N[a1] + i1) * local_N[a2];
+      const C w = tab[a0][i0] * tab[a1][i1];
+      const C *tab2 = tab[a2];
+      for(INT i2=0; i2<local_N[a2]; i2++)
+        out[k+i2] += in[k+i2] * w * tab2[i2];
+    }
   }
 }
 
@@ -476,8 +444,15 @@ static void precompute_inv_phi_hat_general_window(
 {
   INT l=0;
 
-  for(INT t=0; t<3; t++)
-    for(INT k=local_N_start[t]; k<local_N_start[t] + local_N[t]; k++, l++)
-      pre_inv_phi_hat[l] = PNX(inv_phi_hat)(window_param, t, k);
+  /* Expensive special functions, e.g., the complex error function of the Gaussian_T window,
+   * are evaluated by all threads. The sinc power window uses the scratch array of the plan. */
+  for(INT t=0; t<3; t++){
+#ifdef PNFFT_OPENMP
+    #pragma omp parallel for schedule(static) if(!(window_param->pnfft_flags & PNFFT_WINDOW_SINC_POWER))
+#endif
+    for(INT k=0; k<local_N[t]; k++)
+      pre_inv_phi_hat[l+k] = PNX(inv_phi_hat)(window_param, t, local_N_start[t] + k);
+    l += local_N[t];
+  }
 }
 
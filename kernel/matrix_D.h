@@ -22,9 +22,12 @@
 #define __MATRIX_D_H__
 
 void PNX(trafo_D)(
-    PNX(plan) ths, int interlaced);
+    PNX(plan) ths, int interlaced, C *copy);
 void PNX(adjoint_D)(
-    PNX(plan) ths, int interlaced);
+    PNX(plan) ths, int interlaced, const C *in);
+
+void PNX(init_phi_hat_quad)(
+    PNX(plan) ths);
 
 void PNX(precompute_inv_phi_hat_trafo)(
     PNX(plan) ths,
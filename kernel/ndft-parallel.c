@@ -47,7 +47,7 @@ static void loop_over_particles_adj(
     INT *sorted_index);
 
 static int is_hermitian(
-  INT k0, INT k1, INT k2,
+  int d, INT k0, INT k1, INT k2,
   INT N0, INT N1, INT N2);
 
 static PNX(plan) mkplan(
@@ -57,10 +57,16 @@ static void local_size_B(
     const PNX(plan) ths,
     INT *local_no, INT *local_no_start);
 static void get_size_gcells(
-    int m, int cutoff, unsigned pnfft_flags,
+    int d, const int *m, const int *cutoff, unsigned pnfft_flags,
     INT *gcells_below, INT *gcells_above);
+static unsigned huge_flags_nodes(
+    unsigned malloc_flags);
+static int intpol_order(
+    unsigned pnfft_flags);
+static INT default_intpol_num_nodes(
+    int cutoff);
 static void lowest_summation_index(
-    const INT *n, int m, const R *x,
+    int d, const INT *n, const int *m, const R *x,
     const INT *local_no_start, const INT *gcells_below,
     R *floor_nx_j, INT *u_j);
 static void local_array_size(
@@ -68,109 +74,128 @@ static void local_array_size(
     INT *local_ngc);
 
 static void pre_psi_tensor(
-    const INT *n, const R *b, int m, int cutoff, const R *x, const R *floor_nx,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff, const R *x, const R *floor_nx,
     const R *exp_const, R *spline_coeffs, unsigned pnfft_flags,
     int intpol_order, INT intpol_num_nodes, R **intpol_tables_psi,
+    int poly_degree, R **poly_coeffs_psi,
     R *pre_psi);
 static void pre_psi_tensor_direct(
-    const INT *n, const R *b, int m, int cutoff, const R *x, const R *floor_nx,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff, const R *x, const R *floor_nx,
     const R *exp_const, R *spline_coeffs,
     unsigned pnfft_flags,
     R *pre_psi);
 static void pre_psi_tensor_gaussian(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx,
     R *pre_psi);
 static void pre_psi_tensor_fast_gaussian(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, const R *exp_const,
     R *fg_psi);
 static void pre_psi_tensor_bspline(
-    const INT *n, int m, int cutoff,
+    int d, const INT *n, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, R *spline_coeffs, 
     R *pre_psi);
 static void pre_psi_tensor_sinc_power(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, 
     R *pre_psi);
 static void pre_psi_tensor_bessel_i0(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, 
     R *pre_psi);
 static void pre_psi_tensor_kaiser_bessel(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, 
     R *pre_psi);
+static void pre_psi_tensor_es(
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
+    const R *x, const R *floor_nx,
+    R *pre_psi);
 
 static void pre_dpsi_tensor(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, R *spline_coeffs,
     int intpol_order, INT intpol_num_nodes, R **intpol_tables_dpsi,
+    int poly_degree, R **poly_coeffs_dpsi,
     const R *pre_psi, unsigned pnfft_flags,
     R *pre_dpsi);
 static void pre_dpsi_tensor_direct(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, R *spline_coeffs, const R *pre_psi,
     unsigned pnfft_flags,
     R *pre_dpsi);
 static void pre_dpsi_tensor_gaussian(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, const R *fg_psi,
     R *fg_dpsi);
 static void pre_dpsi_tensor_bspline(
-    const INT *n, int m, int cutoff,
+    int d, const INT *n, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, R *spline_coeffs,
     R *pre_dpsi);
 static void pre_dpsi_tensor_sinc_power(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, const R *pre_psi,
     R *pre_dpsi);
 static void pre_dpsi_tensor_bessel_i0(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, 
     R *pre_dpsi);
 static void pre_dpsi_tensor_kaiser_bessel(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
+    const R *x, const R *floor_nx, const R *pre_psi,
+    R *pre_dpsi);
+static void pre_dpsi_tensor_es(
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, const R *pre_psi,
     R *pre_dpsi);
 
 static void pre_ddpsi_tensor(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, R *spline_coeffs,
     int intpol_order, INT intpol_num_nodes, R **intpol_tables_ddpsi,
+    int poly_degree, R **poly_coeffs_ddpsi,
     const R *pre_psi, const R *pre_dpsi, unsigned pnfft_flags,
     R *pre_ddpsi);
 static void pre_ddpsi_tensor_direct(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, R *spline_coeffs, const R *pre_psi, const R *pre_dpsi,
     unsigned pnfft_flags,
     R *pre_ddpsi);
 static void pre_ddpsi_tensor_gaussian(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, const R *fg_psi,
     R *fg_ddpsi);
 static void pre_ddpsi_tensor_bspline(
-    const INT *n, int m, int cutoff,
+    int d, const INT *n, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, R *spline_coeffs,
     R *pre_ddpsi);
 static void pre_ddpsi_tensor_sinc_power(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, const R *pre_psi, const R *pre_dpsi,
     R *pre_ddpsi);
 static void pre_ddpsi_tensor_bessel_i0(
-    const INT *n, const R *b, int m, int cutoff,
-    const R *x, const R *floor_nx,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
+    const R *x, const R *floor_nx, const R *pre_psi, const R *pre_dpsi,
     R *pre_ddpsi);
 static void pre_ddpsi_tensor_kaiser_bessel(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, const R *pre_psi, const R *pre_dpsi,
     R *pre_ddpsi);
+static void pre_ddpsi_tensor_es(
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
+    const R *x, const R *floor_nx, const R *pre_psi,
+    R *pre_ddpsi);
+static void pre_derivative_tensor_closed_form(
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
+    const R *x, const R *floor_nx, int der, unsigned pnfft_flags,
+    R *pre_dpsi);
 
 static void sort_nodes_for_better_cache_handle(
-    int d, const INT *n, int m, INT local_x_num, const R *local_x,
-    INT *ar_x);
+    int d, const INT *n, const int *m, INT local_x_num, const R *local_x,
+    INT *ar_x_temp, INT *ar_x);
 static void project_node_to_grid(
-    const INT *n, int m, const R *x,
+    int d, const INT *n, const int *m, const R *x,
     R *floor_nx_j, INT *u_j);
 static void get_mpi_cart_dims_3d(
     MPI_Comm comm_cart,
@@ -192,12 +217,15 @@ static R kaiser_bessel_derivative_1d(
 static R kaiser_bessel_second_derivative_1d(
     R x, INT n, R b, int m, R psi, R dpsi);
 
+static R es_1d(
+    R x, INT n, R b, int m);
+static R es_derivative_1d(
+    R x, INT n, R b, int m, R psi);
+static R es_second_derivative_1d(
+    R x, INT n, R b, int m, R psi);
+
+
 
-static void init_intpol_table_psi(
-    INT num_nodes_per_interval, int intpol_order, int cutoff,
-    INT n, int m, int dim, int derivative,
-    const PNX(plan) wind_param,
-    R *table);
 static R psi_gaussian(
     R x, INT n, R b);
 static R dpsi_gaussian(
@@ -228,15 +256,18 @@ static R dpsi_kaiser(
     R x, INT n, R b, int m);
 static R ddpsi_kaiser(
     R x, INT n, R b, int m);
+static R psi_es(
+    R x, INT n, R b, int m);
+static R dpsi_es(
+    R x, INT n, R b, int m);
+static R ddpsi_es(
+    R x, INT n, R b, int m);
 
 static void precompute_psi(
     PNX(plan) ths, INT ind, R* x, R* buffer_psi, R* buffer_dpsi, R* buffer_ddpsi,
     unsigned precompute_flags,
     R* pre_psi, R* pre_dpsi, R* pre_ddpsi);
 
-static void free_intpol_tables(
-    R** intpol_tables, int num_tables);
-
 
 /* TODO: This function calculates the number of minimum samples of the 2-point-Taylor regularized
  * kernel function 1/x to reach a certain relative error 'eps'. Our windows are likely to be nicer,
@@ -318,46 +349,24 @@ static INT calc_intpol_num_nodes(
 }
 #endif
 
-static void init_intpol_table_psi(
-    INT num_nodes_per_interval, int intpol_order, int cutoff,
-    INT n, int m, int dim, int derivative,
-    const PNX(plan) wind_param,
-    R *table
-    )
-{
-  /* interpolation of "f" at grid point "r" of order
-   * 0: uses f[r]
-   * 1: uses f[r], f[r+1]
-   * 2: uses f[r-1], f[r], f[r+1]
-   * 3: uses f[r-1], f[r], f[r+1], f[r+2]
-   * This equivalent to f[-order/2], ... , f[(order+1)/2]
-   * with integer division. */
-  INT ind=0;
-  for(INT k=0; k<num_nodes_per_interval; k++){
-    for(INT c=0; c<cutoff; c++){
-      for(INT i=-intpol_order/2; i<=(intpol_order+1)/2; i++){
-        /* avoid multiple evaluations of psi(...) at the same points */
-        if( (k > 0) && (i < (intpol_order+1)/2) )
-          table[ind] = table[ind - cutoff*(intpol_order+1) + 1];
-        else {
-          switch(derivative){
-            case 0: table[ind] = PNX(psi)(wind_param, dim, (m + (R)(k+i)/num_nodes_per_interval - c)/n); break;
-            case 1: table[ind] = PNX(dpsi)(wind_param, dim, (m + (R)(k+i)/num_nodes_per_interval - c)/n); break;
-            case 2: table[ind] = PNX(ddpsi)(wind_param, dim, (m + (R)(k+i)/num_nodes_per_interval - c)/n); break;
-          }
-        }
-        ++ind;
-      }
-    }
-  }
-}
 
 
 static int is_hermitian(
-  INT k0, INT k1, INT k2,
+  int d, INT k0, INT k1, INT k2,
   INT N0, INT N1, INT N2
   )
 {
+  /* plans with d < 3 halve their last nontrivial axis, move the trivial axes to the front */
+  if(d < 3){
+    INT k[3] = {k0, k1, k2}, N[3] = {N0, N1, N2}, kk[3] = {0, 0, 0}, NN[3] = {1, 1, 1};
+    for(int t=2, s=2; t>=0; t--)
+      if(N[t] > 1){
+        kk[s] = k[t]; NN[s] = N[t]; s--;
+      }
+    k0 = kk[0]; k1 = kk[1]; k2 = kk[2];
+    N0 = NN[0]; N1 = NN[1]; N2 = NN[2];
+  }
+
   // these have to be zero
   if ( (k0 == 0 || k0 ==  -N0/2) && (k1 == 0 || k1 ==  -N1/2) && (k2 == 0 || k2 ==  -N2/2) )
     return 1;
@@ -381,6 +390,7 @@ void PNX(trafo_A)(
   int np_total, myrnk;
   INT local_Np[3], local_Np_start[3]; 
   C *buffer;
+  size_t mark;
 
   if(nodes == NULL) return;
 
@@ -415,7 +425,7 @@ void PNX(trafo_A)(
 
   for(int pid=0; pid<np_total; pid++){
     /* compute local_Np, local_Np_start of proc. with rank pid */
-    PNX(local_block_internal)(ths->N, ths->no, ths->comm_cart, pid, ths->pnfft_flags, ths->trafo_flag,
+    PNX(local_block_internal)(ths->d, ths->N, ths->no, ths->comm_cart, pid, ths->pnfft_flags, ths->trafo_flag,
         local_Np, local_Np_start);
 
     INT local_Np_total = PNX(prod_INT)(3, local_Np);
@@ -423,10 +433,13 @@ void PNX(trafo_A)(
     /* Avoid errors for empty blocks */
     if(local_Np_total == 0) continue;
 
-    buffer = (myrnk == pid) ? ths->f_hat : PNX(malloc_C)(local_Np_total);
+    mark = PNX(workspace_mark)(ths);
+    buffer = (myrnk == pid) ? ths->f_hat : (C*) PNX(workspace_get)(ths, sizeof(C) * (size_t) local_Np_total);
 
     /* broadcast block of Fourier coefficients from p to all procs */
     MPI_Bcast(buffer, 2*local_Np_total, PNFFT_MPI_REAL_TYPE, pid, ths->comm_cart);
+    PNX(counter_add)(ths->counter_trafo, PNFFT_TIMER_MATRIX_A, PNFFT_COUNTER_MPI_BYTES, (double) local_Np_total * sizeof(C));
+    PNX(counter_add)(ths->counter_trafo, PNFFT_TIMER_MATRIX_A, PNFFT_COUNTER_MPI_MSGS, 1);
 
     INT t0 = (ths->pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? 1 : 0;
     INT t1 = (ths->pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? 2 : 1;
@@ -440,13 +453,18 @@ void PNX(trafo_A)(
     INT s5 = (ths->pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? 0 : 5;
 
     for(INT j=0; j<nodes->local_M; j++){
-      C exp_x0 = pnfft_cexp(-2.0 * PNFFT_PI * nodes->x[3*j+t0] * I);
-      C exp_x1 = pnfft_cexp(-2.0 * PNFFT_PI * nodes->x[3*j+t1] * I);
-      C exp_x2 = pnfft_cexp(-2.0 * PNFFT_PI * nodes->x[3*j+t2] * I);
+      /* components d <= t < 3 of the nodes are ignored */
+      R x_j[3];
+      for(int t=0; t<3; t++)
+        x_j[t] = (t < ths->d) ? nodes->x[3*j+t] : 0;
 
-      C exp_kx0_start = pnfft_cexp(-2.0 * PNFFT_PI * local_Np_start[t0] * nodes->x[3*j+t0] * I);
-      C exp_kx1_start = pnfft_cexp(-2.0 * PNFFT_PI * local_Np_start[t1] * nodes->x[3*j+t1] * I);
-      C exp_kx2_start = pnfft_cexp(-2.0 * PNFFT_PI * local_Np_start[t2] * nodes->x[3*j+t2] * I);
+      C exp_x0 = pnfft_cexp(-2.0 * PNFFT_PI * x_j[t0] * I);
+      C exp_x1 = pnfft_cexp(-2.0 * PNFFT_PI * x_j[t1] * I);
+      C exp_x2 = pnfft_cexp(-2.0 * PNFFT_PI * x_j[t2] * I);
+
+      C exp_kx0_start = pnfft_cexp(-2.0 * PNFFT_PI * local_Np_start[t0] * x_j[t0] * I);
+      C exp_kx1_start = pnfft_cexp(-2.0 * PNFFT_PI * local_Np_start[t1] * x_j[t1] * I);
+      C exp_kx2_start = pnfft_cexp(-2.0 * PNFFT_PI * local_Np_start[t2] * x_j[t2] * I);
 
       if(compute_flags & PNFFT_COMPUTE_HESSIAN_F){
         R hessian_f_r[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
@@ -464,7 +482,7 @@ void PNX(trafo_A)(
               if (ths->trafo_flag & PNFFTI_TRAFO_C2R) {
                 if ( ! (k0 == 0 && k1 == 0 && k2 == 0)
                      &&
-                     ! is_hermitian(k0, k1, k2, ths->N[t0], ths->N[t1], ths->N[t2])
+                     ! is_hermitian(ths->d, k0, k1, k2, ths->N[t0], ths->N[t1], ths->N[t2])
                    )
                 {
                   hessian_f_r[0] += 2 * k0 * k0 * pnfft_creal(bufferTimesExp);
@@ -524,7 +542,7 @@ void PNX(trafo_A)(
               if (ths->trafo_flag & PNFFTI_TRAFO_C2R) {
                 if ( ! (k0 == 0 && k1 == 0 && k2 == 0)
                       &&
-                     ! is_hermitian(k0, k1, k2, ths->N[t0], ths->N[t1], ths->N[t2])
+                     ! is_hermitian(ths->d, k0, k1, k2, ths->N[t0], ths->N[t1], ths->N[t2])
                     )
                 {
                   grad_f_r[0] += 2 * k0 * pnfft_cimag(bufferTimesExp);
@@ -569,7 +587,7 @@ void PNX(trafo_A)(
               if (ths->trafo_flag & PNFFTI_TRAFO_C2R) {
                 if (k0 == 0 && k1 == 0 && k2 == 0)
                   f_r += pnfft_creal(buffer[m]);
-                else if ( ! is_hermitian(k0, k1, k2, ths->N[t0], ths->N[t1], ths->N[t2]) )
+                else if ( ! is_hermitian(ths->d, k0, k1, k2, ths->N[t0], ths->N[t1], ths->N[t2]) )
                   f_r += 2 * pnfft_creal(buffer[m] * exp_kx2);
               } else if (ths->trafo_flag & PNFFTI_TRAFO_C2C)
                 f_c += buffer[m] * exp_kx2;
@@ -588,7 +606,7 @@ void PNX(trafo_A)(
       }
     }
 
-    if(myrnk != pid) PNX(free)(buffer);
+    PNX(workspace_release)(ths, mark);
   }
 
   R minusTwoPi  = -2.0 * PNFFT_PI;
@@ -621,6 +639,7 @@ void PNX(adj_A)(
   int np_total, myrnk;
   INT local_Np[3], local_Np_start[3]; 
   C *buffer;
+  size_t mark;
 
   if(nodes == NULL) return;
 
@@ -637,7 +656,7 @@ void PNX(adj_A)(
 
   for(int pid=0; pid<np_total; pid++){
     /* compute local_Np, local_Np_start of proc. with rank pid */
-    PNX(local_block_internal)(ths->N, ths->no, ths->comm_cart, pid, ths->pnfft_flags, ths->trafo_flag,
+    PNX(local_block_internal)(ths->d, ths->N, ths->no, ths->comm_cart, pid, ths->pnfft_flags, ths->trafo_flag,
         local_Np, local_Np_start);
 
     INT local_Np_total = PNX(prod_INT)(3, local_Np);
@@ -645,7 +664,8 @@ void PNX(adj_A)(
     /* Avoid errors for empty blocks */
     if(local_Np_total == 0) continue;
 
-    buffer = malloc(sizeof(C) * local_Np_total);
+    mark = PNX(workspace_mark)(ths);
+    buffer = (C*) PNX(workspace_get)(ths, sizeof(C) * (size_t) local_Np_total);
     if(pid==myrnk) /* accumulate results with existing values */
       for(INT k=0; k<local_Np_total; k++) buffer[k] = ths->f_hat[k];
     else
@@ -656,13 +676,18 @@ void PNX(adj_A)(
     INT t2 = (ths->pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? 0 : 2;
 
     for(INT j=0; j<nodes->local_M; j++){
-      C exp_x0 = pnfft_cexp(+2.0 * PNFFT_PI * nodes->x[3*j+t0] * I);
-      C exp_x1 = pnfft_cexp(+2.0 * PNFFT_PI * nodes->x[3*j+t1] * I);
-      C exp_x2 = pnfft_cexp(+2.0 * PNFFT_PI * nodes->x[3*j+t2] * I);
+      /* components d <= t < 3 of the nodes are ignored */
+      R x_j[3];
+      for(int t=0; t<3; t++)
+        x_j[t] = (t < ths->d) ? nodes->x[3*j+t] : 0;
+
+      C exp_x0 = pnfft_cexp(+2.0 * PNFFT_PI * x_j[t0] * I);
+      C exp_x1 = pnfft_cexp(+2.0 * PNFFT_PI * x_j[t1] * I);
+      C exp_x2 = pnfft_cexp(+2.0 * PNFFT_PI * x_j[t2] * I);
 
-      C exp_kx0_start = pnfft_cexp(+2.0 * PNFFT_PI * local_Np_start[t0] * nodes->x[3*j+t0] * I);
-      C exp_kx1_start = pnfft_cexp(+2.0 * PNFFT_PI * local_Np_start[t1] * nodes->x[3*j+t1] * I);
-      C exp_kx2_start = pnfft_cexp(+2.0 * PNFFT_PI * local_Np_start[t2] * nodes->x[3*j+t2] * I);
+      C exp_kx0_start = pnfft_cexp(+2.0 * PNFFT_PI * local_Np_start[t0] * x_j[t0] * I);
+      C exp_kx1_start = pnfft_cexp(+2.0 * PNFFT_PI * local_Np_start[t1] * x_j[t1] * I);
+      C exp_kx2_start = pnfft_cexp(+2.0 * PNFFT_PI * local_Np_start[t2] * x_j[t2] * I);
 
       if(compute_flags & PNFFT_COMPUTE_F){
         C f;
@@ -717,7 +742,9 @@ void PNX(adj_A)(
 
     /* reduce block of Fourier coefficients from all procs to p */
     MPI_Reduce(buffer, ths->f_hat, 2*local_Np_total, PNFFT_MPI_REAL_TYPE, MPI_SUM, pid, ths->comm_cart);
-    PNX(free)(buffer);
+    PNX(counter_add)(ths->counter_adj, PNFFT_TIMER_MATRIX_A, PNFFT_COUNTER_MPI_BYTES, (double) local_Np_total * sizeof(C));
+    PNX(counter_add)(ths->counter_adj, PNFFT_TIMER_MATRIX_A, PNFFT_COUNTER_MPI_MSGS, 1);
+    PNX(workspace_release)(ths, mark);
   }
 }
 
@@ -779,50 +806,68 @@ static void local_size_B(
     INT *local_no, INT *local_no_start
     )
 {
-  for(int t=0; t<ths->d; t++){
+  for(int t=0; t<3; t++){
     local_no[t] = ths->local_no[t];
     local_no_start[t] = ths->local_no_start[t];
   }
 }
 
+/* N, n, no have 3 entries, where the trivial axes d <= t < 3 are of size 1.
+ * PFFT only sees the first d axes, the local sizes of the trivial axes are padded. */
 INT PNX(local_size_internal)(
-    const INT *N, const INT *n, const INT *no,
+    int d, const INT *N, const INT *n, const INT *no,
     MPI_Comm comm_cart,
     unsigned trafo_flag, unsigned pnfft_flags,
     INT *local_N, INT *local_N_start,
     INT *local_no, INT *local_no_start
     )
 {
-  INT howmany = 1;
+  INT howmany = 1, alloc_local;
   unsigned pfft_flags;
 
   if (trafo_flag & PNFFTI_TRAFO_C2R) {
     INT alloc_local_data_forw, alloc_local_data_back;
     pfft_flags = (pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? PFFT_TRANSPOSED_IN : 0;
 
-    alloc_local_data_forw = PX(local_size_many_dft_c2r)(3, n, N, no, howmany,
+    alloc_local_data_forw = PX(local_size_many_dft_c2r)(d, n, N, no, howmany,
         PFFT_DEFAULT_BLOCKS, PFFT_DEFAULT_BLOCKS, comm_cart, pfft_flags | PFFT_SHIFTED_IN | PFFT_SHIFTED_OUT,
         local_N, local_N_start, local_no, local_no_start);
 
     pfft_flags = (pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? PFFT_TRANSPOSED_OUT : 0;
 
-    alloc_local_data_back = PX(local_size_many_dft_r2c)(3, n, no, N, howmany,
+    alloc_local_data_back = PX(local_size_many_dft_r2c)(d, n, no, N, howmany,
         PFFT_DEFAULT_BLOCKS, PFFT_DEFAULT_BLOCKS, comm_cart, pfft_flags | PFFT_SHIFTED_IN | PFFT_SHIFTED_OUT,
         local_no, local_no_start, local_N, local_N_start);
 
-    return (alloc_local_data_forw > alloc_local_data_back) ?
+    alloc_local = (alloc_local_data_forw > alloc_local_data_back) ?
         alloc_local_data_forw : alloc_local_data_back;
   } else { /* trafo_flag & PNFFTI_TRAFO_C2C */
     pfft_flags = (pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? PFFT_TRANSPOSED_IN : 0;
 
-    return PX(local_size_many_dft)(3, n, N, no, howmany,
+    alloc_local = PX(local_size_many_dft)(d, n, N, no, howmany,
         PFFT_DEFAULT_BLOCKS, PFFT_DEFAULT_BLOCKS, comm_cart, pfft_flags | PFFT_SHIFTED_IN | PFFT_SHIFTED_OUT,
         local_N, local_N_start, local_no, local_no_start);
   }
+
+  PNX(pad_trivial_axes)(d, local_N, local_N_start);
+  PNX(pad_trivial_axes)(d, local_no, local_no_start);
+
+  return alloc_local;
+}
+
+/* set size 1 and offset 0 on the trivial axes d <= t < 3 */
+void PNX(pad_trivial_axes)(
+    int d, INT *local_n, INT *local_n_start
+    )
+{
+  for(int t=d; t<3; t++){
+    local_n[t] = 1;
+    local_n_start[t] = 0;
+  }
 }
 
 void PNX(local_block_internal)(
-    const INT *N, const INT *no,
+    int d, const INT *N, const INT *no,
     MPI_Comm comm_cart, int pid,
     unsigned pnfft_flags, unsigned trafo_flag,
     INT *local_N, INT *local_N_start
@@ -852,27 +897,32 @@ void PNX(local_block_internal)(
 //           local_size[0], local_size[1], local_size[2], local_size_start[0], local_size_start[1], local_size_start[2]);
 
   if (trafo_flag & PNFFTI_TRAFO_C2R) {
-    PX(local_block_many_dft_c2r)(3, N, no,
+    PX(local_block_many_dft_c2r)(d, N, no,
         PFFT_DEFAULT_BLOCKS, PFFT_DEFAULT_BLOCKS, comm_cart, pid, pfft_flags | PFFT_SHIFTED_IN | PFFT_SHIFTED_OUT,
         local_N, local_N_start, dummy_lno, dummy_los);
   } else if (trafo_flag & PNFFTI_TRAFO_C2C) {
-    PX(local_block_many_dft)(3, N, no,
+    PX(local_block_many_dft)(d, N, no,
         PFFT_DEFAULT_BLOCKS, PFFT_DEFAULT_BLOCKS, comm_cart, pid, pfft_flags | PFFT_SHIFTED_IN | PFFT_SHIFTED_OUT,
         local_N, local_N_start, dummy_lno, dummy_los);
   }
+
+  PNX(pad_trivial_axes)(d, local_N, local_N_start);
 }
 
 
 /* N - size of NFFT
  * n - oversampled FFT size
- * no - FFT output size (if nodes are only in a subset the array) */
+ * no - FFT output size (if nodes are only in a subset the array)
+ * m - real space cutoff per dimension, ths->m and ths->cutoff hold the maximum over all dimensions
+ * All arrays of the plan hold 3 entries. For d < 3 the trailing axes d <= t < 3 are trivial,
+ * i.e., they are of size 1 and have a window with a single stencil point (m_dim=0, cutoff_dim=1). */
 PNX(plan) PNX(init_internal)(
-    int d, const INT *N, const INT *n, const INT *no, int m,
+    int d, const INT *N, const INT *n, const INT *no, const int *m,
     unsigned trafo_flag, unsigned pnfft_flags, unsigned pfft_opt_flags,
     MPI_Comm comm_cart
     )
 {
-  unsigned pfft_flags=0;
+  unsigned forw_flags, back_flags;
   INT howmany = 1;
   INT alloc_local_in, alloc_local_out, alloc_local_gc;
   INT gcells_below[3], gcells_above[3];
@@ -884,21 +934,28 @@ PNX(plan) PNX(init_internal)(
   ths = mkplan();
 
   ths->d = d;
-  ths->m= m;
 
-  ths->N = (INT*) PNX(malloc)(sizeof(INT) * (size_t) d);
-  ths->n = (INT*) PNX(malloc)(sizeof(INT) * (size_t) d);
-  ths->no= (INT*) PNX(malloc)(sizeof(INT) * (size_t) d);
-  for(int t=0; t<d; t++){
-    ths->N[t]= N[t];
-    ths->n[t]= n[t];
-    ths->no[t]= no[t];
+  ths->N = (INT*) PNX(malloc_tagged)(sizeof(INT) * 3, PNFFT_MEM_OTHER, &ths->mem);
+  ths->n = (INT*) PNX(malloc_tagged)(sizeof(INT) * 3, PNFFT_MEM_OTHER, &ths->mem);
+  ths->no= (INT*) PNX(malloc_tagged)(sizeof(INT) * 3, PNFFT_MEM_OTHER, &ths->mem);
+  for(int t=0; t<3; t++){
+    ths->N[t]= (t < d) ? N[t] : 1;
+    ths->n[t]= (t < d) ? n[t] : 1;
+    ths->no[t]= (t < d) ? no[t] : 1;
   }
 
-  ths->local_N        = (INT*) PNX(malloc)(sizeof(INT) * (size_t) d);
-  ths->local_N_start  = (INT*) PNX(malloc)(sizeof(INT) * (size_t) d);
-  ths->local_no       = (INT*) PNX(malloc)(sizeof(INT) * (size_t) d);
-  ths->local_no_start = (INT*) PNX(malloc)(sizeof(INT) * (size_t) d);
+  ths->m = 0;
+  for(int t=0; t<3; t++){
+    ths->m_dim[t] = (t < d) ? m[t] : 0;
+    ths->cutoff_dim[t] = 2*ths->m_dim[t]+1;
+    if(ths->m_dim[t] > ths->m)
+      ths->m = ths->m_dim[t];
+  }
+
+  ths->local_N        = (INT*) PNX(malloc_tagged)(sizeof(INT) * 3, PNFFT_MEM_OTHER, &ths->mem);
+  ths->local_N_start  = (INT*) PNX(malloc_tagged)(sizeof(INT) * 3, PNFFT_MEM_OTHER, &ths->mem);
+  ths->local_no       = (INT*) PNX(malloc_tagged)(sizeof(INT) * 3, PNFFT_MEM_OTHER, &ths->mem);
+  ths->local_no_start = (INT*) PNX(malloc_tagged)(sizeof(INT) * 3, PNFFT_MEM_OTHER, &ths->mem);
 
   ths->pnfft_flags = pnfft_flags;
   ths->pfft_opt_flags = pfft_opt_flags;
@@ -907,27 +964,29 @@ PNX(plan) PNX(init_internal)(
   MPI_Comm_dup(comm_cart, &(ths->comm_cart));
   get_mpi_cart_dims_3d(comm_cart, &ths->rnk_pm, ths->np, ths->coords);
   
-  ths->cutoff = 2*m+1;
+  ths->cutoff = 2*ths->m+1;
   ths->N_total = ths->n_total = 1;
   for(int t=0; t<d; t++){
     ths->N_total *= N[t];
     ths->n_total *= n[t];
   }
   /* x_max is filled in init_guru */
-  ths->x_max = (R*) PNX(malloc)(sizeof(R) * (size_t) d);
-  ths->sigma = (R*) PNX(malloc)(sizeof(R) * (size_t) d);
-  for(int t = 0;t < d; t++)
-    ths->sigma[t] = ((R)n[t])/N[t];
+  ths->x_max = (R*) PNX(malloc_tagged)(sizeof(R) * 3, PNFFT_MEM_OTHER, &ths->mem);
+  ths->sigma = (R*) PNX(malloc_tagged)(sizeof(R) * 3, PNFFT_MEM_OTHER, &ths->mem);
+  for(int t = 0;t < 3; t++){
+    ths->x_max[t] = 0.5;
+    ths->sigma[t] = ((R)ths->n[t])/ths->N[t];
+  }
 
-  get_size_gcells(m, ths->cutoff, pnfft_flags,
+  get_size_gcells(d, ths->m_dim, ths->cutoff_dim, pnfft_flags,
       gcells_below, gcells_above);
 
   /* alloc_local_data_in is given in units of complex for both c2r and c2c */
-  alloc_local_in = PNX(local_size_internal)(N, n, no, comm_cart, ths->trafo_flag, ths->pnfft_flags,
+  alloc_local_in = PNX(local_size_internal)(d, ths->N, ths->n, ths->no, comm_cart, ths->trafo_flag, ths->pnfft_flags,
       ths->local_N, ths->local_N_start, ths->local_no, ths->local_no_start);
 
   /* alloc_local is given in units of complex for c2c and in units of real for c2r */
-  alloc_local_gc = PX(local_size_many_gc)(3, ths->local_no, ths->local_no_start,
+  alloc_local_gc = PX(local_size_many_gc)(d, ths->local_no, ths->local_no_start,
       howmany, gcells_below, gcells_above,
       local_ngc, local_gc_start);
 
@@ -943,76 +1002,88 @@ PNX(plan) PNX(init_internal)(
   ths->local_no_total = PNX(prod_INT)(d, ths->local_no);
 
   if(pnfft_flags & PNFFT_MALLOC_F_HAT)
-    ths->f_hat = (ths->local_N_total) ? (C*) PNX(malloc)(sizeof(C) * (size_t) ths->local_N_total) : NULL;
+    ths->f_hat = (ths->local_N_total) ? (C*) PNX(malloc_placed)(sizeof(C) * (size_t) ths->local_N_total, PNFFT_MEM_F_HAT, &ths->mem, pnfft_flags) : NULL;
 
-  /* init PFFT all the time (do not use the PNFFT_INIT_FFT flag anymore since
-   * the init of parallel FFT is far too complicated for any user) */
-  ths->g2 = (alloc_local_out) ? PNX(alloc_real)(alloc_local_out) : NULL;
-  if(pnfft_flags & PNFFT_FFT_IN_PLACE)
-    ths->g1 = ths->g2;
-  else
-    ths->g1 = (alloc_local_in) ? PNX(alloc_real)(alloc_local_in) : NULL;
+  ths->alloc_local_in  = alloc_local_in;
+  ths->alloc_local_out = alloc_local_out;
 
-  /* For derivative in Fourier space we need an extra buffer
-   * (since we need to scale the output of the forward FFT with three different factors) */
-  if(ths->pnfft_flags & PNFFT_DIFF_IK)
-    ths->g1_buffer = (ths->local_N_total) ? PNX(alloc_real)(2 * ths->local_N_total) : NULL;
-  else
-    ths->g1_buffer = NULL;
-
-  /* plan PFFT */
-  pfft_flags = pfft_opt_flags | PFFT_SHIFTED_IN | PFFT_SHIFTED_OUT;
-  if(ths->pnfft_flags & PNFFT_TRANSPOSED_F_HAT)
-    pfft_flags |= PFFT_TRANSPOSED_IN;
-  if(ths->trafo_flag & PNFFTI_TRAFO_C2R)
-    ths->pfft_forw = PX(plan_many_dft_c2r)(3, n, N, no, howmany,
-        PFFT_DEFAULT_BLOCKS, PFFT_DEFAULT_BLOCKS, (C*) ths->g1, ths->g2, comm_cart,
-        PFFT_FORWARD, pfft_flags);
-  else
-    ths->pfft_forw = PX(plan_many_dft)(3, n, N, no, howmany,
-        PFFT_DEFAULT_BLOCKS, PFFT_DEFAULT_BLOCKS, (C*) ths->g1, (C*) ths->g2, comm_cart,
-        PFFT_FORWARD, pfft_flags);
-  
-  pfft_flags = pfft_opt_flags | PFFT_SHIFTED_IN | PFFT_SHIFTED_OUT;
-  if(ths->pnfft_flags & PNFFT_TRANSPOSED_F_HAT) 
-    pfft_flags |= PFFT_TRANSPOSED_OUT;
-  if(ths->trafo_flag & PNFFTI_TRAFO_C2R)
-    ths->pfft_back = PX(plan_many_dft_r2c)(3, n, no, N, howmany,
-        PFFT_DEFAULT_BLOCKS, PFFT_DEFAULT_BLOCKS, ths->g2, (C*) ths->g1, comm_cart,
-        PFFT_BACKWARD, pfft_flags);
-  else
-    ths->pfft_back = PX(plan_many_dft)(3, n, no, N, howmany,
-        PFFT_DEFAULT_BLOCKS, PFFT_DEFAULT_BLOCKS, (C*) ths->g2, (C*) ths->g1, comm_cart,
-        PFFT_BACKWARD, pfft_flags);
-
-  /* plan ghost cell send and receive */
-  if(ths->trafo_flag & PNFFTI_TRAFO_C2R)
-    ths->gcplan = PX(plan_many_rgc)(3, no, howmany, PFFT_DEFAULT_BLOCKS,
-        gcells_below, gcells_above, ths->g2, comm_cart, 0);
-  else
-    ths->gcplan = PX(plan_many_cgc)(3, no, howmany, PFFT_DEFAULT_BLOCKS,
-        gcells_below, gcells_above, (C*) ths->g2, comm_cart, 0);
+  /* first touch with the static schedule of the Fourier space loops */
+  PNX(first_touch)((R*) ths->f_hat, (ths->f_hat) ? 2*ths->local_N_total : 0);
+
+  /* PFFT flags */
+  forw_flags = back_flags = pfft_opt_flags | PFFT_SHIFTED_IN | PFFT_SHIFTED_OUT;
+  if(ths->pnfft_flags & PNFFT_TRANSPOSED_F_HAT){
+    forw_flags |= PFFT_TRANSPOSED_IN;
+    back_flags |= PFFT_TRANSPOSED_OUT;
+  }
+
+  /* share grids and PFFT plans with compatible plans */
+  if(pnfft_flags & PNFFT_PLAN_POOL){
+    PNX(acquire_pooled_grids)(ths, alloc_local_in, alloc_local_out, forw_flags, back_flags,
+        gcells_below, gcells_above);
+  } else {
+    /* init PFFT all the time (do not use the PNFFT_INIT_FFT flag anymore since
+     * the init of parallel FFT is far too complicated for any user) */
+    ths->g2 = (alloc_local_out) ? (R*) PNX(malloc_placed)(sizeof(R) * (size_t) alloc_local_out, PNFFT_MEM_FFT_GRIDS, &ths->mem, pnfft_flags) : NULL;
+    if(alloc_local_out > alloc_local_in)
+      PNX(split_tagged)(ths->g2, sizeof(R) * (size_t) (alloc_local_out - alloc_local_in), PNFFT_MEM_GHOST_CELLS);
+    if(pnfft_flags & PNFFT_FFT_IN_PLACE)
+      ths->g1 = ths->g2;
+    else
+      ths->g1 = (alloc_local_in) ? (R*) PNX(malloc_placed)(sizeof(R) * (size_t) alloc_local_in, PNFFT_MEM_FFT_GRIDS, &ths->mem, pnfft_flags) : NULL;
+
+    /* For derivative in Fourier space we need an extra buffer
+     * (since we need to scale the output of the forward FFT with three different factors) */
+    if(ths->pnfft_flags & PNFFT_DIFF_IK)
+      ths->g1_buffer = (ths->local_N_total) ? (R*) PNX(malloc_placed)(sizeof(R) * (size_t) (2 * ths->local_N_total), PNFFT_MEM_FFT_GRIDS, &ths->mem, pnfft_flags) : NULL;
+    else
+      ths->g1_buffer = NULL;
+
+    /* first touch with the static schedule of the grid loops */
+    PNX(first_touch)(ths->g2, alloc_local_out);
+    if(ths->g1 != ths->g2)
+      PNX(first_touch)(ths->g1, alloc_local_in);
+    PNX(first_touch)(ths->g1_buffer, 2*ths->local_N_total);
+
+    /* plan PFFT */
+    if(ths->trafo_flag & PNFFTI_TRAFO_C2R)
+      ths->pfft_forw = PX(plan_many_dft_c2r)(d, n, N, no, howmany,
+          PFFT_DEFAULT_BLOCKS, PFFT_DEFAULT_BLOCKS, (C*) ths->g1, ths->g2, comm_cart,
+          PFFT_FORWARD, forw_flags);
+    else
+      ths->pfft_forw = PX(plan_many_dft)(d, n, N, no, howmany,
+          PFFT_DEFAULT_BLOCKS, PFFT_DEFAULT_BLOCKS, (C*) ths->g1, (C*) ths->g2, comm_cart,
+          PFFT_FORWARD, forw_flags);
+
+    if(ths->trafo_flag & PNFFTI_TRAFO_C2R)
+      ths->pfft_back = PX(plan_many_dft_r2c)(d, n, no, N, howmany,
+          PFFT_DEFAULT_BLOCKS, PFFT_DEFAULT_BLOCKS, ths->g2, (C*) ths->g1, comm_cart,
+          PFFT_BACKWARD, back_flags);
+    else
+      ths->pfft_back = PX(plan_many_dft)(d, n, no, N, howmany,
+          PFFT_DEFAULT_BLOCKS, PFFT_DEFAULT_BLOCKS, (C*) ths->g2, (C*) ths->g1, comm_cart,
+          PFFT_BACKWARD, back_flags);
+
+    /* plan ghost cell send and receive */
+    if(ths->trafo_flag & PNFFTI_TRAFO_C2R)
+      ths->gcplan = PX(plan_many_rgc)(d, no, howmany, PFFT_DEFAULT_BLOCKS,
+          gcells_below, gcells_above, ths->g2, comm_cart, 0);
+    else
+      ths->gcplan = PX(plan_many_cgc)(d, no, howmany, PFFT_DEFAULT_BLOCKS,
+          gcells_below, gcells_above, (C*) ths->g2, comm_cart, 0);
+  }
 
   /* init interpolation of window function */
-  if(pnfft_flags & PNFFT_PRE_CONST_PSI)
-    ths->intpol_order = 0;
-  else if(pnfft_flags & PNFFT_PRE_LIN_PSI)
-    ths->intpol_order = 1;
-  else if(pnfft_flags & PNFFT_PRE_QUAD_PSI)
-    ths->intpol_order = 2;
-  else if(pnfft_flags & PNFFT_PRE_CUB_PSI)
-    ths->intpol_order = 3;
-  else
-    ths->intpol_order = -1;
+  ths->intpol_order = intpol_order(pnfft_flags);
 
   /* init window specific parameters */
-  ths->b = (R*) PNX(malloc)(sizeof(R) * (size_t) d);
-  for(int t=0; t<ths->d; t++)
+  ths->b = (R*) PNX(malloc_tagged)(sizeof(R) * 3, PNFFT_MEM_WINDOW_TABLES, &ths->mem);
+  for(int t=0; t<3; t++)
     ths->b[t]= 0.0;
 
   if(ths->pnfft_flags & PNFFT_WINDOW_GAUSSIAN){
     for(int t=0; t<ths->d; t++)
-      ths->b[t]= ((R)ths->m / PNFFT_PI) * K(2.0)*ths->sigma[t] / (K(2.0)*ths->sigma[t]-K(1.0));
+      ths->b[t]= ((R)ths->m_dim[t] / PNFFT_PI) * K(2.0)*ths->sigma[t] / (K(2.0)*ths->sigma[t]-K(1.0));
 #if TUNE_B_FOR_EWALD_SPLITTING
     for(int t=0; t<ths->d; t++)
       ths->b[t]= 0.715303;
@@ -1025,7 +1096,7 @@ PNX(plan) PNX(init_internal)(
 //       R tmp = (R) ths->n[t] / alpha / B;
 //       ths->b[t] -= tmp*tmp;
 //       R tmp = (R) ths->n[t];
-      ths->b[t] = 2.0 * (R)ths->m / (PNFFT_PI * C*C);
+      ths->b[t] = 2.0 * (R)ths->m_dim[t] / (PNFFT_PI * C*C);
     }
 //     for(int t=0; t<d; t++){
 //       ths->b[t] = 1.2732;
@@ -1034,13 +1105,13 @@ PNX(plan) PNX(init_internal)(
   } else if(pnfft_flags & PNFFT_WINDOW_BSPLINE){
     /* malloc array for scratch values of de Boor algorithm, no need to initialize */
     if(ths->spline_coeffs == NULL)
-      ths->spline_coeffs= (R*) PNX(malloc)(sizeof(R)*2*ths->m);
+      ths->spline_coeffs= (R*) PNX(malloc_tagged)(sizeof(R)*2*ths->m, PNFFT_MEM_WINDOW_TABLES, &ths->mem);
   } else if(pnfft_flags & PNFFT_WINDOW_SINC_POWER){
     /* malloc array for scratch values of de Boor algorithm, no need to initialize */
     if(ths->spline_coeffs == NULL)
-      ths->spline_coeffs= (R*) PNX(malloc)(sizeof(R)*2*ths->m);
+      ths->spline_coeffs= (R*) PNX(malloc_tagged)(sizeof(R)*2*ths->m, PNFFT_MEM_WINDOW_TABLES, &ths->mem);
     for(int t=0; t<ths->d; t++)
-      ths->b[t]= (R)ths->m * (K(2.0)*ths->sigma[t]) / (K(2.0)*ths->sigma[t]-K(1.0));
+      ths->b[t]= (R)ths->m_dim[t] * (K(2.0)*ths->sigma[t]) / (K(2.0)*ths->sigma[t]-K(1.0));
 #if TUNE_B_FOR_EWALD_SPLITTING
 //     fprintf(stderr, "Sinc-Power: old b = %.4e\n", ths->b[0]);
     for(int t=0; t<ths->d; t++)
@@ -1054,6 +1125,10 @@ PNX(plan) PNX(init_internal)(
     for(int t=0; t<ths->d; t++)
       ths->b[t]= 5.45066;
 #endif
+  } else if(pnfft_flags & PNFFT_WINDOW_ES){
+    /* b = gamma*pi*(1-1/(2*sigma)) times the window width 2*m with safety factor gamma=0.97 */
+    for(int t=0; t<ths->d; t++)
+      ths->b[t] = K(0.97) * (R) PNFFT_PI * (K(1.0) - K(1.0)/(K(2.0)*ths->sigma[t])) * K(2.0) * ths->m_dim[t];
   } else { /* default window function is Kaiser-Bessel */
     for(int t=0; t<ths->d; t++)
       ths->b[t] = (R) PNFFT_PI * (K(2.0) - K(1.0)/ths->sigma[t]);
@@ -1069,16 +1144,126 @@ PNX(plan) PNX(init_internal)(
 }
 
 
+/* Dry run of init_internal, init_nodes and precompute_psi. Returns the bytes per memory category that
+ * the arrays of one plan and one set of nodes need on the calling process at most. PFFT plans,
+ * imported wisdom and small parameter arrays are not included. No memory is allocated. */
+void PNX(estimate_memory_internal)(
+    int d, const INT *N, const INT *n, const INT *no, const int *m, INT local_M,
+    MPI_Comm comm_cart, unsigned trafo_flag, unsigned pnfft_flags,
+    unsigned malloc_flags, unsigned precompute_flags,
+    size_t *bytes
+    )
+{
+  INT howmany = 1;
+  INT alloc_local_in, alloc_local_gc, local_N_total;
+  INT local_N[3], local_N_start[3], local_no[3], local_no_start[3];
+  INT gcells_below[3], gcells_above[3], local_ngc[3], local_gc_start[3];
+  int m_dim[3], cutoff_dim[3], cutoff = 1;
+  const int order = intpol_order(pnfft_flags);
+
+  for(int k=0; k<PNFFT_MEM_CATEGORIES; k++)
+    bytes[k] = 0;
+
+  for(int t=0; t<3; t++){
+    m_dim[t] = (t < d) ? m[t] : 0;
+    cutoff_dim[t] = 2*m_dim[t]+1;
+    if(cutoff_dim[t] > cutoff)
+      cutoff = cutoff_dim[t];
+  }
+
+  /* same sizes as in init_internal */
+  get_size_gcells(d, m_dim, cutoff_dim, pnfft_flags,
+      gcells_below, gcells_above);
+  alloc_local_in = 2 * PNX(local_size_internal)(d, N, n, no, comm_cart, trafo_flag, pnfft_flags,
+      local_N, local_N_start, local_no, local_no_start);
+  alloc_local_gc = PX(local_size_many_gc)(d, local_no, local_no_start,
+      howmany, gcells_below, gcells_above,
+      local_ngc, local_gc_start);
+  if(trafo_flag & PNFFTI_TRAFO_C2C)
+    alloc_local_gc *= 2;
+  local_N_total = PNX(prod_INT)(d, local_N);
+
+  bytes[PNFFT_MEM_FFT_GRIDS] = sizeof(R) * (size_t) alloc_local_in;
+  if(~pnfft_flags & PNFFT_FFT_IN_PLACE)
+    bytes[PNFFT_MEM_FFT_GRIDS] += sizeof(R) * (size_t) alloc_local_in;
+  if(pnfft_flags & PNFFT_DIFF_IK)
+    bytes[PNFFT_MEM_FFT_GRIDS] += sizeof(R) * (size_t) ((pnfft_flags & PNFFT_PLAN_POOL) ? alloc_local_in : 2*local_N_total);
+  if(alloc_local_gc > alloc_local_in)
+    bytes[PNFFT_MEM_GHOST_CELLS] = sizeof(R) * (size_t) (alloc_local_gc - alloc_local_in);
+
+  /* interpolation tables with the default number of nodes */
+  if(order >= 0){
+    int tables = 1;
+    if(~pnfft_flags & PNFFT_DIFF_IK)
+      tables += ((pnfft_flags & PNFFT_DIFF_INTPOL_PSI) && (order == 3)) ? 0 : 2;
+    for(int t=0; t<d; t++)
+      bytes[PNFFT_MEM_WINDOW_TABLES] += sizeof(R) * (size_t) (tables * default_intpol_num_nodes(cutoff) * cutoff_dim[t] * (order+1));
+  }
+  if(pnfft_flags & PNFFT_PRE_PHI_HAT)
+    bytes[PNFFT_MEM_WINDOW_TABLES] += 2 * sizeof(C) * (size_t) PNX(sum_INT)(3, local_N);
+
+  /* same sizes as in precompute_psi */
+  if(precompute_flags & PNFFT_PRE_PSI){
+    const int il = (pnfft_flags & PNFFT_INTERLACED) ? 2 : 1;
+    const INT per_node = (precompute_flags & PNFFT_PRE_FULL) ? PNFFT_PROD3(cutoff_dim) : PNFFT_SUM3(cutoff_dim);
+    INT values = per_node;
+
+    if(~pnfft_flags & PNFFT_DIFF_IK){
+      if(precompute_flags & PNFFT_PRE_GRAD_PSI)
+        values += (precompute_flags & PNFFT_PRE_FULL) ? 3*per_node : per_node;
+      if(precompute_flags & PNFFT_PRE_HESSIAN_PSI)
+        values += (precompute_flags & PNFFT_PRE_FULL) ? 6*per_node : per_node;
+    }
+    bytes[PNFFT_MEM_PRE_PSI] = sizeof(R) * (size_t) (il * values * local_M);
+  }
+
+  /* sorted indices of precompute_psi and the scratch array of the radix sort */
+  if((pnfft_flags & PNFFT_SORT_NODES) && (precompute_flags & PNFFT_PRE_PSI))
+    bytes[PNFFT_MEM_SORT] = (1 + PNFFT_SORT_RADIX) * sizeof(INT) * (size_t) (2 * local_M);
+
+  /* Largest fill level of the workspace, i.e., either the deconvolution tables of matrix D
+   * or the sorted indices and window buffers of matrix B for all compute flags. */
+  {
+    const size_t batch_buf = PNX(workspace_size)(sizeof(R) * (size_t) (cutoff*3*PNFFT_WINDOW_BATCH));
+    size_t ws_B = 0, ws_D = PNX(workspace_size)(sizeof(C) * (size_t) PNX(sum_INT)(3, local_N));
+
+    if(pnfft_flags & PNFFT_SORT_NODES)
+      ws_B += (1 + PNFFT_SORT_RADIX) * PNX(workspace_size)(sizeof(INT) * (size_t) (2 * local_M));
+    if(~precompute_flags & PNFFT_PRE_PSI)
+      ws_B += (PNX(window_batch_supported)(pnfft_flags) ? 2 : 1) * batch_buf;
+    if(~pnfft_flags & PNFFT_DIFF_IK){
+      if(~precompute_flags & PNFFT_PRE_GRAD_PSI)
+        ws_B += batch_buf;
+      if(~precompute_flags & PNFFT_PRE_HESSIAN_PSI)
+        ws_B += batch_buf;
+    }
+    bytes[PNFFT_MEM_WORKSPACE] = PNFFT_MAX(ws_B, ws_D);
+  }
+
+  if(pnfft_flags & PNFFT_MALLOC_F_HAT)
+    bytes[PNFFT_MEM_F_HAT] = sizeof(C) * (size_t) local_N_total;
+
+  if(malloc_flags & PNFFT_MALLOC_X)
+    bytes[PNFFT_MEM_NODES] += sizeof(R) * (size_t) (3 * local_M);
+  if(malloc_flags & PNFFT_MALLOC_F)
+    bytes[PNFFT_MEM_NODES] += sizeof(R) * (size_t) (2 * local_M);
+  if(malloc_flags & PNFFT_MALLOC_GRAD_F)
+    bytes[PNFFT_MEM_NODES] += sizeof(R) * (size_t) (6 * local_M);
+  if(malloc_flags & PNFFT_MALLOC_HESSIAN_F)
+    bytes[PNFFT_MEM_NODES] += sizeof(R) * (size_t) (12 * local_M);
+}
+
+
 void PNX(init_precompute_window)(
     PNX(plan) ths
     )
 {
   if(ths->pnfft_flags & PNFFT_FAST_GAUSSIAN){
     if(ths->exp_const == NULL)
-      ths->exp_const = (R*) PNX(malloc)(sizeof(R) * (size_t) ths->d * ths->cutoff);
-    for(int t=0; t<ths->d; t++)
-      for(int s=0; s<ths->cutoff; s++)
-        ths->exp_const[ths->cutoff*t+s] = pnfft_exp(-s*s/ths->b[t])/(pnfft_sqrt(PNFFT_PI*ths->b[t]));
+      ths->exp_const = (R*) PNX(malloc_tagged)(sizeof(R) * (size_t) PNFFT_SUM3(ths->cutoff_dim), PNFFT_MEM_WINDOW_TABLES, &ths->mem);
+    for(int t=0, o=0; t<ths->d; o+=ths->cutoff_dim[t], t++)
+      for(int s=0; s<ths->cutoff_dim[t]; s++)
+        ths->exp_const[o+s] = pnfft_exp(-s*s/ths->b[t])/(pnfft_sqrt(PNFFT_PI*ths->b[t]));
   }
 
 #if PNFFT_TUNE_PRECOMPUTE_INTPOL
@@ -1089,48 +1274,62 @@ void PNX(init_precompute_window)(
 #if PNFFT_ENABLE_CALC_INTPOL_NODES
     ths->intpol_num_nodes = calc_intpol_num_nodes(ths->intpol_order, 1e-16);
 #else
-    /* For m=15 we get 1e-15 accuracy with 3rd order interpolation and 2048 interpolation nodes per interval,
-     * which gives a total number of (2*15+1)*2048 interpolation nodes.
-     * Keep the total number of interpolation nodes (2*m+1)*intpol_num_nodes constant for all other 'm'. */
-    ths->intpol_num_nodes = pnfft_ceil( (2.0*15.0+1.0)/ths->cutoff ) * 2048;
+    ths->intpol_num_nodes = default_intpol_num_nodes(ths->cutoff);
 #endif
+    /* imported wisdom overrides the table size */
+    PNX(recall_wisdom)(ths, &ths->intpol_num_nodes, NULL);
+
+    /* tables are shared between dimensions and plans with equal window parameters */
     if(ths->intpol_tables_psi == NULL)
-      ths->intpol_tables_psi = (R**) PNX(malloc)(sizeof(R*) * (size_t) ths->d);
-    for(int t=0; t<ths->d; t++){
-      ths->intpol_tables_psi[t] = (R*) PNX(malloc)(sizeof(R)*(ths->intpol_num_nodes * ths->cutoff * (ths->intpol_order+1)));
-      init_intpol_table_psi(ths->intpol_num_nodes, ths->intpol_order, ths->cutoff, ths->n[t], ths->m, t, 0, ths,
-          ths->intpol_tables_psi[t]);
-    }
+      ths->intpol_tables_psi = (R**) PNX(malloc_tagged)(sizeof(R*) * (size_t) ths->d, PNFFT_MEM_WINDOW_TABLES, &ths->mem);
+    else
+      PNX(release_intpol_tables)(ths->intpol_tables_psi, ths->d);
+    for(int t=0; t<ths->d; t++)
+      ths->intpol_tables_psi[t] = PNX(acquire_intpol_table)(ths, t, 0);
 
     if( ~ths->pnfft_flags & PNFFT_DIFF_IK ){
+      /* with PNFFT_DIFF_INTPOL_PSI the cubic interpolant of psi is differentiated,
+       * i.e., dpsi and ddpsi refer to the psi tables and no extra memory is needed */
+      int derivative_tables = ((ths->pnfft_flags & PNFFT_DIFF_INTPOL_PSI) && (ths->intpol_order == 3)) ? 0 : 1;
+
       if(ths->intpol_tables_dpsi == NULL)
-        ths->intpol_tables_dpsi = (R**) PNX(malloc)(sizeof(R*) * (size_t) ths->d);
-      for(int t=0; t<ths->d; t++){
-        ths->intpol_tables_dpsi[t] = (R*) PNX(malloc)(sizeof(R)*(ths->intpol_num_nodes * ths->cutoff * (ths->intpol_order+1)));
-        init_intpol_table_psi(ths->intpol_num_nodes, ths->intpol_order, ths->cutoff, ths->n[t], ths->m, t, 1, ths,
-            ths->intpol_tables_dpsi[t]);
-      }
+        ths->intpol_tables_dpsi = (R**) PNX(malloc_tagged)(sizeof(R*) * (size_t) ths->d, PNFFT_MEM_WINDOW_TABLES, &ths->mem);
+      else
+        PNX(release_intpol_tables)(ths->intpol_tables_dpsi, ths->d);
+      for(int t=0; t<ths->d; t++)
+        ths->intpol_tables_dpsi[t] = PNX(acquire_intpol_table)(ths, t, derivative_tables);
 
       if(ths->intpol_tables_ddpsi == NULL)
-        ths->intpol_tables_ddpsi = (R**) PNX(malloc)(sizeof(R*) * (size_t) ths->d);
-      for(int t=0; t<ths->d; t++){
-        ths->intpol_tables_ddpsi[t] = (R*) PNX(malloc)(sizeof(R)*(ths->intpol_num_nodes * ths->cutoff * (ths->intpol_order+1)));
-        init_intpol_table_psi(ths->intpol_num_nodes, ths->intpol_order, ths->cutoff, ths->n[t], ths->m, t, 2, ths,
-            ths->intpol_tables_ddpsi[t]);
-      }
+        ths->intpol_tables_ddpsi = (R**) PNX(malloc_tagged)(sizeof(R*) * (size_t) ths->d, PNFFT_MEM_WINDOW_TABLES, &ths->mem);
+      else
+        PNX(release_intpol_tables)(ths->intpol_tables_ddpsi, ths->d);
+      for(int t=0; t<ths->d; t++)
+        ths->intpol_tables_ddpsi[t] = PNX(acquire_intpol_table)(ths, t, 2*derivative_tables);
     }
   }
+
+  /* fit piecewise polynomials to the window */
+  if(ths->pnfft_flags & PNFFT_PRE_POLY_PSI)
+    PNX(init_poly_window)(ths);
+
+  /* derived parameters are exported with the next call of export_wisdom */
+  PNX(remember_wisdom)(ths);
+
 #if PNFFT_TUNE_PRECOMPUTE_INTPOL
   _timer_ += MPI_Wtime();
   fprintf(stderr, "\nPrecomputation of interpolation tables took %e\n\n", _timer_);
 #endif
 
+  /* window Fourier coefficients without closed form are computed by quadrature */
+  if(ths->pnfft_flags & PNFFT_WINDOW_ES)
+    PNX(init_phi_hat_quad)(ths);
+
   /* precompute deconvultion in Fourier space */
   if(ths->pnfft_flags & PNFFT_PRE_PHI_HAT){
     if(ths->pre_inv_phi_hat_trafo == NULL)
-      ths->pre_inv_phi_hat_trafo = (C*) malloc(sizeof(C) * PNX(sum_INT)(ths->d, ths->local_N));
+      ths->pre_inv_phi_hat_trafo = (C*) PNX(malloc_tagged)(sizeof(C) * (size_t) PNX(sum_INT)(3, ths->local_N), PNFFT_MEM_WINDOW_TABLES, &ths->mem);
     if(ths->pre_inv_phi_hat_adj == NULL)
-      ths->pre_inv_phi_hat_adj   = (C*) malloc(sizeof(C) * PNX(sum_INT)(ths->d, ths->local_N));
+      ths->pre_inv_phi_hat_adj   = (C*) PNX(malloc_tagged)(sizeof(C) * (size_t) PNX(sum_INT)(3, ths->local_N), PNFFT_MEM_WINDOW_TABLES, &ths->mem);
     
     PNX(precompute_inv_phi_hat_trafo)(ths,
         ths->pre_inv_phi_hat_trafo);
@@ -1145,12 +1344,12 @@ void PNX(precompute_psi)(
     PNX(plan) ths, PNX(nodes) nodes, unsigned precompute_flags
     )
 {
-  INT *sorted_index = NULL;
+  INT *sorted_index = NULL, *sort_temp = NULL;
   R *buffer_psi=NULL, *buffer_dpsi=NULL, *buffer_ddpsi=NULL;
   R x[3];
   int pre_func = 0, pre_grad = 0, pre_hess = 0;
   pre_func = precompute_flags & PNFFT_PRE_PSI;
-  if(ths->pnfft_flags & PNFFT_DIFF_AD){
+  if( ~ths->pnfft_flags & PNFFT_DIFF_IK ){
     pre_grad = precompute_flags & PNFFT_PRE_GRAD_PSI;
     pre_hess = precompute_flags & PNFFT_PRE_HESSIAN_PSI;
   }
@@ -1177,60 +1376,65 @@ void PNX(precompute_psi)(
   /* allocate memory */
   INT size_psi, size_dpsi, size_ddpsi;
   if(nodes->precompute_flags & PNFFT_PRE_FULL){
-    size_psi   = PNFFT_POW3(ths->cutoff) * nodes->local_M;
-    size_dpsi  = PNFFT_POW3(ths->cutoff) * nodes->local_M * 3;
-    size_ddpsi = PNFFT_POW3(ths->cutoff) * nodes->local_M * 6;
+    size_psi   = PNFFT_PROD3(ths->cutoff_dim) * nodes->local_M;
+    size_dpsi  = PNFFT_PROD3(ths->cutoff_dim) * nodes->local_M * 3;
+    size_ddpsi = PNFFT_PROD3(ths->cutoff_dim) * nodes->local_M * 6;
   } else {
-    size_psi   = 3 * ths->cutoff * nodes->local_M;
-    size_dpsi  = 3 * ths->cutoff * nodes->local_M;
-    size_ddpsi = 3 * ths->cutoff * nodes->local_M;
+    size_psi   = PNFFT_SUM3(ths->cutoff_dim) * nodes->local_M;
+    size_dpsi  = PNFFT_SUM3(ths->cutoff_dim) * nodes->local_M;
+    size_ddpsi = PNFFT_SUM3(ths->cutoff_dim) * nodes->local_M;
   }
 
   if( pre_func ){
-    nodes->pre_psi = (size_psi) ? (R*) PNX(malloc)(sizeof(R) * size_psi) : NULL;
+    nodes->pre_psi = (size_psi) ? (R*) PNX(malloc_tagged)(sizeof(R) * (size_t) size_psi, PNFFT_MEM_PRE_PSI, &nodes->mem) : NULL;
     if( ths->pnfft_flags & PNFFT_INTERLACED )
-      nodes->pre_psi_il = (size_psi) ? (R*) PNX(malloc)(sizeof(R) * size_psi) : NULL;
+      nodes->pre_psi_il = (size_psi) ? (R*) PNX(malloc_tagged)(sizeof(R) * (size_t) size_psi, PNFFT_MEM_PRE_PSI, &nodes->mem) : NULL;
   }
   if( pre_grad ){
-    nodes->pre_dpsi = (size_dpsi) ? (R*) PNX(malloc)(sizeof(R) * size_dpsi) : NULL;
+    nodes->pre_dpsi = (size_dpsi) ? (R*) PNX(malloc_tagged)(sizeof(R) * (size_t) size_dpsi, PNFFT_MEM_PRE_PSI, &nodes->mem) : NULL;
     if( ths->pnfft_flags & PNFFT_INTERLACED )
-      nodes->pre_dpsi_il = (size_dpsi) ? (R*) PNX(malloc)(sizeof(R) * size_dpsi) : NULL;
+      nodes->pre_dpsi_il = (size_dpsi) ? (R*) PNX(malloc_tagged)(sizeof(R) * (size_t) size_dpsi, PNFFT_MEM_PRE_PSI, &nodes->mem) : NULL;
   }
   if( pre_hess ){
-    nodes->pre_ddpsi = (size_ddpsi) ? (R*) PNX(malloc)(sizeof(R) * size_ddpsi) : NULL;
+    nodes->pre_ddpsi = (size_ddpsi) ? (R*) PNX(malloc_tagged)(sizeof(R) * (size_t) size_ddpsi, PNFFT_MEM_PRE_PSI, &nodes->mem) : NULL;
     if( ths->pnfft_flags & PNFFT_INTERLACED )
-      nodes->pre_ddpsi_il = (size_ddpsi) ? (R*) PNX(malloc)(sizeof(R) * size_ddpsi) : NULL;
+      nodes->pre_ddpsi_il = (size_ddpsi) ? (R*) PNX(malloc_tagged)(sizeof(R) * (size_t) size_ddpsi, PNFFT_MEM_PRE_PSI, &nodes->mem) : NULL;
   }
 
   /* save precomputations in the same order as needed in matrix B */
   if( ths->pnfft_flags & PNFFT_SORT_NODES ){
-    sorted_index = (INT*) PNX(malloc)(sizeof(INT) * (size_t) 2*nodes->local_M);
+    sorted_index = (INT*) PNX(malloc_tagged)(sizeof(INT) * (size_t) 2*nodes->local_M, PNFFT_MEM_SORT, &ths->mem);
+#if PNFFT_SORT_RADIX
+    sort_temp = (INT*) PNX(malloc_tagged)(sizeof(INT) * (size_t) 2*nodes->local_M, PNFFT_MEM_SORT, &ths->mem);
+#endif
     sort_nodes_for_better_cache_handle(
-        ths->d, ths->n, ths->m, nodes->local_M, nodes->x,
-        sorted_index);
+        ths->d, ths->n, ths->m_dim, nodes->local_M, nodes->x,
+        sort_temp, sorted_index);
+    PNX(save_free)(sort_temp);
   }
 
   if( precompute_flags & PNFFT_PRE_FULL ){
     if( pre_func )
-      buffer_psi = (R*) PNX(malloc)(sizeof(R) * (size_t) ths->cutoff*3);
-    if( pre_grad )
-      buffer_dpsi = (R*) PNX(malloc)(sizeof(R) * (size_t) ths->cutoff*3);
+      buffer_psi = (R*) PNX(malloc_tagged)(sizeof(R) * (size_t) ths->cutoff*3, PNFFT_MEM_PRE_PSI, &ths->mem);
+    if( pre_grad || pre_hess )
+      buffer_dpsi = (R*) PNX(malloc_tagged)(sizeof(R) * (size_t) ths->cutoff*3, PNFFT_MEM_PRE_PSI, &ths->mem);
     if( pre_hess )
-      buffer_ddpsi = (R*) PNX(malloc)(sizeof(R) * (size_t) ths->cutoff*3);
+      buffer_ddpsi = (R*) PNX(malloc_tagged)(sizeof(R) * (size_t) ths->cutoff*3, PNFFT_MEM_PRE_PSI, &ths->mem);
   }
 
   for(INT p=0; p<nodes->local_M; p++){
     INT j = (ths->pnfft_flags & PNFFT_SORT_NODES) ? sorted_index[2*p+1] : p;
 
+    /* components d <= t < 3 of the nodes are ignored */
     for(int t=0; t<3; t++)
-      x[t] = nodes->x[ths->d*j+t];
+      x[t] = (t < ths->d) ? nodes->x[3*j+t] : 0;
     precompute_psi(ths, p, x, buffer_psi, buffer_dpsi, buffer_ddpsi, precompute_flags,
         nodes->pre_psi, nodes->pre_dpsi, nodes->pre_ddpsi);
 
     if(ths->pnfft_flags & PNFFT_INTERLACED){
       /* shift x by half the mesh width */
-      for(int t=0; t<3; t++){
-        x[t] = nodes->x[ths->d*j+t] + 0.5/ths->n[t];
+      for(int t=0; t<ths->d; t++){
+        x[t] = nodes->x[3*j+t] + 0.5/ths->n[t];
         if(x[t] >= 0.5)
           x[t] -= 1.0;
       }
@@ -1255,36 +1459,38 @@ static void precompute_psi(
     R* pre_psi, R* pre_dpsi, R* pre_ddpsi
     )
 {
-  int cutoff = ths->cutoff;
+  const int *cutoff = ths->cutoff_dim;
+  const int o1 = cutoff[0], o2 = cutoff[0]+cutoff[1], o3 = PNFFT_SUM3(cutoff);
   R floor_nx[3];
   for(int t=0; t<3; t++)
     floor_nx[t] = pnfft_floor(ths->n[t]*x[t]);
 
   int pre_func = 0, pre_grad = 0, pre_hess = 0;
   pre_func = precompute_flags & PNFFT_PRE_PSI;
-  if(ths->pnfft_flags & PNFFT_DIFF_AD){
+  if( ~ths->pnfft_flags & PNFFT_DIFF_IK ){
     pre_grad = precompute_flags & PNFFT_PRE_GRAD_PSI;
     pre_hess = precompute_flags & PNFFT_PRE_HESSIAN_PSI;
   }
 
   if(precompute_flags & PNFFT_PRE_FULL){
     /* shift index to current particle */
-    pre_psi   +=     ind * PNFFT_POW3(cutoff);
-    pre_dpsi  += 3 * ind * PNFFT_POW3(cutoff);
-    pre_ddpsi += 3 * ind * PNFFT_POW3(cutoff);
+    pre_psi   +=     ind * PNFFT_PROD3(cutoff);
+    pre_dpsi  += 3 * ind * PNFFT_PROD3(cutoff);
+    pre_ddpsi += 6 * ind * PNFFT_PROD3(cutoff);
 
     if( pre_func ){
       pre_psi_tensor(
-          ths->n, ths->b, ths->m, ths->cutoff, x, floor_nx,
+          ths->d, ths->n, ths->b, ths->m_dim, ths->cutoff_dim, x, floor_nx,
           ths->exp_const, ths->spline_coeffs, ths->pnfft_flags,
           ths->intpol_order, ths->intpol_num_nodes, ths->intpol_tables_psi,
+          ths->poly_degree, ths->poly_coeffs_psi,
           buffer_psi);
 
       INT m=0;
-      for(INT l0=0; l0<cutoff; l0++){
-        for(INT l1=cutoff; l1<2*cutoff; l1++){
+      for(INT l0=0; l0<o1; l0++){
+        for(INT l1=o1; l1<o2; l1++){
           R psi_xy  = buffer_psi[l0] * buffer_psi[l1];
-          for(INT l2=2*cutoff; l2<3*cutoff; l2++){
+          for(INT l2=o2; l2<o3; l2++){
             pre_psi[m++] = psi_xy * buffer_psi[l2];
           }
         }
@@ -1293,18 +1499,19 @@ static void precompute_psi(
 
     if( pre_grad ){
       pre_dpsi_tensor(
-          ths->n, ths->b, ths->m, ths->cutoff, x, floor_nx, ths->spline_coeffs,
+          ths->d, ths->n, ths->b, ths->m_dim, ths->cutoff_dim, x, floor_nx, ths->spline_coeffs,
           ths->intpol_order, ths->intpol_num_nodes, ths->intpol_tables_dpsi,
+          ths->poly_degree, ths->poly_coeffs_dpsi,
           buffer_psi, ths->pnfft_flags,
           buffer_dpsi);
         
       INT md=0;
-      for(INT l0=0; l0<cutoff; l0++){
-        for(INT l1=cutoff; l1<2*cutoff; l1++){
+      for(INT l0=0; l0<o1; l0++){
+        for(INT l1=o1; l1<o2; l1++){
           R psi_xy  = buffer_psi[l0]   * buffer_psi[l1];
           R psi_dxy = buffer_dpsi[l0]  * buffer_psi[l1];
           R psi_xdy = buffer_psi[l0]   * buffer_dpsi[l1];
-          for(INT l2=2*cutoff; l2<3*cutoff; l2++, md+=3){
+          for(INT l2=o2; l2<o3; l2++, md+=3){
             pre_dpsi[md+0] = psi_dxy * buffer_psi[l2];
             pre_dpsi[md+1] = psi_xdy * buffer_psi[l2];
             pre_dpsi[md+2] = psi_xy  * buffer_dpsi[l2];
@@ -1314,22 +1521,32 @@ static void precompute_psi(
     }
 
     if( pre_hess ){
+      /* the mixed derivatives need dpsi on the axes */
+      if( !pre_grad )
+        pre_dpsi_tensor(
+            ths->d, ths->n, ths->b, ths->m_dim, ths->cutoff_dim, x, floor_nx, ths->spline_coeffs,
+            ths->intpol_order, ths->intpol_num_nodes, ths->intpol_tables_dpsi,
+            ths->poly_degree, ths->poly_coeffs_dpsi,
+            buffer_psi, ths->pnfft_flags,
+            buffer_dpsi);
+
       pre_ddpsi_tensor(
-          ths->n, ths->b, ths->m, ths->cutoff, x, floor_nx, ths->spline_coeffs,
+          ths->d, ths->n, ths->b, ths->m_dim, ths->cutoff_dim, x, floor_nx, ths->spline_coeffs,
           ths->intpol_order, ths->intpol_num_nodes, ths->intpol_tables_ddpsi,
+          ths->poly_degree, ths->poly_coeffs_ddpsi,
           buffer_psi, buffer_dpsi, ths->pnfft_flags,
           buffer_ddpsi);
 
       INT mdd=0;
-      for(INT l0=0; l0<cutoff; l0++){
-        for(INT l1=cutoff; l1<2*cutoff; l1++){
+      for(INT l0=0; l0<o1; l0++){
+        for(INT l1=o1; l1<o2; l1++){
           R psi_xy   = buffer_psi[l0]  * buffer_psi[l1];
           R psi_dxy  = buffer_dpsi[l0] * buffer_psi[l1];
           R psi_xdy  = buffer_psi[l0]  * buffer_dpsi[l1];
           R psi_dxdy = buffer_dpsi[l0] * buffer_dpsi[l1];
           R psi_ddxy = buffer_ddpsi[l0]* buffer_psi[l1];
           R psi_xddy = buffer_psi[l0]  * buffer_ddpsi[l1];
-          for(INT l2=2*cutoff; l2<3*cutoff; l2++, mdd+=6){
+          for(INT l2=o2; l2<o3; l2++, mdd+=6){
             pre_ddpsi[mdd+0] = psi_ddxy * buffer_psi[l2];
             pre_ddpsi[mdd+1] = psi_dxdy * buffer_psi[l2];
             pre_ddpsi[mdd+2] = psi_dxy * buffer_dpsi[l2];
@@ -1342,29 +1559,32 @@ static void precompute_psi(
     }
   } else {
     /* shift index to current particle */
-    pre_psi   += ind * 3 * cutoff;
-    pre_dpsi  += ind * 3 * cutoff;
-    pre_ddpsi += ind * 3 * cutoff;
+    pre_psi   += ind * o3;
+    pre_dpsi  += ind * o3;
+    pre_ddpsi += ind * o3;
 
     if( pre_func )
       pre_psi_tensor(
-          ths->n, ths->b, ths->m, ths->cutoff, x, floor_nx,
+          ths->d, ths->n, ths->b, ths->m_dim, ths->cutoff_dim, x, floor_nx,
           ths->exp_const, ths->spline_coeffs, ths->pnfft_flags,
           ths->intpol_order, ths->intpol_num_nodes, ths->intpol_tables_psi,
+          ths->poly_degree, ths->poly_coeffs_psi,
           pre_psi);
 
     if( pre_grad )
       pre_dpsi_tensor(
-          ths->n, ths->b, ths->m, ths->cutoff, x, floor_nx, ths->spline_coeffs,
+          ths->d, ths->n, ths->b, ths->m_dim, ths->cutoff_dim, x, floor_nx, ths->spline_coeffs,
           ths->intpol_order, ths->intpol_num_nodes, ths->intpol_tables_dpsi,
+          ths->poly_degree, ths->poly_coeffs_dpsi,
           pre_psi, ths->pnfft_flags,
           pre_dpsi);
 
     if( pre_hess )
       pre_ddpsi_tensor(
-          ths->n, ths->b, ths->m, ths->cutoff, x, floor_nx, ths->spline_coeffs,
+          ths->d, ths->n, ths->b, ths->m_dim, ths->cutoff_dim, x, floor_nx, ths->spline_coeffs,
           ths->intpol_order, ths->intpol_num_nodes, ths->intpol_tables_ddpsi,
-          pre_psi, pre_dpsi, ths->pnfft_flags,
+          ths->poly_degree, ths->poly_coeffs_ddpsi,
+          pre_psi, (pre_grad) ? pre_dpsi : NULL, ths->pnfft_flags,
           pre_ddpsi);
   }
 }
@@ -1377,6 +1597,9 @@ static PNX(plan) mkplan(
 {
   PNX(plan) ths = (plan_s*) malloc(sizeof(plan_s));
 
+  PNX(reset_memory)(&ths->mem);
+  PNX(init_workspace)(ths);
+
   ths->f_hat  = NULL;
   ths->N      = NULL;
   ths->sigma  = NULL;
@@ -1401,6 +1624,8 @@ static PNX(plan) mkplan(
   ths->g1 = NULL;
   ths->g2 = NULL;
   ths->g1_buffer = NULL;
+  ths->alloc_local_in  = 0;
+  ths->alloc_local_out = 0;
   
   ths->pfft_forw = NULL;
   ths->pfft_back = NULL;
@@ -1411,21 +1636,27 @@ static PNX(plan) mkplan(
   ths->intpol_tables_dpsi = NULL;
   ths->intpol_tables_ddpsi = NULL;
 
+  ths->poly_degree = 0;
+  ths->poly_coeffs_psi   = NULL;
+  ths->poly_coeffs_dpsi  = NULL;
+  ths->poly_coeffs_ddpsi = NULL;
+
+  ths->phi_hat_quad_num = 0;
+  ths->phi_hat_quad_nodes   = NULL;
+  ths->phi_hat_quad_weights = NULL;
+
   ths->timer_trafo = PNX(mktimer)();
   ths->timer_adj   = PNX(mktimer)();
+  ths->counter_trafo = PNX(mkcounter)();
+  ths->counter_adj   = PNX(mkcounter)();
 
-  return ths;
-}
-
-static void free_intpol_tables(R** intpol_tables, int num_tables){
-  if(NULL == intpol_tables)
-    return;
-  
-  for(int t=0; t<num_tables; ++t){
-    PNX(save_free)(intpol_tables[t]);
-  }
+  ths->stage_begin = NULL;
+  ths->stage_end   = NULL;
+  ths->stage_data  = NULL;
+  ths->stage_component  = -1;
+  ths->stage_interlaced = 0;
 
-  PNX(free)(intpol_tables);
+  return ths;
 }
 
 void PNX(rmplan)(
@@ -1436,8 +1667,11 @@ void PNX(rmplan)(
   if(ths==NULL)
     return;
 
+  /* f_hat outlives the plan, if it is not freed */
   if(pnfft_finalize_flags & PNFFT_FREE_F_HAT)
     PNX(save_free)(ths->f_hat);
+  else
+    PNX(detach_tagged)(ths->f_hat);
 
   PNX(save_free)(ths->N);
   PNX(save_free)(ths->sigma);
@@ -1457,21 +1691,34 @@ void PNX(rmplan)(
   PNX(save_free)(ths->pre_inv_phi_hat_trafo);
   PNX(save_free)(ths->pre_inv_phi_hat_adj);
 
-  /* g1 and g2 may point to the same mem for inplace transforms, do not free twice */
-  if(ths->g2 != ths->g1) PNX(save_free)(ths->g2);
-  PNX(save_free)(ths->g1);
-  PNX(save_free)(ths->g1_buffer);
-
-  PX(destroy_plan)(ths->pfft_forw);
-  PX(destroy_plan)(ths->pfft_back);
-  PX(destroy_gcplan)(ths->gcplan);
-
-  free_intpol_tables(ths->intpol_tables_psi, ths->d);
-  free_intpol_tables(ths->intpol_tables_dpsi, ths->d);
-  free_intpol_tables(ths->intpol_tables_ddpsi, ths->d);
+  if(ths->pnfft_flags & PNFFT_PLAN_POOL)
+    PNX(release_pooled_grids)(ths);
+  else {
+    /* g1 and g2 may point to the same mem for inplace transforms, do not free twice */
+    if(ths->g2 != ths->g1) PNX(save_free)(ths->g2);
+    PNX(save_free)(ths->g1);
+    PNX(save_free)(ths->g1_buffer);
+
+    PX(destroy_plan)(ths->pfft_forw);
+    PX(destroy_plan)(ths->pfft_back);
+    PX(destroy_gcplan)(ths->gcplan);
+  }
+
+  PNX(release_intpol_tables)(ths->intpol_tables_psi, ths->d);
+  PNX(release_intpol_tables)(ths->intpol_tables_dpsi, ths->d);
+  PNX(release_intpol_tables)(ths->intpol_tables_ddpsi, ths->d);
+  PNX(save_free)(ths->intpol_tables_psi);
+  PNX(save_free)(ths->intpol_tables_dpsi);
+  PNX(save_free)(ths->intpol_tables_ddpsi);
+  PNX(free_poly_window)(ths);
+  PNX(save_free)(ths->phi_hat_quad_nodes);
+  PNX(save_free)(ths->phi_hat_quad_weights);
+  PNX(free_workspace)(ths);
 
   PNX(rmtimer)(ths->timer_trafo);
   PNX(rmtimer)(ths->timer_adj);
+  PNX(rmcounter)(ths->counter_trafo);
+  PNX(rmcounter)(ths->counter_adj);
 
   MPI_Comm_free(&(ths->comm_cart));
 
@@ -1488,7 +1735,8 @@ void PNX(malloc_x)(
   if( ~malloc_flags & PNFFT_MALLOC_X )
     return;
 
-  nodes->x = (nodes->local_M>0) ? (R*) PNX(malloc)(sizeof(R) * (size_t) 3*nodes->local_M) : NULL;
+  nodes->x = (nodes->local_M>0) ? (R*) PNX(malloc_placed)(sizeof(R) * (size_t) 3*nodes->local_M, PNFFT_MEM_NODES, &nodes->mem, huge_flags_nodes(malloc_flags)) : NULL;
+  PNX(first_touch)(nodes->x, 3*nodes->local_M);
 }
 
 void PNX(malloc_f)(
@@ -1498,7 +1746,8 @@ void PNX(malloc_f)(
   if( ~malloc_flags & PNFFT_MALLOC_F )
     return;
 
-  nodes->f = (nodes->local_M>0) ? (R*) PNX(malloc)(sizeof(R) * 2 * (size_t) nodes->local_M) : NULL;
+  nodes->f = (nodes->local_M>0) ? (R*) PNX(malloc_placed)(sizeof(R) * 2 * (size_t) nodes->local_M, PNFFT_MEM_NODES, &nodes->mem, huge_flags_nodes(malloc_flags)) : NULL;
+  PNX(first_touch)(nodes->f, 2*nodes->local_M);
 }
 
 void PNX(malloc_grad_f)(
@@ -1508,7 +1757,8 @@ void PNX(malloc_grad_f)(
   if( ~malloc_flags & PNFFT_MALLOC_GRAD_F )
     return;
 
-  nodes->grad_f = (nodes->local_M>0) ? (R*) PNX(malloc)(sizeof(R) * 2 * (size_t) 3*nodes->local_M) : NULL;
+  nodes->grad_f = (nodes->local_M>0) ? (R*) PNX(malloc_placed)(sizeof(R) * 2 * (size_t) 3*nodes->local_M, PNFFT_MEM_NODES, &nodes->mem, huge_flags_nodes(malloc_flags)) : NULL;
+  PNX(first_touch)(nodes->grad_f, 6*nodes->local_M);
 }
 
 void PNX(malloc_hessian_f)(
@@ -1518,7 +1768,8 @@ void PNX(malloc_hessian_f)(
   if( ~malloc_flags & PNFFT_MALLOC_HESSIAN_F )
     return;
 
-  nodes->hessian_f = (nodes->local_M>0) ? (R*) PNX(malloc)(sizeof(R) * 2 * (size_t) 6*nodes->local_M) : NULL;
+  nodes->hessian_f = (nodes->local_M>0) ? (R*) PNX(malloc_placed)(sizeof(R) * 2 * (size_t) 6*nodes->local_M, PNFFT_MEM_NODES, &nodes->mem, huge_flags_nodes(malloc_flags)) : NULL;
+  PNX(first_touch)(nodes->hessian_f, 12*nodes->local_M);
 }
 
 void PNX(trafo_F)(
@@ -1531,6 +1782,7 @@ void PNX(trafo_F)(
 #endif
 
   PX(execute)(ths->pfft_forw);
+  PNX(count_F)(ths, ths->counter_trafo);
 }
 
 void PNX(adjoint_F)(
@@ -1538,6 +1790,7 @@ void PNX(adjoint_F)(
     )
 {
   PX(execute)(ths->pfft_back);
+  PNX(count_F)(ths, ths->counter_adj);
 
 #if PNFFT_ENABLE_DEBUG
   PNX(debug_sum_print)(ths->g1, ths->local_N[0]*ths->local_N[1]*ths->local_N[2], 1,
@@ -1548,25 +1801,59 @@ void PNX(adjoint_F)(
 
 /* Implement ghostcell send for all dimensions */
 static void get_size_gcells(
-    int m, int cutoff, unsigned pnfft_flags,
+    int d, const int *m, const int *cutoff, unsigned pnfft_flags,
     INT *gcells_below, INT *gcells_above
     )
 {
   for(int t=0; t<3; t++){
-    gcells_below[t] = m;
-    gcells_above[t] = cutoff - gcells_below[t] - 1;
-    if(pnfft_flags & PNFFT_INTERLACED)
+    gcells_below[t] = m[t];
+    gcells_above[t] = cutoff[t] - gcells_below[t] - 1;
+    if((pnfft_flags & PNFFT_INTERLACED) && (t < d))
       gcells_above[t] += 1;
   }
 }
 
+/* node arrays use transparent huge pages only */
+static unsigned huge_flags_nodes(
+    unsigned malloc_flags
+    )
+{
+  return (malloc_flags & PNFFT_MALLOC_HUGE_PAGES) ? PNFFT_HUGE_PAGES : 0;
+}
+
+static int intpol_order(
+    unsigned pnfft_flags
+    )
+{
+  if(pnfft_flags & PNFFT_PRE_CONST_PSI)
+    return 0;
+  else if(pnfft_flags & PNFFT_PRE_LIN_PSI)
+    return 1;
+  else if(pnfft_flags & PNFFT_PRE_QUAD_PSI)
+    return 2;
+  else if(pnfft_flags & PNFFT_PRE_CUB_PSI)
+    return 3;
+  else
+    return -1;
+}
+
+/* For m=15 we get 1e-15 accuracy with 3rd order interpolation and 2048 interpolation nodes per interval,
+ * which gives a total number of (2*15+1)*2048 interpolation nodes.
+ * Keep the total number of interpolation nodes (2*m+1)*intpol_num_nodes constant for all other 'm'. */
+static INT default_intpol_num_nodes(
+    int cutoff
+    )
+{
+  return (INT) pnfft_ceil( (2.0*15.0+1.0)/cutoff ) * 2048;
+}
+
 static void lowest_summation_index(
-    const INT *n, int m, const R *x,
+    int d, const INT *n, const int *m, const R *x,
     const INT *local_no_start, const INT *gcells_below,
     R *floor_nx_j, INT *u_j
     )
 {
-  project_node_to_grid(n, m, x, floor_nx_j, u_j);
+  project_node_to_grid(d, n, m, x, floor_nx_j, u_j);
   for(int t=0; t<3; t++)
     u_j[t] = u_j[t] - local_no_start[t] + gcells_below[t];
 }
@@ -1584,63 +1871,122 @@ static void local_array_size(
 
 
 static void pre_tensor_intpol(
-    const INT *n, int cutoff, const R *x, const R *floor_nx,
+    int d, const INT *n, const int *cutoff, const R *x, const R *floor_nx,
     int intpol_order, INT intpol_num_nodes, R **intpol_tables_psi,
     R *pre_psi
     )
 {
-  const int d=3;
-
-  for(int t=0; t<d; t++){
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
     R dist = n[t]*x[t] - floor_nx[t] ; /* 0<= dist < 1 */
     INT k = (INT) pnfft_floor(dist*intpol_num_nodes);
     R dist_k = dist*intpol_num_nodes - (R)k; /* 0 <= dist_k < 1 */
-    k *= cutoff * (intpol_order+1);
+    k *= cutoff[t] * (intpol_order+1);
     switch(intpol_order){
       case 0 :
-        for(int s=0; s<cutoff; s++, k++)
-          pre_psi[cutoff*t+s] = pnfft_intpol_const(k, intpol_tables_psi[t]);
+        for(int s=0; s<cutoff[t]; s++, k++)
+          pre_psi[o+s] = pnfft_intpol_const(k, intpol_tables_psi[t]);
         break;
       case 1 :
-        for(int s=0; s<cutoff; s++, k+=2)
-          pre_psi[cutoff*t+s] = pnfft_intpol_lin(k, dist_k, intpol_tables_psi[t]);
+        for(int s=0; s<cutoff[t]; s++, k+=2)
+          pre_psi[o+s] = pnfft_intpol_lin(k, dist_k, intpol_tables_psi[t]);
         break;
       case 2 :
-        for(int s=0; s<cutoff; s++, k+=3)
-          pre_psi[cutoff*t+s] = pnfft_intpol_quad(k, dist_k, intpol_tables_psi[t]);
+        for(int s=0; s<cutoff[t]; s++, k+=3)
+          pre_psi[o+s] = pnfft_intpol_quad(k, dist_k, intpol_tables_psi[t]);
         break;
       default:
-        for(int s=0; s<cutoff; s++, k+=4)
-          pre_psi[cutoff*t+s] = pnfft_intpol_kub(k, dist_k, intpol_tables_psi[t]);
+        for(int s=0; s<cutoff[t]; s++, k+=4)
+          pre_psi[o+s] = pnfft_intpol_kub(k, dist_k, intpol_tables_psi[t]);
     }
   }
 }
 
 
-/* switch between direct evaluation and interpolation */
+/* evaluate first or second derivative of the cubic interpolant of psi,
+ * the chain rule gives the factor n*intpol_num_nodes per derivative */
+static void pre_tensor_intpol_derivative(
+    int d, const INT *n, const int *cutoff, const R *x, const R *floor_nx,
+    int derivative, INT intpol_num_nodes, R **intpol_tables_psi,
+    R *pre_dpsi
+    )
+{
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    R dist = n[t]*x[t] - floor_nx[t] ; /* 0<= dist < 1 */
+    INT k = (INT) pnfft_floor(dist*intpol_num_nodes);
+    R dist_k = dist*intpol_num_nodes - (R)k; /* 0 <= dist_k < 1 */
+    R h = (R) n[t] * intpol_num_nodes;
+    k *= cutoff[t] * 4;
+    if(derivative == 1){
+      for(int s=0; s<cutoff[t]; s++, k+=4)
+        pre_dpsi[o+s] = h * pnfft_intpol_kub_d(k, dist_k, intpol_tables_psi[t]);
+    } else {
+      h *= h;
+      for(int s=0; s<cutoff[t]; s++, k+=4)
+        pre_dpsi[o+s] = h * pnfft_intpol_kub_dd(k, dist_k, intpol_tables_psi[t]);
+    }
+  }
+}
+
+
+/* evaluate piecewise polynomial approximation of the window with Horner's scheme,
+ * the innermost loop runs over all stencil offsets */
+static void pre_tensor_poly(
+    int d, const INT *n, const int *cutoff, const R *x, const R *floor_nx,
+    int poly_degree, R **poly_coeffs,
+    R *pre_psi
+    )
+{
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    const R z = 2.0*(n[t]*x[t] - floor_nx[t]) - 1.0; /* -1 <= z < 1 */
+    const R *c = poly_coeffs[t] + poly_degree*cutoff[t];
+    R *p = pre_psi + o;
+
+    for(int s=0; s<cutoff[t]; s++)
+      p[s] = c[s];
+    for(int k=poly_degree-1; k>=0; k--){
+      c -= cutoff[t];
+      for(int s=0; s<cutoff[t]; s++)
+        p[s] = p[s]*z + c[s];
+    }
+  }
+}
+
+
+/* switch between direct evaluation, interpolation and polynomial approximation */
 static void pre_psi_tensor(
-    const INT *n, const R *b, int m, int cutoff, const R *x, const R *floor_nx,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff, const R *x, const R *floor_nx,
     const R *exp_const, R *spline_coeffs, unsigned pnfft_flags,
     int intpol_order, INT intpol_num_nodes, R **intpol_tables_psi,
+    int poly_degree, R **poly_coeffs_psi,
     R *pre_psi
     )
 {
-  if(pnfft_flags & PNFFT_PRE_INTPOL_PSI)
+  if(pnfft_flags & PNFFT_PRE_POLY_PSI)
+    pre_tensor_poly(
+        d, n, cutoff, x, floor_nx,
+        poly_degree, poly_coeffs_psi,
+        pre_psi);
+  else if(pnfft_flags & PNFFT_PRE_INTPOL_PSI)
     pre_tensor_intpol(
-        n, cutoff, x, floor_nx,
+        d, n, cutoff, x, floor_nx,
         intpol_order, intpol_num_nodes, intpol_tables_psi,
         pre_psi);
   else
     pre_psi_tensor_direct(
-        n, b, m, cutoff, x, floor_nx,
+        d, n, b, m, cutoff, x, floor_nx,
         exp_const, spline_coeffs, pnfft_flags,
         pre_psi);
+
+  /* trivial axes of plans with d < 3 have one stencil point with weight 1 */
+  for(int t=0, o=0; t<3; o+=cutoff[t], t++)
+    if(t >= d)
+      pre_psi[o] = K(1.0);
 }
 
 
 /* calculate window function */
 static void pre_psi_tensor_direct(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx,
     const R *exp_const, R *spline_coeffs,
     unsigned pnfft_flags,
@@ -1650,457 +1996,611 @@ static void pre_psi_tensor_direct(
   if(pnfft_flags & PNFFT_WINDOW_GAUSSIAN){
     if(pnfft_flags & PNFFT_FAST_GAUSSIAN)
       pre_psi_tensor_fast_gaussian(
-          n, b, m, cutoff, x, floor_nx, exp_const,
+          d, n, b, m, cutoff, x, floor_nx, exp_const,
           pre_psi);
     else
       pre_psi_tensor_gaussian(
-          n, b, m, cutoff, x, floor_nx,
+          d, n, b, m, cutoff, x, floor_nx,
           pre_psi);
   } 
   else if(pnfft_flags & PNFFT_WINDOW_BSPLINE)
     pre_psi_tensor_bspline(
-        n, m, cutoff, x, floor_nx, spline_coeffs,
+        d, n, m, cutoff, x, floor_nx, spline_coeffs,
         pre_psi);
   else if(pnfft_flags & PNFFT_WINDOW_SINC_POWER)
     pre_psi_tensor_sinc_power(
-        n, b, m, cutoff, x, floor_nx,
+        d, n, b, m, cutoff, x, floor_nx,
         pre_psi);
   else if(pnfft_flags & PNFFT_WINDOW_BESSEL_I0)
     pre_psi_tensor_bessel_i0(
-        n, b, m, cutoff, x, floor_nx,
+        d, n, b, m, cutoff, x, floor_nx,
+        pre_psi);
+  else if(pnfft_flags & PNFFT_WINDOW_ES)
+    pre_psi_tensor_es(
+        d, n, b, m, cutoff, x, floor_nx,
         pre_psi);
   else
     pre_psi_tensor_kaiser_bessel(
-        n, b, m, cutoff, x, floor_nx,
+        d, n, b, m, cutoff, x, floor_nx,
         pre_psi);
 }
 
 static void pre_psi_tensor_gaussian(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx,
     R *pre_psi
     )
 {
-  const int d=3;
   R u_j;
 
-  for(int t=0; t<d; t++){
-    u_j = floor_nx[t] - n[t]*x[t] - m;
-    for(int s=0; s<cutoff; s++)
-      pre_psi[cutoff*t+s] = pnfft_exp(-PNFFT_SQR(u_j + s) / b[t]) / pnfft_sqrt(PNFFT_PI*b[t]);
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    u_j = floor_nx[t] - n[t]*x[t] - m[t];
+    for(int s=0; s<cutoff[t]; s++)
+      pre_psi[o+s] = pnfft_exp(-PNFFT_SQR(u_j + s) / b[t]) / pnfft_sqrt(PNFFT_PI*b[t]);
   }
 }
 
 static void pre_psi_tensor_fast_gaussian(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, const R *exp_const,
     R *fg_psi
     )
 {
-  const int d=3;
   R u_j, exp_sqr, exp_lin, tmp;
 
-  for(int t=0; t<d; t++){
-    u_j = floor_nx[t] - m;
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    u_j = floor_nx[t] - m[t];
     exp_sqr = pnfft_exp( -PNFFT_SQR( n[t]*x[t]-u_j ) / b[t] );
     exp_lin = pnfft_exp( 2*( n[t]*x[t]-u_j ) / b[t] );
 
     tmp = exp_sqr;
-    for(int s=0; s<cutoff; s++){
-      fg_psi[cutoff*t+s] = tmp * exp_const[cutoff*t+s];
+    for(int s=0; s<cutoff[t]; s++){
+      fg_psi[o+s] = tmp * exp_const[o+s];
       tmp *= exp_lin;
     }
   }
 }
 
 static void pre_psi_tensor_bspline(
-    const INT *n, int m, int cutoff,
+    int d, const INT *n, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, R *spline_coeffs, 
     R *pre_psi
     )
 {
-  const int d=3;
-
-  if(m<9){
-    for(int t=0; t<d; t++){
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    if(m[t]<9){
       /* Bspline is shifted by m */
       R dist = floor_nx[t]  - n[t]*x[t] + 0.5; 
-      for(int s=0; s<cutoff; s++)
-        pre_psi[cutoff*t+s] = PNX(fast_bspline)(
-            s-1, dist, 2*m);
+      for(int s=0; s<cutoff[t]; s++)
+        pre_psi[o+s] = PNX(fast_bspline)(
+            s-1, dist, 2*m[t]);
+      continue;
     }
-    return;
-  }
 
-  for(int t=0; t<d; t++){
     /* Bspline is shifted by m */
     R u_j = floor_nx[t] - n[t]*x[t]; 
-    for(int s=0; s<cutoff; s++)
-      pre_psi[cutoff*t+s] = PNX(bspline)(
-          2*m, u_j + (R)s, spline_coeffs);
+    for(int s=0; s<cutoff[t]; s++)
+      pre_psi[o+s] = PNX(bspline)(
+          2*m[t], u_j + (R)s, spline_coeffs);
   }
 }
 
 /* The factor n of the window cancels with the factor 1/n from matrix D. */
 static void pre_psi_tensor_sinc_power(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx,
     R *pre_psi
     )
 {
-  const int d=3;
   R u_j;
 
-  for(int t=0; t<d; t++){
-    u_j = floor_nx[t] - n[t]*x[t] - m; 
-    for(int s=0; s<cutoff; s++)
-      pre_psi[cutoff*t+s] =
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    u_j = floor_nx[t] - n[t]*x[t] - m[t]; 
+    for(int s=0; s<cutoff[t]; s++)
+      pre_psi[o+s] =
         pnfft_pow(
             PNX(sinc)( PNFFT_PI * (u_j + s) / b[t]),
-            K(2.0)*(R)m
+            K(2.0)*(R)m[t]
         ) / b[t];
   }
 }
 
 static void pre_psi_tensor_bessel_i0(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx,
     R *pre_psi
     )
 {
-  const int d=3;
   R u_j;
 
-  for(int t=0; t<d; t++){
-    u_j = floor_nx[t] - n[t]*x[t] - m;
-    for(int s=0; s<cutoff; s++)
-      pre_psi[cutoff*t+s] = window_bessel_i0_1d(
-          (u_j + s) / n[t], n[t], b[t], m);
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    u_j = floor_nx[t] - n[t]*x[t] - m[t];
+    for(int s=0; s<cutoff[t]; s++)
+      pre_psi[o+s] = window_bessel_i0_1d(
+          (u_j + s) / n[t], n[t], b[t], m[t]);
   }
 }
 
 static void pre_psi_tensor_kaiser_bessel(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx,
     R *pre_psi
     )
 {
-  const int d=3;
   R u_j;
 
-  for(int t=0; t<d; t++){
-    u_j = floor_nx[t] - n[t]*x[t] - m;
-    for(int s=0; s<cutoff; s++)
-      pre_psi[cutoff*t+s] = kaiser_bessel_1d(
-          (u_j + s) / n[t], n[t], b[t], m);
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    u_j = floor_nx[t] - n[t]*x[t] - m[t];
+    for(int s=0; s<cutoff[t]; s++)
+      pre_psi[o+s] = kaiser_bessel_1d(
+          (u_j + s) / n[t], n[t], b[t], m[t]);
+  }
+}
+
+static void pre_psi_tensor_es(
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
+    const R *x, const R *floor_nx,
+    R *pre_psi
+    )
+{
+  R u_j;
+
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    u_j = floor_nx[t] - n[t]*x[t] - m[t];
+    for(int s=0; s<cutoff[t]; s++)
+      pre_psi[o+s] = es_1d(
+          (u_j + s) / n[t], n[t], b[t], m[t]);
   }
 }
 
 /* switch between direct evaluation and interpolation */
 static void pre_dpsi_tensor(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, R *spline_coeffs,
     int intpol_order, INT intpol_num_nodes, R **intpol_tables_dpsi,
+    int poly_degree, R **poly_coeffs_dpsi,
     const R *pre_psi, unsigned pnfft_flags,
     R *pre_dpsi
     )
 {
-  if(pnfft_flags & PNFFT_PRE_INTPOL_PSI)
+  if(pnfft_flags & PNFFT_PRE_POLY_PSI)
+    pre_tensor_poly(
+        d, n, cutoff, x, floor_nx,
+        poly_degree, poly_coeffs_dpsi,
+        pre_dpsi);
+  else if((pnfft_flags & PNFFT_PRE_INTPOL_PSI) && (pnfft_flags & PNFFT_DIFF_INTPOL_PSI) && (intpol_order == 3))
+    pre_tensor_intpol_derivative(
+        d, n, cutoff, x, floor_nx,
+        1, intpol_num_nodes, intpol_tables_dpsi,
+        pre_dpsi);
+  else if(pnfft_flags & PNFFT_PRE_INTPOL_PSI)
     pre_tensor_intpol(
-        n, cutoff, x, floor_nx,
+        d, n, cutoff, x, floor_nx,
         intpol_order, intpol_num_nodes, intpol_tables_dpsi,
         pre_dpsi);
   else
     pre_dpsi_tensor_direct(
-        n, b, m, cutoff, x, floor_nx, spline_coeffs,
+        d, n, b, m, cutoff, x, floor_nx, spline_coeffs,
         pre_psi, pnfft_flags,
         pre_dpsi);
+
+  for(int t=0, o=0; t<3; o+=cutoff[t], t++)
+    if(t >= d)
+      pre_dpsi[o] = K(0.0);
 }
 
 /* calculate window derivative */
 static void pre_dpsi_tensor_direct(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, R *spline_coeffs, const R *pre_psi,
     unsigned pnfft_flags,
     R *pre_dpsi
     )
 {
-  if(pnfft_flags & PNFFT_WINDOW_GAUSSIAN)
+  if( (pre_psi == NULL) && !(pnfft_flags & (PNFFT_WINDOW_BSPLINE | PNFFT_WINDOW_BESSEL_I0)) )
+    pre_derivative_tensor_closed_form(
+        d, n, b, m, cutoff, x, floor_nx, 1, pnfft_flags,
+        pre_dpsi);
+  else if(pnfft_flags & PNFFT_WINDOW_GAUSSIAN)
     pre_dpsi_tensor_gaussian(
-        n, b, m, cutoff, x, floor_nx, pre_psi,
+        d, n, b, m, cutoff, x, floor_nx, pre_psi,
         pre_dpsi);
   else if(pnfft_flags & PNFFT_WINDOW_BSPLINE)
     pre_dpsi_tensor_bspline(
-        n, m, cutoff, x, floor_nx, spline_coeffs,
+        d, n, m, cutoff, x, floor_nx, spline_coeffs,
         pre_dpsi);
   else if(pnfft_flags & PNFFT_WINDOW_SINC_POWER)
     pre_dpsi_tensor_sinc_power(
-        n, b, m, cutoff, x, floor_nx, pre_psi,
+        d, n, b, m, cutoff, x, floor_nx, pre_psi,
         pre_dpsi);
   else if(pnfft_flags & PNFFT_WINDOW_BESSEL_I0)
     pre_dpsi_tensor_bessel_i0(
-        n, b, m, cutoff, x, floor_nx,
+        d, n, b, m, cutoff, x, floor_nx,
+        pre_dpsi);
+  else if(pnfft_flags & PNFFT_WINDOW_ES)
+    pre_dpsi_tensor_es(
+        d, n, b, m, cutoff, x, floor_nx, pre_psi,
         pre_dpsi);
   else
     pre_dpsi_tensor_kaiser_bessel(
-        n, b, m, cutoff, x, floor_nx, pre_psi,
+        d, n, b, m, cutoff, x, floor_nx, pre_psi,
         pre_dpsi);
 }
 
+/* The derivatives of the Gaussian are polynomials times psi. Therefore, they are computed
+ * from psi of pre_psi_tensor_gaussian as well as pre_psi_tensor_fast_gaussian. */
 static void pre_dpsi_tensor_gaussian(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, const R *fg_psi,
     R *fg_dpsi
     )
 {
-  const int d=3;
-  R u_j;
+  R u_j, c;
 
-  for(int t=0; t<d; t++){
-    u_j = n[t]*x[t] - floor_nx[t] + m;
-    for(int s=0; s<cutoff; s++)
-      fg_dpsi[cutoff*t+s] = -2.0*n[t]/b[t] * (u_j-s) * fg_psi[cutoff*t+s];
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    u_j = n[t]*x[t] - floor_nx[t] + m[t];
+    c = -2.0*n[t]/b[t];
+    for(int s=0; s<cutoff[t]; s++, u_j-=1.0)
+      fg_dpsi[o+s] = c * u_j * fg_psi[o+s];
   }
 }
 
 static void pre_dpsi_tensor_bspline(
-    const INT *n, int m, int cutoff,
+    int d, const INT *n, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, R *spline_coeffs,
     R *pre_dpsi
     )
 {
-  const int d=3;
-
-  if(m<9){
-    for(int t=0; t<d; t++){
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    if(m[t]<9){
       /* Bspline is shifted by m */
       R dist = floor_nx[t] - n[t]*x[t] + 0.5;
-      for(int s=0; s<cutoff; s++)
-        pre_dpsi[cutoff*t+s] = -(R)n[t] * PNX(fast_bspline_d)(
-            s-1, dist, 2*m);
+      for(int s=0; s<cutoff[t]; s++)
+        pre_dpsi[o+s] = -(R)n[t] * PNX(fast_bspline_d)(
+            s-1, dist, 2*m[t]);
+      continue;
     }
-    return;
-  }
 
-  for(int t=0; t<d; t++){
-    /* Bspline is shifted by m */
-    R u_j = n[t]*x[t] - floor_nx[t] + m;
-    for(int s=0; s<cutoff; s++)
-      pre_dpsi[cutoff*t+s] = (R)n[t] *
-        ( PNX(bspline)(2*m-1, u_j - (R)s + m, spline_coeffs)
-          - PNX(bspline)(2*m-1, u_j - (R)s + m - 1, spline_coeffs) );
+    /* The derivative is the difference of two B-splines of lower order at neighboring shifts.
+     * Consecutive stencil points share one of them. Bspline is shifted by m */
+    R u_j = n[t]*x[t] - floor_nx[t] + m[t];
+    R b0 = PNX(bspline)(2*m[t]-1, u_j + m[t], spline_coeffs), b1;
+    for(int s=0; s<cutoff[t]; s++){
+      b1 = PNX(bspline)(2*m[t]-1, u_j - (R)s + m[t] - 1, spline_coeffs);
+      pre_dpsi[o+s] = (R)n[t] * (b0 - b1);
+      b0 = b1;
+    }
   }
 }
 
 
 /* The factor n of the window cancels with the factor 1/n from matrix D. */
 static void pre_dpsi_tensor_sinc_power(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, const R *pre_psi,
     R *pre_dpsi
     )
 {
-  const int d=3;
   R u_j, y;
 
-  for(int t=0; t<d; t++){
-    u_j =  n[t]*x[t] - floor_nx[t] + m;
-    for(int s=0; s<cutoff; s++){
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    u_j =  n[t]*x[t] - floor_nx[t] + m[t];
+    for(int s=0; s<cutoff[t]; s++){
       y =  PNFFT_PI * (u_j - s) / b[t];
       if(pnfft_fabs(y) > PNFFT_EPSILON)
-        pre_dpsi[cutoff*t+s] =
-          2.0 * (R)m * PNFFT_PI * (R)n[t] / b[t] * ( 1.0/pnfft_tan(y) - 1.0/y ) * pre_psi[cutoff*t+s];
+        pre_dpsi[o+s] =
+          2.0 * (R)m[t] * PNFFT_PI * (R)n[t] / b[t] * ( 1.0/pnfft_tan(y) - 1.0/y ) * pre_psi[o+s];
       else
-        pre_dpsi[cutoff*t+s] = K(0.0);
+        pre_dpsi[o+s] = K(0.0);
     }
   }
 }
 
 static void pre_dpsi_tensor_bessel_i0(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx,
     R *pre_dpsi
     )
 {
-  const int d=3;
   R u_j;
 
-  for(int t=0; t<d; t++){
-    u_j = n[t]*x[t] - floor_nx[t] + m;
-    for(int s=0; s<cutoff; s++)
-      pre_dpsi[cutoff*t+s] = window_bessel_i0_derivative_1d(
-          (u_j - s) / n[t], n[t], b[t], m);
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    u_j = n[t]*x[t] - floor_nx[t] + m[t];
+    for(int s=0; s<cutoff[t]; s++)
+      pre_dpsi[o+s] = window_bessel_i0_derivative_1d(
+          (u_j - s) / n[t], n[t], b[t], m[t]);
   }
 }
 
 
 static void pre_dpsi_tensor_kaiser_bessel(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
+    const R *x, const R *floor_nx, const R *pre_psi,
+    R *pre_dpsi
+    )
+{
+  R u_j, v, dd, sh, ch;
+
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    u_j = n[t]*x[t] - floor_nx[t] + m[t];
+    for(int s=0; s<cutoff[t]; s++){
+      v = u_j - s;
+      dd = PNFFT_SQR( (R)m[t] ) - v*v;
+      if(dd > 0){
+        /* cosh(b*r) = sqrt(1 + sinh(b*r)^2) with sinh(b*r) = pi*r*psi, r = sqrt(m^2-(n*x)^2) */
+        sh = PNFFT_PI * pnfft_sqrt(dd) * pre_psi[o+s];
+        ch = pnfft_sqrt(1.0 + sh*sh);
+        pre_dpsi[o+s] = n[t]*v/dd * (pre_psi[o+s] - b[t]*ch/PNFFT_PI);
+      } else
+        pre_dpsi[o+s] = kaiser_bessel_derivative_1d(
+            v / n[t],
+            n[t], b[t], m[t], pre_psi[o+s]);
+    }
+  }
+}
+
+static void pre_dpsi_tensor_es(
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, const R *pre_psi,
     R *pre_dpsi
     )
 {
-  const int d=3;
   R u_j;
 
-  for(int t=0; t<d; t++){
-    u_j = n[t]*x[t] - floor_nx[t] + m;
-    for(int s=0; s<cutoff; s++)
-      pre_dpsi[cutoff*t+s] = kaiser_bessel_derivative_1d(
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    u_j = n[t]*x[t] - floor_nx[t] + m[t];
+    for(int s=0; s<cutoff[t]; s++)
+      pre_dpsi[o+s] = es_derivative_1d(
           (u_j - s) / n[t],
-          n[t], b[t], m, pre_psi[cutoff*t+s]);
+          n[t], b[t], m[t], pre_psi[o+s]);
   }
 }
 
 /* switch between direct evaluation and interpolation */
 static void pre_ddpsi_tensor(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, R *spline_coeffs,
     int intpol_order, INT intpol_num_nodes, R **intpol_tables_ddpsi,
+    int poly_degree, R **poly_coeffs_ddpsi,
     const R *pre_psi, const R *pre_dpsi, unsigned pnfft_flags,
     R *pre_ddpsi
     )
 {
-  if(pnfft_flags & PNFFT_PRE_INTPOL_PSI)
+  if(pnfft_flags & PNFFT_PRE_POLY_PSI)
+    pre_tensor_poly(
+        d, n, cutoff, x, floor_nx,
+        poly_degree, poly_coeffs_ddpsi,
+        pre_ddpsi);
+  else if((pnfft_flags & PNFFT_PRE_INTPOL_PSI) && (pnfft_flags & PNFFT_DIFF_INTPOL_PSI) && (intpol_order == 3))
+    pre_tensor_intpol_derivative(
+        d, n, cutoff, x, floor_nx,
+        2, intpol_num_nodes, intpol_tables_ddpsi,
+        pre_ddpsi);
+  else if(pnfft_flags & PNFFT_PRE_INTPOL_PSI)
     pre_tensor_intpol(
-        n, cutoff, x, floor_nx,
+        d, n, cutoff, x, floor_nx,
         intpol_order, intpol_num_nodes, intpol_tables_ddpsi,
         pre_ddpsi);
   else
     pre_ddpsi_tensor_direct(
-        n, b, m, cutoff, x, floor_nx, spline_coeffs,
+        d, n, b, m, cutoff, x, floor_nx, spline_coeffs,
         pre_psi, pre_dpsi, pnfft_flags,
         pre_ddpsi);
+
+  for(int t=0, o=0; t<3; o+=cutoff[t], t++)
+    if(t >= d)
+      pre_ddpsi[o] = K(0.0);
 }
 
 /* calculate window second derivative */
 static void pre_ddpsi_tensor_direct(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, R *spline_coeffs, const R *pre_psi, const R *pre_dpsi,
     unsigned pnfft_flags,
     R *pre_ddpsi
     )
 {
-  if(pnfft_flags & PNFFT_WINDOW_GAUSSIAN)
+  if( ((pre_psi == NULL) || (pre_dpsi == NULL)) && !(pnfft_flags & PNFFT_WINDOW_BSPLINE) )
+    pre_derivative_tensor_closed_form(
+        d, n, b, m, cutoff, x, floor_nx, 2, pnfft_flags,
+        pre_ddpsi);
+  else if(pnfft_flags & PNFFT_WINDOW_GAUSSIAN)
     pre_ddpsi_tensor_gaussian(
-        n, b, m, cutoff, x, floor_nx, pre_psi,
+        d, n, b, m, cutoff, x, floor_nx, pre_psi,
         pre_ddpsi);
   else if(pnfft_flags & PNFFT_WINDOW_BSPLINE)
     pre_ddpsi_tensor_bspline(
-        n, m, cutoff, x, floor_nx, spline_coeffs,
+        d, n, m, cutoff, x, floor_nx, spline_coeffs,
         pre_ddpsi);
   else if(pnfft_flags & PNFFT_WINDOW_SINC_POWER)
     pre_ddpsi_tensor_sinc_power(
-        n, b, m, cutoff, x, floor_nx, pre_psi, pre_dpsi,
+        d, n, b, m, cutoff, x, floor_nx, pre_psi, pre_dpsi,
         pre_ddpsi);
   else if(pnfft_flags & PNFFT_WINDOW_BESSEL_I0)
     pre_ddpsi_tensor_bessel_i0(
-        n, b, m, cutoff, x, floor_nx,
+        d, n, b, m, cutoff, x, floor_nx, pre_psi, pre_dpsi,
+        pre_ddpsi);
+  else if(pnfft_flags & PNFFT_WINDOW_ES)
+    pre_ddpsi_tensor_es(
+        d, n, b, m, cutoff, x, floor_nx, pre_psi,
         pre_ddpsi);
   else
     pre_ddpsi_tensor_kaiser_bessel(
-        n, b, m, cutoff, x, floor_nx, pre_psi, pre_dpsi,
+        d, n, b, m, cutoff, x, floor_nx, pre_psi, pre_dpsi,
         pre_ddpsi);
 }
 
 static void pre_ddpsi_tensor_gaussian(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, const R *fg_psi,
     R *fg_ddpsi
     )
 {
-  const int d=3;
-  R u_j;
+  R u_j, c, c2;
 
-  for(int t=0; t<d; t++){
-    u_j = n[t]*x[t] - floor_nx[t] + m;
-    for(int s=0; s<cutoff; s++)
-      fg_ddpsi[cutoff*t+s] = 2.0*n[t]*n[t]/b[t] * ( 2.0/b[t] * (u_j-s) * (u_j-s) - 1.0 ) * fg_psi[cutoff*t+s];
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    u_j = n[t]*x[t] - floor_nx[t] + m[t];
+    c  = 2.0*n[t]*n[t]/b[t];
+    c2 = 2.0/b[t];
+    for(int s=0; s<cutoff[t]; s++, u_j-=1.0)
+      fg_ddpsi[o+s] = c * ( c2 * u_j * u_j - 1.0 ) * fg_psi[o+s];
   }
 }
 
 static void pre_ddpsi_tensor_bspline(
-    const INT *n, int m, int cutoff,
+    int d, const INT *n, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, R *spline_coeffs,
     R *pre_ddpsi
     )
 {
-  const int d=3;
-
-  if(m<9){
-    for(int t=0; t<d; t++){
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    if(m[t]<9){
       /* Bspline is shifted by m */
       R dist = floor_nx[t] - n[t]*x[t] + 0.5;
-      for(int s=0; s<cutoff; s++)
-	pre_ddpsi[cutoff*t+s] = (R)n[t] * (R)n[t] * PNX(fast_bspline_dd)(s-1, dist, 2*m);
+      for(int s=0; s<cutoff[t]; s++)
+	pre_ddpsi[o+s] = (R)n[t] * (R)n[t] * PNX(fast_bspline_dd)(s-1, dist, 2*m[t]);
+      continue;
     }
-    return;
-  }
 
-  for(int t=0; t<d; t++){
-    /* Bspline is shifted by m */
-    R u_j = n[t]*x[t] - floor_nx[t] + m;
-    for(int s=0; s<cutoff; s++)
-      pre_ddpsi[cutoff*t+s] = (R)n[t] * (R)n[t] *
-        ( PNX(bspline)(2*m-2, u_j - (R)s + m, spline_coeffs)
-	  - 2.0 * PNX(bspline)(2*m-2, u_j - (R)s + m - 1, spline_coeffs)
-          + PNX(bspline)(2*m-2, u_j - (R)s + m - 2, spline_coeffs) );
+    /* second differences of B-splines of lower order, consecutive stencil points share two of them,
+     * Bspline is shifted by m */
+    R u_j = n[t]*x[t] - floor_nx[t] + m[t];
+    R b0 = PNX(bspline)(2*m[t]-2, u_j + m[t], spline_coeffs);
+    R b1 = PNX(bspline)(2*m[t]-2, u_j + m[t] - 1, spline_coeffs), b2;
+    for(int s=0; s<cutoff[t]; s++){
+      b2 = PNX(bspline)(2*m[t]-2, u_j - (R)s + m[t] - 2, spline_coeffs);
+      pre_ddpsi[o+s] = (R)n[t] * (R)n[t] * (b0 - 2.0*b1 + b2);
+      b0 = b1;
+      b1 = b2;
+    }
   }
 }
 
 /* The factor n of the window cancels with the factor 1/n from matrix D. */
 static void pre_ddpsi_tensor_sinc_power(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, const R *pre_psi, const R *pre_dpsi,
     R *pre_ddpsi
     )
 {
-  const int d=3;
-  R u_j, y;
+  R u_j, y, c, g, cot;
 
-  for(int t=0; t<d; t++){
-    u_j =  n[t]*x[t] - floor_nx[t] + m;
-    for(int s=0; s<cutoff; s++){
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    u_j =  n[t]*x[t] - floor_nx[t] + m[t];
+    c = 2.0 * (R)m[t] * PNFFT_PI * (R)n[t] / b[t];
+    for(int s=0; s<cutoff[t]; s++){
       y =  PNFFT_PI * (u_j - s) / b[t];
-      if(pnfft_fabs(y) > PNFFT_EPSILON)
-	pre_ddpsi[cutoff*t+s] = 2.0 * (R)m * PNFFT_PI * (R)n[t] / b[t] * ( 1.0/pnfft_tan(y) - 1.0/y ) * pre_dpsi[cutoff*t+s]
-	  + 2.0 * (R)m * PNFFT_SQR( PNFFT_PI * (R)n[t] / b[t] ) * ( 1.0/(y*y) - 1.0 - 1.0/PNFFT_SQR(pnfft_tan(y)) ) * pre_psi[cutoff*t+s];
-      else
-	pre_ddpsi[cutoff*t+s] = -2.0 * (R)m * PNFFT_SQR( PNFFT_PI * (R)n[t] / b[t] ) / ( 3.0 * b[t] );
+      if(pnfft_fabs(y) > PNFFT_EPSILON){
+        /* reuse cot(y) - 1/y = dpsi/(c*psi) unless psi is too small for the division */
+        if(pnfft_fabs(pre_psi[o+s]) > PNFFT_EPSILON*PNFFT_EPSILON)
+          g = pre_dpsi[o+s] / (c * pre_psi[o+s]);
+        else
+          g = 1.0/pnfft_tan(y) - 1.0/y;
+        cot = g + 1.0/y;
+	pre_ddpsi[o+s] = c * g * pre_dpsi[o+s]
+	  + 2.0 * (R)m[t] * PNFFT_SQR( PNFFT_PI * (R)n[t] / b[t] ) * ( 1.0/(y*y) - 1.0 - cot*cot ) * pre_psi[o+s];
+      } else
+	pre_ddpsi[o+s] = -2.0 * (R)m[t] * PNFFT_SQR( PNFFT_PI * (R)n[t] / b[t] ) / ( 3.0 * b[t] );
     }
   }
 }
 
+/* With I0(b*r) = 2*psi and I1(b*r)/r = -2*dpsi/(b*n*n*x) the second derivative
+ * is a combination of psi and dpsi and no further Bessel function has to be evaluated. */
 static void pre_ddpsi_tensor_bessel_i0(
-    const INT *n, const R *b, int m, int cutoff,
-    const R *x, const R *floor_nx,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
+    const R *x, const R *floor_nx, const R *pre_psi, const R *pre_dpsi,
     R *pre_ddpsi
     )
 {
-  const int d=3;
-  R u_j;
+  R u_j, v, y, dd;
 
-  for(int t=0; t<d; t++){
-    u_j = n[t]*x[t] - floor_nx[t] + m;
-    for(int s=0; s<cutoff; s++)
-      pre_ddpsi[cutoff*t+s] = window_bessel_i0_second_derivative_1d(
-          (u_j - s) / n[t], n[t], b[t], m);
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    u_j = n[t]*x[t] - floor_nx[t] + m[t];
+    for(int s=0; s<cutoff[t]; s++){
+      v = u_j - s;
+      y = v*v;
+      dd = PNFFT_SQR( (R)m[t] ) - y;
+      if( (dd > 0) && (pnfft_fabs(v) > PNFFT_EPSILON) )
+        pre_ddpsi[o+s] = PNFFT_SQR(b[t]*n[t]) * y * pre_psi[o+s] / dd
+          + n[t] * (y + PNFFT_SQR( (R)m[t] )) * pre_dpsi[o+s] / (v*dd);
+      else
+        pre_ddpsi[o+s] = window_bessel_i0_second_derivative_1d(
+            v / n[t], n[t], b[t], m[t]);
+    }
   }
 }
 
 static void pre_ddpsi_tensor_kaiser_bessel(
-    const INT *n, const R *b, int m, int cutoff,
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
     const R *x, const R *floor_nx, const R *pre_psi, const R *pre_dpsi,
     R *pre_ddpsi
     )
 {
-  const int d=3;
+  R u_j, v, dd, sh, ch, psi, dpsi;
+
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    u_j =  n[t]*x[t] - floor_nx[t] + m[t];
+    for(int s=0; s<cutoff[t]; s++){
+      v = u_j - s;
+      dd = PNFFT_SQR( (R)m[t] ) - v*v;
+      psi = pre_psi[o+s];
+      dpsi = pre_dpsi[o+s];
+      if(dd > 0){
+        /* cosh(b*r) = sqrt(1 + sinh(b*r)^2) with sinh(b*r) = pi*r*psi, r = sqrt(m^2-(n*x)^2) */
+        sh = PNFFT_PI * pnfft_sqrt(dd) * psi;
+        ch = pnfft_sqrt(1.0 + sh*sh);
+        pre_ddpsi[o+s] = 3.0*n[t]*v*dpsi/dd + n[t]*n[t]*psi/dd*( 1.0 + PNFFT_SQR(b[t]*v) )
+          - b[t]*n[t]*n[t]/(PNFFT_PI*dd) * ch;
+      } else
+        pre_ddpsi[o+s] = kaiser_bessel_second_derivative_1d( v / n[t], n[t], b[t], m[t], psi, dpsi);
+    }
+  }
+}
+
+static void pre_ddpsi_tensor_es(
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
+    const R *x, const R *floor_nx, const R *pre_psi,
+    R *pre_ddpsi
+    )
+{
   R u_j;
 
-  for(int t=0; t<d; t++){
-    u_j =  n[t]*x[t] - floor_nx[t] + m;
-    for(int s=0; s<cutoff; s++)
-      pre_ddpsi[cutoff*t+s] = kaiser_bessel_second_derivative_1d( (u_j - s) / n[t], n[t], b[t], m, pre_psi[cutoff*t+s], pre_dpsi[cutoff*t+s]);
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    u_j = n[t]*x[t] - floor_nx[t] + m[t];
+    for(int s=0; s<cutoff[t]; s++)
+      pre_ddpsi[o+s] = es_second_derivative_1d(
+          (u_j - s) / n[t],
+          n[t], b[t], m[t], pre_psi[o+s]);
+  }
+}
+
+/* First (der = 1) or second (der = 2) derivative of the window without psi and dpsi on the axes,
+ * e.g. if the nodes hold full tensors of PNFFT_PRE_FULL instead of the values on the axes. */
+static void pre_derivative_tensor_closed_form(
+    int d, const INT *n, const R *b, const int *m, const int *cutoff,
+    const R *x, const R *floor_nx, int der, unsigned pnfft_flags,
+    R *pre_dpsi
+    )
+{
+  R u_j, v;
+
+  for(int t=0, o=0; t<d; o+=cutoff[t], t++){
+    u_j = n[t]*x[t] - floor_nx[t] + m[t];
+    for(int s=0; s<cutoff[t]; s++){
+      v = (u_j - s) / n[t];
+      if(pnfft_flags & PNFFT_WINDOW_GAUSSIAN)
+        pre_dpsi[o+s] = (der == 1) ? dpsi_gaussian(v, n[t], b[t]) : ddpsi_gaussian(v, n[t], b[t]);
+      else if(pnfft_flags & PNFFT_WINDOW_SINC_POWER)
+        pre_dpsi[o+s] = (der == 1) ? dpsi_sinc_power(v, n[t], b[t], m[t]) : ddpsi_sinc_power(v, n[t], b[t], m[t]);
+      else if(pnfft_flags & PNFFT_WINDOW_BESSEL_I0)
+        pre_dpsi[o+s] = (der == 1) ? window_bessel_i0_derivative_1d(v, n[t], b[t], m[t])
+                                   : window_bessel_i0_second_derivative_1d(v, n[t], b[t], m[t]);
+      else if(pnfft_flags & PNFFT_WINDOW_ES)
+        pre_dpsi[o+s] = (der == 1) ? dpsi_es(v, n[t], b[t], m[t]) : ddpsi_es(v, n[t], b[t], m[t]);
+      else
+        pre_dpsi[o+s] = (der == 1) ? dpsi_kaiser(v, n[t], b[t], m[t]) : ddpsi_kaiser(v, n[t], b[t], m[t]);
+    }
   }
 }
 
@@ -2114,25 +2614,25 @@ static void pre_ddpsi_tensor_kaiser_bessel(
  * \arg m window length
  * \arg local_x_num number of nodes
  * \arg local_x nodes array
+ * \arg ar_x_temp scratch array of size 2*local_x_num (radix sort only)
  * \arg ar_x resulting index array
  *
  * \author Toni Volkmer
  */
 static void sort_nodes_for_better_cache_handle(
-    int d, const INT *n, int m, INT local_x_num, const R *local_x,
-    INT *ar_x
+    int d, const INT *n, const int *m, INT local_x_num, const R *local_x,
+    INT *ar_x_temp, INT *ar_x
     )
 {
 #if PNFFT_SORT_RADIX
   INT u_j[d], i, j, help, rhigh;
-  INT *ar_x_temp;
   R nprod;
 
   for(i = 0; i < local_x_num; i++) {
     ar_x[2*i] = 0;
     ar_x[2*i+1] = i;
     for(j = 0; j < d; j++) {
-      help = pnfft_floor( n[j]*local_x[d*i+j] - m);
+      help = pnfft_floor( n[j]*local_x[3*i+j] - m[j]);
       u_j[j] = (help%n[j]+n[j])%n[j];
 
       ar_x[2*i] += u_j[j];
@@ -2146,15 +2646,13 @@ static void sort_nodes_for_better_cache_handle(
 
   rhigh = pnfft_ceil(pnfft_log2(nprod)) - 1;
 
-  ar_x_temp = (INT*) PNX(malloc)(2*local_x_num*sizeof(INT));
   PNX(sort_node_indices_radix_lsdf)(local_x_num, ar_x, ar_x_temp, rhigh);
 #  ifdef OMP_ASSERT
   for (i = 1; i < local_x_num; i++)
     assert(ar_x[2*(i-1)] <= ar_x[2*i]);
 #  endif
-  PNX(free)(ar_x_temp);
 #else
-  PNX(sort_nodes_indices_qsort_3d)(n, m, local_x_num, local_x, ar_x);
+  PNX(sort_nodes_indices_qsort_3d)(d, n, m, local_x_num, local_x, ar_x);
 #endif
 }
 
@@ -2163,13 +2661,19 @@ static void sort_nodes_for_better_cache_handle(
 
 
 static void project_node_to_grid(
-    const INT *n, int m, const R *x,
+    int d, const INT *n, const int *m, const R *x,
     R *floor_nx_j, INT *u_j
     )
 {
-  for(int t=0; t<3; t++){
+  for(int t=0; t<d; t++){
     floor_nx_j[t] = pnfft_floor(n[t]*x[t]);
-    u_j[t] = (INT) floor_nx_j[t] - m;
+    u_j[t] = (INT) floor_nx_j[t] - m[t];
+  }
+
+  /* trivial axes of plans with d < 3 */
+  for(int t=d; t<3; t++){
+    floor_nx_j[t] = 0;
+    u_j[t] = 0;
   }
 }
 
@@ -2284,6 +2788,46 @@ static R kaiser_bessel_second_derivative_1d(
   return (d>0) ? 3.0*n*n*x*dpsi/d + n*n*psi/d*( 1.0 + PNFFT_SQR(b*n*x) ) - b*n*n/(PNFFT_PI*d)*pnfft_cosh(b*r) : b*PNFFT_SQR(b*n)/(15.0*PNFFT_PI)*(PNFFT_SQR(b*m)-5.0);
 }
 
+/* "exponential of semicircle" window psi(x) = exp(b*(sqrt(1-(n*x/m)^2)-1)) with compact support */
+static R es_1d(
+    R x, INT n, R b, int m
+    )
+{
+  R d = 1.0 - PNFFT_SQR( x*n/m );
+
+  /* Compact support in real space */
+  return (d<0) ? 0.0 : pnfft_exp( b*(pnfft_sqrt(d)-1.0) );
+}
+
+static R es_derivative_1d(
+    R x, INT n, R b, int m, R psi
+    )
+{
+  R d = 1.0 - PNFFT_SQR( x*n/m );
+
+  /* Compact support in real space, the derivative is singular at the border of the support */
+  if(d<=0)
+    return 0.0;
+
+  return -b*n*n*x / (m*m*pnfft_sqrt(d)) * psi;
+}
+
+static R es_second_derivative_1d(
+    R x, INT n, R b, int m, R psi
+    )
+{
+  R d = 1.0 - PNFFT_SQR( x*n/m );
+
+  /* Compact support in real space, the derivative is singular at the border of the support */
+  if(d<=0)
+    return 0.0;
+
+  R r = pnfft_sqrt(d);
+  R g1 = -b*n*x / (m*m*r);   /* first derivative of exponent w.r.t. n*x */
+  R g2 = -b / (m*m*d*r);     /* second derivative of exponent w.r.t. n*x */
+  return (R)n*n * (g2 + g1*g1) * psi;
+}
+
 
 R PNX(psi)(
     const PNX(plan) ths, int dim, R x
@@ -2292,13 +2836,15 @@ R PNX(psi)(
   if(ths->pnfft_flags & PNFFT_WINDOW_GAUSSIAN)
     return psi_gaussian(x, ths->n[dim], ths->b[dim]);
   else if(ths->pnfft_flags & PNFFT_WINDOW_BSPLINE)
-    return psi_bspline(x, ths->n[dim], ths->m, ths->spline_coeffs);
+    return psi_bspline(x, ths->n[dim], ths->m_dim[dim], ths->spline_coeffs);
   else if(ths->pnfft_flags & PNFFT_WINDOW_SINC_POWER)
-    return psi_sinc_power(x, ths->n[dim], ths->b[dim], ths->m);
+    return psi_sinc_power(x, ths->n[dim], ths->b[dim], ths->m_dim[dim]);
   else if(ths->pnfft_flags & PNFFT_WINDOW_BESSEL_I0)
-    return psi_bessel_i0(x, ths->n[dim], ths->b[dim], ths->m);
+    return psi_bessel_i0(x, ths->n[dim], ths->b[dim], ths->m_dim[dim]);
+  else if(ths->pnfft_flags & PNFFT_WINDOW_ES)
+    return psi_es(x, ths->n[dim], ths->b[dim], ths->m_dim[dim]);
   else
-    return psi_kaiser(x, ths->n[dim], ths->b[dim], ths->m);
+    return psi_kaiser(x, ths->n[dim], ths->b[dim], ths->m_dim[dim]);
 }
 
 R PNX(dpsi)(
@@ -2308,13 +2854,15 @@ R PNX(dpsi)(
   if(ths->pnfft_flags & PNFFT_WINDOW_GAUSSIAN)
     return dpsi_gaussian(x, ths->n[dim], ths->b[dim]);
   else if(ths->pnfft_flags & PNFFT_WINDOW_BSPLINE)
-    return dpsi_bspline(x, ths->n[dim], ths->m, ths->spline_coeffs);
+    return dpsi_bspline(x, ths->n[dim], ths->m_dim[dim], ths->spline_coeffs);
   else if(ths->pnfft_flags & PNFFT_WINDOW_SINC_POWER)
-    return dpsi_sinc_power(x, ths->n[dim], ths->b[dim], ths->m);
+    return dpsi_sinc_power(x, ths->n[dim], ths->b[dim], ths->m_dim[dim]);
   else if(ths->pnfft_flags & PNFFT_WINDOW_BESSEL_I0)
-    return dpsi_bessel_i0(x, ths->n[dim], ths->b[dim], ths->m);
+    return dpsi_bessel_i0(x, ths->n[dim], ths->b[dim], ths->m_dim[dim]);
+  else if(ths->pnfft_flags & PNFFT_WINDOW_ES)
+    return dpsi_es(x, ths->n[dim], ths->b[dim], ths->m_dim[dim]);
   else
-    return dpsi_kaiser(x, ths->n[dim], ths->b[dim], ths->m);
+    return dpsi_kaiser(x, ths->n[dim], ths->b[dim], ths->m_dim[dim]);
 }
 
 R PNX(ddpsi)(
@@ -2324,13 +2872,15 @@ R PNX(ddpsi)(
   if(ths->pnfft_flags & PNFFT_WINDOW_GAUSSIAN)
     return ddpsi_gaussian(x, ths->n[dim], ths->b[dim]);
   else if(ths->pnfft_flags & PNFFT_WINDOW_BSPLINE)
-    return ddpsi_bspline(x, ths->n[dim], ths->m, ths->spline_coeffs);
+    return ddpsi_bspline(x, ths->n[dim], ths->m_dim[dim], ths->spline_coeffs);
   else if(ths->pnfft_flags & PNFFT_WINDOW_SINC_POWER)
-    return ddpsi_sinc_power(x, ths->n[dim], ths->b[dim], ths->m);
+    return ddpsi_sinc_power(x, ths->n[dim], ths->b[dim], ths->m_dim[dim]);
   else if(ths->pnfft_flags & PNFFT_WINDOW_BESSEL_I0)
-    return ddpsi_bessel_i0(x, ths->n[dim], ths->b[dim], ths->m);
+    return ddpsi_bessel_i0(x, ths->n[dim], ths->b[dim], ths->m_dim[dim]);
+  else if(ths->pnfft_flags & PNFFT_WINDOW_ES)
+    return ddpsi_es(x, ths->n[dim], ths->b[dim], ths->m_dim[dim]);
   else
-    return ddpsi_kaiser(x, ths->n[dim], ths->b[dim], ths->m);
+    return ddpsi_kaiser(x, ths->n[dim], ths->b[dim], ths->m_dim[dim]);
 }
 
 
@@ -2463,14 +3013,36 @@ static R ddpsi_kaiser(
       x, n, b, m, psi, dpsi);
 }
 
+static R psi_es(
+    R x, INT n, R b, int m
+    )
+{
+  return es_1d(x, n, b, m);
+}
+
+static R dpsi_es(
+    R x, INT n, R b, int m
+    )
+{
+  return es_derivative_1d(
+      x, n, b, m, es_1d(x, n, b, m));
+}
+
+static R ddpsi_es(
+    R x, INT n, R b, int m
+    )
+{
+  return es_second_derivative_1d(
+      x, n, b, m, es_1d(x, n, b, m));
+}
+
 
 /* Alternative sorting based on C standard qsort */
 void PNX(sort_nodes_indices_qsort_3d)(
-    const INT *n, int m, INT local_M, const R *x,
+    int d, const INT *n, const int *m, INT local_M, const R *x,
     INT *sort
     )
 { /* sort must be of length 2*local_M */
-  int d = 3;
   INT u_j[3];
   R floor_nx_j[3];
 
@@ -2478,7 +3050,7 @@ void PNX(sort_nodes_indices_qsort_3d)(
     return;
 
   for(INT k = 0; k < local_M; k++){
-    project_node_to_grid(n, m, x+d*k, floor_nx_j, u_j);
+    project_node_to_grid(d, n, m, x+3*k, floor_nx_j, u_j);
     sort[2*k]   = PNFFT_PLAIN_INDEX_3D(u_j, n);
     sort[2*k+1] = k;
   }
@@ -2524,10 +3096,11 @@ void PNX(trafo_B_ad)(
     int use_interlacing, int interlaced, unsigned compute_flags
     )
 {
-  INT *sorted_index = NULL;
+  INT *sorted_index = NULL, *sort_temp = NULL;
   INT local_no[3], local_no_start[3];
   INT gcells_below[3], gcells_above[3];
   INT local_ngc[3];
+  const size_t mark = PNX(workspace_mark)(ths);
  
   local_size_B(ths,
       local_no, local_no_start);
@@ -2539,10 +3112,10 @@ void PNX(trafo_B_ad)(
 #endif
 
   /* perform fftshift */
-  PNFFT_START_TIMING(ths->comm_cart, ths->timer_trafo[PNFFT_TIMER_SHIFT_INPUT]);
-  PNFFT_FINISH_TIMING(ths->timer_trafo[PNFFT_TIMER_SHIFT_INPUT]);
+  PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_SHIFT_INPUT);
+  PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_SHIFT_INPUT);
 
-  get_size_gcells(ths->m, ths->cutoff, ths->pnfft_flags,
+  get_size_gcells(ths->d, ths->m_dim, ths->cutoff_dim, ths->pnfft_flags,
       gcells_below, gcells_above);
   local_array_size(local_no, gcells_below, gcells_above,
       local_ngc);
@@ -2554,9 +3127,10 @@ void PNX(trafo_B_ad)(
 #endif
 
   /* send ghost cells in ring */
-  PNFFT_START_TIMING(ths->comm_cart, ths->timer_trafo[PNFFT_TIMER_GCELLS]);
+  PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_GCELLS);
   PX(exchange)(ths->gcplan);
-  PNFFT_FINISH_TIMING(ths->timer_trafo[PNFFT_TIMER_GCELLS]);
+  PNX(count_gcells)(ths, ths->counter_trafo, local_no, local_ngc);
+  PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_GCELLS);
 
 #if PNFFT_ENABLE_DEBUG
   PNX(debug_sum_print)(ths->g2, PNX(prod_INT)(3, local_ngc),
@@ -2571,12 +3145,15 @@ void PNX(trafo_B_ad)(
 
   /* sort indices for better cache handling */
   if(ths->pnfft_flags & PNFFT_SORT_NODES){
-    PNFFT_START_TIMING(ths->comm_cart, ths->timer_trafo[PNFFT_TIMER_SORT_NODES]);
-    sorted_index = (INT*) PNX(malloc)(sizeof(INT) * (size_t) 2*nodes->local_M);
+    PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_SORT_NODES);
+    sorted_index = (INT*) PNX(workspace_get)(ths, sizeof(INT) * (size_t) 2*nodes->local_M);
+#if PNFFT_SORT_RADIX
+    sort_temp = (INT*) PNX(workspace_get)(ths, sizeof(INT) * (size_t) 2*nodes->local_M);
+#endif
     sort_nodes_for_better_cache_handle(
-        ths->d, ths->n, ths->m, nodes->local_M, nodes->x,
-        sorted_index);
-    PNFFT_FINISH_TIMING(ths->timer_trafo[PNFFT_TIMER_SORT_NODES]);
+        ths->d, ths->n, ths->m_dim, nodes->local_M, nodes->x,
+        sort_temp, sorted_index);
+    PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_SORT_NODES);
   }
 
 #if PNFFT_ENABLE_DEBUG
@@ -2584,12 +3161,12 @@ void PNX(trafo_B_ad)(
       "PNFFT: Sum of x after sort");
 #endif
 
-  PNFFT_START_TIMING(ths->comm_cart, ths->timer_trafo[PNFFT_TIMER_LOOP_B]);
+  PNFFT_START_STAGE(ths, timer_trafo, PNFFT_TIMER_LOOP_B);
   loop_over_particles_trafo(
       ths, nodes, f, grad_f, hessian_f, offset, stride,
       local_no_start, local_ngc, gcells_below,
       use_interlacing, interlaced, compute_flags, sorted_index);
-  PNFFT_FINISH_TIMING(ths->timer_trafo[PNFFT_TIMER_LOOP_B]);
+  PNFFT_FINISH_STAGE(ths, timer_trafo, PNFFT_TIMER_LOOP_B);
 
 #if PNFFT_ENABLE_DEBUG
   PNX(debug_sum_print)(f, nodes->local_M,
@@ -2603,8 +3180,7 @@ void PNX(trafo_B_ad)(
   }
 #endif
   
-  if(sorted_index != NULL)
-    PNX(free)(sorted_index);
+  PNX(workspace_release)(ths, mark);
 }
 
 void PNX(adjoint_B_ad)(
@@ -2613,26 +3189,24 @@ void PNX(adjoint_B_ad)(
     int use_interlacing, int interlaced, unsigned compute_flags
     )
 {
-  INT *sorted_index = NULL;
+  INT *sorted_index = NULL, *sort_temp = NULL;
   INT local_no[3], local_no_start[3];
   INT gcells_below[3], gcells_above[3];
   INT local_ngc[3], local_ngc_total;
+  const size_t mark = PNX(workspace_mark)(ths);
 
   local_size_B(ths,
       local_no, local_no_start);
 
-  get_size_gcells(ths->m, ths->cutoff, ths->pnfft_flags,
+  get_size_gcells(ths->d, ths->m_dim, ths->cutoff_dim, ths->pnfft_flags,
       gcells_below, gcells_above);
   local_array_size(local_no, gcells_below, gcells_above,
       local_ngc);
 
   local_ngc_total = PNX(prod_INT)(3, local_ngc);
-  if (ths->trafo_flag & PNFFTI_TRAFO_C2R)
-    for(INT k=0; k<local_ngc_total; k++)
-      ths->g2[k] = 0;
-  else
-    for(INT k=0; k<local_ngc_total; k++)
-      ((C*)ths->g2)[k] = 0;
+  PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_ZERO);
+  PNX(zero_parallel)(ths->g2, (ths->trafo_flag & PNFFTI_TRAFO_C2R) ? local_ngc_total : 2*local_ngc_total);
+  PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_ZERO);
 
 #if PNFFT_ENABLE_DEBUG
   PNX(debug_sum_print)(nodes->x, 3*nodes->local_M, 0,
@@ -2641,12 +3215,15 @@ void PNX(adjoint_B_ad)(
 
   /* sort indices for better cache handling */
   if(ths->pnfft_flags & PNFFT_SORT_NODES){
-    PNFFT_START_TIMING(ths->comm_cart, ths->timer_adj[PNFFT_TIMER_SORT_NODES]);
-    sorted_index = (INT*) PNX(malloc)(sizeof(INT) * (size_t) 2*nodes->local_M);
+    PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_SORT_NODES);
+    sorted_index = (INT*) PNX(workspace_get)(ths, sizeof(INT) * (size_t) 2*nodes->local_M);
+#if PNFFT_SORT_RADIX
+    sort_temp = (INT*) PNX(workspace_get)(ths, sizeof(INT) * (size_t) 2*nodes->local_M);
+#endif
     sort_nodes_for_better_cache_handle(
-        ths->d, ths->n, ths->m, nodes->local_M, nodes->x,
-        sorted_index);
-    PNFFT_FINISH_TIMING(ths->timer_adj[PNFFT_TIMER_SORT_NODES]);
+        ths->d, ths->n, ths->m_dim, nodes->local_M, nodes->x,
+        sort_temp, sorted_index);
+    PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_SORT_NODES);
   }
   
 #if PNFFT_ENABLE_DEBUG
@@ -2658,7 +3235,7 @@ void PNX(adjoint_B_ad)(
       "PNFFT^H: Sum of f");
 #endif
   
-  PNFFT_START_TIMING(ths->comm_cart, ths->timer_adj[PNFFT_TIMER_LOOP_B]);
+  PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_LOOP_B);
   loop_over_particles_adj(
       ths, nodes, f, grad_f, offset, stride,
       local_no_start, local_ngc, gcells_below,
@@ -2666,7 +3243,7 @@ void PNX(adjoint_B_ad)(
   /* TODO: - try to optimize for real values inputs
    *       - combine two r2c FFTs in one c2c FFT
    *       - problem: with parallel domain decomposition its hard to use Hermitian symmetry in order to restore the two separate FFT outputs */
-  PNFFT_FINISH_TIMING(ths->timer_adj[PNFFT_TIMER_LOOP_B]);
+  PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_LOOP_B);
 
 #if PNFFT_ENABLE_DEBUG
   PNX(debug_sum_print)(ths->g2, local_ngc_total,
@@ -2675,9 +3252,10 @@ void PNX(adjoint_B_ad)(
 #endif  
 
   /* reduce ghost cells in ring */
-  PNFFT_START_TIMING(ths->comm_cart, ths->timer_adj[PNFFT_TIMER_GCELLS]);
+  PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_GCELLS);
   PX(reduce)(ths->gcplan);
-  PNFFT_FINISH_TIMING(ths->timer_adj[PNFFT_TIMER_GCELLS]);
+  PNX(count_gcells)(ths, ths->counter_adj, local_no, local_ngc);
+  PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_GCELLS);
 
 #if PNFFT_ENABLE_DEBUG
   PNX(debug_sum_print)(ths->g2, local_no[0]*local_no[1]*local_no[2],
@@ -2686,9 +3264,9 @@ void PNX(adjoint_B_ad)(
 #endif
 
   /* perform fftshift */
-  PNFFT_START_TIMING(ths->comm_cart, ths->timer_adj[PNFFT_TIMER_SHIFT_INPUT]);
+  PNFFT_START_STAGE(ths, timer_adj, PNFFT_TIMER_SHIFT_INPUT);
 //   if(ths->pnfft_flags & PNFFT_SHIFTED_IN)
-  PNFFT_FINISH_TIMING(ths->timer_adj[PNFFT_TIMER_SHIFT_INPUT]);
+  PNFFT_FINISH_STAGE(ths, timer_adj, PNFFT_TIMER_SHIFT_INPUT);
 
 #if PNFFT_ENABLE_DEBUG
   PNX(debug_sum_print)(ths->g2, local_no[0]*local_no[1]*local_no[2],
@@ -2696,8 +3274,7 @@ void PNX(adjoint_B_ad)(
       "PNFFT^H: Sum of Fourier coefficients after twiddles");
 #endif
   
-  if(sorted_index != NULL)
-    PNX(free)(sorted_index);
+  PNX(workspace_release)(ths, mark);
 }
 
 static void loop_over_particles_trafo(
@@ -2709,168 +3286,239 @@ static void loop_over_particles_trafo(
     )
 {
   const int cutoff = ths->cutoff;
-  INT j, m0, u_j[3];
-  R floor_nx_j[3];
-  R *pre_psi = NULL, *pre_dpsi = NULL, *pre_ddpsi = NULL;
-  R x[3];
+  const INT sum_cutoff = PNFFT_SUM3(ths->cutoff_dim);
+  const unsigned pre = nodes->precompute_flags;
+  /* derivatives that are not precomputed need psi and dpsi on the axes */
+  const int need_ddpsi = (~pre & PNFFT_PRE_HESSIAN_PSI) && (compute_flags & PNFFT_COMPUTE_HESSIAN_F);
+  const int need_dpsi = need_ddpsi
+    || ((~pre & PNFFT_PRE_GRAD_PSI) && (compute_flags & (PNFFT_COMPUTE_GRAD_F | PNFFT_COMPUTE_HESSIAN_F)));
+  const int need_psi = (~pre & PNFFT_PRE_PSI) || need_dpsi;
+  /* precomputed values on the axes are reused, full tensors of PNFFT_PRE_FULL are not */
+  R *node_psi  = (interlaced) ? nodes->pre_psi_il  : nodes->pre_psi;
+  R *node_dpsi = (interlaced) ? nodes->pre_dpsi_il : nodes->pre_dpsi;
+  const int eval_psi = need_psi
+    && ((~pre & PNFFT_PRE_PSI) || (pre & PNFFT_PRE_FULL) || (node_psi == NULL));
+  const int eval_dpsi = need_dpsi
+    && ((~pre & PNFFT_PRE_GRAD_PSI) || (pre & PNFFT_PRE_FULL) || (node_dpsi == NULL));
+  const int use_batch = eval_psi && PNX(window_batch_supported)(ths->pnfft_flags);
+  const int batch = PNFFT_WINDOW_BATCH;
+  INT j, m0, u_b[3*PNFFT_WINDOW_BATCH];
+  R floor_nx_b[3*PNFFT_WINDOW_BATCH];
+  R *pre_psi_b = NULL, *pre_dpsi_b = NULL, *pre_ddpsi_b = NULL, *batch_buf = NULL;
+  R x_b[3*PNFFT_WINDOW_BATCH];
+  double t_index = 0, t_window = 0, t_grid = 0, t_scale;
+  const size_t mark = PNX(workspace_mark)(ths);
 #if PNFFT_ENABLE_DEBUG
   R rsum=0.0, rsum_d=0.0, rsum_dd=0.0, grsum, grsum_d, grsum_dd;
 #endif
 
-  if( ~nodes->precompute_flags & PNFFT_PRE_PSI )
-    pre_psi = (R*) PNX(malloc)(sizeof(R) * (size_t) cutoff*3);
-  if( ~nodes->precompute_flags & PNFFT_PRE_GRAD_PSI )
-    if(compute_flags & (PNFFT_COMPUTE_GRAD_F | PNFFT_COMPUTE_HESSIAN_F))
-      pre_dpsi = (R*) PNX(malloc)(sizeof(R) * (size_t) cutoff*3);
-  if( ~nodes->precompute_flags & PNFFT_PRE_HESSIAN_PSI )
-    if(compute_flags & PNFFT_COMPUTE_HESSIAN_F)
-      pre_ddpsi = (R*) PNX(malloc)(sizeof(R) * (size_t) cutoff*3);
-  
-  for(INT p=0; p<nodes->local_M; p++){
-    j = (ths->pnfft_flags & PNFFT_SORT_NODES) ? sorted_index[2*p+1] : p;
-    
-    /* shift x by half the mesh width for interlacing */
-    for(int t=0; t<3; t++){
-      x[t] = nodes->x[ths->d*j+t];
-      if(interlaced)
-        x[t] += 0.5/ths->n[t];
-    }
-
-    /* We need to compute the lowest summation index before we fold x back into [-0.5,0.5).
-     * Otherwise u_j may be also folded and gets less than the local offset local_no_start. */
-    lowest_summation_index(
-        ths->n, ths->m, x, local_no_start, gcells_below,
-        floor_nx_j, u_j);
-    
-    /* assure -0.5 <= x < 0.5 */
-    if(interlaced){
+  if( !need_psi || eval_psi )
+    node_psi = NULL;
+  if( !need_dpsi || eval_dpsi )
+    node_dpsi = NULL;
+
+  if( eval_psi )
+    pre_psi_b = (R*) PNX(workspace_get)(ths, sizeof(R) * (size_t) cutoff*3*batch);
+  if( use_batch )
+    batch_buf = (R*) PNX(workspace_get)(ths, sizeof(R) * (size_t) cutoff*3*PNFFT_WINDOW_BATCH);
+  if( eval_dpsi )
+    pre_dpsi_b = (R*) PNX(workspace_get)(ths, sizeof(R) * (size_t) cutoff*3*batch);
+  if( need_ddpsi )
+    pre_ddpsi_b = (R*) PNX(workspace_get)(ths, sizeof(R) * (size_t) cutoff*3*batch);
+
+  /* Index computation, window evaluation and grid access run in separate passes over
+   * each batch, such that the sub-stages can be timed with a few calls of MPI_Wtime per batch.
+   * Only every PNFFT_SUBSTAGE_SAMPLE-th batch is timed, the sums are scaled afterwards. */
+  for(INT p0=0; p0<nodes->local_M; p0+=batch){
+    const int num = (int) PNFFT_MIN(batch, nodes->local_M - p0);
+    const int sampled = PNFFT_SUBSTAGE_SAMPLED(p0/batch);
+
+    PNFFT_START_SUBSTAGE(t_index, sampled)
+    for(int q=0; q<num; q++){
+      R *x = x_b + 3*q, *floor_nx_j = floor_nx_b + 3*q;
+      j = (ths->pnfft_flags & PNFFT_SORT_NODES) ? sorted_index[2*(p0+q)+1] : p0+q;
+
+      /* shift x by half the mesh width for interlacing,
+       * components d <= t < 3 of the nodes are ignored */
       for(int t=0; t<3; t++){
-        if(x[t] >= 0.5){
-          x[t] -= 1.0;
-          floor_nx_j[t] -= ths->n[t];
+        x[t] = (t < ths->d) ? nodes->x[3*j+t] : 0;
+        if(interlaced && (t < ths->d))
+          x[t] += 0.5/ths->n[t];
+      }
+
+      /* We need to compute the lowest summation index before we fold x back into [-0.5,0.5).
+       * Otherwise u_j may be also folded and gets less than the local offset local_no_start. */
+      lowest_summation_index(
+          ths->d, ths->n, ths->m_dim, x, local_no_start, gcells_below,
+          floor_nx_j, u_b + 3*q);
+
+      /* assure -0.5 <= x < 0.5 */
+      if(interlaced){
+        for(int t=0; t<ths->d; t++){
+          if(x[t] >= 0.5){
+            x[t] -= 1.0;
+            floor_nx_j[t] -= ths->n[t];
+          }
         }
       }
     }
 
-    /* evaluate window on axes */
-    if( ~nodes->precompute_flags & PNFFT_PRE_PSI ){
-      pre_psi_tensor(
-          ths->n, ths->b, ths->m, ths->cutoff, x, floor_nx_j,
-          ths->exp_const, ths->spline_coeffs, ths->pnfft_flags,
-          ths->intpol_order, ths->intpol_num_nodes, ths->intpol_tables_psi,
-          pre_psi);
+    PNFFT_FINISH_SUBSTAGE(t_index, sampled)
+
+    /* evaluate window on axes for all particles of the batch at once */
+    PNFFT_START_SUBSTAGE(t_window, sampled)
+    if(use_batch)
+      PNX(pre_psi_tensor_batch)(
+          ths, num, x_b, floor_nx_b, batch_buf,
+          pre_psi_b);
+
+    for(int q=0; q<num; q++){
+      INT p = p0 + q;
+      R *x = x_b + 3*q, *floor_nx_j = floor_nx_b + 3*q;
+      R *pre_psi = (pre_psi_b != NULL) ? pre_psi_b + 3*cutoff*q : (node_psi != NULL) ? node_psi + p*sum_cutoff : NULL;
+      R *pre_dpsi = (pre_dpsi_b != NULL) ? pre_dpsi_b + 3*cutoff*q : (node_dpsi != NULL) ? node_dpsi + p*sum_cutoff : NULL;
+      R *pre_ddpsi = (pre_ddpsi_b != NULL) ? pre_ddpsi_b + 3*cutoff*q : NULL;
+
+      /* evaluate window on axes */
+      if( eval_psi ){
+        if(!use_batch)
+          pre_psi_tensor(
+              ths->d, ths->n, ths->b, ths->m_dim, ths->cutoff_dim, x, floor_nx_j,
+              ths->exp_const, ths->spline_coeffs, ths->pnfft_flags,
+              ths->intpol_order, ths->intpol_num_nodes, ths->intpol_tables_psi,
+              ths->poly_degree, ths->poly_coeffs_psi,
+              pre_psi);
   
 #if PNFFT_ENABLE_DEBUG
-      /* Don't want to use PNX(debug_sum_print) because we are in a loop */
-      for(int t=0; t<3*cutoff; t++)
-        rsum += pnfft_fabs(pre_psi[t]);
+        /* Don't want to use PNX(debug_sum_print) because we are in a loop */
+        for(int t=0; t<PNFFT_SUM3(ths->cutoff_dim); t++)
+          rsum += pnfft_fabs(pre_psi[t]);
 #endif
-    }
+      }
  
-    if( ~nodes->precompute_flags & PNFFT_PRE_GRAD_PSI ){
-      if( compute_flags & (PNFFT_COMPUTE_GRAD_F | PNFFT_COMPUTE_HESSIAN_F) )
+      if( eval_dpsi ){
         pre_dpsi_tensor(
-            ths->n, ths->b, ths->m, ths->cutoff, x, floor_nx_j, ths->spline_coeffs,
+            ths->d, ths->n, ths->b, ths->m_dim, ths->cutoff_dim, x, floor_nx_j, ths->spline_coeffs,
             ths->intpol_order, ths->intpol_num_nodes, ths->intpol_tables_dpsi,
+            ths->poly_degree, ths->poly_coeffs_dpsi,
             pre_psi, ths->pnfft_flags,
             pre_dpsi);
 
 #if PNFFT_ENABLE_DEBUG
         /* Don't want to use PNX(debug_sum_print) because we are in a loop */
-        for(int t=0; t<3*cutoff; t++)
+        for(int t=0; t<PNFFT_SUM3(ths->cutoff_dim); t++)
           rsum_d += pnfft_fabs(pre_dpsi[t]);
 #endif
-    }
+      }
 
-    if( ~nodes->precompute_flags & PNFFT_PRE_HESSIAN_PSI ) {
-      if(compute_flags & PNFFT_COMPUTE_HESSIAN_F)
+      if( need_ddpsi ){
         pre_ddpsi_tensor(
-            ths->n, ths->b, ths->m, ths->cutoff, x, floor_nx_j, ths->spline_coeffs,
+            ths->d, ths->n, ths->b, ths->m_dim, ths->cutoff_dim, x, floor_nx_j, ths->spline_coeffs,
             ths->intpol_order, ths->intpol_num_nodes, ths->intpol_tables_ddpsi,
+            ths->poly_degree, ths->poly_coeffs_ddpsi,
             pre_psi, pre_dpsi, ths->pnfft_flags,
             pre_ddpsi);
 
 #if PNFFT_ENABLE_DEBUG
         /* Don't want to use PNX(debug_sum_print) because we are in a loop */
-        for(int t=0; t<3*cutoff; t++)
+        for(int t=0; t<PNFFT_SUM3(ths->cutoff_dim); t++)
           rsum_dd += pnfft_fabs(pre_ddpsi[t]);
 #endif
+      }
     }
+    PNFFT_FINISH_SUBSTAGE(t_window, sampled)
+
+    /* add the window weighted grid values to the nodes */
+    PNFFT_START_SUBSTAGE(t_grid, sampled)
+    for(int q=0; q<num; q++){
+      INT p = p0 + q, *u_j = u_b + 3*q;
+      R *pre_psi = (pre_psi_b != NULL) ? pre_psi_b + 3*cutoff*q : (node_psi != NULL) ? node_psi + p*sum_cutoff : NULL;
+      R *pre_dpsi = (pre_dpsi_b != NULL) ? pre_dpsi_b + 3*cutoff*q : (node_dpsi != NULL) ? node_dpsi + p*sum_cutoff : NULL;
+      R *pre_ddpsi = (pre_ddpsi_b != NULL) ? pre_ddpsi_b + 3*cutoff*q : NULL;
+      j = (ths->pnfft_flags & PNFFT_SORT_NODES) ? sorted_index[2*p+1] : p;
+
+      INT ind = j*stride + offset;
+      m0 = PNFFT_PLAIN_INDEX_3D(u_j, local_ngc);
+      if(compute_flags & PNFFT_COMPUTE_F && compute_flags & PNFFT_COMPUTE_GRAD_F){
+        /* compute f and grad_f at once */
+        if(ths->pnfft_flags & PNFFT_REAL_F)
+          PNX(assign_f_and_grad_f_r2r)(
+              ths, nodes, p, ths->g2, pre_psi, pre_dpsi,
+              2*m0, local_ngc, ths->cutoff_dim, 2, 2, use_interlacing, interlaced,
+              f + 2*ind, grad_f + 2*3*ind);
+        else if(ths->trafo_flag & PNFFTI_TRAFO_C2R)
+          PNX(assign_f_and_grad_f_r2r)(
+              ths, nodes, p, ths->g2, pre_psi, pre_dpsi,
+              m0, local_ngc, ths->cutoff_dim, 1, 1, use_interlacing, interlaced,
+              f + ind, grad_f + 3*ind);
+        else
+          PNX(assign_f_and_grad_f_c2c)(
+              ths, nodes, p, (C*)ths->g2, pre_psi, pre_dpsi,
+              m0, local_ngc, ths->cutoff_dim, use_interlacing, interlaced,
+              (C*)f + ind, (C*)grad_f + 3*ind);
+      } else if(compute_flags & PNFFT_COMPUTE_F){
+        /* compute f */
+        if(ths->pnfft_flags & PNFFT_REAL_F)
+          PNX(assign_f_r2r)(
+              ths, nodes, p, ths->g2, pre_psi,
+              2*m0, local_ngc, ths->cutoff_dim, 2, use_interlacing, interlaced,
+              f + 2*ind);
+        else if(ths->trafo_flag & PNFFTI_TRAFO_C2R)
+          PNX(assign_f_r2r)(
+              ths, nodes, p, ths->g2, pre_psi,
+              m0, local_ngc, ths->cutoff_dim, 1, use_interlacing, interlaced,
+              f + ind);
+        else
+          PNX(assign_f_c2c)(
+              ths, nodes, p, (C*)ths->g2, pre_psi,
+              m0, local_ngc, ths->cutoff_dim, use_interlacing, interlaced,
+              (C*)f + ind);
+      } else if(compute_flags & PNFFT_COMPUTE_GRAD_F){
+        /* compute grad_f */
+        if(ths->pnfft_flags & PNFFT_REAL_F)
+          PNX(assign_grad_f_r2r)(
+              ths, nodes, p, ths->g2, pre_psi, pre_dpsi,
+              2*m0, local_ngc, ths->cutoff_dim, 2, 2, use_interlacing, interlaced,
+              grad_f + 2*3*ind);
+        else if(ths->trafo_flag & PNFFTI_TRAFO_C2R)
+          PNX(assign_grad_f_r2r)(
+              ths, nodes, p, ths->g2, pre_psi, pre_dpsi,
+              m0, local_ngc, ths->cutoff_dim, 1, 1, use_interlacing, interlaced,
+              grad_f + 3*ind);
+        else
+          PNX(assign_grad_f_c2c)(
+              ths, nodes, p, (C*)ths->g2, pre_psi, pre_dpsi,
+              m0, local_ngc, ths->cutoff_dim, use_interlacing, interlaced,
+              (C*)grad_f + 3*ind);
+      }
 
-    INT ind = j*stride + offset;
-    m0 = PNFFT_PLAIN_INDEX_3D(u_j, local_ngc);
-    if(compute_flags & PNFFT_COMPUTE_F && compute_flags & PNFFT_COMPUTE_GRAD_F){
-      /* compute f and grad_f at once */
-      if(ths->pnfft_flags & PNFFT_REAL_F)
-        PNX(assign_f_and_grad_f_r2r)(
-            ths, nodes, p, ths->g2, pre_psi, pre_dpsi,
-            2*m0, local_ngc, cutoff, 2, 2, use_interlacing, interlaced,
-            f + 2*ind, grad_f + 2*3*ind);
-      else if(ths->trafo_flag & PNFFTI_TRAFO_C2R)
-        PNX(assign_f_and_grad_f_r2r)(
-            ths, nodes, p, ths->g2, pre_psi, pre_dpsi,
-            m0, local_ngc, cutoff, 1, 1, use_interlacing, interlaced,
-            f + ind, grad_f + 3*ind);
-      else
-        PNX(assign_f_and_grad_f_c2c)(
-            ths, nodes, p, (C*)ths->g2, pre_psi, pre_dpsi,
-            m0, local_ngc, cutoff, use_interlacing, interlaced,
-            (C*)f + ind, (C*)grad_f + 3*ind);
-    } else if(compute_flags & PNFFT_COMPUTE_F){
-      /* compute f */
-      if(ths->pnfft_flags & PNFFT_REAL_F)
-        PNX(assign_f_r2r)(
-            ths, nodes, p, ths->g2, pre_psi,
-            2*m0, local_ngc, cutoff, 2, use_interlacing, interlaced,
-            f + 2*ind);
-      else if(ths->trafo_flag & PNFFTI_TRAFO_C2R)
-        PNX(assign_f_r2r)(
-            ths, nodes, p, ths->g2, pre_psi,
-            m0, local_ngc, cutoff, 1, use_interlacing, interlaced,
-            f + ind);
-      else
-        PNX(assign_f_c2c)(
-            ths, nodes, p, (C*)ths->g2, pre_psi,
-            m0, local_ngc, cutoff, use_interlacing, interlaced,
-            (C*)f + ind);
-    } else if(compute_flags & PNFFT_COMPUTE_GRAD_F){
-      /* compute grad_f */
-      if(ths->pnfft_flags & PNFFT_REAL_F)
-        PNX(assign_grad_f_r2r)(
-            ths, nodes, p, ths->g2, pre_psi, pre_dpsi,
-            2*m0, local_ngc, cutoff, 2, 2, use_interlacing, interlaced,
-            grad_f + 2*3*ind);
-      else if(ths->trafo_flag & PNFFTI_TRAFO_C2R)
-        PNX(assign_grad_f_r2r)(
-            ths, nodes, p, ths->g2, pre_psi, pre_dpsi,
-            m0, local_ngc, cutoff, 1, 1, use_interlacing, interlaced,
-            grad_f + 3*ind);
-      else
-        PNX(assign_grad_f_c2c)(
-            ths, nodes, p, (C*)ths->g2, pre_psi, pre_dpsi,
-            m0, local_ngc, cutoff, use_interlacing, interlaced,
-            (C*)grad_f + 3*ind);
-    }
-
-    if (compute_flags & PNFFT_COMPUTE_HESSIAN_F){
-      if(ths->pnfft_flags & PNFFT_REAL_F)
-        PNX(assign_hessian_f_r2r)(
-            ths, nodes, p, ths->g2, pre_psi, pre_dpsi, pre_ddpsi,
-            2*m0, local_ngc, cutoff, 2, 2, use_interlacing, interlaced,
-            hessian_f + 2*6*ind);
-      else if(ths->trafo_flag & PNFFTI_TRAFO_C2R)
-        PNX(assign_hessian_f_r2r)(
-            ths, nodes, p, ths->g2, pre_psi, pre_dpsi, pre_ddpsi,
-            m0, local_ngc, cutoff, 1, 1, use_interlacing, interlaced,
-            hessian_f + 6*ind);
-      else 
-        PNX(assign_hessian_f_c2c)(
-            ths, nodes, p, (C*)ths->g2, pre_psi, pre_dpsi, pre_ddpsi,
-            m0, local_ngc, cutoff, use_interlacing, interlaced,
-            (C*)hessian_f + 6*ind);
+      if (compute_flags & PNFFT_COMPUTE_HESSIAN_F){
+        if(ths->pnfft_flags & PNFFT_REAL_F)
+          PNX(assign_hessian_f_r2r)(
+              ths, nodes, p, ths->g2, pre_psi, pre_dpsi, pre_ddpsi,
+              2*m0, local_ngc, ths->cutoff_dim, 2, 2, use_interlacing, interlaced,
+              hessian_f + 2*6*ind);
+        else if(ths->trafo_flag & PNFFTI_TRAFO_C2R)
+          PNX(assign_hessian_f_r2r)(
+              ths, nodes, p, ths->g2, pre_psi, pre_dpsi, pre_ddpsi,
+              m0, local_ngc, ths->cutoff_dim, 1, 1, use_interlacing, interlaced,
+              hessian_f + 6*ind);
+        else 
+          PNX(assign_hessian_f_c2c)(
+              ths, nodes, p, (C*)ths->g2, pre_psi, pre_dpsi, pre_ddpsi,
+              m0, local_ngc, ths->cutoff_dim, use_interlacing, interlaced,
+              (C*)hessian_f + 6*ind);
+      }
     }
+    PNFFT_FINISH_SUBSTAGE(t_grid, sampled)
   }
 
+  t_scale = PNFFT_SUBSTAGE_SCALE((nodes->local_M + batch - 1) / batch);
+  ths->timer_trafo[PNFFT_TIMER_INDEX]  += t_scale * t_index;
+  ths->timer_trafo[PNFFT_TIMER_WINDOW] += t_scale * t_window;
+  ths->timer_trafo[PNFFT_TIMER_GRID]   += t_scale * t_grid;
+  PNX(count_loop_B)(ths, ths->counter_trafo, nodes->local_M, compute_flags, 0);
+
 #if PNFFT_ENABLE_DEBUG
   MPI_Reduce(&rsum, &grsum, 1, PNFFT_MPI_REAL_TYPE, MPI_SUM, 0, MPI_COMM_WORLD);
   PX(fprintf)(MPI_COMM_WORLD, stderr, "PNFFT: Sum of pre_psi: %e\n", grsum);
@@ -2882,9 +3530,7 @@ static void loop_over_particles_trafo(
   PX(fprintf)(MPI_COMM_WORLD, stderr, "PNFFT: Sum of pre_dpsi: %e\n", grsum_dd);
 #endif
 
-  if(pre_psi != NULL)   PNX(free)(pre_psi);
-  if(pre_dpsi != NULL)  PNX(free)(pre_dpsi);
-  if(pre_ddpsi != NULL) PNX(free)(pre_ddpsi);
+  PNX(workspace_release)(ths, mark);
 }
 
 static void loop_over_particles_adj(
@@ -2896,106 +3542,166 @@ static void loop_over_particles_adj(
     )
 {
   const int cutoff = ths->cutoff;
-  INT j, m0, u_j[3];
-  R floor_nx_j[3];
-  R *pre_psi = NULL, *pre_dpsi = NULL;
-  R x[3];
+  const INT sum_cutoff = PNFFT_SUM3(ths->cutoff_dim);
+  const unsigned pre = nodes->precompute_flags;
+  /* see loop_over_particles_trafo */
+  const int need_dpsi = (~pre & PNFFT_PRE_GRAD_PSI) && (compute_flags & PNFFT_COMPUTE_GRAD_F);
+  const int need_psi = (~pre & PNFFT_PRE_PSI) || need_dpsi;
+  R *node_psi = (interlaced) ? nodes->pre_psi_il : nodes->pre_psi;
+  const int eval_psi = need_psi
+    && ((~pre & PNFFT_PRE_PSI) || (pre & PNFFT_PRE_FULL) || (node_psi == NULL));
+  const int use_batch = eval_psi && PNX(window_batch_supported)(ths->pnfft_flags);
+  const int batch = PNFFT_WINDOW_BATCH;
+  INT j, m0, u_b[3*PNFFT_WINDOW_BATCH];
+  R floor_nx_b[3*PNFFT_WINDOW_BATCH];
+  R *pre_psi_b = NULL, *pre_dpsi_b = NULL, *batch_buf = NULL;
+  R x_b[3*PNFFT_WINDOW_BATCH];
+  double t_index = 0, t_window = 0, t_grid = 0, t_scale;
+  const size_t mark = PNX(workspace_mark)(ths);
 #if PNFFT_ENABLE_DEBUG
   R rsum=0.0, rsum_d=0.0, grsum, grsum_d;
 #endif
 
-  if( ~nodes->precompute_flags & PNFFT_PRE_PSI )
-    pre_psi = (R*) PNX(malloc)(sizeof(R) * (size_t) cutoff*3);
-  if( ~nodes->precompute_flags & PNFFT_PRE_GRAD_PSI )
-    if( compute_flags & PNFFT_COMPUTE_GRAD_F )
-      pre_dpsi = (R*) PNX(malloc)(sizeof(R) * (size_t) cutoff*3);
+  if( !need_psi || eval_psi )
+    node_psi = NULL;
 
-  for(INT p=0; p<nodes->local_M; p++){
-    j = (sorted_index) ? sorted_index[2*p+1] : p;
+  if( eval_psi )
+    pre_psi_b = (R*) PNX(workspace_get)(ths, sizeof(R) * (size_t) cutoff*3*batch);
+  if( use_batch )
+    batch_buf = (R*) PNX(workspace_get)(ths, sizeof(R) * (size_t) cutoff*3*PNFFT_WINDOW_BATCH);
+  if( need_dpsi )
+    pre_dpsi_b = (R*) PNX(workspace_get)(ths, sizeof(R) * (size_t) cutoff*3*batch);
 
-    /* shift x by half the mesh width for interlacing */
-    for(int t=0; t<3; t++){
-      x[t] = nodes->x[ths->d*j+t];
-      if(interlaced)
-        x[t] += 0.5/ths->n[t];
-    }
+  /* separate passes for the sampled timing of the sub-stages, see loop_over_particles_trafo */
+  for(INT p0=0; p0<nodes->local_M; p0+=batch){
+    const int num = (int) PNFFT_MIN(batch, nodes->local_M - p0);
+    const int sampled = PNFFT_SUBSTAGE_SAMPLED(p0/batch);
 
-    /* We need to compute the lowest summation index before we fold x back into [-0.5,0.5).
-     * Otherwise u_j may be also folded and gets less than the local offset local_no_start. */
-    lowest_summation_index(
-        ths->n, ths->m, x, local_no_start, gcells_below,
-        floor_nx_j, u_j);
+    PNFFT_START_SUBSTAGE(t_index, sampled)
+    for(int q=0; q<num; q++){
+      R *x = x_b + 3*q, *floor_nx_j = floor_nx_b + 3*q;
+      j = (sorted_index) ? sorted_index[2*(p0+q)+1] : p0+q;
 
-    /* assure -0.5 <= x < 0.5 */
-    if(interlaced){
+      /* shift x by half the mesh width for interlacing,
+       * components d <= t < 3 of the nodes are ignored */
       for(int t=0; t<3; t++){
-        if(x[t] >= 0.5){
-          x[t] -= 1.0;
-          floor_nx_j[t] -= ths->n[t];
+        x[t] = (t < ths->d) ? nodes->x[3*j+t] : 0;
+        if(interlaced && (t < ths->d))
+          x[t] += 0.5/ths->n[t];
+      }
+
+      /* We need to compute the lowest summation index before we fold x back into [-0.5,0.5).
+       * Otherwise u_j may be also folded and gets less than the local offset local_no_start. */
+      lowest_summation_index(
+          ths->d, ths->n, ths->m_dim, x, local_no_start, gcells_below,
+          floor_nx_j, u_b + 3*q);
+
+      /* assure -0.5 <= x < 0.5 */
+      if(interlaced){
+        for(int t=0; t<ths->d; t++){
+          if(x[t] >= 0.5){
+            x[t] -= 1.0;
+            floor_nx_j[t] -= ths->n[t];
+          }
         }
       }
     }
 
-    /* evaluate window on axes */
-    if( ~nodes->precompute_flags & PNFFT_PRE_PSI ){
-      pre_psi_tensor(
-          ths->n, ths->b, ths->m, cutoff, x, floor_nx_j,
-          ths->exp_const, ths->spline_coeffs, ths->pnfft_flags,
-          ths->intpol_order, ths->intpol_num_nodes, ths->intpol_tables_psi,
-          pre_psi);
+    PNFFT_FINISH_SUBSTAGE(t_index, sampled)
+
+    /* evaluate window on axes for all particles of the batch at once */
+    PNFFT_START_SUBSTAGE(t_window, sampled)
+    if(use_batch)
+      PNX(pre_psi_tensor_batch)(
+          ths, num, x_b, floor_nx_b, batch_buf,
+          pre_psi_b);
+
+    for(int q=0; q<num; q++){
+      INT p = p0 + q;
+      R *x = x_b + 3*q, *floor_nx_j = floor_nx_b + 3*q;
+      R *pre_psi = (pre_psi_b != NULL) ? pre_psi_b + 3*cutoff*q : (node_psi != NULL) ? node_psi + p*sum_cutoff : NULL;
+      R *pre_dpsi = (pre_dpsi_b != NULL) ? pre_dpsi_b + 3*cutoff*q : NULL;
+
+      /* evaluate window on axes */
+      if( eval_psi ){
+        if(!use_batch)
+          pre_psi_tensor(
+              ths->d, ths->n, ths->b, ths->m_dim, ths->cutoff_dim, x, floor_nx_j,
+              ths->exp_const, ths->spline_coeffs, ths->pnfft_flags,
+              ths->intpol_order, ths->intpol_num_nodes, ths->intpol_tables_psi,
+              ths->poly_degree, ths->poly_coeffs_psi,
+              pre_psi);
 
 #if PNFFT_ENABLE_DEBUG
-      /* Don't want to use PNX(debug_sum_print) because we are in a loop */
-      for(int t=0; t<3*cutoff; t++)
-        rsum += pnfft_fabs(pre_psi[t]);
+        /* Don't want to use PNX(debug_sum_print) because we are in a loop */
+        for(int t=0; t<PNFFT_SUM3(ths->cutoff_dim); t++)
+          rsum += pnfft_fabs(pre_psi[t]);
 #endif
-    }
+      }
 
-    if( ~nodes->precompute_flags & PNFFT_PRE_GRAD_PSI ){
-      if( compute_flags & PNFFT_COMPUTE_GRAD_F )
+      if( need_dpsi ){
         pre_dpsi_tensor(
-            ths->n, ths->b, ths->m, ths->cutoff, x, floor_nx_j, ths->spline_coeffs,
+            ths->d, ths->n, ths->b, ths->m_dim, ths->cutoff_dim, x, floor_nx_j, ths->spline_coeffs,
             ths->intpol_order, ths->intpol_num_nodes, ths->intpol_tables_dpsi,
+            ths->poly_degree, ths->poly_coeffs_dpsi,
             pre_psi, ths->pnfft_flags,
             pre_dpsi);
 
 #if PNFFT_ENABLE_DEBUG
         /* Don't want to use PNX(debug_sum_print) because we are in a loop */
-        for(int t=0; t<3*cutoff; t++)
+        for(int t=0; t<PNFFT_SUM3(ths->cutoff_dim); t++)
           rsum_d += pnfft_fabs(pre_dpsi[t]);
 #endif
+      }
     }
+    PNFFT_FINISH_SUBSTAGE(t_window, sampled)
+
+    /* spread the window weighted nodes to the grid */
+    PNFFT_START_SUBSTAGE(t_grid, sampled)
+    for(int q=0; q<num; q++){
+      INT p = p0 + q, *u_j = u_b + 3*q;
+      R *pre_psi = (pre_psi_b != NULL) ? pre_psi_b + 3*cutoff*q : (node_psi != NULL) ? node_psi + p*sum_cutoff : NULL;
+      R *pre_dpsi = (pre_dpsi_b != NULL) ? pre_dpsi_b + 3*cutoff*q : NULL;
+      j = (sorted_index) ? sorted_index[2*p+1] : p;
+
+      INT ind = j*stride + offset;
+      m0 = PNFFT_PLAIN_INDEX_3D(u_j, local_ngc);
+      if(compute_flags & PNFFT_COMPUTE_F){
+        if (ths->trafo_flag & PNFFTI_TRAFO_C2R)
+          PNX(spread_f_r2r)(
+              ths, nodes, p, f[ind], pre_psi, m0, local_ngc, ths->cutoff_dim, 1,
+              use_interlacing, interlaced,
+              ths->g2);
+        else
+          PNX(spread_f_c2c)(
+              ths, nodes, p, ((C*)f)[ind], pre_psi, m0, local_ngc, ths->cutoff_dim,
+              use_interlacing, interlaced,
+              (C*)ths->g2);
+      }
 
-    INT ind = j*stride + offset;
-    m0 = PNFFT_PLAIN_INDEX_3D(u_j, local_ngc);
-    if(compute_flags & PNFFT_COMPUTE_F){
-      if (ths->trafo_flag & PNFFTI_TRAFO_C2R)
-        PNX(spread_f_r2r)(
-            ths, nodes, p, f[ind], pre_psi, m0, local_ngc, cutoff, 1,
-            use_interlacing, interlaced,
-            ths->g2);
-      else
-        PNX(spread_f_c2c)(
-            ths, nodes, p, ((C*)f)[ind], pre_psi, m0, local_ngc, cutoff,
-            use_interlacing, interlaced,
-            (C*)ths->g2);
-    }
-
-    if(compute_flags & PNFFT_COMPUTE_GRAD_F){
-      /* compute grad_f */
-      if(ths->trafo_flag & PNFFTI_TRAFO_C2R)
-        PNX(spread_grad_f_r2r)(
-            ths, nodes, p, grad_f + 3*ind, pre_psi, pre_dpsi,
-            m0, local_ngc, cutoff, 1, 1, use_interlacing, interlaced,
-            ths->g2);
-      else
-        PNX(spread_grad_f_c2c)(
-            ths, nodes, p, (C*)grad_f + 3*ind, pre_psi, pre_dpsi,
-            m0, local_ngc, cutoff, use_interlacing, interlaced,
-            (C*)ths->g2);
+      if(compute_flags & PNFFT_COMPUTE_GRAD_F){
+        /* compute grad_f */
+        if(ths->trafo_flag & PNFFTI_TRAFO_C2R)
+          PNX(spread_grad_f_r2r)(
+              ths, nodes, p, grad_f + 3*ind, pre_psi, pre_dpsi,
+              m0, local_ngc, ths->cutoff_dim, 1, 1, use_interlacing, interlaced,
+              ths->g2);
+        else
+          PNX(spread_grad_f_c2c)(
+              ths, nodes, p, (C*)grad_f + 3*ind, pre_psi, pre_dpsi,
+              m0, local_ngc, ths->cutoff_dim, use_interlacing, interlaced,
+              (C*)ths->g2);
+      }
     }
+    PNFFT_FINISH_SUBSTAGE(t_grid, sampled)
   }
 
+  t_scale = PNFFT_SUBSTAGE_SCALE((nodes->local_M + batch - 1) / batch);
+  ths->timer_adj[PNFFT_TIMER_INDEX]  += t_scale * t_index;
+  ths->timer_adj[PNFFT_TIMER_WINDOW] += t_scale * t_window;
+  ths->timer_adj[PNFFT_TIMER_GRID]   += t_scale * t_grid;
+  PNX(count_loop_B)(ths, ths->counter_adj, nodes->local_M, compute_flags, 1);
+
 #if PNFFT_ENABLE_DEBUG
   MPI_Reduce(&rsum, &grsum, 1, PNFFT_MPI_REAL_TYPE, MPI_SUM, 0, MPI_COMM_WORLD);
   PX(fprintf)(MPI_COMM_WORLD, stderr, "PNFFT^H: Sum of pre_psi: %e\n", grsum);
@@ -3004,30 +3710,31 @@ static void loop_over_particles_adj(
   PX(fprintf)(MPI_COMM_WORLD, stderr, "PNFFT^H: Sum of pre_dpsi: %e\n", grsum_d);
 #endif
 
-  if(pre_psi != NULL)   PNX(free)(pre_psi);
-  if(pre_dpsi != NULL)  PNX(free)(pre_dpsi);
+  PNX(workspace_release)(ths, mark);
 }
 
 
+/* All ik-scaling loops run over the local block in memory order.
+ * The outermost axis is distributed with a static schedule. */
 void PNX(adjoint_scale_ik_diff_c2c)(
     const C* g1, INT *local_N_start, INT *local_N, int dim, unsigned pnfft_flags,
     C* g1_buffer
     )
 {
-  INT k[3], m=0;
+  /* g_hat is transposed N1 x N2 x N0 or non-transposed N0 x N1 x N2 */
+  const int a0 = (pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? 1 : 0;
+  const int a1 = (pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? 2 : 1;
+  const int a2 = (pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? 0 : 2;
 
-  if(pnfft_flags & PNFFT_TRANSPOSED_F_HAT){
-    /* g_hat is transposed N1 x N2 x N0 */
-    for(k[1]=local_N_start[1]; k[1]<local_N_start[1] + local_N[1]; k[1]++)
-      for(k[2]=local_N_start[2]; k[2]<local_N_start[2] + local_N[2]; k[2]++)
-        for(k[0]=local_N_start[0]; k[0]<local_N_start[0] + local_N[0]; k[0]++, m++)
-          g1_buffer[m] += 2*PNFFT_PI * I * k[dim] * g1[m];
-  } else {
-    /* g_hat is non-transposed N0 x N1 x N2 */
-    for(k[0]=local_N_start[0]; k[0]<local_N_start[0] + local_N[0]; k[0]++)
-      for(k[1]=local_N_start[1]; k[1]<local_N_start[1] + local_N[1]; k[1]++)
-        for(k[2]=local_N_start[2]; k[2]<local_N_start[2] + local_N[2]; k[2]++, m++)
-          g1_buffer[m] += 2*PNFFT_PI * I * k[dim] * g1[m];
+#ifdef PNFFT_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for(INT i0=0; i0<local_N[a0]; i0++){
+    INT k[3], m = i0*local_N[a1]*local_N[a2];
+    k[a0] = local_N_start[a0] + i0;
+    for(k[a1]=local_N_start[a1]; k[a1]<local_N_start[a1] + local_N[a1]; k[a1]++)
+      for(k[a2]=local_N_start[a2]; k[a2]<local_N_start[a2] + local_N[a2]; k[a2]++, m++)
+        g1_buffer[m] += 2*PNFFT_PI * I * k[dim] * g1[m];
   }
 }
 
@@ -3036,20 +3743,20 @@ void PNX(trafo_scale_ik_diff_c2c)(
     C* g1
     )
 {
-  INT k[3], m=0;
+  /* g_hat is transposed N1 x N2 x N0 or non-transposed N0 x N1 x N2 */
+  const int a0 = (pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? 1 : 0;
+  const int a1 = (pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? 2 : 1;
+  const int a2 = (pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? 0 : 2;
 
-  if(pnfft_flags & PNFFT_TRANSPOSED_F_HAT){
-    /* g_hat is transposed N1 x N2 x N0 */
-    for(k[1]=local_N_start[1]; k[1]<local_N_start[1] + local_N[1]; k[1]++)
-      for(k[2]=local_N_start[2]; k[2]<local_N_start[2] + local_N[2]; k[2]++)
-        for(k[0]=local_N_start[0]; k[0]<local_N_start[0] + local_N[0]; k[0]++, m++)
-          g1[m] = -2*PNFFT_PI * I * k[dim] * g1_buffer[m];
-  } else {
-    /* g_hat is non-transposed N0 x N1 x N2 */
-    for(k[0]=local_N_start[0]; k[0]<local_N_start[0] + local_N[0]; k[0]++)
-      for(k[1]=local_N_start[1]; k[1]<local_N_start[1] + local_N[1]; k[1]++)
-        for(k[2]=local_N_start[2]; k[2]<local_N_start[2] + local_N[2]; k[2]++, m++)
-          g1[m] = -2*PNFFT_PI * I * k[dim] * g1_buffer[m];
+#ifdef PNFFT_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for(INT i0=0; i0<local_N[a0]; i0++){
+    INT k[3], m = i0*local_N[a1]*local_N[a2];
+    k[a0] = local_N_start[a0] + i0;
+    for(k[a1]=local_N_start[a1]; k[a1]<local_N_start[a1] + local_N[a1]; k[a1]++)
+      for(k[a2]=local_N_start[a2]; k[a2]<local_N_start[a2] + local_N[a2]; k[a2]++, m++)
+        g1[m] = -2*PNFFT_PI * I * k[dim] * g1_buffer[m];
   }
 }
 
@@ -3058,9 +3765,12 @@ void PNX(trafo_scale_ik_diff2_c2c)(
     C* g1
     )
 {
-  INT k[3], m=0;
   int t1=0, t2=0;
   R minusFourPiSqr = -4.0 * PNFFT_PI * PNFFT_PI;
+  /* g_hat is transposed N1 x N2 x N0 or non-transposed N0 x N1 x N2 */
+  const int a0 = (pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? 1 : 0;
+  const int a1 = (pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? 2 : 1;
+  const int a2 = (pnfft_flags & PNFFT_TRANSPOSED_F_HAT) ? 0 : 2;
   
   switch(dim){
     case 0: t1=0; t2=0; break;
@@ -3071,17 +3781,14 @@ void PNX(trafo_scale_ik_diff2_c2c)(
     case 5: t1=2; t2=2; break;
   }
 
-  if(pnfft_flags & PNFFT_TRANSPOSED_F_HAT){
-    /* g_hat is transposed N1 x N2 x N0 */
-    for(k[1]=local_N_start[1]; k[1]<local_N_start[1] + local_N[1]; k[1]++)
-      for(k[2]=local_N_start[2]; k[2]<local_N_start[2] + local_N[2]; k[2]++)
-        for(k[0]=local_N_start[0]; k[0]<local_N_start[0] + local_N[0]; k[0]++, m++)
-          g1[m] = minusFourPiSqr * k[t1] * k[t2] * g1_buffer[m];
-  } else {
-    /* g_hat is non-transposed N0 x N1 x N2 */
-    for(k[0]=local_N_start[0]; k[0]<local_N_start[0] + local_N[0]; k[0]++)
-      for(k[1]=local_N_start[1]; k[1]<local_N_start[1] + local_N[1]; k[1]++)
-        for(k[2]=local_N_start[2]; k[2]<local_N_start[2] + local_N[2]; k[2]++, m++)
-          g1[m] = minusFourPiSqr * k[t1] * k[t2] * g1_buffer[m];
+#ifdef PNFFT_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for(INT i0=0; i0<local_N[a0]; i0++){
+    INT k[3], m = i0*local_N[a1]*local_N[a2];
+    k[a0] = local_N_start[a0] + i0;
+    for(k[a1]=local_N_start[a1]; k[a1]<local_N_start[a1] + local_N[a1]; k[a1]++)
+      for(k[a2]=local_N_start[a2]; k[a2]<local_N_start[a2] + local_N[a2]; k[a2]++, m++)
+        g1[m] = minusFourPiSqr * k[t1] * k[t2] * g1_buffer[m];
   }
 }
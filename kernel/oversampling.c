@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2011-2013 Michael Pippig
+ *
+ * This file is part of PNFFT.
+ *
+ * PNFFT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PNFFT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PNFFT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "pnfft.h"
+#include "ipnfft.h"
+
+/* Oversampled FFT sizes for oversampling factors below 2 and retuning of the cut-off m,
+ * such that the smaller FFT grid keeps the accuracy of the default configuration. */
+
+/* cut-off of retuned windows is limited to a multiple of the reference cut-off */
+#define MAX_M_FACTOR 3
+
+static int is_smooth(
+    INT n);
+
+
+/* A-priori estimates of the aliasing and truncation error per dimension relative to the 1-norm of f_hat,
+ * see Potts, Steidl, Tasche: Fast Fourier transforms for nonequispaced data, and
+ * Barnett, Magland, af Klinteberg: A parallel non-uniform fast Fourier transform library (FINUFFT). */
+R PNX(window_error_estimate)(
+    unsigned window, R sigma, int m
+    )
+{
+  if(window & PNFFT_WINDOW_GAUSSIAN)
+    return 4.0 * pnfft_exp(-m * PNFFT_PI * (1.0 - 1.0/(2.0*sigma-1.0)));
+  if(window & (PNFFT_WINDOW_BSPLINE | PNFFT_WINDOW_SINC_POWER))
+    return 4.0 * pnfft_pow(1.0/(2.0*sigma-1.0), 2*m);
+  if(window & PNFFT_WINDOW_ES)
+    /* same shape parameter as in init_internal */
+    return 10.0 * pnfft_exp(-0.97 * PNFFT_PI * (1.0 - 1.0/(2.0*sigma)) * 2.0 * m);
+
+  /* Kaiser-Bessel and Bessel I0 */
+  return 4.0 * PNFFT_PI * (pnfft_sqrt(m) + m) * pnfft_sqrt(pnfft_sqrt(1.0 - 1.0/sigma))
+    * pnfft_exp(-2.0 * PNFFT_PI * m * pnfft_sqrt(1.0 - 1.0/sigma));
+}
+
+/* Smallest cut-off m, such that the window reaches with oversampling factor 'sigma'
+ * at least the accuracy of cut-off 'm_ref' with oversampling factor 'sigma_ref'. */
+int PNX(retune_m)(
+    unsigned window, R sigma, int m_ref, R sigma_ref
+    )
+{
+  R err_ref = PNX(window_error_estimate)(window, sigma_ref, m_ref);
+  int m;
+
+  if(sigma >= sigma_ref)
+    return m_ref;
+
+  for(m=m_ref; m<MAX_M_FACTOR*m_ref; m++)
+    if( PNX(window_error_estimate)(window, sigma, m) <= err_ref )
+      break;
+
+  return m;
+}
+
+/* Smallest even FFT size n >= n_min, that factorizes into 2, 3, 5 and 7. */
+INT PNX(smooth_fft_size)(
+    INT n_min
+    )
+{
+  INT n = (n_min > 2) ? n_min + (n_min % 2) : 2;
+
+  while( !is_smooth(n) )
+    n += 2;
+
+  return n;
+}
+
+static int is_smooth(
+    INT n
+    )
+{
+  const INT primes[4] = {2, 3, 5, 7};
+
+  for(int k=0; k<4; k++)
+    while( n % primes[k] == 0 )
+      n /= primes[k];
+
+  return (n == 1);
+}
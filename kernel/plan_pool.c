@@ -0,0 +1,369 @@
+/*
+ * Copyright (c) 2011-2013 Michael Pippig
+ *
+ * This file is part of PNFFT.
+ *
+ * PNFFT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PNFFT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PNFFT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "pnfft.h"
+#include "ipnfft.h"
+
+/* Process wide pool of FFT grids for plans with PNFFT_PLAN_POOL.
+ * Plans on congruent communicators with equal FFT size n, output size no, transform type
+ * and in-place flag share the scratch grids g1, g2 and g1_buffer. Within one set of grids
+ * plans with equal N and PFFT flags share the PFFT plans and plans with equal ghost cells
+ * share the ghost cell plan. All pooled objects are reference counted.
+ * The grids only hold scratch data during one call of trafo or adj, i.e., plans of one pool
+ * must not be executed concurrently. */
+
+typedef struct fft_entry_s{
+  INT N[3];                   /**< Size of NFFT                                    */
+  unsigned forw_flags;        /**< PFFT flags of forward plan                      */
+  unsigned back_flags;        /**< PFFT flags of backward plan                     */
+
+  PX(plan) pfft_forw;         /**< Forward PFFT plan                               */
+  PX(plan) pfft_back;         /**< Backward PFFT plan                              */
+  int refs;                   /**< Number of plans using these PFFT plans          */
+  struct fft_entry_s *next;
+} fft_entry;
+
+typedef struct gc_entry_s{
+  INT gcells_below[3];        /**< Number of ghost cells below local block         */
+  INT gcells_above[3];        /**< Number of ghost cells above local block         */
+
+  PX(gcplan) gcplan;          /**< PFFT Ghostcell plan                             */
+  int refs;                   /**< Number of plans using this ghost cell plan      */
+  struct gc_entry_s *next;
+} gc_entry;
+
+typedef struct grid_entry_s{
+  MPI_Comm comm;              /**< Communicator the grids are distributed on       */
+  int rnk_pm;                 /**< Rank of Cartesian communicator                  */
+  int np[3];                  /**< Size of Cartesian communicator                  */
+  int d;                      /**< Dimension of the FFT                            */
+  INT n[3];                   /**< FFT length                                      */
+  INT no[3];                  /**< FFT output length                               */
+  unsigned trafo_flag;        /**< Transformation type (c2c or c2r)                */
+  int in_place;               /**< g1 and g2 point to the same memory              */
+  unsigned huge_flags;        /**< Huge page flags the grids were allocated with   */
+
+  INT alloc_local_in;         /**< Number of reals in g1 and g1_buffer             */
+  INT alloc_local_out;        /**< Number of reals in g2                           */
+  R *g1;                      /**< Input of PFFT                                   */
+  R *g2;                      /**< Output of PFFT                                  */
+  R *g1_buffer;               /**< Buffer for computing Fourier-space derivatives  */
+
+  fft_entry *fft_plans;
+  gc_entry *gc_plans;
+  int refs;                   /**< Number of plans using these grids               */
+  struct grid_entry_s *next;
+} grid_entry;
+
+static grid_entry *grid_pool = NULL;
+
+static int all_found(
+    const void *found, MPI_Comm comm);
+static grid_entry* acquire_grids(
+    const PNX(plan) ths, INT alloc_local_in, INT alloc_local_out);
+static fft_entry* acquire_fft_plans(
+    const PNX(plan) ths, grid_entry *grids,
+    unsigned forw_flags, unsigned back_flags);
+static gc_entry* acquire_gcplan(
+    const PNX(plan) ths, grid_entry *grids,
+    const INT *gcells_below, const INT *gcells_above);
+static grid_entry* find_grids(
+    const PNX(plan) ths);
+
+
+/* pools may differ between processes, e.g., after plans on sub-communicators */
+static int all_found(
+    const void *found, MPI_Comm comm
+    )
+{
+  int have = (found != NULL), all_have;
+  MPI_Allreduce(&have, &all_have, 1, MPI_INT, MPI_MIN, comm);
+  return all_have;
+}
+
+static grid_entry* acquire_grids(
+    const PNX(plan) ths, INT alloc_local_in, INT alloc_local_out
+    )
+{
+  const int in_place = (ths->pnfft_flags & PNFFT_FFT_IN_PLACE) ? 1 : 0;
+  const unsigned trafo_flag = ths->trafo_flag & (PNFFTI_TRAFO_C2C | PNFFTI_TRAFO_C2R);
+  const unsigned huge_flags = ths->pnfft_flags & (PNFFT_HUGE_PAGES | PNFFT_HUGE_PAGES_EXPLICIT);
+  grid_entry *e, *found = NULL;
+
+  for(e = grid_pool; e != NULL; e = e->next){
+    int result;
+    MPI_Comm_compare(e->comm, ths->comm_cart, &result);
+    if( (result != MPI_IDENT) && (result != MPI_CONGRUENT) )
+      continue;
+    /* equal processes may still form different process meshes */
+    if( (e->rnk_pm != ths->rnk_pm) || (e->np[0] != ths->np[0]) || (e->np[1] != ths->np[1]) || (e->np[2] != ths->np[2]) )
+      continue;
+    if( (e->d != ths->d) || !PNX(equal_INT)(3, e->n, ths->n) || !PNX(equal_INT)(3, e->no, ths->no) )
+      continue;
+    if( (e->trafo_flag != trafo_flag) || (e->in_place != in_place) || (e->huge_flags != huge_flags) )
+      continue;
+    /* grids can not grow, since PFFT plans are bound to their memory */
+    if( (e->alloc_local_in < alloc_local_in) || (e->alloc_local_out < alloc_local_out) )
+      continue;
+    found = e;
+    break;
+  }
+
+  if(all_found(found, ths->comm_cart)){
+    found->refs++;
+    return found;
+  }
+
+  e = (grid_entry*) malloc(sizeof(grid_entry));
+  MPI_Comm_dup(ths->comm_cart, &e->comm);
+  e->rnk_pm = ths->rnk_pm;
+  for(int t=0; t<3; t++)
+    e->np[t] = ths->np[t];
+  e->d = ths->d;
+  PNX(vcopy_INT)(3, ths->n, e->n);
+  PNX(vcopy_INT)(3, ths->no, e->no);
+  e->trafo_flag = trafo_flag;
+  e->in_place   = in_place;
+  e->huge_flags = huge_flags;
+
+  e->alloc_local_in  = alloc_local_in;
+  e->alloc_local_out = alloc_local_out;
+  /* pooled grids are shared between plans and accounted to the process only */
+  e->g2 = (alloc_local_out) ? (R*) PNX(malloc_placed)(sizeof(R) * (size_t) alloc_local_out, PNFFT_MEM_FFT_GRIDS, NULL, huge_flags) : NULL;
+  if(alloc_local_out > alloc_local_in)
+    PNX(split_tagged)(e->g2, sizeof(R) * (size_t) (alloc_local_out - alloc_local_in), PNFFT_MEM_GHOST_CELLS);
+  if(in_place)
+    e->g1 = e->g2;
+  else
+    e->g1 = (alloc_local_in) ? (R*) PNX(malloc_placed)(sizeof(R) * (size_t) alloc_local_in, PNFFT_MEM_FFT_GRIDS, NULL, huge_flags) : NULL;
+  e->g1_buffer = NULL;
+
+  /* first touch with the static schedule of the grid loops */
+  PNX(first_touch)(e->g2, alloc_local_out);
+  if(e->g1 != e->g2)
+    PNX(first_touch)(e->g1, alloc_local_in);
+
+  e->fft_plans = NULL;
+  e->gc_plans  = NULL;
+  e->refs = 1;
+
+  e->next = grid_pool;
+  grid_pool = e;
+
+  return e;
+}
+
+static fft_entry* acquire_fft_plans(
+    const PNX(plan) ths, grid_entry *grids,
+    unsigned forw_flags, unsigned back_flags
+    )
+{
+  INT howmany = 1;
+  fft_entry *e, *found = NULL;
+
+  for(e = grids->fft_plans; e != NULL; e = e->next){
+    if( PNX(equal_INT)(3, e->N, ths->N) && (e->forw_flags == forw_flags) && (e->back_flags == back_flags) ){
+      found = e;
+      break;
+    }
+  }
+
+  if(all_found(found, ths->comm_cart)){
+    found->refs++;
+    return found;
+  }
+
+  e = (fft_entry*) malloc(sizeof(fft_entry));
+  PNX(vcopy_INT)(3, ths->N, e->N);
+  e->forw_flags = forw_flags;
+  e->back_flags = back_flags;
+
+  if(ths->trafo_flag & PNFFTI_TRAFO_C2R){
+    e->pfft_forw = PX(plan_many_dft_c2r)(ths->d, ths->n, ths->N, ths->no, howmany,
+        PFFT_DEFAULT_BLOCKS, PFFT_DEFAULT_BLOCKS, (C*) grids->g1, grids->g2, grids->comm,
+        PFFT_FORWARD, forw_flags);
+    e->pfft_back = PX(plan_many_dft_r2c)(ths->d, ths->n, ths->no, ths->N, howmany,
+        PFFT_DEFAULT_BLOCKS, PFFT_DEFAULT_BLOCKS, grids->g2, (C*) grids->g1, grids->comm,
+        PFFT_BACKWARD, back_flags);
+  } else {
+    e->pfft_forw = PX(plan_many_dft)(ths->d, ths->n, ths->N, ths->no, howmany,
+        PFFT_DEFAULT_BLOCKS, PFFT_DEFAULT_BLOCKS, (C*) grids->g1, (C*) grids->g2, grids->comm,
+        PFFT_FORWARD, forw_flags);
+    e->pfft_back = PX(plan_many_dft)(ths->d, ths->n, ths->no, ths->N, howmany,
+        PFFT_DEFAULT_BLOCKS, PFFT_DEFAULT_BLOCKS, (C*) grids->g2, (C*) grids->g1, grids->comm,
+        PFFT_BACKWARD, back_flags);
+  }
+  e->refs = 1;
+
+  e->next = grids->fft_plans;
+  grids->fft_plans = e;
+
+  return e;
+}
+
+static gc_entry* acquire_gcplan(
+    const PNX(plan) ths, grid_entry *grids,
+    const INT *gcells_below, const INT *gcells_above
+    )
+{
+  INT howmany = 1;
+  gc_entry *e, *found = NULL;
+
+  for(e = grids->gc_plans; e != NULL; e = e->next){
+    if( PNX(equal_INT)(3, e->gcells_below, gcells_below) && PNX(equal_INT)(3, e->gcells_above, gcells_above) ){
+      found = e;
+      break;
+    }
+  }
+
+  if(all_found(found, ths->comm_cart)){
+    found->refs++;
+    return found;
+  }
+
+  e = (gc_entry*) malloc(sizeof(gc_entry));
+  PNX(vcopy_INT)(3, gcells_below, e->gcells_below);
+  PNX(vcopy_INT)(3, gcells_above, e->gcells_above);
+
+  if(ths->trafo_flag & PNFFTI_TRAFO_C2R)
+    e->gcplan = PX(plan_many_rgc)(ths->d, ths->no, howmany, PFFT_DEFAULT_BLOCKS,
+        e->gcells_below, e->gcells_above, grids->g2, grids->comm, 0);
+  else
+    e->gcplan = PX(plan_many_cgc)(ths->d, ths->no, howmany, PFFT_DEFAULT_BLOCKS,
+        e->gcells_below, e->gcells_above, (C*) grids->g2, grids->comm, 0);
+  e->refs = 1;
+
+  e->next = grids->gc_plans;
+  grids->gc_plans = e;
+
+  return e;
+}
+
+static grid_entry* find_grids(
+    const PNX(plan) ths
+    )
+{
+  /* grid pointers may be NULL on processes without local data, the PFFT plans are unique */
+  for(grid_entry *e = grid_pool; e != NULL; e = e->next)
+    for(fft_entry *f = e->fft_plans; f != NULL; f = f->next)
+      if(f->pfft_forw == ths->pfft_forw)
+        return e;
+  return NULL;
+}
+
+
+/* Set the grids, PFFT plans and ghost cell plan of 'ths' from the pool.
+ * Missing objects are allocated and planned. Collective on ths->comm_cart. */
+void PNX(acquire_pooled_grids)(
+    PNX(plan) ths, INT alloc_local_in, INT alloc_local_out,
+    unsigned forw_flags, unsigned back_flags,
+    const INT *gcells_below, const INT *gcells_above
+    )
+{
+  grid_entry *grids = acquire_grids(ths, alloc_local_in, alloc_local_out);
+  fft_entry *ffts = acquire_fft_plans(ths, grids, forw_flags, back_flags);
+  gc_entry *gc = acquire_gcplan(ths, grids, gcells_below, gcells_above);
+
+  /* the derivative buffer holds at most the input of the FFT and is allocated on first request */
+  if( (ths->pnfft_flags & PNFFT_DIFF_IK) && (grids->g1_buffer == NULL) && grids->alloc_local_in ){
+    grids->g1_buffer = (R*) PNX(malloc_placed)(sizeof(R) * (size_t) grids->alloc_local_in, PNFFT_MEM_FFT_GRIDS, NULL, grids->huge_flags);
+    PNX(first_touch)(grids->g1_buffer, grids->alloc_local_in);
+  }
+
+  ths->g1 = grids->g1;
+  ths->g2 = grids->g2;
+  ths->g1_buffer = (ths->pnfft_flags & PNFFT_DIFF_IK) ? grids->g1_buffer : NULL;
+  ths->pfft_forw = ffts->pfft_forw;
+  ths->pfft_back = ffts->pfft_back;
+  ths->gcplan = gc->gcplan;
+}
+
+/* Drop the references of 'ths' to pooled objects. Objects are freed after their last reference is gone. */
+void PNX(release_pooled_grids)(
+    PNX(plan) ths
+    )
+{
+  grid_entry **p, *grids = find_grids(ths);
+
+  if(grids == NULL)
+    return;
+
+  for(fft_entry **q = &grids->fft_plans; *q != NULL; q = &(*q)->next){
+    fft_entry *e = *q;
+    if(e->pfft_forw != ths->pfft_forw)
+      continue;
+    if(--e->refs == 0){
+      *q = e->next;
+      PX(destroy_plan)(e->pfft_forw);
+      PX(destroy_plan)(e->pfft_back);
+      free(e);
+    }
+    break;
+  }
+
+  for(gc_entry **q = &grids->gc_plans; *q != NULL; q = &(*q)->next){
+    gc_entry *e = *q;
+    if(e->gcplan != ths->gcplan)
+      continue;
+    if(--e->refs == 0){
+      *q = e->next;
+      PX(destroy_gcplan)(e->gcplan);
+      free(e);
+    }
+    break;
+  }
+
+  ths->g1 = ths->g2 = ths->g1_buffer = NULL;
+  ths->pfft_forw = ths->pfft_back = NULL;
+  ths->gcplan = NULL;
+
+  if(--grids->refs > 0)
+    return;
+
+  for(p = &grid_pool; *p != grids; p = &(*p)->next);
+  *p = grids->next;
+
+  /* g1 and g2 may point to the same mem for inplace transforms, do not free twice */
+  if(grids->g2 != grids->g1) PNX(save_free)(grids->g2);
+  PNX(save_free)(grids->g1);
+  PNX(save_free)(grids->g1_buffer);
+  MPI_Comm_free(&grids->comm);
+  free(grids);
+}
+
+/* Number of bytes of the pooled grids that are used by 'ths', including memory shared with other plans. */
+size_t PNX(pooled_grid_bytes)(
+    const PNX(plan) ths
+    )
+{
+  grid_entry *grids = find_grids(ths);
+  size_t bytes;
+
+  if(grids == NULL)
+    return 0;
+
+  bytes = sizeof(R) * (size_t) grids->alloc_local_out;
+  if(!grids->in_place)
+    bytes += sizeof(R) * (size_t) grids->alloc_local_in;
+  if(grids->g1_buffer != NULL)
+    bytes += sizeof(R) * (size_t) grids->alloc_local_in;
+
+  return bytes;
+}
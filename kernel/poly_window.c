@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2011-2013 Michael Pippig
+ *
+ * This file is part of PNFFT.
+ *
+ * PNFFT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PNFFT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PNFFT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <math.h>
+#include "pnfft.h"
+#include "ipnfft.h"
+
+/* Piecewise polynomial approximation of the window function (PNFFT_PRE_POLY_PSI).
+ * For every stencil offset s=0,...,cutoff-1 the function
+ *   p_s(z) = psi^(derivative)( (m + dist - s)/n ),   z = 2*dist-1,  0 <= dist < 1,
+ * is interpolated at Chebyshev points and stored in monomial basis with layout
+ * coeffs[k*cutoff + s], such that all stencil values are evaluated with
+ * one Horner scheme that runs over s in the innermost loop. */
+
+#define POLY_MIN_DEGREE  4
+#define POLY_MAX_DEGREE 24
+
+static R eval_window(
+    const PNX(plan) ths, int dim, int derivative, R x);
+static void fit_poly(
+    const PNX(plan) ths, int dim, int derivative, int degree,
+    R *coeffs);
+static R fit_error(
+    const PNX(plan) ths, int dim, int derivative, int degree,
+    const R *coeffs);
+static R** malloc_coeffs(
+    int d, int cutoff, memory_s *owner);
+static void free_coeffs(
+    R **coeffs, int d);
+
+
+static R eval_window(
+    const PNX(plan) ths, int dim, int derivative, R x
+    )
+{
+  switch(derivative){
+    case 1:  return PNX(dpsi)(ths, dim, x);
+    case 2:  return PNX(ddpsi)(ths, dim, x);
+    default: return PNX(psi)(ths, dim, x);
+  }
+}
+
+static void fit_poly(
+    const PNX(plan) ths, int dim, int derivative, int degree,
+    R *coeffs
+    )
+{
+  const int cutoff = ths->cutoff_dim[dim], nz = degree+1;
+  const long double pi = acosl(-1.0L);
+  long double fz[POLY_MAX_DEGREE+1], cheb[POLY_MAX_DEGREE+1], mono[POLY_MAX_DEGREE+1];
+  long double tkm1[POLY_MAX_DEGREE+1], tk[POLY_MAX_DEGREE+1], tkp1[POLY_MAX_DEGREE+1];
+
+  for(int s=0; s<cutoff; s++){
+    /* sample at Chebyshev points of first kind */
+    for(int j=0; j<nz; j++){
+      long double z = cosl(pi*(j+0.5L)/nz);
+      fz[j] = eval_window(ths, dim, derivative, (ths->m_dim[dim] + (R)(0.5L*(z+1.0L)) - s) / ths->n[dim]);
+    }
+
+    /* Chebyshev coefficients */
+    for(int k=0; k<nz; k++){
+      long double sum = 0.0L;
+      for(int j=0; j<nz; j++)
+        sum += fz[j] * cosl(pi*k*(j+0.5L)/nz);
+      cheb[k] = 2.0L*sum/nz;
+    }
+    cheb[0] *= 0.5L;
+
+    /* change to monomial basis by the recurrence T_{k+1} = 2z T_k - T_{k-1} */
+    for(int i=0; i<nz; i++)
+      mono[i] = tkm1[i] = tk[i] = 0.0L;
+    tkm1[0] = 1.0L;
+    mono[0] = cheb[0];
+    if(degree > 0){
+      tk[1] = 1.0L;
+      mono[1] = cheb[1];
+    }
+    for(int k=1; k<degree; k++){
+      tkp1[0] = -tkm1[0];
+      for(int i=1; i<nz; i++)
+        tkp1[i] = 2.0L*tk[i-1] - tkm1[i];
+      for(int i=0; i<nz; i++){
+        mono[i] += cheb[k+1] * tkp1[i];
+        tkm1[i] = tk[i];
+        tk[i] = tkp1[i];
+      }
+    }
+
+    for(int k=0; k<nz; k++)
+      coeffs[k*cutoff + s] = (R) mono[k];
+  }
+}
+
+/* Maximum error of the polynomial approximation relative to the maximum of |psi^(derivative)|.
+ * Sample points are located between the interpolation points. */
+static R fit_error(
+    const PNX(plan) ths, int dim, int derivative, int degree,
+    const R *coeffs
+    )
+{
+  const int cutoff = ths->cutoff_dim[dim], nt = 2*(degree+1);
+  R err = 0, max = 0;
+
+  for(int i=0; i<nt; i++){
+    R z = -1.0 + (2.0*i+1.0)/nt;
+    for(int s=0; s<cutoff; s++){
+      R f = eval_window(ths, dim, derivative, (ths->m_dim[dim] + 0.5*(z+1.0) - s) / ths->n[dim]);
+      R p = coeffs[degree*cutoff + s];
+      for(int k=degree-1; k>=0; k--)
+        p = p*z + coeffs[k*cutoff + s];
+      err = PNFFT_MAX(err, pnfft_fabs(p-f));
+      max = PNFFT_MAX(max, pnfft_fabs(f));
+    }
+  }
+
+  return (max > 0) ? err/max : err;
+}
+
+static R** malloc_coeffs(
+    int d, int cutoff, memory_s *owner
+    )
+{
+  R **coeffs = (R**) PNX(malloc_tagged)(sizeof(R*) * (size_t) d, PNFFT_MEM_WINDOW_TABLES, owner);
+  for(int t=0; t<d; t++)
+    coeffs[t] = (R*) PNX(malloc_tagged)(sizeof(R) * (size_t) (POLY_MAX_DEGREE+1) * cutoff, PNFFT_MEM_WINDOW_TABLES, owner);
+  return coeffs;
+}
+
+static void free_coeffs(
+    R **coeffs, int d
+    )
+{
+  if(coeffs == NULL)
+    return;
+
+  for(int t=0; t<d; t++)
+    PNX(save_free)(coeffs[t]);
+  PNX(free)(coeffs);
+}
+
+
+/* Choose the smallest degree that reproduces the window up to the accuracy of the truncated window,
+ * i.e., the relative size of psi at the border of its support, but not better than machine precision.
+ * If even POLY_MAX_DEGREE misses this accuracy (e.g. B-splines of large m), the plan falls back to
+ * direct evaluation of the window and PNFFT_PRE_POLY_PSI is removed from its flags. */
+void PNX(init_poly_window)(
+    PNX(plan) ths
+    )
+{
+  const int num_derivatives = (ths->pnfft_flags & PNFFT_DIFF_IK) ? 1 : 3;
+  R **coeffs[3];
+  R tol = 100*PNFFT_EPSILON;
+
+  PNX(free_poly_window)(ths);
+
+  for(int t=0; t<ths->d; t++){
+    R psi_max = pnfft_fabs(PNX(psi)(ths, t, 0));
+    R psi_border = pnfft_fabs(PNX(psi)(ths, t, (R) ths->m_dim[t] / ths->n[t]));
+    if(psi_max > 0)
+      tol = PNFFT_MAX(tol, 0.1*psi_border/psi_max);
+  }
+
+  for(int der=0; der<num_derivatives; der++)
+    coeffs[der] = malloc_coeffs(ths->d, ths->cutoff, &ths->mem);
+
+  /* start with the degree of an equivalent plan from the wisdom, the error check still applies */
+  int degree = POLY_MIN_DEGREE;
+  PNX(recall_wisdom)(ths, NULL, &degree);
+  R err = 0;
+  for(degree=PNFFT_MIN(PNFFT_MAX(degree, POLY_MIN_DEGREE), POLY_MAX_DEGREE); degree<=POLY_MAX_DEGREE; degree++){
+    err = 0;
+    for(int der=0; der<num_derivatives; der++){
+      for(int t=0; t<ths->d; t++){
+        fit_poly(ths, t, der, degree, coeffs[der][t]);
+        err = PNFFT_MAX(err, fit_error(ths, t, der, degree, coeffs[der][t]));
+      }
+    }
+    if(err <= tol)
+      break;
+  }
+
+  if(err > tol){
+    for(int der=0; der<num_derivatives; der++)
+      free_coeffs(coeffs[der], ths->d);
+    ths->pnfft_flags &= ~PNFFT_PRE_POLY_PSI;
+    return;
+  }
+
+  ths->poly_degree = degree;
+  ths->poly_coeffs_psi = coeffs[0];
+  if(num_derivatives > 1){
+    ths->poly_coeffs_dpsi  = coeffs[1];
+    ths->poly_coeffs_ddpsi = coeffs[2];
+  }
+}
+
+void PNX(free_poly_window)(
+    PNX(plan) ths
+    )
+{
+  free_coeffs(ths->poly_coeffs_psi, ths->d);
+  free_coeffs(ths->poly_coeffs_dpsi, ths->d);
+  free_coeffs(ths->poly_coeffs_ddpsi, ths->d);
+
+  ths->poly_degree = 0;
+  ths->poly_coeffs_psi   = NULL;
+  ths->poly_coeffs_dpsi  = NULL;
+  ths->poly_coeffs_ddpsi = NULL;
+}
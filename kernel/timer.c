@@ -38,6 +38,65 @@ static void fprint_average_timer_internal(
     unsigned flags);
 static void fprint_average_timer(
     MPI_Comm comm, FILE *file, const PNX(plan) ths, unsigned flags);
+static int compare_double(
+    const void *a, const void *b);
+static int timer_depth(
+    int idx);
+static void fprint_json_node(
+    FILE *file, int idx, int depth,
+    const double *min, const double *median, const double *max, const double *counter);
+static void fprint_json_direction(
+    FILE *file, const char *dir, const double *timer_iter,
+    const double *min, const double *median, const double *max, const double *counter);
+static void fprint_csv_direction(
+    FILE *file, const char *dir, int procs, const double *timer_iter,
+    const double *min, const double *median, const double *max, const double *counter);
+static void average_stats(
+    MPI_Comm comm, const double *timer,
+    double *min, double *median, double *max);
+static void average_counter_median(
+    MPI_Comm comm, PNX(plan) ths, int adjoint,
+    double *counter);
+
+/* Parent of every timer in the tree, -1 marks the roots. The sub-stages of the loop over
+ * the particles and of matrix B add up to their parent. The ik components split the
+ * D, F and B time of ik-differentiation per component and therefore form a separate root.
+ * PNFFT_TIMER_ITER counts the calls and is not part of the tree. */
+static const int timer_parents[PNFFT_TIMER_LENGTH] = {
+  -1,                     /* PNFFT_TIMER_ITER */
+  -1,                     /* PNFFT_TIMER_WHOLE */
+  PNFFT_TIMER_MATRIX_B,   /* PNFFT_TIMER_LOOP_B */
+  PNFFT_TIMER_MATRIX_B,   /* PNFFT_TIMER_SORT_NODES */
+  PNFFT_TIMER_MATRIX_B,   /* PNFFT_TIMER_GCELLS */
+  PNFFT_TIMER_WHOLE,      /* PNFFT_TIMER_MATRIX_B */
+  PNFFT_TIMER_WHOLE,      /* PNFFT_TIMER_MATRIX_F */
+  PNFFT_TIMER_WHOLE,      /* PNFFT_TIMER_MATRIX_D */
+  PNFFT_TIMER_MATRIX_B,   /* PNFFT_TIMER_SHIFT_INPUT */
+  PNFFT_TIMER_MATRIX_B,   /* PNFFT_TIMER_SHIFT_OUTPUT */
+  PNFFT_TIMER_LOOP_B,     /* PNFFT_TIMER_INDEX */
+  PNFFT_TIMER_LOOP_B,     /* PNFFT_TIMER_WINDOW */
+  PNFFT_TIMER_LOOP_B,     /* PNFFT_TIMER_GRID */
+  PNFFT_TIMER_MATRIX_B,   /* PNFFT_TIMER_ZERO */
+  -1,                     /* PNFFT_TIMER_IK */
+  PNFFT_TIMER_IK,         /* PNFFT_TIMER_IK_F */
+  PNFFT_TIMER_IK, PNFFT_TIMER_IK, PNFFT_TIMER_IK,   /* PNFFT_TIMER_IK_GRAD */
+  PNFFT_TIMER_IK, PNFFT_TIMER_IK, PNFFT_TIMER_IK,
+  PNFFT_TIMER_IK, PNFFT_TIMER_IK, PNFFT_TIMER_IK,   /* PNFFT_TIMER_IK_HESSIAN */
+  PNFFT_TIMER_WHOLE       /* PNFFT_TIMER_MATRIX_A */
+};
+
+static const char *counter_names[PNFFT_COUNTER_KINDS] = {
+  "flops", "bytes", "mpi_bytes", "mpi_msgs"
+};
+
+static const char *timer_names[PNFFT_TIMER_LENGTH] = {
+  "iter", "whole", "loop_B", "sort_nodes", "gcells",
+  "matrix_B", "matrix_F", "matrix_D", "shift_in", "shift_out",
+  "index", "window", "grid", "zero",
+  "ik", "ik_f", "ik_grad_0", "ik_grad_1", "ik_grad_2",
+  "ik_hessian_0", "ik_hessian_1", "ik_hessian_2", "ik_hessian_3", "ik_hessian_4", "ik_hessian_5",
+  "matrix_A"
+};
 
 
 double* PNX(get_timer_trafo)(
@@ -104,12 +163,83 @@ void PNX(timer_free)(
   PNX(rmtimer)(ths); 
 }
 
+int PNX(timer_parent)(
+    int idx
+    )
+{
+  if(idx < 0 || idx >= PNFFT_TIMER_LENGTH)
+    return -1;
+  return timer_parents[idx];
+}
+
+const char* PNX(timer_name)(
+    int idx
+    )
+{
+  if(idx < 0 || idx >= PNFFT_TIMER_LENGTH)
+    return NULL;
+  return timer_names[idx];
+}
+
+/* Collective, gathers one sample of every timer per process. The results are available on all processes. */
+void PNX(timer_reduce_stats)(
+    MPI_Comm comm, const double *timer,
+    double *min, double *median, double *max
+    )
+{
+  int size;
+  double *all, *col;
+
+  MPI_Comm_size(comm, &size);
+  all = (double*) malloc(sizeof(double) * (size_t) size * PNFFT_TIMER_LENGTH);
+  col = (double*) malloc(sizeof(double) * (size_t) size);
+  MPI_Allgather((void*) timer, PNFFT_TIMER_LENGTH, MPI_DOUBLE, all, PNFFT_TIMER_LENGTH, MPI_DOUBLE, comm);
+
+  for(int t=0; t<PNFFT_TIMER_LENGTH; t++){
+    for(int r=0; r<size; r++)
+      col[r] = all[r*PNFFT_TIMER_LENGTH + t];
+    qsort(col, (size_t) size, sizeof(double), compare_double);
+    min[t] = col[0];
+    max[t] = col[size-1];
+    median[t] = (size % 2) ? col[size/2] : 0.5 * (col[size/2-1] + col[size/2]);
+  }
+
+  free(col);
+  free(all);
+}
+
 void PNX(reset_timer)(
     PNX(plan) ths
     )
 {
   timer_reset(ths->timer_trafo);
   timer_reset(ths->timer_adj);
+  PNX(reset_counter)(ths->counter_trafo);
+  PNX(reset_counter)(ths->counter_adj);
+}
+
+/* The hooks are called on every process at the beginning and end of every timed stage except the
+ * sub-stages index, window and grid of the loop over the nodes. bytes and mpi_bytes are the counters
+ * of the stage accumulated so far, i.e., the difference between end and beginning is the traffic of
+ * this call. Passing NULL removes a hook. */
+void PNX(set_stage_hooks)(
+    PNX(plan) ths, PNX(stage_hook) begin, PNX(stage_hook) end, void *data
+    )
+{
+  ths->stage_begin = begin;
+  ths->stage_end   = end;
+  ths->stage_data  = data;
+}
+
+void PNX(call_stage_hook)(
+    PNX(plan) ths, PNX(stage_hook) hook, int adjoint, int stage
+    )
+{
+  const double *counter = (adjoint) ? ths->counter_adj : ths->counter_trafo;
+
+  hook(ths, stage, ths->stage_component, ths->stage_interlaced, adjoint,
+      counter[PNFFT_COUNTER_BYTES*PNFFT_TIMER_LENGTH + stage],
+      counter[PNFFT_COUNTER_MPI_BYTES*PNFFT_TIMER_LENGTH + stage], ths->stage_data);
 }
 
 static void timer_reset(
@@ -170,6 +300,91 @@ void PNX(write_average_timer_adv)(
   PX(write_average_gctimer_adv)(ths->gcplan, name, comm);
 }
 
+/* Writes the timer tree of trafo and adjoint with min/median/max over all processes of comm
+ * as one JSON object. Only the root process writes, an existing file is overwritten. */
+void PNX(write_timer_tree_json)(
+    const PNX(plan) ths, const char *name, MPI_Comm comm
+    )
+{
+  int rank, size;
+  FILE *f;
+  double min_trafo[PNFFT_TIMER_LENGTH], median_trafo[PNFFT_TIMER_LENGTH], max_trafo[PNFFT_TIMER_LENGTH];
+  double min_adj[PNFFT_TIMER_LENGTH], median_adj[PNFFT_TIMER_LENGTH], max_adj[PNFFT_TIMER_LENGTH];
+  double counter_trafo[PNFFT_COUNTER_KINDS*PNFFT_TIMER_LENGTH], counter_adj[PNFFT_COUNTER_KINDS*PNFFT_TIMER_LENGTH];
+
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+  average_stats(comm, ths->timer_trafo, min_trafo, median_trafo, max_trafo);
+  average_stats(comm, ths->timer_adj, min_adj, median_adj, max_adj);
+  average_counter_median(comm, ths, 0, counter_trafo);
+  average_counter_median(comm, ths, 1, counter_adj);
+
+  if(rank != 0)
+    return;
+
+  f = fopen(name, "w");
+  if(f == NULL){
+    fprintf(stderr, "Error: Cannot open file %s.\n", name);
+    return;
+  }
+
+  fprintf(f, "{\n  \"procs\": %d,\n  \"d\": %d,\n", size, ths->d);
+  fprintf(f, "  \"N\": [");
+  for(int t=0; t<ths->d; t++)
+    fprintf(f, "%s%td", (t) ? ", " : "", ths->N[t]);
+  fprintf(f, "],\n  \"n\": [");
+  for(int t=0; t<ths->d; t++)
+    fprintf(f, "%s%td", (t) ? ", " : "", ths->n[t]);
+  fprintf(f, "],\n  \"m\": [");
+  for(int t=0; t<ths->d; t++)
+    fprintf(f, "%s%d", (t) ? ", " : "", ths->m_dim[t]);
+  fprintf(f, "],\n");
+
+  fprint_json_direction(f, "trafo", ths->timer_trafo, min_trafo, median_trafo, max_trafo, counter_trafo);
+  fprintf(f, ",\n");
+  fprint_json_direction(f, "adj", ths->timer_adj, min_adj, median_adj, max_adj, counter_adj);
+  fprintf(f, "\n}\n");
+
+  fclose(f);
+}
+
+/* Appends one line per timer and direction with min/median/max over all processes of comm.
+ * Only the root process writes, the header is written into new files. */
+void PNX(write_timer_tree_csv)(
+    const PNX(plan) ths, const char *name, MPI_Comm comm
+    )
+{
+  int rank, size, newfile;
+  FILE *f;
+  double min_trafo[PNFFT_TIMER_LENGTH], median_trafo[PNFFT_TIMER_LENGTH], max_trafo[PNFFT_TIMER_LENGTH];
+  double min_adj[PNFFT_TIMER_LENGTH], median_adj[PNFFT_TIMER_LENGTH], max_adj[PNFFT_TIMER_LENGTH];
+  double counter_trafo[PNFFT_COUNTER_KINDS*PNFFT_TIMER_LENGTH], counter_adj[PNFFT_COUNTER_KINDS*PNFFT_TIMER_LENGTH];
+
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+  average_stats(comm, ths->timer_trafo, min_trafo, median_trafo, max_trafo);
+  average_stats(comm, ths->timer_adj, min_adj, median_adj, max_adj);
+  average_counter_median(comm, ths, 0, counter_trafo);
+  average_counter_median(comm, ths, 1, counter_adj);
+
+  if(rank != 0)
+    return;
+
+  newfile = !file_exists(name);
+  f = fopen(name, "a");
+  if(f == NULL){
+    fprintf(stderr, "Error: Cannot open file %s.\n", name);
+    return;
+  }
+
+  if(newfile)
+    fprintf(f, "direction,node,parent,depth,procs,iterations,min,median,max,flops,bytes,mpi_bytes,mpi_msgs\n");
+  fprint_csv_direction(f, "trafo", size, ths->timer_trafo, min_trafo, median_trafo, max_trafo, counter_trafo);
+  fprint_csv_direction(f, "adj", size, ths->timer_adj, min_adj, median_adj, max_adj, counter_adj);
+
+  fclose(f);
+}
+
 void PNX(print_average_timer)(
     const PNX(plan) ths, MPI_Comm comm
     )
@@ -254,6 +469,8 @@ static void write_run_specific_infos(
     PX(fprintf)(comm, file, "%% pnfft_flags == PNFFT_WINDOW_SINC_POWER");
   else if(ths->pnfft_flags & PNFFT_WINDOW_BESSEL_I0)
     PX(fprintf)(comm, file, "%% pnfft_flags == PNFFT_WINDOW_BESSEL_I0");
+  else if(ths->pnfft_flags & PNFFT_WINDOW_ES)
+    PX(fprintf)(comm, file, "%% pnfft_flags == PNFFT_WINDOW_ES");
   else
     PX(fprintf)(comm, file, "%% pnfft_flags == PNFFT_WINDOW_KAISER_BESSEL");
 
@@ -271,6 +488,16 @@ static void write_run_specific_infos(
     PX(fprintf)(comm, file, " | PNFFT_PRE_QUAD_PSI");
   if(ths->pnfft_flags & PNFFT_PRE_CUB_PSI)
     PX(fprintf)(comm, file, " | PNFFT_PRE_CUB_PSI");
+  if(ths->pnfft_flags & PNFFT_PRE_POLY_PSI)
+    PX(fprintf)(comm, file, " | PNFFT_PRE_POLY_PSI");
+  if(ths->pnfft_flags & PNFFT_DIFF_INTPOL_PSI)
+    PX(fprintf)(comm, file, " | PNFFT_DIFF_INTPOL_PSI");
+  if(ths->pnfft_flags & PNFFT_PLAN_POOL)
+    PX(fprintf)(comm, file, " | PNFFT_PLAN_POOL");
+  if(ths->pnfft_flags & PNFFT_OVERSAMPLING_1_5)
+    PX(fprintf)(comm, file, " | PNFFT_OVERSAMPLING_1_5");
+  if(ths->pnfft_flags & PNFFT_OVERSAMPLING_1_25)
+    PX(fprintf)(comm, file, " | PNFFT_OVERSAMPLING_1_25");
 //   if(ths->pnfft_flags & PNFFT_PRE_PSI)
 //     PX(fprintf)(comm, file, " | PNFFT_PRE_PSI");
 //   if(ths->pnfft_flags & PNFFT_PRE_FULL_PSI)
@@ -353,6 +580,10 @@ static void fprint_average_timer_internal(
     PX(fprintf)(comm, file, "%s_loop_B(%d)     = %.3e;\n", prefix, idx, mt[PNFFT_TIMER_LOOP_B]);
     PX(fprintf)(comm, file, "%s_shift_in(%d)   = %.3e;  ", prefix, idx, mt[PNFFT_TIMER_SHIFT_INPUT]);
     PX(fprintf)(comm, file, "%s_shift_out(%d)  = %.3e;\n", prefix, idx, mt[PNFFT_TIMER_SHIFT_OUTPUT]);
+    PX(fprintf)(comm, file, "%s_index(%d)      = %.3e;  ", prefix, idx, mt[PNFFT_TIMER_INDEX]);
+    PX(fprintf)(comm, file, "%s_window(%d)     = %.3e;\n", prefix, idx, mt[PNFFT_TIMER_WINDOW]);
+    PX(fprintf)(comm, file, "%s_grid(%d)       = %.3e;  ", prefix, idx, mt[PNFFT_TIMER_GRID]);
+    PX(fprintf)(comm, file, "%s_zero(%d)       = %.3e;\n", prefix, idx, mt[PNFFT_TIMER_ZERO]);
   }
 
   PNX(rmtimer)(mt);
@@ -365,6 +596,106 @@ static void fprint_average_timer(
   fprint_average_timer_internal(comm, file, "pnfft_trf", ths->timer_trafo, flags);
   fprint_average_timer_internal(comm, file, "pnfft_adj", ths->timer_adj, flags);
 }
-  
 
+static int compare_double(
+    const void *a, const void *b
+    )
+{
+  const double da = *(const double*) a, db = *(const double*) b;
+  return (da > db) - (da < db);
+}
+
+static int timer_depth(
+    int idx
+    )
+{
+  int depth = 0;
+  while( (idx = timer_parents[idx]) >= 0 )
+    depth++;
+  return depth;
+}
+
+/* statistics of the per-call average times of all processes */
+static void average_stats(
+    MPI_Comm comm, const double *timer,
+    double *min, double *median, double *max
+    )
+{
+  double *avg = PNX(timer_copy)(timer);
+  PNX(timer_average)(avg);
+  PNX(timer_reduce_stats)(comm, avg, min, median, max);
+  PNX(rmtimer)(avg);
+}
+
+/* median of the per-call counts of all processes, layout of the plan counters */
+static void average_counter_median(
+    MPI_Comm comm, PNX(plan) ths, int adjoint,
+    double *counter
+    )
+{
+  double min[PNFFT_TIMER_LENGTH], max[PNFFT_TIMER_LENGTH];
+
+  for(int k=0; k<PNFFT_COUNTER_KINDS; k++){
+    double *c = (adjoint) ? PNX(get_counter_adj)(ths, k) : PNX(get_counter_trafo)(ths, k);
+    average_stats(comm, c, min, counter + k*PNFFT_TIMER_LENGTH, max);
+    PNX(rmtimer)(c);
+  }
+}
+
+static void fprint_json_node(
+    FILE *file, int idx, int depth,
+    const double *min, const double *median, const double *max, const double *counter
+    )
+{
+  int first = 1;
+
+  fprintf(file, "%*s{\"name\": \"%s\", \"min\": %.6e, \"median\": %.6e, \"max\": %.6e",
+      2*depth, "", timer_names[idx], min[idx], median[idx], max[idx]);
+  for(int k=0; k<PNFFT_COUNTER_KINDS; k++)
+    fprintf(file, ", \"%s\": %.6e", counter_names[k], counter[k*PNFFT_TIMER_LENGTH + idx]);
+  fprintf(file, ", \"children\": [");
+  for(int t=1; t<PNFFT_TIMER_LENGTH; t++){
+    if(timer_parents[t] != idx)
+      continue;
+    fprintf(file, "%s\n", (first) ? "" : ",");
+    fprint_json_node(file, t, depth+1, min, median, max, counter);
+    first = 0;
+  }
+  if(first)
+    fprintf(file, "]}");
+  else
+    fprintf(file, "\n%*s]}", 2*depth, "");
+}
+
+static void fprint_json_direction(
+    FILE *file, const char *dir, const double *timer_iter,
+    const double *min, const double *median, const double *max, const double *counter
+    )
+{
+  int first = 1;
+
+  fprintf(file, "  \"%s\": {\n    \"iterations\": %d,\n    \"nodes\": [", dir, (int) timer_iter[PNFFT_TIMER_ITER]);
+  for(int t=1; t<PNFFT_TIMER_LENGTH; t++){
+    if(timer_parents[t] >= 0)
+      continue;
+    fprintf(file, "%s\n", (first) ? "" : ",");
+    fprint_json_node(file, t, 3, min, median, max, counter);
+    first = 0;
+  }
+  fprintf(file, "\n    ]\n  }");
+}
 
+static void fprint_csv_direction(
+    FILE *file, const char *dir, int procs, const double *timer_iter,
+    const double *min, const double *median, const double *max, const double *counter
+    )
+{
+  for(int t=1; t<PNFFT_TIMER_LENGTH; t++){
+    fprintf(file, "%s,%s,%s,%d,%d,%d,%.6e,%.6e,%.6e", dir, timer_names[t],
+        (timer_parents[t] >= 0) ? timer_names[timer_parents[t]] : "", timer_depth(t),
+        procs, (int) timer_iter[PNFFT_TIMER_ITER], min[t], median[t], max[t]);
+    for(int k=0; k<PNFFT_COUNTER_KINDS; k++)
+      fprintf(file, ",%.6e", counter[k*PNFFT_TIMER_LENGTH + t]);
+    fprintf(file, "\n");
+  }
+}
@@ -0,0 +1,497 @@
+/*
+ * Copyright (c) 2011-2013 Michael Pippig
+ *
+ * This file is part of PNFFT.
+ *
+ * PNFFT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PNFFT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PNFFT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "pnfft.h"
+#include "ipnfft.h"
+
+/* Batched evaluation of the window function for PNFFT_WINDOW_BATCH particles at once.
+ * Coordinates are staged in SoA form and all stencil values are computed by loops that run
+ * over the particles of the batch in the innermost loop. The transcendental functions
+ * are replaced by branch free polynomial kernels that the compiler can vectorize.
+ * The results are stored per particle with the same layout as pre_psi_tensor,
+ * i.e., particle p starts at pre_psi[3*cutoff*p] with the cutoff_dim[t] values of each dimension
+ * one after another, followed by the weights 1 of the trivial axes d <= t < 3. */
+
+#define B PNFFT_WINDOW_BATCH
+
+#if defined(PNFFT_PREC_SINGLE)
+#  define EXP_BITS 7
+#  define EXP_MAX  K(87.0)
+#else
+#  define EXP_BITS 10
+#  define EXP_MAX  K(708.0)
+#endif
+
+#if defined(PNFFT_PREC_SINGLE)
+#  define I0_SPLIT K(3.75)
+#else
+#  define I0_SPLIT K(8.0)
+#  define I0_SERIES  (sizeof(i0_series)/sizeof(i0_series[0]))
+#  define I0_CHEB_HI (sizeof(i0_cheb_hi)/sizeof(i0_cheb_hi[0]))
+#endif
+
+/* 2^(2^i) and 2^(-2^i) */
+static const R exp_pow2[] = {
+  K(2.0), K(4.0), K(16.0), K(256.0), K(65536.0), K(4294967296.0), K(1.8446744073709551616e19),
+#if !defined(PNFFT_PREC_SINGLE)
+  K(3.40282366920938463463e38), K(1.15792089237316195424e77), K(1.34078079299425970996e154)
+#endif
+};
+static const R exp_pow2_inv[] = {
+  K(0.5), K(0.25), K(0.0625), K(3.90625e-3), K(1.52587890625e-5), K(2.3283064365386962890625e-10),
+  K(5.42101086242752217003726400434970855712890625e-20),
+#if !defined(PNFFT_PREC_SINGLE)
+  K(2.93873587705571876992184134305561419e-39), K(8.63616855509444462538635186280039957e-78),
+  K(7.45834073120020674329637459870821159e-155)
+#endif
+};
+
+#if !defined(PNFFT_PREC_SINGLE)
+/* coefficients 1/(k!)^2 of the power series of I0 in (x/2)^2, degree 20 suffices on [0,8] */
+static const R i0_series[] = {
+  K(1.0), K(1.0), K(2.5e-1), K(2.77777777777777777778e-2), K(1.73611111111111111111e-3),
+  K(6.94444444444444444444e-5), K(1.92901234567901234568e-6), K(3.93675988914084152179e-8),
+  K(6.15118732678256487780e-10), K(7.59405842812662330593e-12), K(7.59405842812662330593e-14),
+  K(6.27608134555919281482e-16), K(4.35838982330499501029e-18), K(2.57892888952958284633e-20),
+  K(1.31578004567835859506e-22), K(5.84791131412603820028e-25), K(2.28434035708048367199e-27),
+  K(7.90429189301205422833e-30), K(2.43959626327532537911e-32), K(6.75788438580422542691e-35),
+  K(1.68947109645105635673e-37)
+};
+/* Chebyshev coefficients of sqrt(x)*exp(-x)*I0(x) on (8,inf) from Cephes */
+static const R i0_cheb_hi[] = {
+  K(-7.23318048787475395456E-18), K(-4.83050448594418207126E-18), K(4.46562142029675999901E-17),
+  K(3.46122286769746109310E-17), K(-2.82762398051658348494E-16), K(-3.42548561967721913462E-16),
+  K(1.77256013305652638360E-15), K(3.81168066935262242075E-15), K(-9.55484669882830764870E-15),
+  K(-4.15056934728722208663E-14), K(1.54008621752140982691E-14), K(3.85277838274214270114E-13),
+  K(7.18012445138366623367E-13), K(-1.79417853150680611778E-12), K(-1.32158118404477131188E-11),
+  K(-3.14991652796324136454E-11), K(1.18891471078464383424E-11), K(4.94060238822496958910E-10),
+  K(3.39623202570838634515E-9), K(2.26666899049817806459E-8), K(2.04891858946906374183E-7),
+  K(2.89137052083475648297E-6), K(6.88975834691682398426E-5), K(3.36911647825569408990E-3),
+  K(8.04490411014108831608E-1)
+};
+#endif
+
+static inline R vexp(
+    R x);
+static inline R vsin(
+    R x);
+static inline R vsinhc(
+    R y);
+static void batch_kaiser_bessel(
+    R b, int m, int cutoff, const R *u,
+    R *psi);
+static void batch_i0(
+    const R *x,
+    R *i0);
+static void batch_bessel_i0(
+    R b, int m, int cutoff, const R *u,
+    R *psi);
+static void batch_sinc_power(
+    R b, int m, int cutoff, const R *u,
+    R *psi);
+static void batch_gaussian(
+    R b, int cutoff, const R *u,
+    R *psi);
+static void batch_es(
+    R b, int m, int cutoff, const R *u,
+    R *psi);
+
+
+/* exp(x) by reduction x = k*log(2) + r, |r| <= log(2)/2, Taylor polynomial of degree 13 and
+ * multiplication with 2^k that is assembled from the binary digits of k */
+static inline R vexp(
+    R x
+    )
+{
+  const R ln2_hi = K(6.93147180369123816490e-01), ln2_lo = K(1.90821492927058770002e-10);
+
+  /* selections are written as arithmetic with 0/1 masks to keep the code free of jumps */
+  R lo = (R) (x < -EXP_MAX), hi = (R) (x > EXP_MAX);
+  x = (K(1.0)-lo-hi)*x + (hi-lo)*EXP_MAX;
+
+  R kf = x * K(1.442695040888963407359924681001892137);
+  int k = (int) (kf + ((kf >= 0) ? K(0.5) : K(-0.5)));
+  R r = (x - k*ln2_hi) - k*ln2_lo;
+
+  R p = K(1.60590438368216145994e-10);
+  p = p*r + K(2.08767569878680989792e-9);
+  p = p*r + K(2.50521083854417187751e-8);
+  p = p*r + K(2.75573192239858906526e-7);
+  p = p*r + K(2.75573192239858906526e-6);
+  p = p*r + K(2.48015873015873015873e-5);
+  p = p*r + K(1.98412698412698412698e-4);
+  p = p*r + K(1.38888888888888888889e-3);
+  p = p*r + K(8.33333333333333333333e-3);
+  p = p*r + K(4.16666666666666666667e-2);
+  p = p*r + K(1.66666666666666666667e-1);
+  p = p*r + K(0.5);
+  p = p*r + K(1.0);
+  p = p*r + K(1.0);
+
+  int a = (k < 0) ? -k : k;
+  R neg = (R) (k < 0);
+  for(int i=0; i<EXP_BITS; i++){
+    R bit = (R) ((a >> i) & 1);
+    R pow2 = neg*exp_pow2_inv[i] + (K(1.0)-neg)*exp_pow2[i];
+    p *= bit*pow2 + (K(1.0)-bit);
+  }
+
+  return p;
+}
+
+/* sin(x) by reduction x = k*pi + r, |r| <= pi/2, and Taylor polynomial of degree 21 */
+static inline R vsin(
+    R x
+    )
+{
+  const R pi_hi = K(3.140625), pi_lo = K(9.67653589793238462643383279502884197e-4);
+
+  R kf = x * K(0.3183098861837906715377675267450287241);
+  int k = (int) (kf + ((kf >= 0) ? K(0.5) : K(-0.5)));
+  R r = (x - k*pi_hi) - k*pi_lo;
+  R r2 = r*r;
+
+  R p = K(1.95729410633912612308e-20);
+  p = p*r2 + K(-8.22063524662432971696e-18);
+  p = p*r2 + K(2.81145725434552076320e-15);
+  p = p*r2 + K(-7.64716373181981647590e-13);
+  p = p*r2 + K(1.60590438368216145994e-10);
+  p = p*r2 + K(-2.50521083854417187751e-8);
+  p = p*r2 + K(2.75573192239858906526e-6);
+  p = p*r2 + K(-1.98412698412698412698e-4);
+  p = p*r2 + K(8.33333333333333333333e-3);
+  p = p*r2 + K(-1.66666666666666666667e-1);
+  p = p*r2 + K(1.0);
+  p *= r;
+
+  return p * (K(1.0) - K(2.0)*(R) (k & 1));
+}
+
+/* sinh(y)/y for y >= 0, series expansion for small y avoids cancellation and division by zero */
+static inline R vsinhc(
+    R y
+    )
+{
+  const R small = (R) (y < K(0.125));
+  R e = vexp(y);
+  R ys = y + small;
+  R y2 = y*y;
+
+  R series = K(1.0) + y2*(K(1.66666666666666666667e-1) + y2*(K(8.33333333333333333333e-3)
+        + y2*(K(1.98412698412698412698e-4) + y2*(K(2.75573192239858906526e-6)
+        + y2*K(2.50521083854417187751e-8)))));
+
+  R big = K(0.5)*(e - K(1.0)/e)/ys;
+
+  return small*series + (K(1.0)-small)*big;
+}
+
+
+/* Kaiser-Bessel window sinh(b*sqrt(m^2-u^2))/(pi*sqrt(m^2-u^2)).
+ * The rare stencil points with m^2-u^2 < 0 are fixed afterwards by the scalar formula. */
+static void batch_kaiser_bessel(
+    R b, int m, int cutoff, const R *u,
+    R *psi
+    )
+{
+  const R scale = b / PNFFT_PI;
+  R mm = (R)m * (R)m;
+
+  for(int s=0; s<cutoff; s++){
+    R *ps = psi + B*s;
+    for(int p=0; p<B; p++){
+      R v = u[p] + s;
+      R d = mm - v*v;
+      R inside = (R) (d >= 0);
+      R r = pnfft_sqrt(pnfft_fabs(d)*inside);
+      ps[p] = scale * vsinhc(b*r);
+    }
+  }
+
+  for(int s=0; s<cutoff; s++){
+    for(int p=0; p<B; p++){
+      R v = u[p] + s;
+      R d = mm - v*v;
+      if(d < 0){
+        R r = pnfft_sqrt(-d);
+        psi[B*s+p] = pnfft_sin(b*r) / ((R)PNFFT_PI*r);
+      }
+    }
+  }
+}
+
+/* I0(x[p]) for x[p] >= 0 by a fixed number of terms on both sides of I0_SPLIT. Both sides are evaluated
+ * at arguments clamped to their interval and combined with 0/1 masks, which keeps the code free of jumps.
+ * Single precision uses the polynomials of Abramowitz and Stegun 9.8.1 and 9.8.2 (relative error below 3e-7),
+ * the other precisions the power series of degree 20 below 8 and the Chebyshev expansion of Cephes above
+ * (relative error below 6e-16). All recurrences run over the particles in the innermost loop. */
+static void batch_i0(
+    const R *x,
+    R *i0
+    )
+{
+  R lo[B], xh[B];
+#if defined(PNFFT_PREC_SINGLE)
+
+  for(int p=0; p<B; p++){
+    lo[p] = (R) (x[p] <= I0_SPLIT);
+    R xl = lo[p]*x[p] + (K(1.0)-lo[p])*I0_SPLIT;
+    xh[p] = lo[p]*I0_SPLIT + (K(1.0)-lo[p])*x[p];
+
+    R t = xl / I0_SPLIT, y = I0_SPLIT / xh[p];
+    R pl, ph;
+
+    t *= t;
+    pl = K(0.0045813);
+    pl = pl*t + K(0.0360768);
+    pl = pl*t + K(0.2659732);
+    pl = pl*t + K(1.2067492);
+    pl = pl*t + K(3.0899424);
+    pl = pl*t + K(3.5156229);
+    pl = pl*t + K(1.0);
+
+    ph = K(0.00392377);
+    ph = ph*y - K(0.01647633);
+    ph = ph*y + K(0.02635537);
+    ph = ph*y - K(0.02057706);
+    ph = ph*y + K(0.00916281);
+    ph = ph*y - K(0.00157565);
+    ph = ph*y + K(0.00225319);
+    ph = ph*y + K(0.01328592);
+    ph = ph*y + K(0.39894228);
+
+    i0[p] = lo[p]*pl + (K(1.0)-lo[p]) * vexp(x[p]) * ph / pnfft_sqrt(xh[p]);
+  }
+#else
+  R z[B], pl[B], yh[B], h0[B], h1[B], h2[B];
+
+  for(int p=0; p<B; p++){
+    lo[p] = (R) (x[p] <= I0_SPLIT);
+    R xl = lo[p]*x[p] + (K(1.0)-lo[p])*I0_SPLIT;
+    xh[p] = lo[p]*I0_SPLIT + (K(1.0)-lo[p])*x[p];
+    z[p] = K(0.25)*xl*xl;
+    pl[p] = i0_series[I0_SERIES-1];
+    yh[p] = K(32.0)/xh[p] - K(2.0);
+    h0[p] = i0_cheb_hi[0]; h1[p] = 0;
+  }
+
+  for(size_t k=I0_SERIES-1; k>0; k--)
+    for(int p=0; p<B; p++)
+      pl[p] = pl[p]*z[p] + i0_series[k-1];
+
+  /* Clenshaw recurrence of the Cephes routine chbevl */
+  for(size_t k=1; k<I0_CHEB_HI; k++){
+    for(int p=0; p<B; p++){
+      h2[p] = h1[p]; h1[p] = h0[p];
+      h0[p] = yh[p]*h1[p] - h2[p] + i0_cheb_hi[k];
+    }
+  }
+
+  for(int p=0; p<B; p++)
+    i0[p] = lo[p]*pl[p] + (K(1.0)-lo[p]) * vexp(x[p]) * K(0.5)*(h0[p]-h2[p]) / pnfft_sqrt(xh[p]);
+#endif
+}
+
+/* window 0.5*I0(b*sqrt(m^2-u^2)) with compact support */
+static void batch_bessel_i0(
+    R b, int m, int cutoff, const R *u,
+    R *psi
+    )
+{
+  R arg[B], inside[B];
+  R mm = (R)m * (R)m;
+
+  for(int s=0; s<cutoff; s++){
+    R *ps = psi + B*s;
+    for(int p=0; p<B; p++){
+      R v = u[p] + s;
+      R d = mm - v*v;
+      inside[p] = (R) (d >= 0);
+      arg[p] = b*pnfft_sqrt(pnfft_fabs(d)*inside[p]);
+    }
+    batch_i0(arg, ps);
+    for(int p=0; p<B; p++)
+      ps[p] *= K(0.5)*inside[p];
+  }
+}
+
+/* window sinc(pi*u/b)^(2m)/b */
+static void batch_sinc_power(
+    R b, int m, int cutoff, const R *u,
+    R *psi
+    )
+{
+  R base[B];
+
+  for(int s=0; s<cutoff; s++){
+    R *ps = psi + B*s;
+    for(int p=0; p<B; p++){
+      R v = PNFFT_PI * (u[p] + s) / b;
+      R tiny = (R) (pnfft_fabs(v) < PNFFT_EPSILON);
+      R q = vsin(v)/(v + tiny);
+      base[p] = tiny + (K(1.0)-tiny)*q;
+      ps[p] = K(1.0) / b;
+    }
+
+    /* integer power by repeated squaring, the exponent is the same for all particles */
+    for(int e=2*m; e>0; e>>=1){
+      if(e & 1)
+        for(int p=0; p<B; p++)
+          ps[p] *= base[p];
+      for(int p=0; p<B; p++)
+        base[p] *= base[p];
+    }
+  }
+}
+
+/* window exp(-u^2/b)/sqrt(pi*b) */
+static void batch_gaussian(
+    R b, int cutoff, const R *u,
+    R *psi
+    )
+{
+  const R norm = K(1.0) / pnfft_sqrt(PNFFT_PI*b), inv_b = K(1.0) / b;
+
+  for(int s=0; s<cutoff; s++){
+    R *ps = psi + B*s;
+    for(int p=0; p<B; p++){
+      R v = u[p] + s;
+      ps[p] = norm * vexp(-v*v*inv_b);
+    }
+  }
+}
+
+/* window exp(b*(sqrt(1-(u/m)^2)-1)) with compact support */
+static void batch_es(
+    R b, int m, int cutoff, const R *u,
+    R *psi
+    )
+{
+  const R inv_m = K(1.0) / m;
+
+  for(int s=0; s<cutoff; s++){
+    R *ps = psi + B*s;
+    for(int p=0; p<B; p++){
+      R v = (u[p] + s) * inv_m;
+      R d = K(1.0) - v*v;
+      R inside = (R) (d >= 0);
+      ps[p] = inside * vexp( b*(pnfft_sqrt(pnfft_fabs(d))*inside - K(1.0)) );
+    }
+  }
+}
+
+
+/* Check if the window of plan flags 'pnfft_flags' can be evaluated by PNX(pre_psi_tensor_batch). */
+int PNX(window_batch_supported)(
+    unsigned pnfft_flags
+    )
+{
+#if defined(PNFFT_PREC_LDOUBLE)
+  /* polynomial kernels are designed for single and double precision */
+  return 0;
+#else
+  if(pnfft_flags & (PNFFT_PRE_POLY_PSI | PNFFT_PRE_INTPOL_PSI))
+    return 0;
+  if(pnfft_flags & PNFFT_WINDOW_BSPLINE)
+    return 0;
+  if( (pnfft_flags & PNFFT_WINDOW_GAUSSIAN) && (pnfft_flags & PNFFT_FAST_GAUSSIAN) )
+    return 0;
+  return 1;
+#endif
+}
+
+/* Evaluate the window for 'num' <= PNFFT_WINDOW_BATCH particles with coordinates x[3*p+t] and
+ * lowest grid indices floor_nx[3*p+t]. 'buf' must hold 3*cutoff*PNFFT_WINDOW_BATCH values. */
+void PNX(pre_psi_tensor_batch)(
+    const PNX(plan) ths, int num, const R *x, const R *floor_nx,
+    R *buf,
+    R *pre_psi
+    )
+{
+  const int d = ths->d, cutoff = ths->cutoff;
+  R u[B];
+
+  for(int t=0, o=0; t<d; o+=ths->cutoff_dim[t], t++){
+    const int m = ths->m_dim[t], cutoff_t = ths->cutoff_dim[t];
+    R *psi = buf + B*o;
+
+    /* stage coordinates in SoA form, unused lanes repeat the first particle */
+    for(int p=0; p<B; p++){
+      int q = (p < num) ? p : 0;
+      u[p] = floor_nx[3*q+t] - ths->n[t]*x[3*q+t] - m;
+    }
+
+    if(ths->pnfft_flags & PNFFT_WINDOW_GAUSSIAN)
+      batch_gaussian(ths->b[t], cutoff_t, u, psi);
+    else if(ths->pnfft_flags & PNFFT_WINDOW_SINC_POWER)
+      batch_sinc_power(ths->b[t], m, cutoff_t, u, psi);
+    else if(ths->pnfft_flags & PNFFT_WINDOW_BESSEL_I0)
+      batch_bessel_i0(ths->b[t], m, cutoff_t, u, psi);
+    else if(ths->pnfft_flags & PNFFT_WINDOW_ES)
+      batch_es(ths->b[t], m, cutoff_t, u, psi);
+    else
+      batch_kaiser_bessel(ths->b[t], m, cutoff_t, u, psi);
+  }
+
+  /* hand out per particle weights, trivial axes have cutoff_dim=1 */
+  for(int p=0; p<num; p++)
+    for(int t=0, o=0; t<3; o+=ths->cutoff_dim[t], t++)
+      for(int s=0; s<ths->cutoff_dim[t]; s++)
+        pre_psi[3*cutoff*p + o + s] = (t < d) ? buf[B*(o+s) + p] : K(1.0);
+}
+
+/* Sample the window at the grid distances u = m + j/num_nodes - c for j=j_start,...,j_end-1
+ * and c=0,...,cutoff-1, which are the values needed for the interpolation tables.
+ * The results are stored as samples[cutoff*(j-j_start) + c]. */
+void PNX(sample_window_batch)(
+    const PNX(plan) ths, int dim, INT j_start, INT j_end, INT num_nodes,
+    R *samples
+    )
+{
+  const int cutoff = ths->cutoff_dim[dim], m = ths->m_dim[dim];
+  R u[B], *psi = (R*) PNX(malloc_tagged)(sizeof(R) * (size_t) (B*cutoff), PNFFT_MEM_WINDOW_TABLES, NULL);
+
+  for(INT j0=j_start; j0<j_end; j0+=B){
+    INT num = PNFFT_MIN(B, j_end-j0);
+
+    /* psi is even, so stencil offset s corresponds to c = cutoff-1-s */
+    for(int p=0; p<B; p++){
+      INT j = (p < num) ? j0+p : j0;
+      u[p] = m + (R)j/num_nodes - (cutoff-1);
+    }
+
+    if(ths->pnfft_flags & PNFFT_WINDOW_GAUSSIAN)
+      batch_gaussian(ths->b[dim], cutoff, u, psi);
+    else if(ths->pnfft_flags & PNFFT_WINDOW_SINC_POWER)
+      batch_sinc_power(ths->b[dim], m, cutoff, u, psi);
+    else if(ths->pnfft_flags & PNFFT_WINDOW_BESSEL_I0)
+      batch_bessel_i0(ths->b[dim], m, cutoff, u, psi);
+    else if(ths->pnfft_flags & PNFFT_WINDOW_ES)
+      batch_es(ths->b[dim], m, cutoff, u, psi);
+    else
+      batch_kaiser_bessel(ths->b[dim], m, cutoff, u, psi);
+
+    for(INT p=0; p<num; p++)
+      for(int s=0; s<cutoff; s++)
+        samples[cutoff*(j0-j_start+p) + cutoff-1-s] = psi[B*s+p];
+  }
+
+  PNX(free)(psi);
+}
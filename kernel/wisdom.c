@@ -0,0 +1,448 @@
+/*
+ * Copyright (c) 2011-2013 Michael Pippig
+ *
+ * This file is part of PNFFT.
+ *
+ * PNFFT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PNFFT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PNFFT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include "pnfft.h"
+#include "ipnfft.h"
+
+/* Wisdom of PNFFT consists of the FFTW wisdom (PFFT plans are built from serial FFTW plans
+ * and FFTW's global transposes) and of the parameters PNFFT derives during plan creation.
+ * The derived parameters are remembered per geometry (window, d, N, n, m per dimension,
+ * interpolation order, process mesh) in a process wide list and are used as starting guess by later plans.
+ * In addition, the configurations chosen by init_auto are remembered per N, accuracy,
+ * process mesh and auto flags together with their measured run time.
+ *
+ * File format:
+ *   (pnfft-wisdom-2 <num_records>
+ *     (plan window d N0 N1 N2 n0 n1 n2 m0 m1 m2 intpol_order np0 np1 np2 intpol_num_nodes poly_degree)
+ *     (auto N0 N1 N2 eps np0 np1 np2 auto_flags m n0 n1 n2 pnfft_flags time)
+ *     ...
+ *   )
+ *   <FFTW wisdom>
+ * The records of a file are only imported if all of them can be parsed. */
+
+#define WISDOM_HEADER "(pnfft-wisdom-2"
+
+typedef struct wisdom_entry_s{
+  unsigned window;            /**< Window flags                                    */
+  int d;                      /**< Number of dimensions                            */
+  INT N[3];                   /**< Size of NFFT                                    */
+  INT n[3];                   /**< FFT length                                      */
+  int m[3];                   /**< Cut-off parameters of the window function       */
+  int intpol_order;           /**< Order of window interpolation                   */
+  int np[3];                  /**< Size of Cartesian communicator                  */
+
+  INT intpol_num_nodes;       /**< Number of interpolation nodes per interval      */
+  int poly_degree;            /**< Degree of piecewise polynomial window           */
+  struct wisdom_entry_s *next;
+} wisdom_entry;
+
+typedef struct auto_entry_s{
+  INT N[3];                   /**< Size of NFFT                                    */
+  double eps;                 /**< Requested accuracy                              */
+  int np[3];                  /**< Size of Cartesian communicator                  */
+  unsigned auto_flags;        /**< Flags of the search                             */
+
+  int m;                      /**< Chosen cut-off parameter                        */
+  INT n[3];                   /**< Chosen FFT length                               */
+  unsigned pnfft_flags;       /**< Chosen window, evaluation and interlacing flags */
+  double time;                /**< Measured time of trafo and adj (0 if estimated) */
+  struct auto_entry_s *next;
+} auto_entry;
+
+static wisdom_entry *wisdom_list = NULL;
+static auto_entry *auto_list = NULL;
+
+static wisdom_entry* find_entry(
+    wisdom_entry *list, unsigned window, int d, const INT *N, const INT *n, const int *m,
+    int intpol_order, const int *np);
+static wisdom_entry* add_entry(
+    wisdom_entry **list, unsigned window, int d, const INT *N, const INT *n, const int *m,
+    int intpol_order, const int *np);
+static auto_entry* find_auto_entry(
+    auto_entry *list, const INT *N, double eps, const int *np, unsigned auto_flags);
+static auto_entry* add_auto_entry(
+    auto_entry **list, const INT *N, double eps, const int *np, unsigned auto_flags);
+static void free_lists(
+    wisdom_entry **list, auto_entry **alist);
+static int parse_records(
+    const char *str, wisdom_entry **list, auto_entry **alist,
+    const char **fftw_wisdom);
+static char* read_file(
+    const char *filename, MPI_Comm comm);
+
+
+static wisdom_entry* find_entry(
+    wisdom_entry *list, unsigned window, int d, const INT *N, const INT *n, const int *m,
+    int intpol_order, const int *np
+    )
+{
+  for(wisdom_entry *e = list; e != NULL; e = e->next){
+    int match = (e->window == window) && (e->d == d) && (e->intpol_order == intpol_order);
+    for(int t=0; t<3; t++)
+      match = match && (e->N[t] == N[t]) && (e->n[t] == n[t]) && (e->m[t] == m[t]) && (e->np[t] == np[t]);
+    if(match)
+      return e;
+  }
+  return NULL;
+}
+
+static wisdom_entry* add_entry(
+    wisdom_entry **list, unsigned window, int d, const INT *N, const INT *n, const int *m,
+    int intpol_order, const int *np
+    )
+{
+  wisdom_entry *e = find_entry(*list, window, d, N, n, m, intpol_order, np);
+
+  if(e != NULL)
+    return e;
+
+  e = (wisdom_entry*) malloc(sizeof(wisdom_entry));
+  e->window = window;
+  e->d = d;
+  e->intpol_order = intpol_order;
+  for(int t=0; t<3; t++){
+    e->N[t]  = N[t];
+    e->n[t]  = n[t];
+    e->m[t]  = m[t];
+    e->np[t] = np[t];
+  }
+  e->intpol_num_nodes = 0;
+  e->poly_degree = 0;
+
+  e->next = *list;
+  *list = e;
+  return e;
+}
+
+static auto_entry* find_auto_entry(
+    auto_entry *list, const INT *N, double eps, const int *np, unsigned auto_flags
+    )
+{
+  for(auto_entry *e = list; e != NULL; e = e->next){
+    int match = (e->eps == eps) && (e->auto_flags == auto_flags);
+    for(int t=0; t<3; t++)
+      match = match && (e->N[t] == N[t]) && (e->np[t] == np[t]);
+    if(match)
+      return e;
+  }
+  return NULL;
+}
+
+static auto_entry* add_auto_entry(
+    auto_entry **list, const INT *N, double eps, const int *np, unsigned auto_flags
+    )
+{
+  auto_entry *e = find_auto_entry(*list, N, eps, np, auto_flags);
+
+  if(e != NULL)
+    return e;
+
+  e = (auto_entry*) malloc(sizeof(auto_entry));
+  for(int t=0; t<3; t++){
+    e->N[t]  = N[t];
+    e->np[t] = np[t];
+  }
+  e->eps = eps;
+  e->auto_flags = auto_flags;
+  e->next = *list;
+  *list = e;
+  return e;
+}
+
+static void free_lists(
+    wisdom_entry **list, auto_entry **alist
+    )
+{
+  while(*list != NULL){
+    wisdom_entry *e = *list;
+    *list = e->next;
+    free(e);
+  }
+
+  while(*alist != NULL){
+    auto_entry *e = *alist;
+    *alist = e->next;
+    free(e);
+  }
+}
+
+/* Parse the PNFFT records of a wisdom string into 'list' and 'alist'. Returns 0 on error.
+ * On success '*fftw_wisdom' points to the FFTW part of 'str'. */
+static int parse_records(
+    const char *str, wisdom_entry **list, auto_entry **alist,
+    const char **fftw_wisdom
+    )
+{
+  int num_records, pos;
+
+  if( sscanf(str, WISDOM_HEADER " %d%n", &num_records, &pos) != 1 )
+    return 0;
+  str += pos;
+
+  for(int k=0; k<num_records; k++){
+    unsigned window, auto_flags, pnfft_flags;
+    int d, m[3], intpol_order, np[3], poly_degree;
+    INT N[3], n[3], intpol_num_nodes;
+    double eps, time;
+
+    if( sscanf(str, " (plan %u %d %td %td %td %td %td %td %d %d %d %d %d %d %d %td %d )%n",
+          &window, &d, &N[0], &N[1], &N[2], &n[0], &n[1], &n[2], &m[0], &m[1], &m[2], &intpol_order,
+          &np[0], &np[1], &np[2], &intpol_num_nodes, &poly_degree, &pos) == 17 )
+    {
+      wisdom_entry *e = add_entry(list, window, d, N, n, m, intpol_order, np);
+      e->intpol_num_nodes = intpol_num_nodes;
+      e->poly_degree      = poly_degree;
+    } else if( sscanf(str, " (auto %td %td %td %le %d %d %d %u %d %td %td %td %u %le )%n",
+          &N[0], &N[1], &N[2], &eps, &np[0], &np[1], &np[2], &auto_flags,
+          &m[0], &n[0], &n[1], &n[2], &pnfft_flags, &time, &pos) == 14 )
+    {
+      auto_entry *e = add_auto_entry(alist, N, eps, np, auto_flags);
+      e->m = m[0];
+      for(int t=0; t<3; t++)
+        e->n[t] = n[t];
+      e->pnfft_flags = pnfft_flags;
+      e->time = time;
+    } else
+      return 0;
+    str += pos;
+  }
+
+  pos = -1;
+  sscanf(str, " )%n", &pos);
+  if(pos < 0)
+    return 0;
+  *fftw_wisdom = str + pos;
+  return 1;
+}
+
+/* Read the whole file on rank 0 of 'comm' and broadcast the content to all processes.
+ * Returns NULL on all processes, if the file can not be read. */
+static char* read_file(
+    const char *filename, MPI_Comm comm
+    )
+{
+  int myrnk;
+  long len = -1;
+  char *buf = NULL;
+
+  MPI_Comm_rank(comm, &myrnk);
+
+  if(myrnk == 0){
+    FILE *f = fopen(filename, "rb");
+    if(f != NULL){
+      if( (fseek(f, 0, SEEK_END) == 0) && ((len = ftell(f)) >= 0) && (fseek(f, 0, SEEK_SET) == 0) ){
+        buf = (char*) malloc((size_t) len + 1);
+        if( fread(buf, 1, (size_t) len, f) != (size_t) len ){
+          free(buf);
+          buf = NULL;
+          len = -1;
+        }
+      } else
+        len = -1;
+      fclose(f);
+    }
+  }
+
+  MPI_Bcast(&len, 1, MPI_LONG, 0, comm);
+  if(len < 0)
+    return NULL;
+
+  if(myrnk != 0)
+    buf = (char*) malloc((size_t) len + 1);
+  MPI_Bcast(buf, (int) len, MPI_CHAR, 0, comm);
+  buf[len] = '\0';
+
+  return buf;
+}
+
+
+/* Look up the derived parameters of a plan with the geometry of 'ths'.
+ * Returns 0 if there is no wisdom, otherwise the nonzero parameters are written to the outputs. */
+int PNX(recall_wisdom)(
+    const PNX(plan) ths,
+    INT *intpol_num_nodes, int *poly_degree
+    )
+{
+  INT N[3] = {1, 1, 1}, n[3] = {1, 1, 1};
+  int m[3] = {0, 0, 0};
+  wisdom_entry *e;
+
+  for(int t=0; t<ths->d; t++){
+    N[t] = ths->N[t];
+    n[t] = ths->n[t];
+    m[t] = ths->m_dim[t];
+  }
+
+  e = find_entry(wisdom_list, ths->pnfft_flags & PNFFTI_WINDOW_MASK, ths->d, N, n, m, ths->intpol_order, ths->np);
+  if(e == NULL)
+    return 0;
+
+  if( (intpol_num_nodes != NULL) && (e->intpol_num_nodes > 0) )
+    *intpol_num_nodes = e->intpol_num_nodes;
+  if( (poly_degree != NULL) && (e->poly_degree > 0) )
+    *poly_degree = e->poly_degree;
+  return 1;
+}
+
+/* Store the derived parameters of 'ths', such that they are exported with the next call of export_wisdom. */
+void PNX(remember_wisdom)(
+    const PNX(plan) ths
+    )
+{
+  INT N[3] = {1, 1, 1}, n[3] = {1, 1, 1};
+  int m[3] = {0, 0, 0};
+  wisdom_entry *e;
+
+  for(int t=0; t<ths->d; t++){
+    N[t] = ths->N[t];
+    n[t] = ths->n[t];
+    m[t] = ths->m_dim[t];
+  }
+
+  e = add_entry(&wisdom_list, ths->pnfft_flags & PNFFTI_WINDOW_MASK, ths->d, N, n, m, ths->intpol_order, ths->np);
+  if(ths->intpol_num_nodes > 0)
+    e->intpol_num_nodes = ths->intpol_num_nodes;
+  if(ths->poly_degree > 0)
+    e->poly_degree = ths->poly_degree;
+}
+
+/* Look up the configuration that init_auto has chosen for equal N, accuracy, process mesh and auto flags.
+ * Returns 0 if there is no wisdom. */
+int PNX(recall_auto_wisdom)(
+    const INT *N, double eps, const int *np, unsigned auto_flags,
+    int *m, INT *n, unsigned *pnfft_flags, double *time
+    )
+{
+  auto_entry *e = find_auto_entry(auto_list, N, eps, np, auto_flags);
+
+  if(e == NULL)
+    return 0;
+
+  *m = e->m;
+  for(int t=0; t<3; t++)
+    n[t] = e->n[t];
+  *pnfft_flags = e->pnfft_flags;
+  *time = e->time;
+  return 1;
+}
+
+/* Store the configuration chosen by init_auto, such that it is exported with the next call of export_wisdom. */
+void PNX(remember_auto_wisdom)(
+    const INT *N, double eps, const int *np, unsigned auto_flags,
+    int m, const INT *n, unsigned pnfft_flags, double time
+    )
+{
+  auto_entry *e = add_auto_entry(&auto_list, N, eps, np, auto_flags);
+
+  e->m = m;
+  for(int t=0; t<3; t++)
+    e->n[t] = n[t];
+  e->pnfft_flags = pnfft_flags;
+  e->time = time;
+}
+
+
+/* Collective on 'comm'. The FFTW wisdom of all processes is gathered on rank 0,
+ * which writes it together with the PNFFT records to 'filename'.
+ * Returns 1 on success and 0 on failure (on all processes). */
+int PNX(export_wisdom)(
+    const char *filename, MPI_Comm comm
+    )
+{
+  int myrnk, success = 0;
+
+  MPI_Comm_rank(comm, &myrnk);
+  X(mpi_gather_wisdom)(comm);
+
+  if(myrnk == 0){
+    FILE *f = fopen(filename, "w");
+    if(f != NULL){
+      int num_records = 0;
+      for(wisdom_entry *e = wisdom_list; e != NULL; e = e->next)
+        num_records++;
+      for(auto_entry *e = auto_list; e != NULL; e = e->next)
+        num_records++;
+
+      fprintf(f, WISDOM_HEADER " %d\n", num_records);
+      for(wisdom_entry *e = wisdom_list; e != NULL; e = e->next)
+        fprintf(f, "  (plan %u %d %td %td %td %td %td %td %d %d %d %d %d %d %d %td %d)\n",
+            e->window, e->d, e->N[0], e->N[1], e->N[2], e->n[0], e->n[1], e->n[2],
+            e->m[0], e->m[1], e->m[2], e->intpol_order,
+            e->np[0], e->np[1], e->np[2], e->intpol_num_nodes, e->poly_degree);
+      for(auto_entry *e = auto_list; e != NULL; e = e->next)
+        fprintf(f, "  (auto %td %td %td %.17e %d %d %d %u %d %td %td %td %u %.6e)\n",
+            e->N[0], e->N[1], e->N[2], e->eps, e->np[0], e->np[1], e->np[2], e->auto_flags,
+            e->m, e->n[0], e->n[1], e->n[2], e->pnfft_flags, e->time);
+      fprintf(f, ")\n");
+
+      X(export_wisdom_to_file)(f);
+      success = (fclose(f) == 0);
+    }
+  }
+
+  MPI_Bcast(&success, 1, MPI_INT, 0, comm);
+  return success;
+}
+
+/* Collective on 'comm'. Rank 0 reads 'filename' and broadcasts its content,
+ * afterwards all processes import the same PNFFT records and FFTW wisdom.
+ * Returns 1 on success and 0 on failure (on all processes). */
+int PNX(import_wisdom)(
+    const char *filename, MPI_Comm comm
+    )
+{
+  const char *fftw_wisdom;
+  int success;
+  wisdom_entry *list = NULL;
+  auto_entry *alist = NULL;
+  char *buf = read_file(filename, comm);
+
+  if(buf == NULL)
+    return 0;
+
+  /* keep the records of the calling process unless the whole file is valid */
+  success = parse_records(buf, &list, &alist, &fftw_wisdom);
+  if(success)
+    success = X(import_wisdom_from_string)(fftw_wisdom);
+
+  if(success){
+    for(wisdom_entry *e = list; e != NULL; e = e->next){
+      wisdom_entry *g = add_entry(&wisdom_list, e->window, e->d, e->N, e->n, e->m, e->intpol_order, e->np);
+      g->intpol_num_nodes = e->intpol_num_nodes;
+      g->poly_degree      = e->poly_degree;
+    }
+    for(auto_entry *e = alist; e != NULL; e = e->next)
+      PNX(remember_auto_wisdom)(e->N, e->eps, e->np, e->auto_flags, e->m, e->n, e->pnfft_flags, e->time);
+  }
+
+  free_lists(&list, &alist);
+  free(buf);
+  return success;
+}
+
+/* Forget the PNFFT records and the FFTW wisdom of the calling process. */
+void PNX(forget_wisdom)(
+    void
+    )
+{
+  free_lists(&wisdom_list, &auto_list);
+  X(forget_wisdom)();
+}
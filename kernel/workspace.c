@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2011-2013 Michael Pippig
+ *
+ * This file is part of PNFFT.
+ *
+ * PNFFT is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PNFFT is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PNFFT.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Every plan owns one workspace for the temporaries of trafo and adj (sorted node indices,
+ * window values of a batch, broadcast blocks of the direct transform, deconvolution tables).
+ * Buffers are handed out in stack order: PNX(workspace_mark) remembers the fill level and
+ * PNX(workspace_release) returns all buffers taken after the mark.
+ * Requests beyond the capacity are served from the heap. As soon as the workspace is empty again,
+ * it grows to the high-water mark, i.e., after the first call of a transform the following calls
+ * with the same nodes do not allocate at all. */
+
+#include "pnfft.h"
+#include "ipnfft.h"
+
+/* buffers start at cache line boundaries, such that they do not share lines */
+#define PNFFT_WORKSPACE_ALIGN 64
+
+/* header of heap blocks, padded to keep the alignment of the buffer behind it */
+typedef union spill_u{
+  struct{
+    union spill_u *next;      /**< Next older heap block                           */
+    size_t offset;            /**< Fill level of the workspace at allocation       */
+  } s;
+  char pad[PNFFT_WORKSPACE_ALIGN];
+} spill_s;
+
+static size_t round_up(
+    size_t n);
+static void resize(
+    PNX(plan) ths, size_t capacity);
+
+
+void PNX(init_workspace)(
+    PNX(plan) ths
+    )
+{
+  ths->ws.base = NULL;
+  ths->ws.capacity = 0;
+  ths->ws.used = 0;
+  ths->ws.high_water = 0;
+  ths->ws.spill = NULL;
+}
+
+void PNX(free_workspace)(
+    PNX(plan) ths
+    )
+{
+  ths->ws.high_water = 0;
+  PNX(workspace_release)(ths, 0);
+  resize(ths, 0);
+}
+
+size_t PNX(workspace_mark)(
+    const PNX(plan) ths
+    )
+{
+  return ths->ws.used;
+}
+
+/* Returns a buffer of at least 'n' bytes that stays valid until the workspace is released
+ * to a mark taken before this call. Returns NULL for n == 0. */
+void *PNX(workspace_get)(
+    PNX(plan) ths, size_t n
+    )
+{
+  workspace_s *ws = &ths->ws;
+  void *p;
+
+  if(n == 0)
+    return NULL;
+
+  n = round_up(n);
+  if(ws->used + n <= ws->capacity)
+    p = ws->base + ws->used;
+  else {
+    spill_s *s = (spill_s*) PNX(malloc_tagged)(sizeof(spill_s) + n, PNFFT_MEM_WORKSPACE, &ths->mem);
+    if(s == NULL)
+      return NULL;
+    s->s.next = (spill_s*) ws->spill;
+    s->s.offset = ws->used;
+    ws->spill = s;
+    p = s + 1;
+  }
+
+  ws->used += n;
+  if(ws->used > ws->high_water)
+    ws->high_water = ws->used;
+
+  return p;
+}
+
+/* Return all buffers taken after 'mark'. The emptied workspace grows to the largest fill level seen so far. */
+void PNX(workspace_release)(
+    PNX(plan) ths, size_t mark
+    )
+{
+  workspace_s *ws = &ths->ws;
+
+  /* heap blocks are listed newest first */
+  while(ws->spill != NULL && ((spill_s*) ws->spill)->s.offset >= mark){
+    spill_s *s = (spill_s*) ws->spill;
+    ws->spill = s->s.next;
+    PNX(free)(s);
+  }
+
+  ws->used = (mark < ws->used) ? mark : ws->used;
+
+  if(ws->used == 0 && ws->high_water > ws->capacity)
+    resize(ths, ws->high_water);
+}
+
+/* bytes of one buffer in the workspace, used by the memory estimate */
+size_t PNX(workspace_size)(
+    size_t n
+    )
+{
+  return round_up(n);
+}
+
+static size_t round_up(
+    size_t n
+    )
+{
+  return (n + PNFFT_WORKSPACE_ALIGN - 1) / PNFFT_WORKSPACE_ALIGN * PNFFT_WORKSPACE_ALIGN;
+}
+
+/* only called with an empty workspace */
+static void resize(
+    PNX(plan) ths, size_t capacity
+    )
+{
+  workspace_s *ws = &ths->ws;
+
+  PNX(save_free)(ws->base);
+  ws->base = (capacity) ? (char*) PNX(malloc_tagged)(capacity, PNFFT_MEM_WORKSPACE, &ths->mem) : NULL;
+  ws->capacity = (ws->base != NULL) ? capacity : 0;
+}
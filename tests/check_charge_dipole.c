@@ -4,9 +4,11 @@
 
 static void pnfft_perform_guru(
     const ptrdiff_t *N, const ptrdiff_t *n,
-    ptrdiff_t local_Mc, ptrdiff_t local_Md,
+    ptrdiff_t Mc_total, ptrdiff_t Md_total,
+    ptrdiff_t *local_Mc, ptrdiff_t *local_Md,
     int m, const double *x_max, 
     unsigned pnfft_flags, unsigned compute_flags,
+    int nodes_dist, unsigned seed,
     const int *np, MPI_Comm comm, const char *name,
     pnfft_complex **energy, pnfft_complex **force);
 
@@ -19,8 +21,8 @@ static void compare_force(
 
 
 int main(int argc, char **argv){
-  ptrdiff_t local_M, local_Mc, local_Md;
-  int np[3], m, compare_direct=0, debug;
+  ptrdiff_t local_M, local_Mc, local_Md, Mc_total, Md_total;
+  int np[3], m, compare_direct=0, debug, nodes_dist=-1, seed=1, size;
   unsigned pnfft_flags;
   ptrdiff_t N[3], n[3];
   double x_max[3];
@@ -35,22 +37,31 @@ int main(int argc, char **argv){
   pnfft_check_init_parameters(argc, argv, N, n, &local_M, &m, &pnfft_flags, &compute_flags,
       x_max, np, &compare_direct, &debug);
 
-  local_Mc = local_M/2;
-  local_Md = local_M - local_Mc;
+  /* -pnfft_nodes selects one of the deterministic node sets PNFFT_NODES_*,
+   * default is uniform random nodes of srand() */
+  pnfft_get_args(argc, argv, "-pnfft_nodes", 1, PFFT_INT, &nodes_dist);
+  pnfft_get_args(argc, argv, "-pnfft_seed", 1, PFFT_INT, &seed);
+
+  /* all processes got the same number of nodes from the commandline,
+   * both methods use the same total numbers of charges and dipoles */
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  Mc_total = (local_M/2) * size;
+  Md_total = (local_M - local_M/2) * size;
 
   compute_flags &= PNFFT_TRANSPOSED_F_HAT | PNFFT_COMPUTE_DIRECT;
 
   /* calculate parallel NFFT */
-  pnfft_perform_guru(N, n, local_Mc, local_Md, m, x_max, pnfft_flags, compute_flags,
-      np, MPI_COMM_WORLD, "PNFFT",
+  pnfft_perform_guru(N, n, Mc_total, Md_total, &local_Mc, &local_Md, m, x_max, pnfft_flags, compute_flags,
+      nodes_dist, (unsigned) seed, np, MPI_COMM_WORLD, "PNFFT",
       &energy1, &force1);
+  local_M = local_Mc + local_Md;
 
   /* calculate parallel NDFT or NFFT with higher accuracy */
   if(compare_direct) compute_flags |= PNFFT_COMPUTE_DIRECT;
   else               m += 2;
 
-  pnfft_perform_guru(N, n, local_Mc, local_Md, m, x_max, pnfft_flags, compute_flags,
-      np, MPI_COMM_WORLD, "reference method",
+  pnfft_perform_guru(N, n, Mc_total, Md_total, &local_Mc, &local_Md, m, x_max, pnfft_flags, compute_flags,
+      nodes_dist, (unsigned) seed, np, MPI_COMM_WORLD, "reference method",
       &energy2, &force2);
 
   /* calculate error of PNFFT */
@@ -68,16 +79,23 @@ int main(int argc, char **argv){
 }
 
 
+/* Mc_total charges and Md_total dipoles are distributed over all processes and the local numbers
+ * are returned in local_Mc and local_Md. With nodes_dist >= 0 the nodes, charges and dipoles come
+ * from the deterministic generators, otherwise every process gets the same number of random nodes. */
 static void pnfft_perform_guru(
     const ptrdiff_t *N, const ptrdiff_t *n,
-    ptrdiff_t local_Mc, ptrdiff_t local_Md,
+    ptrdiff_t Mc_total, ptrdiff_t Md_total,
+    ptrdiff_t *local_Mc_out, ptrdiff_t *local_Md_out,
     int m, const double *x_max, 
     unsigned pnfft_flags, unsigned compute_flags,
+    int nodes_dist, unsigned seed,
     const int *np, MPI_Comm comm, const char *name,
     pnfft_complex **energy, pnfft_complex **force
     )
 {
-  int myrank;
+  ptrdiff_t local_Mc, local_Md;
+  ptrdiff_t *charges_index = NULL, *dipoles_index = NULL;
+  int myrank, size;
   ptrdiff_t local_N[3], local_N_start[3];
   double lower_border[3], upper_border[3];
   double time, time_max;
@@ -86,9 +104,6 @@ static void pnfft_perform_guru(
   pnfft_nodes charges, dipoles;
   pnfft_complex *buffer;
 
-  *energy = pnfft_alloc_complex(local_Mc + local_Md);
-  *force  = pnfft_alloc_complex(3*local_Mc + 3*local_Md);
-
   /* create three-dimensional process grid of size np[0] x np[1] x np[2], if possible */
   if( pnfft_create_procmesh(3, comm, np, &comm_cart_3d) ){
     pfft_fprintf(comm, stderr, "Error: Procmesh of size %d x %d x %d does not fit to number of allocated processes.\n", np[0], np[1], np[2]);
@@ -98,11 +113,25 @@ static void pnfft_perform_guru(
   }
 
   MPI_Comm_rank(comm_cart_3d, &myrank);
+  MPI_Comm_size(comm_cart_3d, &size);
 
   /* get parameters of data distribution */
   pnfft_local_size_guru(3, N, n, x_max, m, comm_cart_3d, pnfft_flags & PNFFT_TRANSPOSED_F_HAT,
       local_N, local_N_start, lower_border, upper_border);
 
+  if(nodes_dist >= 0){
+    local_Mc = pnfft_local_size_x_3d_dist(nodes_dist, seed, Mc_total, lower_border, upper_border, x_max);
+    local_Md = pnfft_local_size_x_3d_dist(nodes_dist, seed+1, Md_total, lower_border, upper_border, x_max);
+  } else {
+    local_Mc = Mc_total / size;
+    local_Md = Md_total / size;
+  }
+  *local_Mc_out = local_Mc;
+  *local_Md_out = local_Md;
+
+  *energy = pnfft_alloc_complex(local_Mc + local_Md);
+  *force  = pnfft_alloc_complex(3*local_Mc + 3*local_Md);
+
   /* plan parallel NFFT */
   pnfft = pnfft_init_guru(3, N, n, x_max, m,
       PNFFT_MALLOC_F_HAT | pnfft_flags, PFFT_ESTIMATE,
@@ -113,7 +142,7 @@ static void pnfft_perform_guru(
   dipoles = pnfft_init_nodes(local_Md, PNFFT_MALLOC_X | PNFFT_MALLOC_GRAD_F | PNFFT_MALLOC_HESSIAN_F);
 
   pnfft_complex *charges_val = local_Mc ? pnfft_alloc_complex(local_Mc)   : NULL;
-  pnfft_complex *dipoles_val = local_Mc ? pnfft_alloc_complex(3*local_Md) : NULL;
+  pnfft_complex *dipoles_val = local_Md ? pnfft_alloc_complex(3*local_Md) : NULL;
 
   /* get data pointers */
   pnfft_complex *f_hat             = pnfft_get_f_hat(pnfft);
@@ -124,23 +153,42 @@ static void pnfft_perform_guru(
   pnfft_complex *dipoles_hessian_f = pnfft_get_hessian_f(dipoles);
   double        *dipoles_x         = pnfft_get_x(dipoles);
 
-  /* initialize charges and dipoles */
-  srand(myrank);
+  if(nodes_dist >= 0){
+    /* deterministic nodes and values, independent of the process mesh */
+    charges_index = (ptrdiff_t*) malloc(sizeof(ptrdiff_t) * (size_t) (local_Mc + 1));
+    dipoles_index = (ptrdiff_t*) malloc(sizeof(ptrdiff_t) * (size_t) (local_Md + 1));
+
+    pnfft_init_x_3d_dist(nodes_dist, seed, Mc_total, lower_border, upper_border, x_max, local_Mc,
+        charges_x, charges_index);
+    pnfft_init_x_3d_dist(nodes_dist, seed+1, Md_total, lower_border, upper_border, x_max, local_Md,
+        dipoles_x, dipoles_index);
 
-  pnfft_init_f(local_Mc,
-      charges_val);
+    pnfft_init_f_charges(seed, local_Mc, charges_index,
+        charges_val);
+    pnfft_init_grad_f_dipoles(seed, local_Md, dipoles_index,
+        dipoles_val);
 
-  pnfft_init_f(3*local_Md,
-      dipoles_val);
+    free(charges_index);
+    free(dipoles_index);
+  } else {
+    /* initialize charges and dipoles */
+    srand(myrank);
 
-  /* initialize nonequispaced nodes */
-  srand(myrank+1);
+    pnfft_init_f(local_Mc,
+        charges_val);
 
-  pnfft_init_x_3d_adv(lower_border, upper_border, x_max, local_Mc,
-      charges_x);
+    pnfft_init_f(3*local_Md,
+        dipoles_val);
 
-  pnfft_init_x_3d_adv(lower_border, upper_border, x_max, local_Md,
-      dipoles_x);
+    /* initialize nonequispaced nodes */
+    srand(myrank+1);
+
+    pnfft_init_x_3d_adv(lower_border, upper_border, x_max, local_Mc,
+        charges_x);
+
+    pnfft_init_x_3d_adv(lower_border, upper_border, x_max, local_Md,
+        dipoles_x);
+  }
 
   for(ptrdiff_t j=0; j<local_Mc; ++j)
     charges_f[j] = charges_val[j];
@@ -0,0 +1,161 @@
+#include <stdlib.h>
+#include <complex.h>
+#include <pnfft.h>
+
+/* Compare gradient and Hessian computed from separate dpsi/ddpsi interpolation tables
+ * with the derivatives of the cubic psi interpolant (PNFFT_DIFF_INTPOL_PSI).
+ * The derivative of the interpolant loses one power of the table spacing per derivative,
+ * i.e., with the default table size we expect relative errors below 1e-9 for grad_f
+ * and below 1e-5 for hessian_f. */
+#define GRAD_TOL    1e-9
+#define HESSIAN_TOL 1e-5
+
+static void pnfft_perform_guru(
+    const ptrdiff_t *N, const ptrdiff_t *n, ptrdiff_t local_M,
+    int m, const double *x_max,
+    unsigned pnfft_flags, unsigned compute_flags,
+    const int *np, MPI_Comm comm, const char *name,
+    pnfft_complex **grad_f, pnfft_complex **hessian_f);
+
+static int compare(
+    const pnfft_complex *v1, const pnfft_complex *v2, ptrdiff_t local_M, int howmany,
+    double tol, const char *name, MPI_Comm comm);
+
+
+int main(int argc, char **argv){
+  int np[3], m, compare_direct=0, debug, failed=0;
+  unsigned pnfft_flags;
+  ptrdiff_t N[3], n[3], local_M;
+  double x_max[3];
+  unsigned compute_flags;
+  pnfft_complex *grad_f1=NULL, *grad_f2=NULL;
+  pnfft_complex *hessian_f1=NULL, *hessian_f2=NULL;
+
+  MPI_Init(&argc, &argv);
+  pnfft_init();
+
+  /* set values by commandline */
+  pnfft_check_init_parameters(argc, argv, N, n, &local_M, &m, &pnfft_flags, &compute_flags,
+      x_max, np, &compare_direct, &debug);
+
+  /* this check is only meaningful for cubic interpolation and analytic differentiation */
+  pnfft_flags &= ~(PNFFT_PRE_INTPOL_PSI | PNFFT_PRE_POLY_PSI | PNFFT_DIFF_IK | PNFFT_DIFF_INTPOL_PSI);
+  pnfft_flags |= PNFFT_PRE_CUB_PSI;
+  compute_flags = PNFFT_COMPUTE_GRAD_F | PNFFT_COMPUTE_HESSIAN_F;
+
+  /* derivatives interpolated from separate tables */
+  pnfft_perform_guru(N, n, local_M, m, x_max, pnfft_flags, compute_flags,
+      np, MPI_COMM_WORLD, "PNFFT with dpsi/ddpsi tables",
+      &grad_f1, &hessian_f1);
+
+  /* derivatives of the psi interpolant */
+  pnfft_perform_guru(N, n, local_M, m, x_max, pnfft_flags | PNFFT_DIFF_INTPOL_PSI, compute_flags,
+      np, MPI_COMM_WORLD, "PNFFT with differentiated psi interpolant",
+      &grad_f2, &hessian_f2);
+
+  failed += compare(grad_f1, grad_f2, local_M, 3, GRAD_TOL, "* Results in grad_f", MPI_COMM_WORLD);
+  failed += compare(hessian_f1, hessian_f2, local_M, 6, HESSIAN_TOL, "* Results in hessian_f", MPI_COMM_WORLD);
+
+  /* free mem and finalize */
+  if(grad_f1)    pnfft_free(grad_f1);
+  if(grad_f2)    pnfft_free(grad_f2);
+  if(hessian_f1) pnfft_free(hessian_f1);
+  if(hessian_f2) pnfft_free(hessian_f2);
+  pnfft_cleanup();
+  MPI_Finalize();
+  return (failed) ? 1 : 0;
+}
+
+
+static void pnfft_perform_guru(
+    const ptrdiff_t *N, const ptrdiff_t *n, ptrdiff_t local_M,
+    int m, const double *x_max,
+    unsigned pnfft_flags, unsigned compute_flags,
+    const int *np, MPI_Comm comm, const char *name,
+    pnfft_complex **grad_f, pnfft_complex **hessian_f
+    )
+{
+  int myrank;
+  ptrdiff_t local_N[3], local_N_start[3];
+  double lower_border[3], upper_border[3];
+  double time, time_max;
+  MPI_Comm comm_cart_3d;
+  pnfft_complex *f_hat;
+  double *x;
+  pnfft_plan pnfft;
+  pnfft_nodes nodes;
+
+  /* create three-dimensional process grid of size np[0] x np[1] x np[2], if possible */
+  if( pnfft_create_procmesh(3, comm, np, &comm_cart_3d) ){
+    pfft_fprintf(comm, stderr, "Error: Procmesh of size %d x %d x %d does not fit to number of allocated processes.\n", np[0], np[1], np[2]);
+    pfft_fprintf(comm, stderr, "       Please allocate %d processes (mpiexec -np %d ...) or change the procmesh (with -pnfft_np * * *).\n", np[0]*np[1]*np[2], np[0]*np[1]*np[2]);
+    MPI_Finalize();
+    exit(1);
+  }
+
+  MPI_Comm_rank(comm_cart_3d, &myrank);
+
+  /* get parameters of data distribution */
+  pnfft_local_size_guru(3, N, n, x_max, m, comm_cart_3d, pnfft_flags & PNFFT_TRANSPOSED_F_HAT,
+      local_N, local_N_start, lower_border, upper_border);
+
+  /* plan parallel NFFT */
+  pnfft = pnfft_init_guru(3, N, n, x_max, m,
+      PNFFT_MALLOC_F_HAT | pnfft_flags, PFFT_ESTIMATE,
+      comm_cart_3d);
+
+  /* initialize nodes */
+  nodes = pnfft_init_nodes(local_M, PNFFT_MALLOC_X | PNFFT_MALLOC_GRAD_F | PNFFT_MALLOC_HESSIAN_F);
+
+  /* get data pointers */
+  f_hat      = pnfft_get_f_hat(pnfft);
+  *grad_f    = pnfft_get_grad_f(nodes);
+  *hessian_f = pnfft_get_hessian_f(nodes);
+  x          = pnfft_get_x(nodes);
+
+  /* initialize Fourier coefficients */
+  pnfft_init_f_hat_3d(N, local_N, local_N_start, pnfft_flags & PNFFT_TRANSPOSED_F_HAT,
+      f_hat);
+
+  /* initialize nonequispaced nodes, use equal seeds for both runs */
+  srand(myrank);
+  pnfft_init_x_3d_adv(lower_border, upper_border, x_max, local_M,
+      x);
+
+  /* execute parallel NFFT */
+  time = -MPI_Wtime();
+  pnfft_trafo(pnfft, nodes, compute_flags);
+  time += MPI_Wtime();
+
+  /* print timing */
+  MPI_Reduce(&time, &time_max, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+  pfft_printf(comm, "%s needs %6.2e s\n", name, time_max);
+
+  /* free mem and finalize, do not free grad_f and hessian_f */
+  pnfft_finalize(pnfft, PNFFT_FREE_F_HAT);
+  pnfft_free_nodes(nodes, PNFFT_FREE_X);
+  MPI_Comm_free(&comm_cart_3d);
+}
+
+/* maximum error relative to the maximum absolute value of the reference, returns 1 if 'tol' is exceeded */
+static int compare(
+    const pnfft_complex *v1, const pnfft_complex *v2, ptrdiff_t local_M, int howmany,
+    double tol, const char *name, MPI_Comm comm
+    )
+{
+  double local[2] = {0, 0}, global[2], rel;
+
+  for(ptrdiff_t j=0; j<howmany*local_M; j++){
+    if( cabs(v1[j]-v2[j]) > local[0])
+      local[0] = cabs(v1[j]-v2[j]);
+    if( cabs(v1[j]) > local[1])
+      local[1] = cabs(v1[j]);
+  }
+
+  MPI_Allreduce(local, global, 2, MPI_DOUBLE, MPI_MAX, comm);
+  rel = (global[1] > 0) ? global[0]/global[1] : global[0];
+
+  pfft_printf(comm, "%s - absolute error = %6.2e,  relative error =  %6.2e (tolerance %6.2e) %s\n",
+      name, global[0], rel, tol, (rel <= tol) ? "passed" : "FAILED");
+  return (rel > tol);
+}
@@ -0,0 +1,127 @@
+#include <stdlib.h>
+#include <complex.h>
+#include <pnfft.h>
+
+/* Let pnfft_init_auto choose the parameters for a given accuracy and compare the result of the
+ * trafo with direct computation. A second call with equal arguments must reuse the decision. */
+#define AUTO_EPS 1e-6
+
+static int compare_parameters(
+    pnfft_plan pnfft1, pnfft_plan pnfft2, MPI_Comm comm);
+
+
+int main(int argc, char **argv){
+  int np[3], m, compare_direct=0, debug, failed=0, myrank;
+  unsigned pnfft_flags, auto_flags;
+  ptrdiff_t N[3], n[3], local_M, local_N[3], local_N_start[3];
+  double x_max[3], lower_border[3], upper_border[3];
+  double local_err = 0, err, local_norm = 0, norm;
+  unsigned compute_flags;
+  pnfft_complex *f, *f_hat, *f_ndft;
+  pnfft_plan pnfft, pnfft2;
+  pnfft_nodes nodes;
+  MPI_Comm comm_cart_3d;
+
+  MPI_Init(&argc, &argv);
+  pnfft_init();
+
+  /* set values by commandline, only N and np are used */
+  pnfft_check_init_parameters(argc, argv, N, n, &local_M, &m, &pnfft_flags, &compute_flags,
+      x_max, np, &compare_direct, &debug);
+
+  /* create three-dimensional process grid of size np[0] x np[1] x np[2], if possible */
+  if( pnfft_create_procmesh(3, MPI_COMM_WORLD, np, &comm_cart_3d) ){
+    pfft_fprintf(MPI_COMM_WORLD, stderr, "Error: Procmesh of size %d x %d x %d does not fit to number of allocated processes.\n", np[0], np[1], np[2]);
+    pfft_fprintf(MPI_COMM_WORLD, stderr, "       Please allocate %d processes (mpiexec -np %d ...) or change the procmesh (with -pnfft_np * * *).\n", np[0]*np[1]*np[2], np[0]*np[1]*np[2]);
+    MPI_Finalize();
+    return 1;
+  }
+  MPI_Comm_rank(comm_cart_3d, &myrank);
+
+  auto_flags = PNFFT_AUTO_MEASURE;
+  if(debug)
+    auto_flags |= PNFFT_AUTO_VERBOSE;
+
+  /* plan parallel NFFT with automatically chosen parameters */
+  pnfft = pnfft_init_auto(N, AUTO_EPS, comm_cart_3d, auto_flags);
+
+  /* get parameters of data distribution of the chosen plan */
+  pnfft_get_n(pnfft, n);
+  pnfft_get_x_max(pnfft, x_max);
+  m = pnfft_get_m(pnfft);
+  pnfft_flags = pnfft_get_pnfft_flags(pnfft);
+  pnfft_local_size_guru(3, N, n, x_max, m, comm_cart_3d, pnfft_flags & PNFFT_TRANSPOSED_F_HAT,
+      local_N, local_N_start, lower_border, upper_border);
+
+  /* initialize nodes */
+  nodes = pnfft_init_nodes(local_M, PNFFT_MALLOC_X | PNFFT_MALLOC_F);
+  f = pnfft_get_f(nodes);
+  f_hat = pnfft_get_f_hat(pnfft);
+
+  /* initialize Fourier coefficients and nonequispaced nodes */
+  pnfft_init_f_hat_3d(N, local_N, local_N_start, pnfft_flags & PNFFT_TRANSPOSED_F_HAT,
+      f_hat);
+  srand(myrank);
+  pnfft_init_x_3d_adv(lower_border, upper_border, x_max, local_M,
+      pnfft_get_x(nodes));
+
+  /* the error bound of pnfft_init_auto is relative to the 1-norm of f_hat */
+  for(ptrdiff_t k=0; k<local_N[0]*local_N[1]*local_N[2]; k++)
+    local_norm += cabs(f_hat[k]);
+  MPI_Allreduce(&local_norm, &norm, 1, MPI_DOUBLE, MPI_SUM, comm_cart_3d);
+
+  /* direct computation, f_hat is preserved */
+  pnfft_trafo(pnfft, nodes, PNFFT_COMPUTE_DIRECT | PNFFT_COMPUTE_F);
+  f_ndft = pnfft_alloc_complex(local_M);
+  for(ptrdiff_t j=0; j<local_M; j++)
+    f_ndft[j] = f[j];
+
+  /* initialize Fourier coefficients again, since the fast trafo overwrites f_hat */
+  pnfft_init_f_hat_3d(N, local_N, local_N_start, pnfft_flags & PNFFT_TRANSPOSED_F_HAT,
+      f_hat);
+  pnfft_trafo(pnfft, nodes, PNFFT_COMPUTE_F);
+
+  for(ptrdiff_t j=0; j<local_M; j++)
+    if( cabs(f[j]-f_ndft[j]) > local_err)
+      local_err = cabs(f[j]-f_ndft[j]);
+  MPI_Allreduce(&local_err, &err, 1, MPI_DOUBLE, MPI_MAX, comm_cart_3d);
+  err /= norm;
+
+  pfft_printf(comm_cart_3d, "* Results in f of automatic plan (n = %td x %td x %td, m = %d) - relative error = %6.2e %s\n",
+      n[0], n[1], n[2], m, err, (err <= AUTO_EPS) ? "passed" : "FAILED");
+  failed += (err > AUTO_EPS);
+
+  /* second call reuses the decision stored in the wisdom */
+  pnfft2 = pnfft_init_auto(N, AUTO_EPS, comm_cart_3d, auto_flags);
+  failed += compare_parameters(pnfft, pnfft2, comm_cart_3d);
+
+  /* free mem and finalize */
+  pnfft_finalize(pnfft2, PNFFT_FREE_F_HAT);
+  pnfft_finalize(pnfft, PNFFT_FREE_F_HAT);
+  pnfft_free_nodes(nodes, PNFFT_FREE_X | PNFFT_FREE_F);
+  pnfft_free(f_ndft);
+  MPI_Comm_free(&comm_cart_3d);
+  pnfft_cleanup();
+  MPI_Finalize();
+  return (failed) ? 1 : 0;
+}
+
+
+/* returns 1 if the plans differ in n, m or pnfft_flags */
+static int compare_parameters(
+    pnfft_plan pnfft1, pnfft_plan pnfft2, MPI_Comm comm
+    )
+{
+  ptrdiff_t n1[3], n2[3];
+  int equal;
+
+  pnfft_get_n(pnfft1, n1);
+  pnfft_get_n(pnfft2, n2);
+  equal = (n1[0] == n2[0]) && (n1[1] == n2[1]) && (n1[2] == n2[2])
+    && (pnfft_get_m(pnfft1) == pnfft_get_m(pnfft2))
+    && (pnfft_get_pnfft_flags(pnfft1) == pnfft_get_pnfft_flags(pnfft2));
+
+  pfft_printf(comm, "* Parameters of second automatic plan %s\n",
+      (equal) ? "passed" : "FAILED");
+  return !equal;
+}
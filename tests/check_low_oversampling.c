@@ -0,0 +1,122 @@
+#include <stdlib.h>
+#include <complex.h>
+#include <pnfft.h>
+
+/* Plans of the adv interface with oversampling factors 1.5 and 1.25 use smaller FFT grids
+ * and a larger cutoff. Their error must stay in the range of the default plan with oversampling 2. */
+#define ERROR_TOLERANCE_FACTOR 10.0
+
+static double relative_error(
+    const ptrdiff_t *N, ptrdiff_t local_M,
+    unsigned pnfft_flags, MPI_Comm comm_cart_3d);
+
+
+int main(int argc, char **argv){
+  int np[3], m, compare_direct=0, debug, failed=0;
+  unsigned pnfft_flags;
+  ptrdiff_t N[3], n[3], local_M;
+  double x_max[3], err_default, err;
+  unsigned compute_flags;
+  const unsigned oversampling_flags[2] = {PNFFT_OVERSAMPLING_1_5, PNFFT_OVERSAMPLING_1_25};
+  const char *names[2] = {"1.5", "1.25"};
+  MPI_Comm comm_cart_3d;
+
+  MPI_Init(&argc, &argv);
+  pnfft_init();
+
+  /* set values by commandline, the adv interface chooses n and m */
+  pnfft_check_init_parameters(argc, argv, N, n, &local_M, &m, &pnfft_flags, &compute_flags,
+      x_max, np, &compare_direct, &debug);
+  pnfft_flags &= PNFFT_WINDOW_GAUSSIAN | PNFFT_WINDOW_BSPLINE | PNFFT_WINDOW_SINC_POWER
+      | PNFFT_WINDOW_BESSEL_I0 | PNFFT_WINDOW_ES;
+  pnfft_flags |= PNFFT_MALLOC_F_HAT;
+
+  /* create three-dimensional process grid of size np[0] x np[1] x np[2], if possible */
+  if( pnfft_create_procmesh(3, MPI_COMM_WORLD, np, &comm_cart_3d) ){
+    pfft_fprintf(MPI_COMM_WORLD, stderr, "Error: Procmesh of size %d x %d x %d does not fit to number of allocated processes.\n", np[0], np[1], np[2]);
+    pfft_fprintf(MPI_COMM_WORLD, stderr, "       Please allocate %d processes (mpiexec -np %d ...) or change the procmesh (with -pnfft_np * * *).\n", np[0]*np[1]*np[2], np[0]*np[1]*np[2]);
+    MPI_Finalize();
+    return 1;
+  }
+
+  err_default = relative_error(N, local_M, pnfft_flags, comm_cart_3d);
+  pfft_printf(comm_cart_3d, "* Oversampling 2: relative error = %6.2e\n", err_default);
+
+  for(int k=0; k<2; k++){
+    err = relative_error(N, local_M, pnfft_flags | oversampling_flags[k], comm_cart_3d);
+    pfft_printf(comm_cart_3d, "* Oversampling %s: relative error = %6.2e %s\n", names[k], err,
+        (err <= ERROR_TOLERANCE_FACTOR * err_default) ? "passed" : "FAILED");
+    failed += (err > ERROR_TOLERANCE_FACTOR * err_default);
+  }
+
+  /* free mem and finalize */
+  MPI_Comm_free(&comm_cart_3d);
+  pnfft_cleanup();
+  MPI_Finalize();
+  return (failed) ? 1 : 0;
+}
+
+
+/* maximum error of the fast trafo compared to direct computation relative to the 1-norm of f_hat */
+static double relative_error(
+    const ptrdiff_t *N, ptrdiff_t local_M,
+    unsigned pnfft_flags, MPI_Comm comm_cart_3d
+    )
+{
+  int myrank;
+  ptrdiff_t local_N[3], local_N_start[3], n[3];
+  double lower_border[3], upper_border[3], x_max[3];
+  double local_err = 0, err, local_norm = 0, norm;
+  pnfft_complex *f, *f_hat, *f_ndft;
+  pnfft_plan pnfft;
+  pnfft_nodes nodes;
+
+  MPI_Comm_rank(comm_cart_3d, &myrank);
+
+  /* get parameters of data distribution */
+  pnfft_local_size_adv(3, N, comm_cart_3d, pnfft_flags,
+      local_N, local_N_start, lower_border, upper_border);
+
+  /* plan parallel NFFT */
+  pnfft = pnfft_init_adv(3, N, pnfft_flags, PFFT_ESTIMATE, comm_cart_3d);
+  pnfft_get_n(pnfft, n);
+  pnfft_get_x_max(pnfft, x_max);
+  pfft_printf(comm_cart_3d, "  n = %td x %td x %td, m = %d\n", n[0], n[1], n[2], pnfft_get_m(pnfft));
+
+  /* initialize nodes, use equal seeds for all runs */
+  nodes = pnfft_init_nodes(local_M, PNFFT_MALLOC_X | PNFFT_MALLOC_F);
+  f = pnfft_get_f(nodes);
+  f_hat = pnfft_get_f_hat(pnfft);
+  srand(myrank);
+  pnfft_init_x_3d_adv(lower_border, upper_border, x_max, local_M,
+      pnfft_get_x(nodes));
+
+  /* direct computation */
+  pnfft_init_f_hat_3d(N, local_N, local_N_start, pnfft_flags & PNFFT_TRANSPOSED_F_HAT,
+      f_hat);
+  for(ptrdiff_t k=0; k<local_N[0]*local_N[1]*local_N[2]; k++)
+    local_norm += cabs(f_hat[k]);
+  MPI_Allreduce(&local_norm, &norm, 1, MPI_DOUBLE, MPI_SUM, comm_cart_3d);
+
+  pnfft_trafo(pnfft, nodes, PNFFT_COMPUTE_DIRECT | PNFFT_COMPUTE_F);
+  f_ndft = pnfft_alloc_complex(local_M);
+  for(ptrdiff_t j=0; j<local_M; j++)
+    f_ndft[j] = f[j];
+
+  /* fast computation */
+  pnfft_init_f_hat_3d(N, local_N, local_N_start, pnfft_flags & PNFFT_TRANSPOSED_F_HAT,
+      f_hat);
+  pnfft_trafo(pnfft, nodes, PNFFT_COMPUTE_F);
+
+  for(ptrdiff_t j=0; j<local_M; j++)
+    if( cabs(f[j]-f_ndft[j]) > local_err)
+      local_err = cabs(f[j]-f_ndft[j]);
+  MPI_Allreduce(&local_err, &err, 1, MPI_DOUBLE, MPI_MAX, comm_cart_3d);
+
+  /* free mem and finalize */
+  pnfft_finalize(pnfft, PNFFT_FREE_F_HAT);
+  pnfft_free_nodes(nodes, PNFFT_FREE_X | PNFFT_FREE_F);
+  pnfft_free(f_ndft);
+
+  return err / norm;
+}
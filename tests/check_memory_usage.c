@@ -0,0 +1,203 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <complex.h>
+#include <pnfft.h>
+
+/* The tagged arrays of plan and nodes must match the dry-run estimate, high-water marks must not be
+ * lower than the current usage and all memory must be released by finalize and free_nodes.
+ * Placed bytes can not exceed the allocated ones. After the first transforms the workspace is large enough,
+ * i.e., repeated transforms must not allocate. */
+
+static int check_usage(
+    const size_t *current, const size_t *peak, const size_t *estimate,
+    unsigned pnfft_flags, MPI_Comm comm);
+static int check_placement(
+    pnfft_plan pnfft, pnfft_nodes nodes, const size_t *current, MPI_Comm comm);
+static int check_steady_state(
+    const size_t *warm, const size_t *peak_warm, MPI_Comm comm);
+static int check_release(
+    const size_t *before, MPI_Comm comm);
+static const char *category_name(
+    int k);
+
+
+int main(int argc, char **argv){
+  int np[3], m, compare_direct=0, debug, failed=0;
+  unsigned pnfft_flags, compute_flags;
+  const unsigned malloc_flags = PNFFT_MALLOC_X | PNFFT_MALLOC_F | PNFFT_MALLOC_GRAD_F;
+  const unsigned precompute_flags = PNFFT_PRE_PSI;
+  ptrdiff_t N[3], n[3], local_M;
+  ptrdiff_t local_N[3], local_N_start[3];
+  double x_max[3], lower_border[3], upper_border[3];
+  size_t before[PNFFT_MEM_CATEGORIES], peak_before[PNFFT_MEM_CATEGORIES];
+  size_t warm[PNFFT_MEM_CATEGORIES], peak_warm[PNFFT_MEM_CATEGORIES];
+  size_t current[PNFFT_MEM_CATEGORIES], peak[PNFFT_MEM_CATEGORIES], estimate[PNFFT_MEM_CATEGORIES];
+  pnfft_plan pnfft;
+  pnfft_nodes nodes;
+  MPI_Comm comm_cart_3d;
+
+  MPI_Init(&argc, &argv);
+  pnfft_init();
+
+  /* set values by commandline */
+  pnfft_check_init_parameters(argc, argv, N, n, &local_M, &m, &pnfft_flags, &compute_flags,
+      x_max, np, &compare_direct, &debug);
+  pnfft_flags |= PNFFT_MALLOC_F_HAT;
+  compute_flags &= ~PNFFT_COMPUTE_HESSIAN_F;
+
+  /* create three-dimensional process grid of size np[0] x np[1] x np[2], if possible */
+  if( pnfft_create_procmesh(3, MPI_COMM_WORLD, np, &comm_cart_3d) ){
+    pfft_fprintf(MPI_COMM_WORLD, stderr, "Error: Procmesh of size %d x %d x %d does not fit to number of allocated processes.\n", np[0], np[1], np[2]);
+    pfft_fprintf(MPI_COMM_WORLD, stderr, "       Please allocate %d processes (mpiexec -np %d ...) or change the procmesh (with -pnfft_np * * *).\n", np[0]*np[1]*np[2], np[0]*np[1]*np[2]);
+    MPI_Finalize();
+    return 1;
+  }
+
+  pnfft_get_memory_usage_total(before, peak_before);
+
+  /* dry run before planning */
+  pnfft_estimate_memory_usage(3, N, n, x_max, m, local_M, comm_cart_3d, pnfft_flags,
+      malloc_flags, precompute_flags, estimate);
+
+  /* get parameters of data distribution and plan parallel NFFT */
+  pnfft_local_size_guru(3, N, n, x_max, m, comm_cart_3d, pnfft_flags,
+      local_N, local_N_start, lower_border, upper_border);
+  pnfft = pnfft_init_guru(3, N, n, x_max, m, pnfft_flags, PFFT_ESTIMATE, comm_cart_3d);
+
+  nodes = pnfft_init_nodes(local_M, malloc_flags);
+  pnfft_init_x_3d_adv(lower_border, upper_border, x_max, local_M,
+      pnfft_get_x(nodes));
+  pnfft_init_f_hat_3d(N, local_N, local_N_start, pnfft_flags & PNFFT_TRANSPOSED_F_HAT,
+      pnfft_get_f_hat(pnfft));
+  pnfft_precompute_psi(pnfft, nodes, precompute_flags);
+
+  pnfft_trafo(pnfft, nodes, compute_flags);
+  pnfft_adj(pnfft, nodes, compute_flags & PNFFT_COMPUTE_F);
+
+  pnfft_get_memory_usage(pnfft, nodes, current, peak);
+  failed += check_usage(current, peak, estimate, pnfft_flags, comm_cart_3d);
+  failed += check_placement(pnfft, nodes, current, comm_cart_3d);
+
+  pnfft_get_memory_usage_total(warm, peak_warm);
+  for(int k=0; k<3; k++){
+    pnfft_trafo(pnfft, nodes, compute_flags);
+    pnfft_adj(pnfft, nodes, compute_flags & PNFFT_COMPUTE_F);
+  }
+  failed += check_steady_state(warm, peak_warm, comm_cart_3d);
+
+  /* free mem and finalize */
+  pnfft_finalize(pnfft, PNFFT_FREE_F_HAT);
+  pnfft_free_nodes(nodes, PNFFT_FREE_X | PNFFT_FREE_F | PNFFT_FREE_GRAD_F);
+  failed += check_release(before, comm_cart_3d);
+
+  MPI_Comm_free(&comm_cart_3d);
+  pnfft_cleanup();
+  MPI_Finalize();
+  return (failed) ? 1 : 0;
+}
+
+
+/* returns 1 if the arrays of fixed size differ from the estimate or a high-water mark is below the current usage */
+static int check_usage(
+    const size_t *current, const size_t *peak, const size_t *estimate,
+    unsigned pnfft_flags, MPI_Comm comm
+    )
+{
+  int failed = 0, global_failed;
+  const int exact[] = {PNFFT_MEM_PRE_PSI, PNFFT_MEM_F_HAT, PNFFT_MEM_NODES};
+
+  for(int k=0; k<PNFFT_MEM_CATEGORIES; k++)
+    if(peak[k] < current[k])
+      failed = 1;
+
+  for(int i=0; i<3; i++){
+    if(current[exact[i]] != estimate[exact[i]]){
+      fprintf(stderr, "* %s: %zu bytes allocated, %zu bytes estimated\n",
+          category_name(exact[i]), current[exact[i]], estimate[exact[i]]);
+      failed = 1;
+    }
+  }
+
+  /* pooled grids may be larger than needed by this plan */
+  if( (~pnfft_flags & PNFFT_PLAN_POOL)
+      && (current[PNFFT_MEM_FFT_GRIDS] + current[PNFFT_MEM_GHOST_CELLS] != estimate[PNFFT_MEM_FFT_GRIDS] + estimate[PNFFT_MEM_GHOST_CELLS]) )
+    failed = 1;
+
+  MPI_Allreduce(&failed, &global_failed, 1, MPI_INT, MPI_MAX, comm);
+
+  for(int k=0; k<PNFFT_MEM_CATEGORIES; k++)
+    pfft_printf(comm, "* %-14s current %10zu B, high-water %10zu B, estimate %10zu B\n",
+        category_name(k), current[k], peak[k], estimate[k]);
+  pfft_printf(comm, "* Memory usage of plan and nodes %s\n", (global_failed) ? "FAILED" : "passed");
+  return global_failed;
+}
+
+/* returns 1 if more bytes are reported as first touched or backed by huge pages than allocated */
+static int check_placement(
+    pnfft_plan pnfft, pnfft_nodes nodes, const size_t *current, MPI_Comm comm
+    )
+{
+  int failed = 0, global_failed;
+  size_t first_touch[PNFFT_MEM_CATEGORIES], huge_pages[PNFFT_MEM_CATEGORIES];
+  size_t sum_first_touch = 0, sum_huge_pages = 0;
+
+  pnfft_get_memory_placement(pnfft, nodes, first_touch, huge_pages);
+  for(int k=0; k<PNFFT_MEM_CATEGORIES; k++){
+    if(first_touch[k] > current[k] || huge_pages[k] > current[k])
+      failed = 1;
+    sum_first_touch += first_touch[k];
+    sum_huge_pages += huge_pages[k];
+  }
+  MPI_Allreduce(&failed, &global_failed, 1, MPI_INT, MPI_MAX, comm);
+
+  pfft_printf(comm, "* Placement: %zu B first touched, %zu B on huge pages %s\n",
+      sum_first_touch, sum_huge_pages, (global_failed) ? "FAILED" : "passed");
+  return global_failed;
+}
+
+/* returns 1 if the transforms allocated memory, which always raises the high-water mark of the workspace */
+static int check_steady_state(
+    const size_t *warm, const size_t *peak_warm, MPI_Comm comm
+    )
+{
+  int failed = 0, global_failed;
+  size_t current[PNFFT_MEM_CATEGORIES], peak[PNFFT_MEM_CATEGORIES];
+
+  pnfft_get_memory_usage_total(current, peak);
+  for(int k=0; k<PNFFT_MEM_CATEGORIES; k++)
+    if(current[k] != warm[k] || peak[k] != peak_warm[k])
+      failed = 1;
+  MPI_Allreduce(&failed, &global_failed, 1, MPI_INT, MPI_MAX, comm);
+
+  pfft_printf(comm, "* Workspace of %zu B, repeated transforms without allocation %s\n",
+      current[PNFFT_MEM_WORKSPACE], (global_failed) ? "FAILED" : "passed");
+  return global_failed;
+}
+
+/* returns 1 if the process holds more memory than before planning */
+static int check_release(
+    const size_t *before, MPI_Comm comm
+    )
+{
+  int failed = 0, global_failed;
+  size_t current[PNFFT_MEM_CATEGORIES], peak[PNFFT_MEM_CATEGORIES];
+
+  pnfft_get_memory_usage_total(current, peak);
+  for(int k=0; k<PNFFT_MEM_CATEGORIES; k++)
+    if(current[k] != before[k])
+      failed = 1;
+  MPI_Allreduce(&failed, &global_failed, 1, MPI_INT, MPI_MAX, comm);
+
+  pfft_printf(comm, "* Release of all memory %s\n", (global_failed) ? "FAILED" : "passed");
+  return global_failed;
+}
+
+static const char *category_name(
+    int k
+    )
+{
+  static const char *names[PNFFT_MEM_CATEGORIES] = {
+    "fft_grids", "ghost_cells", "window_tables", "pre_psi", "sort", "f_hat", "nodes", "other", "workspace"};
+
+  return (k >= 0 && k < PNFFT_MEM_CATEGORIES) ? names[k] : "unknown";
+}
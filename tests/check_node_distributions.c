@@ -0,0 +1,152 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <complex.h>
+#include <pnfft.h>
+
+/* The node generators must split every global set over the process mesh without losing or duplicating a node,
+ * and every local node must equal the node of the same global index generated on a single process.
+ * Charges of a set of even size are neutral and the dipole moments are within [0.5,1.5). */
+
+static int check_distribution(
+    int dist, unsigned seed, ptrdiff_t M_total,
+    const double *lower_border, const double *upper_border, const double *x_max,
+    MPI_Comm comm);
+static const char *distribution_name(
+    int dist);
+
+
+int main(int argc, char **argv){
+  int np[3], m, compare_direct=0, debug, size, failed=0, seed=1;
+  unsigned pnfft_flags, compute_flags;
+  ptrdiff_t N[3], n[3], local_M, M_total;
+  ptrdiff_t local_N[3], local_N_start[3];
+  double x_max[3], lower_border[3], upper_border[3];
+  MPI_Comm comm_cart_3d;
+
+  MPI_Init(&argc, &argv);
+  pnfft_init();
+
+  /* set values by commandline */
+  pnfft_check_init_parameters(argc, argv, N, n, &local_M, &m, &pnfft_flags, &compute_flags,
+      x_max, np, &compare_direct, &debug);
+  pnfft_get_args(argc, argv, "-pnfft_seed", 1, PFFT_INT, &seed);
+
+  /* create three-dimensional process grid of size np[0] x np[1] x np[2], if possible */
+  if( pnfft_create_procmesh(3, MPI_COMM_WORLD, np, &comm_cart_3d) ){
+    pfft_fprintf(MPI_COMM_WORLD, stderr, "Error: Procmesh of size %d x %d x %d does not fit to number of allocated processes.\n", np[0], np[1], np[2]);
+    pfft_fprintf(MPI_COMM_WORLD, stderr, "       Please allocate %d processes (mpiexec -np %d ...) or change the procmesh (with -pnfft_np * * *).\n", np[0]*np[1]*np[2], np[0]*np[1]*np[2]);
+    MPI_Finalize();
+    return 1;
+  }
+
+  /* get the local boxes of the nodes */
+  pnfft_local_size_guru(3, N, n, x_max, m, comm_cart_3d, pnfft_flags,
+      local_N, local_N_start, lower_border, upper_border);
+
+  /* global number of nodes, even for neutral charges */
+  MPI_Comm_size(comm_cart_3d, &size);
+  M_total = 2 * ((local_M * size + 1) / 2);
+
+  for(int dist=PNFFT_NODES_UNIFORM; dist<=PNFFT_NODES_IMBALANCED; dist++)
+    failed += check_distribution(dist, (unsigned) seed, M_total, lower_border, upper_border, x_max,
+        comm_cart_3d);
+
+  MPI_Comm_free(&comm_cart_3d);
+  pnfft_cleanup();
+  MPI_Finalize();
+  return (failed) ? 1 : 0;
+}
+
+
+/* returns 1 if the local sets do not match the global set or the values are out of range */
+static int check_distribution(
+    int dist, unsigned seed, ptrdiff_t M_total,
+    const double *lower_border, const double *upper_border, const double *x_max,
+    MPI_Comm comm
+    )
+{
+  int failed = 0, global_failed;
+  double lo[3], sums[3], global_sums[3], min_M, max_M;
+  ptrdiff_t local_M;
+  ptrdiff_t *index, *index_all;
+  double *x, *x_all;
+  pnfft_complex *f, *grad_f;
+
+  local_M = pnfft_local_size_x_3d_dist(dist, seed, M_total, lower_border, upper_border, x_max);
+  x      = (double*) malloc(sizeof(double) * (size_t) (3*local_M + 3));
+  index  = (ptrdiff_t*) malloc(sizeof(ptrdiff_t) * (size_t) (local_M + 1));
+  f      = pnfft_alloc_complex(local_M + 1);
+  grad_f = pnfft_alloc_complex(3*local_M + 3);
+
+  pnfft_init_x_3d_dist(dist, seed, M_total, lower_border, upper_border, x_max, local_M,
+      x, index);
+  pnfft_init_f_charges(seed, local_M, index,
+      f);
+  pnfft_init_grad_f_dipoles(seed, local_M, index,
+      grad_f);
+
+  /* the same set on a single process */
+  for(int t=0; t<3; t++)
+    lo[t] = -x_max[t];
+  x_all     = (double*) malloc(sizeof(double) * (size_t) 3*M_total);
+  index_all = (ptrdiff_t*) malloc(sizeof(ptrdiff_t) * (size_t) M_total);
+  if(pnfft_local_size_x_3d_dist(dist, seed, M_total, lo, x_max, x_max) != M_total)
+    failed = 1;
+  pnfft_init_x_3d_dist(dist, seed, M_total, lo, x_max, x_max, M_total,
+      x_all, index_all);
+
+  /* number of nodes, sum of indices and sum of charges over all processes */
+  sums[0] = (double) local_M;
+  sums[1] = 0;
+  sums[2] = 0;
+  for(ptrdiff_t j=0; j<local_M; j++){
+    sums[1] += (double) index[j];
+    sums[2] += creal(f[j]);
+
+    if(index[j] < 0 || index[j] >= M_total || (j > 0 && index[j] <= index[j-1])){
+      failed = 1;
+      continue;
+    }
+    for(int t=0; t<3; t++){
+      if(x[3*j+t] < lower_border[t] || upper_border[t] <= x[3*j+t])
+        failed = 1;
+      if(x[3*j+t] != x_all[3*index[j]+t])
+        failed = 1;
+    }
+
+    double norm = 0;
+    for(int t=0; t<3; t++)
+      norm += creal(grad_f[3*j+t]) * creal(grad_f[3*j+t]);
+    if(norm < 0.25 * (1 - 1e-12) || 2.25 <= norm)
+      failed = 1;
+  }
+  MPI_Allreduce(sums, global_sums, 3, MPI_DOUBLE, MPI_SUM, comm);
+
+  if(global_sums[0] != (double) M_total)
+    failed = 1;
+  if(global_sums[1] != 0.5 * (double) M_total * (double) (M_total-1))
+    failed = 1;
+  if(global_sums[2] != 0.0)
+    failed = 1;
+
+  MPI_Allreduce(&failed, &global_failed, 1, MPI_INT, MPI_MAX, comm);
+  MPI_Allreduce(&sums[0], &min_M, 1, MPI_DOUBLE, MPI_MIN, comm);
+  MPI_Allreduce(&sums[0], &max_M, 1, MPI_DOUBLE, MPI_MAX, comm);
+
+  pfft_printf(comm, "* Nodes %-10s: %td nodes, %.0f to %.0f per process %s\n",
+      distribution_name(dist), M_total, min_M, max_M, (global_failed) ? "FAILED" : "passed");
+
+  free(x); free(index);
+  free(x_all); free(index_all);
+  pnfft_free(f); pnfft_free(grad_f);
+  return global_failed;
+}
+
+static const char *distribution_name(
+    int dist
+    )
+{
+  static const char *names[] = {"uniform", "clustered", "slab", "lattice", "imbalanced"};
+
+  return (dist >= 0 && dist <= PNFFT_NODES_IMBALANCED) ? names[dist] : "unknown";
+}
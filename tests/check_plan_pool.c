@@ -0,0 +1,144 @@
+#include <stdlib.h>
+#include <complex.h>
+#include <pnfft.h>
+
+/* Two plans with different window and m share their FFT grids with PNFFT_PLAN_POOL.
+ * Both must reproduce the results of the same plans without pool exactly. */
+
+static void init_plan(
+    const ptrdiff_t *N, const ptrdiff_t *n, ptrdiff_t local_M,
+    int m, const double *x_max, unsigned pnfft_flags,
+    MPI_Comm comm_cart_3d,
+    pnfft_plan *pnfft, pnfft_nodes *nodes);
+static int compare(
+    const pnfft_complex *v1, const pnfft_complex *v2, ptrdiff_t local_M,
+    const char *name, MPI_Comm comm);
+
+
+int main(int argc, char **argv){
+  int np[3], m, compare_direct=0, debug, failed=0;
+  unsigned pnfft_flags, window_flags[2];
+  ptrdiff_t N[3], n[3], local_M;
+  double x_max[3];
+  unsigned compute_flags;
+  size_t shared_bytes[2], private_bytes[2];
+  pnfft_complex *f_ref[2];
+  pnfft_plan pnfft[2];
+  pnfft_nodes nodes[2];
+  MPI_Comm comm_cart_3d;
+
+  MPI_Init(&argc, &argv);
+  pnfft_init();
+
+  /* set values by commandline */
+  pnfft_check_init_parameters(argc, argv, N, n, &local_M, &m, &pnfft_flags, &compute_flags,
+      x_max, np, &compare_direct, &debug);
+
+  pnfft_flags &= ~(PNFFT_WINDOW_GAUSSIAN | PNFFT_WINDOW_BSPLINE | PNFFT_WINDOW_SINC_POWER
+      | PNFFT_WINDOW_BESSEL_I0 | PNFFT_WINDOW_ES | PNFFT_PLAN_POOL);
+  window_flags[0] = PNFFT_WINDOW_KAISER_BESSEL;
+  window_flags[1] = PNFFT_WINDOW_GAUSSIAN;
+  compute_flags = PNFFT_COMPUTE_F;
+
+  /* create three-dimensional process grid of size np[0] x np[1] x np[2], if possible */
+  if( pnfft_create_procmesh(3, MPI_COMM_WORLD, np, &comm_cart_3d) ){
+    pfft_fprintf(MPI_COMM_WORLD, stderr, "Error: Procmesh of size %d x %d x %d does not fit to number of allocated processes.\n", np[0], np[1], np[2]);
+    pfft_fprintf(MPI_COMM_WORLD, stderr, "       Please allocate %d processes (mpiexec -np %d ...) or change the procmesh (with -pnfft_np * * *).\n", np[0]*np[1]*np[2], np[0]*np[1]*np[2]);
+    MPI_Finalize();
+    return 1;
+  }
+
+  /* reference results of plans with private grids, the second plan uses a smaller m */
+  for(int k=0; k<2; k++){
+    init_plan(N, n, local_M, m-k, x_max, pnfft_flags | window_flags[k], comm_cart_3d,
+        &pnfft[k], &nodes[k]);
+    pnfft_trafo(pnfft[k], nodes[k], compute_flags);
+    f_ref[k] = pnfft_get_f(nodes[k]);
+    pnfft_finalize(pnfft[k], PNFFT_FREE_F_HAT);
+    pnfft_free_nodes(nodes[k], PNFFT_FREE_X);
+  }
+
+  /* both plans alive at the same time with pooled grids */
+  for(int k=0; k<2; k++)
+    init_plan(N, n, local_M, m-k, x_max, pnfft_flags | window_flags[k] | PNFFT_PLAN_POOL, comm_cart_3d,
+        &pnfft[k], &nodes[k]);
+  for(int k=0; k<2; k++)
+    pnfft_trafo(pnfft[k], nodes[k], compute_flags);
+
+  failed += compare(f_ref[0], pnfft_get_f(nodes[0]), local_M, "* Results in f of Kaiser-Bessel plan", MPI_COMM_WORLD);
+  failed += compare(f_ref[1], pnfft_get_f(nodes[1]), local_M, "* Results in f of Gaussian plan", MPI_COMM_WORLD);
+
+  /* both plans report the same shared grids */
+  for(int k=0; k<2; k++)
+    pnfft_get_plan_memory(pnfft[k], &shared_bytes[k], &private_bytes[k]);
+  if( (shared_bytes[0] != shared_bytes[1]) ){
+    pfft_printf(MPI_COMM_WORLD, "* Shared memory of pooled plans differs: %zu != %zu bytes FAILED\n", shared_bytes[0], shared_bytes[1]);
+    failed++;
+  }
+
+  /* free mem and finalize */
+  for(int k=0; k<2; k++){
+    pnfft_finalize(pnfft[k], PNFFT_FREE_F_HAT);
+    pnfft_free_nodes(nodes[k], PNFFT_FREE_X | PNFFT_FREE_F);
+    pnfft_free(f_ref[k]);
+  }
+  MPI_Comm_free(&comm_cart_3d);
+  pnfft_cleanup();
+  MPI_Finalize();
+  return (failed) ? 1 : 0;
+}
+
+
+static void init_plan(
+    const ptrdiff_t *N, const ptrdiff_t *n, ptrdiff_t local_M,
+    int m, const double *x_max, unsigned pnfft_flags,
+    MPI_Comm comm_cart_3d,
+    pnfft_plan *pnfft, pnfft_nodes *nodes
+    )
+{
+  int myrank;
+  ptrdiff_t local_N[3], local_N_start[3];
+  double lower_border[3], upper_border[3];
+
+  MPI_Comm_rank(comm_cart_3d, &myrank);
+
+  /* get parameters of data distribution */
+  pnfft_local_size_guru(3, N, n, x_max, m, comm_cart_3d, pnfft_flags & PNFFT_TRANSPOSED_F_HAT,
+      local_N, local_N_start, lower_border, upper_border);
+
+  /* plan parallel NFFT */
+  *pnfft = pnfft_init_guru(3, N, n, x_max, m,
+      PNFFT_MALLOC_F_HAT | pnfft_flags, PFFT_ESTIMATE,
+      comm_cart_3d);
+
+  /* initialize nodes */
+  *nodes = pnfft_init_nodes(local_M, PNFFT_MALLOC_X | PNFFT_MALLOC_F);
+
+  /* initialize Fourier coefficients */
+  pnfft_init_f_hat_3d(N, local_N, local_N_start, pnfft_flags & PNFFT_TRANSPOSED_F_HAT,
+      pnfft_get_f_hat(*pnfft));
+
+  /* initialize nonequispaced nodes, use equal seeds for all runs */
+  srand(myrank);
+  pnfft_init_x_3d_adv(lower_border, upper_border, x_max, local_M,
+      pnfft_get_x(*nodes));
+}
+
+/* maximum absolute difference, returns 1 if the results are not identical */
+static int compare(
+    const pnfft_complex *v1, const pnfft_complex *v2, ptrdiff_t local_M,
+    const char *name, MPI_Comm comm
+    )
+{
+  double local = 0, global;
+
+  for(ptrdiff_t j=0; j<local_M; j++)
+    if( cabs(v1[j]-v2[j]) > local)
+      local = cabs(v1[j]-v2[j]);
+
+  MPI_Allreduce(&local, &global, 1, MPI_DOUBLE, MPI_MAX, comm);
+
+  pfft_printf(comm, "%s - absolute error = %6.2e %s\n",
+      name, global, (global == 0) ? "passed" : "FAILED");
+  return (global != 0);
+}
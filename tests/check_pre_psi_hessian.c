@@ -0,0 +1,147 @@
+#include <stdlib.h>
+#include <complex.h>
+#include <pnfft.h>
+
+/* Hessians of nodes with precomputed psi and dpsi but without precomputed ddpsi.
+ * The second derivatives of most windows are formed from psi and dpsi, which must be taken
+ * from the precomputed values on the axes or, with PNFFT_PRE_FULL, be evaluated again.
+ * The results must agree with a trafo without any precomputation. */
+#define TOL 1e-10
+#define NUM_WINDOWS 5
+
+static int perform_check(
+    const ptrdiff_t *N, const ptrdiff_t *n, ptrdiff_t local_M,
+    int m, const double *x_max, unsigned pnfft_flags, const char *window,
+    const int *np, MPI_Comm comm);
+static int compare(
+    const pnfft_complex *v1, const pnfft_complex *v2, ptrdiff_t len,
+    const char *name, MPI_Comm comm);
+
+
+int main(int argc, char **argv){
+  int np[3], m, compare_direct=0, debug, failed=0;
+  unsigned pnfft_flags, compute_flags;
+  ptrdiff_t N[3], n[3], local_M;
+  double x_max[3];
+  const unsigned windows[NUM_WINDOWS] = {
+    PNFFT_WINDOW_KAISER_BESSEL, PNFFT_WINDOW_BESSEL_I0, PNFFT_WINDOW_SINC_POWER,
+    PNFFT_WINDOW_ES, PNFFT_WINDOW_GAUSSIAN};
+  const char *names[NUM_WINDOWS] = {"Kaiser-Bessel", "Bessel I0", "sinc power", "ES", "Gaussian"};
+
+  MPI_Init(&argc, &argv);
+  pnfft_init();
+
+  /* set values by commandline */
+  pnfft_check_init_parameters(argc, argv, N, n, &local_M, &m, &pnfft_flags, &compute_flags,
+      x_max, np, &compare_direct, &debug);
+
+  /* direct window evaluation with analytic differentiation, both passes of interlacing */
+  pnfft_flags &= ~(PNFFT_PRE_INTPOL_PSI | PNFFT_PRE_POLY_PSI | PNFFT_DIFF_IK | PNFFT_DIFF_INTPOL_PSI
+      | PNFFT_WINDOW_GAUSSIAN_T | PNFFT_WINDOW_BSPLINE | PNFFT_WINDOW_SINC_POWER
+      | PNFFT_WINDOW_BESSEL_I0 | PNFFT_WINDOW_ES);
+  pnfft_flags |= PNFFT_INTERLACED;
+
+  for(int w=0; w<NUM_WINDOWS; w++)
+    failed += perform_check(N, n, local_M, m, x_max, pnfft_flags | windows[w], names[w],
+        np, MPI_COMM_WORLD);
+
+  pnfft_cleanup();
+  MPI_Finalize();
+  return (failed) ? 1 : 0;
+}
+
+
+/* returns the number of precomputations with results that differ from the trafo without precomputation */
+static int perform_check(
+    const ptrdiff_t *N, const ptrdiff_t *n, ptrdiff_t local_M,
+    int m, const double *x_max, unsigned pnfft_flags, const char *window,
+    const int *np, MPI_Comm comm
+    )
+{
+  const unsigned compute_flags = PNFFT_COMPUTE_F | PNFFT_COMPUTE_GRAD_F | PNFFT_COMPUTE_HESSIAN_F;
+  const unsigned precompute_flags[2] = {
+    PNFFT_PRE_PSI | PNFFT_PRE_GRAD_PSI, PNFFT_PRE_FULL | PNFFT_PRE_PSI | PNFFT_PRE_GRAD_PSI};
+  const char *pre_names[2] = {"PRE_PSI | PRE_GRAD_PSI", "PRE_FULL | PRE_PSI | PRE_GRAD_PSI"};
+  int myrank, failed = 0;
+  ptrdiff_t local_N[3], local_N_start[3];
+  double lower_border[3], upper_border[3];
+  MPI_Comm comm_cart_3d;
+  pnfft_complex *f_ref, *grad_f_ref, *hessian_f_ref;
+  pnfft_plan pnfft;
+  pnfft_nodes nodes;
+
+  /* create three-dimensional process grid of size np[0] x np[1] x np[2], if possible */
+  if( pnfft_create_procmesh(3, comm, np, &comm_cart_3d) ){
+    pfft_fprintf(comm, stderr, "Error: Procmesh of size %d x %d x %d does not fit to number of allocated processes.\n", np[0], np[1], np[2]);
+    pfft_fprintf(comm, stderr, "       Please allocate %d processes (mpiexec -np %d ...) or change the procmesh (with -pnfft_np * * *).\n", np[0]*np[1]*np[2], np[0]*np[1]*np[2]);
+    MPI_Finalize();
+    exit(1);
+  }
+
+  MPI_Comm_rank(comm_cart_3d, &myrank);
+
+  pnfft_local_size_guru(3, N, n, x_max, m, comm_cart_3d, pnfft_flags & PNFFT_TRANSPOSED_F_HAT,
+      local_N, local_N_start, lower_border, upper_border);
+  pnfft = pnfft_init_guru(3, N, n, x_max, m, PNFFT_MALLOC_F_HAT | pnfft_flags, PFFT_ESTIMATE,
+      comm_cart_3d);
+  nodes = pnfft_init_nodes(local_M, PNFFT_MALLOC_X | PNFFT_MALLOC_F | PNFFT_MALLOC_GRAD_F | PNFFT_MALLOC_HESSIAN_F);
+
+  pnfft_init_f_hat_3d(N, local_N, local_N_start, pnfft_flags & PNFFT_TRANSPOSED_F_HAT,
+      pnfft_get_f_hat(pnfft));
+  srand(myrank);
+  pnfft_init_x_3d_adv(lower_border, upper_border, x_max, local_M,
+      pnfft_get_x(nodes));
+
+  /* reference without precomputation */
+  f_ref         = pnfft_alloc_complex(local_M);
+  grad_f_ref    = pnfft_alloc_complex(3*local_M);
+  hessian_f_ref = pnfft_alloc_complex(6*local_M);
+  pnfft_trafo(pnfft, nodes, compute_flags);
+  for(ptrdiff_t j=0; j<local_M; j++)
+    f_ref[j] = pnfft_get_f(nodes)[j];
+  for(ptrdiff_t j=0; j<3*local_M; j++)
+    grad_f_ref[j] = pnfft_get_grad_f(nodes)[j];
+  for(ptrdiff_t j=0; j<6*local_M; j++)
+    hessian_f_ref[j] = pnfft_get_hessian_f(nodes)[j];
+
+  for(int k=0; k<2; k++){
+    pnfft_precompute_psi(pnfft, nodes, precompute_flags[k]);
+    pnfft_trafo(pnfft, nodes, compute_flags);
+
+    pfft_printf(comm_cart_3d, "* %s window with %s:\n", window, pre_names[k]);
+    failed += compare(pnfft_get_f(nodes), f_ref, local_M, "  f", comm_cart_3d);
+    failed += compare(pnfft_get_grad_f(nodes), grad_f_ref, 3*local_M, "  grad_f", comm_cart_3d);
+    failed += compare(pnfft_get_hessian_f(nodes), hessian_f_ref, 6*local_M, "  hessian_f", comm_cart_3d);
+  }
+
+  pnfft_free(f_ref);
+  pnfft_free(grad_f_ref);
+  pnfft_free(hessian_f_ref);
+  pnfft_finalize(pnfft, PNFFT_FREE_F_HAT);
+  pnfft_free_nodes(nodes, PNFFT_FREE_X | PNFFT_FREE_F | PNFFT_FREE_GRAD_F | PNFFT_FREE_HESSIAN_F);
+  MPI_Comm_free(&comm_cart_3d);
+  return failed;
+}
+
+/* maximum error relative to the maximum absolute value of the reference, returns 1 if TOL is exceeded */
+static int compare(
+    const pnfft_complex *v1, const pnfft_complex *v2, ptrdiff_t len,
+    const char *name, MPI_Comm comm
+    )
+{
+  double local[2] = {0, 0}, global[2], rel;
+
+  for(ptrdiff_t j=0; j<len; j++){
+    if( cabs(v1[j]-v2[j]) > local[0])
+      local[0] = cabs(v1[j]-v2[j]);
+    if( cabs(v2[j]) > local[1])
+      local[1] = cabs(v2[j]);
+  }
+
+  MPI_Allreduce(local, global, 2, MPI_DOUBLE, MPI_MAX, comm);
+  rel = (global[1] > 0) ? global[0]/global[1] : global[0];
+
+  pfft_printf(comm, "%s - relative error = %6.2e (tolerance %6.2e) %s\n",
+      name, rel, TOL, (rel <= TOL) ? "passed" : "FAILED");
+  return (rel > TOL);
+}
@@ -0,0 +1,213 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <complex.h>
+#include <pnfft.h>
+
+/* The stage hooks must be called in properly nested pairs with the component of ik-differentiation
+ * and the pass of interlacing. The byte counts passed at the end of a stage minus the ones passed
+ * at its beginning must add up to the counters of the plan. Removed hooks must not be called. */
+#define MAX_DEPTH 16
+
+typedef struct {
+  int depth, failed;
+  int stage[MAX_DEPTH], adjoint[MAX_DEPTH];
+  double bytes[MAX_DEPTH], mpi_bytes[MAX_DEPTH];
+  double calls[2][PNFFT_TIMER_LENGTH];
+  double sum_bytes[2][PNFFT_TIMER_LENGTH], sum_mpi_bytes[2][PNFFT_TIMER_LENGTH];
+  int seen_component[2][PNFFT_TIMER_LENGTH], seen_interlaced[2];
+} trace_s;
+
+static void hook_begin(
+    pnfft_plan ths, int stage, int component, int interlaced, int adjoint,
+    double bytes, double mpi_bytes, void *data);
+static void hook_end(
+    pnfft_plan ths, int stage, int component, int interlaced, int adjoint,
+    double bytes, double mpi_bytes, void *data);
+static int check_trace(
+    pnfft_plan pnfft, const trace_s *trace, int adjoint, int interlaced, const char *dir,
+    MPI_Comm comm);
+static int check_removed(
+    pnfft_plan pnfft, pnfft_nodes nodes, trace_s *trace,
+    MPI_Comm comm);
+
+
+int main(int argc, char **argv){
+  int np[3], m, compare_direct=0, debug, failed=0;
+  unsigned pnfft_flags, compute_flags;
+  ptrdiff_t N[3], n[3], local_M;
+  ptrdiff_t local_N[3], local_N_start[3];
+  double x_max[3], lower_border[3], upper_border[3];
+  trace_s trace = {0};
+  pnfft_plan pnfft;
+  pnfft_nodes nodes;
+  MPI_Comm comm_cart_3d;
+
+  MPI_Init(&argc, &argv);
+  pnfft_init();
+
+  /* set values by commandline */
+  pnfft_check_init_parameters(argc, argv, N, n, &local_M, &m, &pnfft_flags, &compute_flags,
+      x_max, np, &compare_direct, &debug);
+  pnfft_flags |= PNFFT_MALLOC_F_HAT | PNFFT_DIFF_IK | PNFFT_INTERLACED;
+
+  /* create three-dimensional process grid of size np[0] x np[1] x np[2], if possible */
+  if( pnfft_create_procmesh(3, MPI_COMM_WORLD, np, &comm_cart_3d) ){
+    pfft_fprintf(MPI_COMM_WORLD, stderr, "Error: Procmesh of size %d x %d x %d does not fit to number of allocated processes.\n", np[0], np[1], np[2]);
+    pfft_fprintf(MPI_COMM_WORLD, stderr, "       Please allocate %d processes (mpiexec -np %d ...) or change the procmesh (with -pnfft_np * * *).\n", np[0]*np[1]*np[2], np[0]*np[1]*np[2]);
+    MPI_Finalize();
+    return 1;
+  }
+
+  /* get parameters of data distribution and plan parallel NFFT */
+  pnfft_local_size_guru(3, N, n, x_max, m, comm_cart_3d, pnfft_flags,
+      local_N, local_N_start, lower_border, upper_border);
+  pnfft = pnfft_init_guru(3, N, n, x_max, m, pnfft_flags, PFFT_ESTIMATE, comm_cart_3d);
+
+  nodes = pnfft_init_nodes(local_M, PNFFT_MALLOC_X | PNFFT_MALLOC_F | PNFFT_MALLOC_GRAD_F);
+  pnfft_init_x_3d_adv(lower_border, upper_border, x_max, local_M,
+      pnfft_get_x(nodes));
+  pnfft_init_f_hat_3d(N, local_N, local_N_start, pnfft_flags & PNFFT_TRANSPOSED_F_HAT,
+      pnfft_get_f_hat(pnfft));
+
+  /* the first calls are not traced */
+  pnfft_trafo(pnfft, nodes, PNFFT_COMPUTE_F | PNFFT_COMPUTE_GRAD_F);
+  pnfft_adj(pnfft, nodes, PNFFT_COMPUTE_F | PNFFT_COMPUTE_GRAD_F);
+  pnfft_reset_timer(pnfft);
+
+  pnfft_set_stage_hooks(pnfft, hook_begin, hook_end, &trace);
+  for(int k=0; k<2; k++){
+    pnfft_trafo(pnfft, nodes, PNFFT_COMPUTE_F | PNFFT_COMPUTE_GRAD_F);
+    pnfft_adj(pnfft, nodes, PNFFT_COMPUTE_F | PNFFT_COMPUTE_GRAD_F);
+  }
+
+  failed += check_trace(pnfft, &trace, 0, 1, "trafo", comm_cart_3d);
+  failed += check_trace(pnfft, &trace, 1, 1, "adj", comm_cart_3d);
+  failed += check_removed(pnfft, nodes, &trace, comm_cart_3d);
+
+  /* free mem and finalize */
+  pnfft_finalize(pnfft, PNFFT_FREE_F_HAT);
+  pnfft_free_nodes(nodes, PNFFT_FREE_X | PNFFT_FREE_F | PNFFT_FREE_GRAD_F);
+  MPI_Comm_free(&comm_cart_3d);
+  pnfft_cleanup();
+  MPI_Finalize();
+  return (failed) ? 1 : 0;
+}
+
+
+static void hook_begin(
+    pnfft_plan ths, int stage, int component, int interlaced, int adjoint,
+    double bytes, double mpi_bytes, void *data
+    )
+{
+  trace_s *trace = (trace_s*) data;
+
+  if(ths == NULL || stage <= PNFFT_TIMER_ITER || stage >= PNFFT_TIMER_LENGTH || trace->depth >= MAX_DEPTH){
+    trace->failed = 1;
+    return;
+  }
+
+  trace->stage[trace->depth] = stage;
+  trace->adjoint[trace->depth] = adjoint;
+  trace->bytes[trace->depth] = bytes;
+  trace->mpi_bytes[trace->depth] = mpi_bytes;
+  trace->depth++;
+
+  if(component >= 0)
+    trace->seen_component[adjoint][component] = 1;
+  if(interlaced)
+    trace->seen_interlaced[adjoint] = 1;
+}
+
+static void hook_end(
+    pnfft_plan ths, int stage, int component, int interlaced, int adjoint,
+    double bytes, double mpi_bytes, void *data
+    )
+{
+  trace_s *trace = (trace_s*) data;
+  int top;
+
+  if(ths == NULL || trace->depth < 1){
+    trace->failed = 1;
+    return;
+  }
+
+  /* stages must end in reverse order of their beginning */
+  top = --trace->depth;
+  if(trace->stage[top] != stage || trace->adjoint[top] != adjoint){
+    trace->failed = 1;
+    return;
+  }
+  if(bytes < trace->bytes[top] || mpi_bytes < trace->mpi_bytes[top])
+    trace->failed = 1;
+
+  trace->calls[adjoint][stage]++;
+  trace->sum_bytes[adjoint][stage] += bytes - trace->bytes[top];
+  trace->sum_mpi_bytes[adjoint][stage] += mpi_bytes - trace->mpi_bytes[top];
+  (void) component; (void) interlaced;
+}
+
+/* returns 1 if the hooks were not nested, missed a component or do not match the counters */
+static int check_trace(
+    pnfft_plan pnfft, const trace_s *trace, int adjoint, int interlaced, const char *dir,
+    MPI_Comm comm
+    )
+{
+  int failed = trace->failed || trace->depth != 0, global_failed;
+  double *timer, *bytes, *mpi_bytes;
+
+  timer = (adjoint) ? pnfft_get_timer_adj(pnfft) : pnfft_get_timer_trafo(pnfft);
+  bytes = (adjoint) ? pnfft_get_counter_adj(pnfft, PNFFT_COUNTER_BYTES) : pnfft_get_counter_trafo(pnfft, PNFFT_COUNTER_BYTES);
+  mpi_bytes = (adjoint) ? pnfft_get_counter_adj(pnfft, PNFFT_COUNTER_MPI_BYTES) : pnfft_get_counter_trafo(pnfft, PNFFT_COUNTER_MPI_BYTES);
+
+  if(trace->calls[adjoint][PNFFT_TIMER_WHOLE] != timer[PNFFT_TIMER_ITER])
+    failed = 1;
+
+  if( !trace->seen_component[adjoint][PNFFT_TIMER_IK_F] )
+    failed = 1;
+  for(int dim=0; dim<3; dim++)
+    if( !trace->seen_component[adjoint][PNFFT_TIMER_IK_GRAD + dim] )
+      failed = 1;
+  if(trace->seen_interlaced[adjoint] != interlaced)
+    failed = 1;
+
+  for(int t=PNFFT_TIMER_WHOLE; t<PNFFT_TIMER_LENGTH; t++){
+    if(trace->calls[adjoint][t] == 0)
+      continue;
+    if(fabs(trace->sum_bytes[adjoint][t] - bytes[t]) > 1e-12 * bytes[t]
+        || fabs(trace->sum_mpi_bytes[adjoint][t] - mpi_bytes[t]) > 1e-12 * mpi_bytes[t]){
+      fprintf(stderr, "* %s: hooks of %s saw %e bytes, counter has %e bytes\n",
+          dir, pnfft_timer_name(t), trace->sum_bytes[adjoint][t], bytes[t]);
+      failed = 1;
+    }
+  }
+  MPI_Allreduce(&failed, &global_failed, 1, MPI_INT, MPI_MAX, comm);
+
+  pfft_printf(comm, "* Stage hooks of %s: %.0f calls of matrix_B, %.0f of matrix_F, %.3e bytes in matrix_F %s\n",
+      dir, trace->calls[adjoint][PNFFT_TIMER_MATRIX_B], trace->calls[adjoint][PNFFT_TIMER_MATRIX_F],
+      trace->sum_bytes[adjoint][PNFFT_TIMER_MATRIX_F], (global_failed) ? "FAILED" : "passed");
+
+  pnfft_timer_free(timer);
+  pnfft_timer_free(bytes);
+  pnfft_timer_free(mpi_bytes);
+  return global_failed;
+}
+
+/* returns 1 if a trafo after removing the hooks still calls them */
+static int check_removed(
+    pnfft_plan pnfft, pnfft_nodes nodes, trace_s *trace,
+    MPI_Comm comm
+    )
+{
+  const double calls = trace->calls[0][PNFFT_TIMER_WHOLE];
+  int failed, global_failed;
+
+  pnfft_set_stage_hooks(pnfft, NULL, NULL, NULL);
+  pnfft_trafo(pnfft, nodes, PNFFT_COMPUTE_F);
+
+  failed = trace->failed || trace->depth != 0 || trace->calls[0][PNFFT_TIMER_WHOLE] != calls;
+  MPI_Allreduce(&failed, &global_failed, 1, MPI_INT, MPI_MAX, comm);
+
+  pfft_printf(comm, "* Removed stage hooks: %s\n", (global_failed) ? "FAILED" : "passed");
+  return global_failed;
+}
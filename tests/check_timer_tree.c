@@ -0,0 +1,154 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <complex.h>
+#include <pnfft.h>
+
+/* The children of every timer must not take longer than their parent (up to the resolution of MPI_Wtime),
+ * and the statistics over all processes must be ordered. The counters of a parent include its children. */
+#define TIMER_TOLERANCE 1e-3
+
+static int check_tree(
+    const double *timer, const char *dir, MPI_Comm comm);
+static int check_counters(
+    pnfft_plan pnfft, int adjoint, const char *dir, MPI_Comm comm);
+
+
+int main(int argc, char **argv){
+  int np[3], m, compare_direct=0, debug, failed=0;
+  unsigned pnfft_flags, compute_flags;
+  ptrdiff_t N[3], n[3], local_M;
+  ptrdiff_t local_N[3], local_N_start[3];
+  double x_max[3], lower_border[3], upper_border[3];
+  double *timer_trafo, *timer_adj;
+  pnfft_plan pnfft;
+  pnfft_nodes nodes;
+  MPI_Comm comm_cart_3d;
+
+  MPI_Init(&argc, &argv);
+  pnfft_init();
+
+  /* set values by commandline */
+  pnfft_check_init_parameters(argc, argv, N, n, &local_M, &m, &pnfft_flags, &compute_flags,
+      x_max, np, &compare_direct, &debug);
+  pnfft_flags |= PNFFT_MALLOC_F_HAT;
+
+  /* create three-dimensional process grid of size np[0] x np[1] x np[2], if possible */
+  if( pnfft_create_procmesh(3, MPI_COMM_WORLD, np, &comm_cart_3d) ){
+    pfft_fprintf(MPI_COMM_WORLD, stderr, "Error: Procmesh of size %d x %d x %d does not fit to number of allocated processes.\n", np[0], np[1], np[2]);
+    pfft_fprintf(MPI_COMM_WORLD, stderr, "       Please allocate %d processes (mpiexec -np %d ...) or change the procmesh (with -pnfft_np * * *).\n", np[0]*np[1]*np[2], np[0]*np[1]*np[2]);
+    MPI_Finalize();
+    return 1;
+  }
+
+  /* get parameters of data distribution and plan parallel NFFT */
+  pnfft_local_size_guru(3, N, n, x_max, m, comm_cart_3d, pnfft_flags,
+      local_N, local_N_start, lower_border, upper_border);
+  pnfft = pnfft_init_guru(3, N, n, x_max, m, pnfft_flags, PFFT_ESTIMATE, comm_cart_3d);
+
+  nodes = pnfft_init_nodes(local_M, PNFFT_MALLOC_X | PNFFT_MALLOC_F | PNFFT_MALLOC_GRAD_F);
+  pnfft_init_x_3d_adv(lower_border, upper_border, x_max, local_M,
+      pnfft_get_x(nodes));
+  pnfft_init_f_hat_3d(N, local_N, local_N_start, pnfft_flags & PNFFT_TRANSPOSED_F_HAT,
+      pnfft_get_f_hat(pnfft));
+
+  for(int k=0; k<3; k++){
+    pnfft_trafo(pnfft, nodes, PNFFT_COMPUTE_F | PNFFT_COMPUTE_GRAD_F);
+    pnfft_adj(pnfft, nodes, PNFFT_COMPUTE_F);
+  }
+
+  timer_trafo = pnfft_get_timer_trafo(pnfft);
+  timer_adj = pnfft_get_timer_adj(pnfft);
+  failed += check_tree(timer_trafo, "trafo", comm_cart_3d);
+  failed += check_tree(timer_adj, "adj", comm_cart_3d);
+  failed += check_counters(pnfft, 0, "trafo", comm_cart_3d);
+  failed += check_counters(pnfft, 1, "adj", comm_cart_3d);
+
+  pnfft_write_timer_tree_json(pnfft, "check_timer_tree.json", comm_cart_3d);
+  pnfft_write_timer_tree_csv(pnfft, "check_timer_tree.csv", comm_cart_3d);
+
+  /* free mem and finalize */
+  pnfft_timer_free(timer_trafo);
+  pnfft_timer_free(timer_adj);
+  pnfft_finalize(pnfft, PNFFT_FREE_F_HAT);
+  pnfft_free_nodes(nodes, PNFFT_FREE_X | PNFFT_FREE_F | PNFFT_FREE_GRAD_F);
+  MPI_Comm_free(&comm_cart_3d);
+  pnfft_cleanup();
+  MPI_Finalize();
+  return (failed) ? 1 : 0;
+}
+
+
+/* returns 1 if the children of a timer sum up to more than the timer or the statistics are not ordered,
+ * the sub-stages of the loop over the nodes are sampled estimates and only need to be non-negative */
+static int check_tree(
+    const double *timer, const char *dir, MPI_Comm comm
+    )
+{
+  int failed = 0, global_failed;
+  double sum[PNFFT_TIMER_LENGTH] = {0};
+  double min[PNFFT_TIMER_LENGTH], median[PNFFT_TIMER_LENGTH], max[PNFFT_TIMER_LENGTH];
+
+  for(int t=1; t<PNFFT_TIMER_LENGTH; t++)
+    if(pnfft_timer_parent(t) >= 0)
+      sum[pnfft_timer_parent(t)] += timer[t];
+
+  for(int t=1; t<PNFFT_TIMER_LENGTH; t++){
+    if(pnfft_timer_parent(t) == PNFFT_TIMER_LOOP_B && timer[t] < 0){
+      fprintf(stderr, "* %s: %s takes %e s\n", dir, pnfft_timer_name(t), timer[t]);
+      failed = 1;
+    }
+    if(t != PNFFT_TIMER_LOOP_B && sum[t] > timer[t] + TIMER_TOLERANCE){
+      fprintf(stderr, "* %s: children of %s take %e s, but %s takes %e s\n",
+          dir, pnfft_timer_name(t), sum[t], pnfft_timer_name(t), timer[t]);
+      failed = 1;
+    }
+  }
+  MPI_Allreduce(&failed, &global_failed, 1, MPI_INT, MPI_MAX, comm);
+
+  pnfft_timer_reduce_stats(comm, timer, min, median, max);
+  for(int t=0; t<PNFFT_TIMER_LENGTH; t++)
+    if(min[t] > median[t] || median[t] > max[t])
+      global_failed = 1;
+
+  pfft_printf(comm, "* Timer tree of %s: whole = %.3e s, loop_B = %.3e s (index %.3e s, window %.3e s, grid %.3e s) %s\n",
+      dir, max[PNFFT_TIMER_WHOLE], max[PNFFT_TIMER_LOOP_B], max[PNFFT_TIMER_INDEX], max[PNFFT_TIMER_WINDOW],
+      max[PNFFT_TIMER_GRID], (global_failed) ? "FAILED" : "passed");
+  return global_failed;
+}
+
+/* returns 1 if the children of a counter sum up to more than the counter or the grid access is not counted */
+static int check_counters(
+    pnfft_plan pnfft, int adjoint, const char *dir, MPI_Comm comm
+    )
+{
+  int failed = 0, global_failed;
+  double *counter[PNFFT_COUNTER_KINDS], *timer;
+
+  timer = (adjoint) ? pnfft_get_timer_adj(pnfft) : pnfft_get_timer_trafo(pnfft);
+  for(int k=0; k<PNFFT_COUNTER_KINDS; k++){
+    double sum[PNFFT_TIMER_LENGTH] = {0};
+    counter[k] = (adjoint) ? pnfft_get_counter_adj(pnfft, k) : pnfft_get_counter_trafo(pnfft, k);
+    if(counter[k][PNFFT_TIMER_ITER] != timer[PNFFT_TIMER_ITER])
+      failed = 1;
+
+    for(int t=1; t<PNFFT_TIMER_LENGTH; t++)
+      if(pnfft_timer_parent(t) >= 0)
+        sum[pnfft_timer_parent(t)] += counter[k][t];
+    for(int t=1; t<PNFFT_TIMER_LENGTH; t++)
+      if(sum[t] > counter[k][t] * (1.0 + 1e-12))
+        failed = 1;
+  }
+  if(counter[PNFFT_COUNTER_FLOPS][PNFFT_TIMER_GRID] <= 0 || counter[PNFFT_COUNTER_BYTES][PNFFT_TIMER_GRID] <= 0)
+    failed = 1;
+  MPI_Allreduce(&failed, &global_failed, 1, MPI_INT, MPI_MAX, comm);
+
+  pfft_printf(comm, "* Counters of %s: grid %.3e GFlop/s, %.3e GB/s, FFT %.3e MB sent %s\n", dir,
+      (timer[PNFFT_TIMER_GRID] > 0) ? 1e-9 * counter[PNFFT_COUNTER_FLOPS][PNFFT_TIMER_GRID] / timer[PNFFT_TIMER_GRID] : 0.0,
+      (timer[PNFFT_TIMER_GRID] > 0) ? 1e-9 * counter[PNFFT_COUNTER_BYTES][PNFFT_TIMER_GRID] / timer[PNFFT_TIMER_GRID] : 0.0,
+      1e-6 * counter[PNFFT_COUNTER_MPI_BYTES][PNFFT_TIMER_MATRIX_F], (global_failed) ? "FAILED" : "passed");
+
+  for(int k=0; k<PNFFT_COUNTER_KINDS; k++)
+    pnfft_timer_free(counter[k]);
+  pnfft_timer_free(timer);
+  return global_failed;
+}
@@ -0,0 +1,148 @@
+#include <stdlib.h>
+#include <complex.h>
+#include <pnfft.h>
+
+/* Plans of pnfft_init_guru_aniso use one cutoff per dimension. With equal cutoffs they must
+ * reproduce pnfft_init_guru, with different cutoffs the error is dominated by the smallest one. */
+#define ERROR_TOLERANCE_FACTOR 10.0
+
+static double relative_error(
+    const ptrdiff_t *N, const ptrdiff_t *n, const double *x_max, int m_guru, const int *m,
+    ptrdiff_t local_M, unsigned pnfft_flags, MPI_Comm comm_cart_3d,
+    pnfft_complex *f_fast);
+
+
+int main(int argc, char **argv){
+  int np[3], m, compare_direct=0, debug, failed=0;
+  int m_iso[3], m_aniso[3], m_min;
+  unsigned pnfft_flags, compute_flags;
+  ptrdiff_t N[3], n[3], local_M;
+  double x_max[3], err_guru, err_iso, err_aniso, err_min, local_diff = 0, diff;
+  pnfft_complex *f_guru, *f_iso;
+  MPI_Comm comm_cart_3d;
+
+  MPI_Init(&argc, &argv);
+  pnfft_init();
+
+  /* set values by commandline */
+  pnfft_check_init_parameters(argc, argv, N, n, &local_M, &m, &pnfft_flags, &compute_flags,
+      x_max, np, &compare_direct, &debug);
+  pnfft_flags &= PNFFT_WINDOW_GAUSSIAN | PNFFT_WINDOW_BSPLINE | PNFFT_WINDOW_SINC_POWER
+      | PNFFT_WINDOW_BESSEL_I0 | PNFFT_WINDOW_ES;
+  pnfft_flags |= PNFFT_MALLOC_F_HAT;
+
+  /* create three-dimensional process grid of size np[0] x np[1] x np[2], if possible */
+  if( pnfft_create_procmesh(3, MPI_COMM_WORLD, np, &comm_cart_3d) ){
+    pfft_fprintf(MPI_COMM_WORLD, stderr, "Error: Procmesh of size %d x %d x %d does not fit to number of allocated processes.\n", np[0], np[1], np[2]);
+    pfft_fprintf(MPI_COMM_WORLD, stderr, "       Please allocate %d processes (mpiexec -np %d ...) or change the procmesh (with -pnfft_np * * *).\n", np[0]*np[1]*np[2], np[0]*np[1]*np[2]);
+    MPI_Finalize();
+    return 1;
+  }
+
+  m_min = (m > 3) ? m-2 : 2;
+  for(int t=0; t<3; t++)
+    m_iso[t] = m;
+  m_aniso[0] = m; m_aniso[1] = m_min; m_aniso[2] = m+1;
+
+  f_guru = pnfft_alloc_complex(local_M);
+  f_iso  = pnfft_alloc_complex(local_M);
+
+  /* equal cutoffs: both interfaces run the same code, i.e., the results must be bitwise equal */
+  err_guru = relative_error(N, n, x_max, m, NULL, local_M, pnfft_flags, comm_cart_3d, f_guru);
+  err_iso  = relative_error(N, n, x_max, m, m_iso, local_M, pnfft_flags, comm_cart_3d, f_iso);
+  for(ptrdiff_t j=0; j<local_M; j++)
+    if( cabs(f_guru[j]-f_iso[j]) > local_diff)
+      local_diff = cabs(f_guru[j]-f_iso[j]);
+  MPI_Allreduce(&local_diff, &diff, 1, MPI_DOUBLE, MPI_MAX, comm_cart_3d);
+  pfft_printf(comm_cart_3d, "* Anisotropic plan with m = %d x %d x %d: relative error = %6.2e (init_guru: %6.2e), difference = %6.2e %s\n",
+      m_iso[0], m_iso[1], m_iso[2], err_iso, err_guru, diff, (diff == 0) ? "passed" : "FAILED");
+  failed += (diff != 0);
+
+  /* different cutoffs: compare with the isotropic plan of the smallest cutoff */
+  for(int t=0; t<3; t++)
+    m_iso[t] = m_min;
+  err_min = relative_error(N, n, x_max, m, m_iso, local_M, pnfft_flags, comm_cart_3d, f_iso);
+  err_aniso = relative_error(N, n, x_max, m, m_aniso, local_M, pnfft_flags, comm_cart_3d, f_iso);
+  pfft_printf(comm_cart_3d, "* Anisotropic plan with m = %d x %d x %d: relative error = %6.2e (m = %d: %6.2e) %s\n",
+      m_aniso[0], m_aniso[1], m_aniso[2], err_aniso, m_min, err_min,
+      (err_aniso <= ERROR_TOLERANCE_FACTOR * err_min) ? "passed" : "FAILED");
+  failed += (err_aniso > ERROR_TOLERANCE_FACTOR * err_min);
+
+  /* free mem and finalize */
+  pnfft_free(f_guru);
+  pnfft_free(f_iso);
+  MPI_Comm_free(&comm_cart_3d);
+  pnfft_cleanup();
+  MPI_Finalize();
+  return (failed) ? 1 : 0;
+}
+
+
+/* maximum error of the fast trafo compared to direct computation relative to the 1-norm of f_hat,
+ * m == NULL plans with pnfft_init_guru and the isotropic cutoff m_guru */
+static double relative_error(
+    const ptrdiff_t *N, const ptrdiff_t *n, const double *x_max, int m_guru, const int *m,
+    ptrdiff_t local_M, unsigned pnfft_flags, MPI_Comm comm_cart_3d,
+    pnfft_complex *f_fast
+    )
+{
+  int myrank;
+  ptrdiff_t local_N[3], local_N_start[3];
+  double lower_border[3], upper_border[3];
+  double local_err = 0, err, local_norm = 0, norm;
+  pnfft_complex *f, *f_hat, *f_ndft;
+  pnfft_plan pnfft;
+  pnfft_nodes nodes;
+
+  MPI_Comm_rank(comm_cart_3d, &myrank);
+
+  /* get parameters of data distribution and plan parallel NFFT */
+  if(m == NULL){
+    pnfft_local_size_guru(3, N, n, x_max, m_guru, comm_cart_3d, pnfft_flags,
+        local_N, local_N_start, lower_border, upper_border);
+    pnfft = pnfft_init_guru(3, N, n, x_max, m_guru, pnfft_flags, PFFT_ESTIMATE, comm_cart_3d);
+  } else {
+    pnfft_local_size_guru_aniso(3, N, n, x_max, m, comm_cart_3d, pnfft_flags,
+        local_N, local_N_start, lower_border, upper_border);
+    pnfft = pnfft_init_guru_aniso(3, N, n, x_max, m, pnfft_flags, PFFT_ESTIMATE, comm_cart_3d);
+  }
+
+  /* initialize nodes, use equal seeds for all runs */
+  nodes = pnfft_init_nodes(local_M, PNFFT_MALLOC_X | PNFFT_MALLOC_F);
+  f = pnfft_get_f(nodes);
+  f_hat = pnfft_get_f_hat(pnfft);
+  srand(myrank);
+  pnfft_init_x_3d_adv(lower_border, upper_border, x_max, local_M,
+      pnfft_get_x(nodes));
+
+  /* direct computation */
+  pnfft_init_f_hat_3d(N, local_N, local_N_start, pnfft_flags & PNFFT_TRANSPOSED_F_HAT,
+      f_hat);
+  for(ptrdiff_t k=0; k<local_N[0]*local_N[1]*local_N[2]; k++)
+    local_norm += cabs(f_hat[k]);
+  MPI_Allreduce(&local_norm, &norm, 1, MPI_DOUBLE, MPI_SUM, comm_cart_3d);
+
+  pnfft_trafo(pnfft, nodes, PNFFT_COMPUTE_DIRECT | PNFFT_COMPUTE_F);
+  f_ndft = pnfft_alloc_complex(local_M);
+  for(ptrdiff_t j=0; j<local_M; j++)
+    f_ndft[j] = f[j];
+
+  /* fast computation */
+  pnfft_init_f_hat_3d(N, local_N, local_N_start, pnfft_flags & PNFFT_TRANSPOSED_F_HAT,
+      f_hat);
+  pnfft_trafo(pnfft, nodes, PNFFT_COMPUTE_F);
+
+  for(ptrdiff_t j=0; j<local_M; j++){
+    f_fast[j] = f[j];
+    if( cabs(f[j]-f_ndft[j]) > local_err)
+      local_err = cabs(f[j]-f_ndft[j]);
+  }
+  MPI_Allreduce(&local_err, &err, 1, MPI_DOUBLE, MPI_MAX, comm_cart_3d);
+
+  /* free mem and finalize */
+  pnfft_finalize(pnfft, PNFFT_FREE_F_HAT);
+  pnfft_free_nodes(nodes, PNFFT_FREE_X | PNFFT_FREE_F);
+  pnfft_free(f_ndft);
+
+  return err / norm;
+}
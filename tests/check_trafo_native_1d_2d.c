@@ -0,0 +1,152 @@
+#include <stdlib.h>
+#include <complex.h>
+#include <pnfft.h>
+
+/* Native plans with d=2 and d=1 compare the fast trafo (f and gradient) with direct computation.
+ * The nodes hold three components, the unused ones are filled with garbage that must be ignored. */
+#define ERROR_TOLERANCE 1e-8
+
+static int check_dimension(
+    int d, const ptrdiff_t *N, ptrdiff_t local_M, int m,
+    MPI_Comm comm_cart);
+static double max_error(
+    const pnfft_complex *v1, const pnfft_complex *v2, ptrdiff_t size,
+    MPI_Comm comm);
+
+
+int main(int argc, char **argv){
+  int np, size, failed=0;
+  ptrdiff_t N[3] = {16, 14, 1}, local_M = 200;
+  int m = 6;
+  MPI_Comm comm_cart_1d, comm_self_1d;
+
+  MPI_Init(&argc, &argv);
+  pnfft_init();
+
+  /* the process mesh must not have more dimensions than the transform */
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  np = size;
+  if( pnfft_create_procmesh(1, MPI_COMM_WORLD, &np, &comm_cart_1d) ){
+    pfft_fprintf(MPI_COMM_WORLD, stderr, "Error: Procmesh of size %d does not fit to number of allocated processes.\n", np);
+    MPI_Finalize();
+    return 1;
+  }
+  np = 1;
+  pnfft_create_procmesh(1, MPI_COMM_SELF, &np, &comm_self_1d);
+
+  failed += check_dimension(2, N, local_M, m, comm_cart_1d);
+  failed += check_dimension(1, N, local_M, m, comm_self_1d);
+
+  /* free mem and finalize */
+  MPI_Comm_free(&comm_cart_1d);
+  MPI_Comm_free(&comm_self_1d);
+  pnfft_cleanup();
+  MPI_Finalize();
+  return (failed) ? 1 : 0;
+}
+
+
+/* returns 1 if f or grad_f of the fast trafo differ from direct computation */
+static int check_dimension(
+    int d, const ptrdiff_t *N, ptrdiff_t local_M, int m,
+    MPI_Comm comm_cart
+    )
+{
+  int myrank, failed=0;
+  unsigned pnfft_flags = PNFFT_MALLOC_F_HAT;
+  ptrdiff_t n[3], N_pad[3], local_N[3], local_N_start[3];
+  double x_max[3], lower_border[3], upper_border[3];
+  double local_norm = 0, norm, err_f, err_grad;
+  pnfft_complex *f, *grad_f, *f_hat, *f_ndft, *grad_f_ndft;
+  pnfft_plan pnfft;
+  pnfft_nodes nodes;
+
+  MPI_Comm_rank(comm_cart, &myrank);
+
+  /* pad all arrays to three entries for the 3d helper functions */
+  for(int t=0; t<3; t++){
+    N_pad[t] = (t < d) ? N[t] : 1;
+    n[t] = 2*N_pad[t];
+    x_max[t] = 0.5;
+    local_N[t] = 1; local_N_start[t] = 0;
+    lower_border[t] = upper_border[t] = 0;
+  }
+
+  /* get parameters of data distribution, only d entries are written */
+  pnfft_local_size_guru(d, N_pad, n, x_max, m, comm_cart, pnfft_flags,
+      local_N, local_N_start, lower_border, upper_border);
+
+  /* plan parallel NFFT */
+  pnfft = pnfft_init_guru(d, N_pad, n, x_max, m,
+      pnfft_flags, PFFT_ESTIMATE, comm_cart);
+  if(pnfft == NULL){
+    pfft_printf(comm_cart, "* Native plan with d = %d FAILED\n", d);
+    return 1;
+  }
+
+  /* initialize nodes and Fourier coefficients */
+  nodes = pnfft_init_nodes(local_M, PNFFT_MALLOC_X | PNFFT_MALLOC_F | PNFFT_MALLOC_GRAD_F);
+  f = pnfft_get_f(nodes);
+  grad_f = pnfft_get_grad_f(nodes);
+  f_hat = pnfft_get_f_hat(pnfft);
+
+  srand(myrank);
+  pnfft_init_x_3d_adv(lower_border, upper_border, x_max, local_M,
+      pnfft_get_x(nodes));
+  for(ptrdiff_t j=0; j<local_M; j++)
+    for(int t=d; t<3; t++)
+      pnfft_get_x(nodes)[3*j+t] = 1e3 * (t+1);
+
+  pnfft_init_f_hat_3d(N_pad, local_N, local_N_start, 0,
+      f_hat);
+  for(ptrdiff_t k=0; k<local_N[0]*local_N[1]*local_N[2]; k++)
+    local_norm += cabs(f_hat[k]);
+  MPI_Allreduce(&local_norm, &norm, 1, MPI_DOUBLE, MPI_SUM, comm_cart);
+
+  /* direct computation, f_hat is preserved */
+  pnfft_trafo(pnfft, nodes, PNFFT_COMPUTE_DIRECT | PNFFT_COMPUTE_F | PNFFT_COMPUTE_GRAD_F);
+  f_ndft = pnfft_alloc_complex(local_M);
+  grad_f_ndft = pnfft_alloc_complex(3*local_M);
+  for(ptrdiff_t j=0; j<local_M; j++)
+    f_ndft[j] = f[j];
+  for(ptrdiff_t j=0; j<3*local_M; j++)
+    grad_f_ndft[j] = grad_f[j];
+
+  /* fast computation */
+  pnfft_init_f_hat_3d(N_pad, local_N, local_N_start, 0,
+      f_hat);
+  pnfft_trafo(pnfft, nodes, PNFFT_COMPUTE_F | PNFFT_COMPUTE_GRAD_F);
+
+  err_f = max_error(f, f_ndft, local_M, comm_cart) / norm;
+  err_grad = max_error(grad_f, grad_f_ndft, 3*local_M, comm_cart) / norm;
+
+  pfft_printf(comm_cart, "* Results in f of native plan with d = %d - relative error = %6.2e %s\n",
+      d, err_f, (err_f <= ERROR_TOLERANCE) ? "passed" : "FAILED");
+  /* the gradient grows with the bandwidth */
+  pfft_printf(comm_cart, "* Results in grad_f of native plan with d = %d - relative error = %6.2e %s\n",
+      d, err_grad, (err_grad <= ERROR_TOLERANCE * N[0]) ? "passed" : "FAILED");
+  failed += (err_f > ERROR_TOLERANCE) + (err_grad > ERROR_TOLERANCE * N[0]);
+
+  /* free mem and finalize */
+  pnfft_finalize(pnfft, PNFFT_FREE_F_HAT);
+  pnfft_free_nodes(nodes, PNFFT_FREE_X | PNFFT_FREE_F | PNFFT_FREE_GRAD_F);
+  pnfft_free(f_ndft);
+  pnfft_free(grad_f_ndft);
+
+  return (failed) ? 1 : 0;
+}
+
+static double max_error(
+    const pnfft_complex *v1, const pnfft_complex *v2, ptrdiff_t size,
+    MPI_Comm comm
+    )
+{
+  double local = 0, global;
+
+  for(ptrdiff_t j=0; j<size; j++)
+    if( cabs(v1[j]-v2[j]) > local)
+      local = cabs(v1[j]-v2[j]);
+
+  MPI_Allreduce(&local, &global, 1, MPI_DOUBLE, MPI_MAX, comm);
+  return global;
+}
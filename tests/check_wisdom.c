@@ -0,0 +1,235 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <complex.h>
+#include <pnfft.h>
+
+/* Export the wisdom of a plan with piecewise polynomial window, forget it and import it again.
+ * A second plan with equal parameters must reproduce the results of the first plan exactly.
+ * The imported degree must be used: after raising the degree in the file, a third plan must take it. */
+#define WISDOM_FILE "check_wisdom.dat"
+
+static void pnfft_perform_guru(
+    const ptrdiff_t *N, const ptrdiff_t *n, ptrdiff_t local_M,
+    int m, const double *x_max,
+    unsigned pnfft_flags, unsigned compute_flags,
+    const int *np, MPI_Comm comm, const char *name,
+    pnfft_complex **f, int *poly_degree);
+static int raise_poly_degree(
+    const char *filename, int poly_degree, MPI_Comm comm);
+
+static int compare(
+    const pnfft_complex *v1, const pnfft_complex *v2, ptrdiff_t local_M,
+    const char *name, MPI_Comm comm);
+
+
+int main(int argc, char **argv){
+  int np[3], m, compare_direct=0, debug, failed=0;
+  int degree1, degree2, degree3, myrank;
+  unsigned pnfft_flags;
+  ptrdiff_t N[3], n[3], local_M;
+  double x_max[3];
+  unsigned compute_flags;
+  pnfft_complex *f1=NULL, *f2=NULL, *f3=NULL;
+
+  MPI_Init(&argc, &argv);
+  pnfft_init();
+
+  /* set values by commandline */
+  pnfft_check_init_parameters(argc, argv, N, n, &local_M, &m, &pnfft_flags, &compute_flags,
+      x_max, np, &compare_direct, &debug);
+
+  /* the polynomial degree is the derived parameter stored in the wisdom */
+  pnfft_flags &= ~(PNFFT_PRE_INTPOL_PSI | PNFFT_FAST_GAUSSIAN);
+  pnfft_flags |= PNFFT_PRE_POLY_PSI;
+  compute_flags = PNFFT_COMPUTE_F;
+
+  pnfft_perform_guru(N, n, local_M, m, x_max, pnfft_flags, compute_flags,
+      np, MPI_COMM_WORLD, "PNFFT without imported wisdom",
+      &f1, &degree1);
+
+  if( !pnfft_export_wisdom(WISDOM_FILE, MPI_COMM_WORLD) ){
+    pfft_printf(MPI_COMM_WORLD, "* Export of wisdom to %s FAILED\n", WISDOM_FILE);
+    failed++;
+  }
+
+  pnfft_forget_wisdom();
+
+  if( !pnfft_import_wisdom(WISDOM_FILE, MPI_COMM_WORLD) ){
+    pfft_printf(MPI_COMM_WORLD, "* Import of wisdom from %s FAILED\n", WISDOM_FILE);
+    failed++;
+  }
+
+  pnfft_perform_guru(N, n, local_M, m, x_max, pnfft_flags, compute_flags,
+      np, MPI_COMM_WORLD, "PNFFT with imported wisdom",
+      &f2, &degree2);
+
+  failed += compare(f1, f2, local_M, "* Results in f", MPI_COMM_WORLD);
+
+  pfft_printf(MPI_COMM_WORLD, "* Imported polynomial degree %d, exported %d %s\n",
+      degree2, degree1, (degree1 > 0 && degree2 == degree1) ? "passed" : "FAILED");
+  if(degree1 <= 0 || degree2 != degree1)
+    failed++;
+
+  /* a larger degree in the wisdom is the starting guess of the fit and must be kept */
+  if( raise_poly_degree(WISDOM_FILE, degree1, MPI_COMM_WORLD) ){
+    pnfft_forget_wisdom();
+    pnfft_import_wisdom(WISDOM_FILE, MPI_COMM_WORLD);
+    pnfft_perform_guru(N, n, local_M, m, x_max, pnfft_flags, compute_flags,
+        np, MPI_COMM_WORLD, "PNFFT with modified wisdom",
+        &f3, &degree3);
+
+    pfft_printf(MPI_COMM_WORLD, "* Polynomial degree from modified wisdom %d, expected %d %s\n",
+        degree3, degree1+1, (degree3 == degree1+1) ? "passed" : "FAILED");
+    if(degree3 != degree1+1)
+      failed++;
+  }
+
+  /* free mem and finalize */
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  if(myrank == 0)
+    remove(WISDOM_FILE);
+  if(f1) pnfft_free(f1);
+  if(f2) pnfft_free(f2);
+  if(f3) pnfft_free(f3);
+  pnfft_cleanup();
+  MPI_Finalize();
+  return (failed) ? 1 : 0;
+}
+
+
+static void pnfft_perform_guru(
+    const ptrdiff_t *N, const ptrdiff_t *n, ptrdiff_t local_M,
+    int m, const double *x_max,
+    unsigned pnfft_flags, unsigned compute_flags,
+    const int *np, MPI_Comm comm, const char *name,
+    pnfft_complex **f, int *poly_degree
+    )
+{
+  int myrank;
+  ptrdiff_t local_N[3], local_N_start[3];
+  double lower_border[3], upper_border[3];
+  double time, time_max;
+  MPI_Comm comm_cart_3d;
+  pnfft_complex *f_hat;
+  double *x;
+  pnfft_plan pnfft;
+  pnfft_nodes nodes;
+
+  /* create three-dimensional process grid of size np[0] x np[1] x np[2], if possible */
+  if( pnfft_create_procmesh(3, comm, np, &comm_cart_3d) ){
+    pfft_fprintf(comm, stderr, "Error: Procmesh of size %d x %d x %d does not fit to number of allocated processes.\n", np[0], np[1], np[2]);
+    pfft_fprintf(comm, stderr, "       Please allocate %d processes (mpiexec -np %d ...) or change the procmesh (with -pnfft_np * * *).\n", np[0]*np[1]*np[2], np[0]*np[1]*np[2]);
+    MPI_Finalize();
+    exit(1);
+  }
+
+  MPI_Comm_rank(comm_cart_3d, &myrank);
+
+  /* get parameters of data distribution */
+  pnfft_local_size_guru(3, N, n, x_max, m, comm_cart_3d, pnfft_flags & PNFFT_TRANSPOSED_F_HAT,
+      local_N, local_N_start, lower_border, upper_border);
+
+  /* plan parallel NFFT, including the fit of the polynomial window */
+  time = -MPI_Wtime();
+  pnfft = pnfft_init_guru(3, N, n, x_max, m,
+      PNFFT_MALLOC_F_HAT | pnfft_flags, PFFT_ESTIMATE,
+      comm_cart_3d);
+  time += MPI_Wtime();
+
+  /* print timing */
+  MPI_Reduce(&time, &time_max, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+  pfft_printf(comm, "%s: planning needs %6.2e s\n", name, time_max);
+
+  /* initialize nodes */
+  nodes = pnfft_init_nodes(local_M, PNFFT_MALLOC_X | PNFFT_MALLOC_F);
+
+  /* get data pointers */
+  f_hat = pnfft_get_f_hat(pnfft);
+  *f    = pnfft_get_f(nodes);
+  x     = pnfft_get_x(nodes);
+
+  /* initialize Fourier coefficients */
+  pnfft_init_f_hat_3d(N, local_N, local_N_start, pnfft_flags & PNFFT_TRANSPOSED_F_HAT,
+      f_hat);
+
+  /* initialize nonequispaced nodes, use equal seeds for both runs */
+  srand(myrank);
+  pnfft_init_x_3d_adv(lower_border, upper_border, x_max, local_M,
+      x);
+
+  /* execute parallel NFFT */
+  pnfft_trafo(pnfft, nodes, compute_flags);
+  *poly_degree = pnfft_get_poly_degree(pnfft);
+
+  /* free mem and finalize, do not free f */
+  pnfft_finalize(pnfft, PNFFT_FREE_F_HAT);
+  pnfft_free_nodes(nodes, PNFFT_FREE_X);
+  MPI_Comm_free(&comm_cart_3d);
+}
+
+/* Rank 0 replaces the polynomial degree of the plan record in the wisdom file by poly_degree+1.
+ * Returns 1 on all processes if the file was rewritten. */
+static int raise_poly_degree(
+    const char *filename, int poly_degree, MPI_Comm comm
+    )
+{
+  int myrank, success = 0;
+  long len = -1;
+  char *buf = NULL;
+  FILE *file;
+
+  MPI_Comm_rank(comm, &myrank);
+
+  /* the fit uses at most degree 24 */
+  if(myrank == 0 && poly_degree < 24){
+    if( (file = fopen(filename, "rb")) != NULL ){
+      if( (fseek(file, 0, SEEK_END) == 0) && ((len = ftell(file)) >= 0) && (fseek(file, 0, SEEK_SET) == 0) ){
+        buf = (char*) malloc((size_t) len + 1);
+        if( fread(buf, 1, (size_t) len, file) != (size_t) len )
+          len = -1;
+      }
+      fclose(file);
+    }
+
+    /* the degree is the last entry of the only plan record */
+    if(len >= 0){
+      char *record, *end, *num;
+      buf[len] = '\0';
+      record = strstr(buf, "(plan ");
+      end = (record != NULL) ? strchr(record, ')') : NULL;
+      if(end != NULL){
+        for(num = end; num > record && num[-1] != ' '; num--);
+        if( (atoi(num) == poly_degree) && ((file = fopen(filename, "wb")) != NULL) ){
+          fwrite(buf, 1, (size_t) (num - buf), file);
+          fprintf(file, "%d", poly_degree + 1);
+          fputs(end, file);
+          success = (fclose(file) == 0);
+        }
+      }
+    }
+    free(buf);
+  }
+
+  MPI_Bcast(&success, 1, MPI_INT, 0, comm);
+  return success;
+}
+
+/* maximum absolute difference, returns 1 if the results are not identical */
+static int compare(
+    const pnfft_complex *v1, const pnfft_complex *v2, ptrdiff_t local_M,
+    const char *name, MPI_Comm comm
+    )
+{
+  double local = 0, global;
+
+  for(ptrdiff_t j=0; j<local_M; j++)
+    if( cabs(v1[j]-v2[j]) > local)
+      local = cabs(v1[j]-v2[j]);
+
+  MPI_Allreduce(&local, &global, 1, MPI_DOUBLE, MPI_MAX, comm);
+
+  pfft_printf(comm, "%s - absolute error = %6.2e %s\n",
+      name, global, (global == 0) ? "passed" : "FAILED");
+  return (global != 0);
+}
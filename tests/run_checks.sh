@@ -19,6 +19,20 @@ test_files_8="$test_files check_adj check_adj_transposed"
 test_files_8="$test_files check_adjvs_ndft check_adj_vs_ndft_c2r"
 test_files_8="$test_files pnfft_test pnfft_test_adv"
 
+## Checks of single features, appended to the list above:
+test_files_8="$test_files_8 check_diff_intpol"
+test_files_8="$test_files_8 check_wisdom"
+test_files_8="$test_files_8 check_plan_pool"
+test_files_8="$test_files_8 check_init_auto"
+test_files_8="$test_files_8 check_low_oversampling"
+test_files_8="$test_files_8 check_trafo_native_1d_2d"
+test_files_8="$test_files_8 check_trafo_aniso"
+test_files_8="$test_files_8 check_timer_tree"
+test_files_8="$test_files_8 check_memory_usage"
+test_files_8="$test_files_8 check_node_distributions"
+test_files_8="$test_files_8 check_stage_hooks"
+test_files_8="$test_files_8 check_pre_psi_hessian"
+
 # test_files_8="$test_files simple_test_c2r_c2c_compare_complex"
 # test_files_8="$test_files simple_test_c2r_c2c_compare_grad"
 # test_files_8="$test_files simple_test_c2r_c2c_compare_real"